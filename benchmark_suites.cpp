@@ -0,0 +1,147 @@
+/**
+ * @file benchmark_suites.cpp
+ * @brief 性能基准测试套件实现
+ *
+ * 每个基准测试用micros()计时固定迭代次数，输出单次平均耗时，
+ * 用于对比优化前后的实现
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#define LOG_MODULE TEST
+
+#include "benchmark_suites.h"
+#include "display_manager.h"
+#include "global_config.h"
+#include "utils.h"
+#include "logger.h"
+
+// 防止编译器把被测计算优化掉
+static volatile long benchmarkSink = 0;
+
+// 辅助：输出单项基准结果
+static void reportBenchmark(const char* name, unsigned long elapsedUs, uint32_t iterations) {
+    unsigned long nsPerOp = (unsigned long)((uint64_t)elapsedUs * 1000 / iterations);
+    LOG_INFO("  %-28s %8lu us / %lu iters = %lu ns/op", name, elapsedUs, (unsigned long)iterations, nsPerOp);
+}
+
+// =============================================================================
+// 圩日计算基准
+// =============================================================================
+
+// 对照组：优化前逐年逐月累加的天数计算
+static bool legacyIsLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+}
+
+static int legacyDaysInMonth(int month, int year) {
+    if (month == 2) return legacyIsLeapYear(year) ? 29 : 28;
+    if (month == 4 || month == 6 || month == 9 || month == 11) return 30;
+    return 31;
+}
+
+static long legacyDaysSinceBaseDate(int year, int month, int day) {
+    long days = 0;
+    for (int y = MarketConfig::BASE_YEAR; y < year; y++) {
+        days += legacyIsLeapYear(y) ? 366 : 365;
+    }
+    for (int m = 1; m < month; m++) {
+        days += legacyDaysInMonth(m, year);
+    }
+    return days + (day - 1);
+}
+
+/**
+ * @brief 圩日计算：逐年循环 vs 常数时间公式 vs 按日缓存
+ *
+ * 取2099-12-31作为最坏情况（旧实现需循环99年）
+ */
+void runBenchmark_marketDay() {
+    const uint32_t iterations = 10000;
+    const int year = 2099;
+    const int month = 12;
+    const int day = 31;
+
+    LOG_INFO("=== Benchmark: marketDay ===");
+
+    unsigned long start = micros();
+    for (uint32_t i = 0; i < iterations; i++) {
+        long d = legacyDaysSinceBaseDate(year, month, day);
+        benchmarkSink += ((d % MarketConfig::CYCLE_DAYS) + MarketConfig::CYCLE_DAYS) % MarketConfig::CYCLE_DAYS;
+    }
+    reportBenchmark("legacy year/month loop", micros() - start, iterations);
+
+    start = micros();
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchmarkSink += getMarketIndexForDate(year, month, day - (int)(i & 1));
+    }
+    reportBenchmark("daysFromCivil", micros() - start, iterations);
+
+    start = micros();
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchmarkSink += getMarketDayInfo(year, month, day).marketIndex;
+    }
+    reportBenchmark("per-day cache hit", micros() - start, iterations);
+}
+
+// =============================================================================
+// 日志调用基准
+// =============================================================================
+
+/**
+ * @brief 日志调用处的开销：调用处vsnprintf格式化 vs 延迟日志只保存参数
+ *
+ * 不含串口输出：115200波特下一行约5毫秒，远大于两者，延迟日志省下的主要是这部分。
+ * 缓冲区每32条取空一次，取出时的格式化单独计时
+ */
+void runBenchmark_logging() {
+    const uint32_t iterations = 3200;
+    const char* server = "ntp.aliyun.com";
+    char line[256];
+
+    LOG_INFO("=== Benchmark: logging ===");
+
+    unsigned long start = micros();
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchmarkSink += snprintf(line, sizeof(line), "NTP reply from %s: offset %+ld ms, delay %lu ms",
+                                  server, (long)i - 1600, (unsigned long)(i & 63));
+    }
+    reportBenchmark("vsnprintf at call site", micros() - start, iterations);
+
+    LogLevel level = logConfig.currentLevel;
+    logConfig.currentLevel = LOG_LEVEL_DEBUG;
+    flushLogBuffer();
+    bool deferred = setLogDeferred(true);
+    unsigned long recordUs = 0;
+    unsigned long formatUs = 0;
+    for (uint32_t i = 0; i < iterations; i += 32) {
+        start = micros();
+        for (uint32_t k = i; k < i + 32; k++) {
+            LOG_DEBUG("NTP reply from %s: offset %+ld ms, delay %lu ms", server, (long)k - 1600, (unsigned long)(k & 63));
+        }
+        recordUs += micros() - start;
+        start = micros();
+        while (popLogLine(line, sizeof(line))) {
+            benchmarkSink += line[0];
+        }
+        formatUs += micros() - start;
+    }
+    setLogDeferred(deferred);
+    logConfig.currentLevel = level;
+    reportBenchmark("deferred record", recordUs, iterations);
+    reportBenchmark("deferred format in idle", formatUs, iterations);
+}
+
+/**
+ * @brief 运行所有基准测试
+ */
+void runAllBenchmarks() {
+    LOG_INFO("========================================");
+    LOG_INFO("  Benchmarks");
+    LOG_INFO("========================================");
+    runBenchmark_marketDay();
+    runBenchmark_logging();
+    LOG_INFO("========================================");
+}
@@ -0,0 +1,22 @@
+/**
+ * @file benchmark_suites.h
+ * @brief 性能基准测试套件声明
+ *
+ * 基准测试与单元测试共用测试运行器，可在目标板或主机构建中运行
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef BENCHMARK_SUITES_H
+#define BENCHMARK_SUITES_H
+
+#include <Arduino.h>
+
+// 基准测试函数声明
+void runAllBenchmarks();
+void runBenchmark_marketDay();
+void runBenchmark_logging();
+
+#endif // BENCHMARK_SUITES_H
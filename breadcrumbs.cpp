@@ -0,0 +1,385 @@
+/**
+ * @file breadcrumbs.cpp
+ * @brief 跨重启保留的诊断记录实现
+ *
+ * RTC用户内存共512字节，前128字节由OTA引导程序（eboot）使用，
+ * 记录从第128字节起存放：16字节头部 + 13条28字节的记录。
+ * 每次写入只更新变化的几个字（记录本身和头部的位置字），不必重算校验；
+ * 上电时RTC内存内容随机，以魔数和位置范围判断是否有效。
+ *
+ * 正在执行的分段按进入顺序压入头部的一个字（每层8位，最多4层），
+ * 看门狗复位时这个字就是卡住的位置。分段编号按首次执行的顺序登记，
+ * 同一固件每次启动通常相同，启动后再查看报告即可显示为分段名
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#include "breadcrumbs.h"
+#include "global_config.h"
+#include "config.h"
+#include "logger.h"
+#include <stddef.h>
+#include <string.h>
+
+// RTC用户内存布局（偏移以4字节块计）
+static const uint32_t BREADCRUMB_RTC_BLOCK = 32;   // 跳过eboot使用的前128字节
+static const uint32_t BREADCRUMB_MAGIC = 0x42435232; // "BCR2"
+
+struct BreadcrumbHeader {
+  uint32_t magic;
+  uint32_t bootCount;           // 记录所在的启动序号
+  uint32_t sectionTrail;        // 正在执行的分段，最内层在低8位
+  uint8_t head;                 // 下一条记录的位置
+  uint8_t count;                // 有效记录数
+  uint16_t reserved;
+};
+
+static const uint32_t HEADER_WORDS = sizeof(BreadcrumbHeader) / 4;
+static const uint32_t ENTRY_WORDS = sizeof(Breadcrumb) / 4;
+static const uint32_t TRAIL_WORD = offsetof(BreadcrumbHeader, sectionTrail) / 4;
+static const uint32_t POSITION_WORD = offsetof(BreadcrumbHeader, head) / 4;
+
+static_assert((BREADCRUMB_RTC_BLOCK + HEADER_WORDS + BREADCRUMB_CAPACITY * ENTRY_WORDS) * 4 <= 512,
+              "breadcrumb ring exceeds RTC user memory");
+
+// DS1307 NVRAM镜像：魔数(1) 版本(1) 记录(28) CRC8(1)，放在时钟频率修正记录之后
+static const uint8_t MIRROR_NVRAM_ADDR = 24;
+static const uint8_t MIRROR_MAGIC = 0xBC;
+static const uint8_t MIRROR_VERSION = 2;
+static const uint8_t MIRROR_SIZE = 2 + sizeof(Breadcrumb) + 1;
+
+static_assert(MIRROR_NVRAM_ADDR + MIRROR_SIZE <= 56, "breadcrumb mirror exceeds DS1307 NVRAM");
+
+// 本次启动的头部（RTC内存中头部的副本）与上次启动留下的记录
+static BreadcrumbHeader current;
+static struct {
+  bool valid;
+  bool fromNvram;               // 来自DS1307镜像（RTC内存在断电时丢失）
+  BreadcrumbHeader header;
+  Breadcrumb entries[BREADCRUMB_CAPACITY]; // 按时间先后排列
+} previous;
+
+// 辅助：CRC8（多项式0x07，与EEPROM配置的校验一致）
+static uint8_t breadcrumbCrc8(const uint8_t* data, size_t len) {
+  uint8_t crc = 0x00;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+static void writeHeaderWord(uint32_t word) {
+  ESP.rtcUserMemoryWrite(BREADCRUMB_RTC_BLOCK + word, reinterpret_cast<uint32_t*>(&current) + word, 4);
+}
+
+/**
+ * @brief 取出上次启动留下的记录，开始本次启动的记录（启动时尽早调用）
+ */
+void initBreadcrumbs() {
+  BreadcrumbHeader header;
+  ESP.rtcUserMemoryRead(BREADCRUMB_RTC_BLOCK, reinterpret_cast<uint32_t*>(&header), sizeof(header));
+  previous.valid = header.magic == BREADCRUMB_MAGIC && header.head < BREADCRUMB_CAPACITY &&
+                   header.count <= BREADCRUMB_CAPACITY;
+  previous.fromNvram = false;
+  if (previous.valid) {
+    previous.header = header;
+    uint8_t first = (header.head + BREADCRUMB_CAPACITY - header.count) % BREADCRUMB_CAPACITY;
+    for (uint8_t i = 0; i < header.count; i++) {
+      uint8_t slot = (first + i) % BREADCRUMB_CAPACITY;
+      ESP.rtcUserMemoryRead(BREADCRUMB_RTC_BLOCK + HEADER_WORDS + slot * ENTRY_WORDS,
+                            reinterpret_cast<uint32_t*>(&previous.entries[i]), sizeof(Breadcrumb));
+    }
+  }
+
+  current.magic = BREADCRUMB_MAGIC;
+  current.bootCount = previous.valid ? previous.header.bootCount + 1 : 1;
+  current.sectionTrail = 0;
+  current.head = 0;
+  current.count = 0;
+  current.reserved = 0;
+  ESP.rtcUserMemoryWrite(BREADCRUMB_RTC_BLOCK, reinterpret_cast<uint32_t*>(&current), sizeof(current));
+}
+
+/**
+ * @brief RTC内存中没有上次的记录（断电重启）时改用DS1307 NVRAM中的镜像（在RTC初始化后调用）
+ *
+ * 镜像只显示一次，读取后清除
+ */
+void loadBreadcrumbMirror() {
+  if (!BREADCRUMB_NVRAM_MIRROR || !systemState.rtcInitialized || previous.valid) {
+    return;
+  }
+  uint8_t record[MIRROR_SIZE];
+  rtc.readnvram(record, MIRROR_SIZE, MIRROR_NVRAM_ADDR);
+  if (record[0] != MIRROR_MAGIC || record[1] != MIRROR_VERSION ||
+      record[MIRROR_SIZE - 1] != breadcrumbCrc8(record, MIRROR_SIZE - 1)) {
+    return;
+  }
+  memcpy(&previous.entries[0], record + 2, sizeof(Breadcrumb));
+  memset(&previous.header, 0, sizeof(previous.header));
+  previous.header.count = 1;
+  previous.valid = true;
+  previous.fromNvram = true;
+  rtc.writenvram(MIRROR_NVRAM_ADDR, 0);
+}
+
+// 辅助：填写记录的公共字段
+static void initEntry(Breadcrumb& entry, BreadcrumbType type, uint8_t code, uint8_t level) {
+  entry.millis = millis();
+  entry.type = type;
+  entry.code = code;
+  entry.level = level;
+  entry.section = (uint8_t)(current.sectionTrail & 0xFF);
+  memset(entry.text, 0, sizeof(entry.text));
+  entry.arg = 0;
+}
+
+// 辅助：写入RTC用户内存并前移位置
+static void appendEntry(Breadcrumb& entry) {
+  ESP.rtcUserMemoryWrite(BREADCRUMB_RTC_BLOCK + HEADER_WORDS + current.head * ENTRY_WORDS,
+                         reinterpret_cast<uint32_t*>(&entry), sizeof(entry));
+
+  current.head = (current.head + 1) % BREADCRUMB_CAPACITY;
+  if (current.count < BREADCRUMB_CAPACITY) {
+    current.count++;
+  }
+  writeHeaderWord(POSITION_WORD);
+}
+
+/**
+ * @brief 追加一条记录
+ * @param text 说明文字，超过BREADCRUMB_TEXT_SIZE的部分截断，可为NULL
+ */
+void addBreadcrumb(BreadcrumbType type, uint8_t code, uint8_t level, const char* text) {
+  if (current.magic != BREADCRUMB_MAGIC) {
+    return;  // initBreadcrumbs()之前
+  }
+  Breadcrumb entry;
+  initEntry(entry, type, code, level);
+  if (text != NULL) {
+    memcpy(entry.text, text, strnlen(text, sizeof(entry.text)));
+  }
+  appendEntry(entry);
+}
+
+/**
+ * @brief 追加一条日志记录：只复制格式串开头和第一个整数参数，不做格式化
+ * @param logLevel 日志级别
+ * @param format 格式串
+ * @param progmem 格式串是否在Flash中
+ * @param argKind 第一个参数的类型，没有整数参数时为BREADCRUMB_ARG_NONE
+ * @param arg 第一个整数参数
+ */
+void addLogBreadcrumb(uint8_t logLevel, const char* format, bool progmem, BreadcrumbArg argKind, uint32_t arg) {
+  if (current.magic != BREADCRUMB_MAGIC) {
+    return;
+  }
+  Breadcrumb entry;
+  initEntry(entry, BREADCRUMB_LOG, logLevel, argKind);
+  for (size_t i = 0; i < sizeof(entry.text); i++) {
+    char c = progmem ? (char)pgm_read_byte(format + i) : format[i];
+    if (c == '\0') {
+      break;
+    }
+    entry.text[i] = c;
+  }
+  entry.arg = arg;
+  appendEntry(entry);
+}
+
+// 分段名称表，下标为分段编号
+static const char* sectionNames[BREADCRUMB_MAX_SECTIONS];
+static uint8_t sectionCount = 0;
+
+/**
+ * @brief 登记分段（同名的调用点共用一个分段）
+ * @return 分段编号，分段表已满时返回0xFF（不记录）
+ */
+uint8_t registerBreadcrumbSection(const char* name) {
+  for (uint8_t i = 0; i < sectionCount; i++) {
+    if (strcmp(sectionNames[i], name) == 0) {
+      return i;
+    }
+  }
+  if (sectionCount >= BREADCRUMB_MAX_SECTIONS) {
+    LOG_WARNING("Breadcrumb section table full, ignoring %s", name);
+    return 0xFF;
+  }
+  sectionNames[sectionCount] = name;
+  return sectionCount++;
+}
+
+/**
+ * @brief 分段名称
+ * @return 名称，未登记时返回NULL
+ */
+const char* getBreadcrumbSectionName(uint8_t section) {
+  return section < sectionCount ? sectionNames[section] : NULL;
+}
+
+/**
+ * @brief 进入分段（由BREADCRUMB_SECTION调用）
+ * @return 进入前的分段记录，离开时交给leaveBreadcrumbSection()
+ */
+uint32_t enterBreadcrumbSection(uint8_t section) {
+  uint32_t trail = current.sectionTrail;
+  if (section < 0xFF) {
+    current.sectionTrail = (trail << 8) | (uint8_t)(section + 1);
+    writeHeaderWord(TRAIL_WORD);
+  }
+  return trail;
+}
+
+void leaveBreadcrumbSection(uint32_t previousTrail) {
+  if (current.sectionTrail != previousTrail) {
+    current.sectionTrail = previousTrail;
+    writeHeaderWord(TRAIL_WORD);
+  }
+}
+
+/**
+ * @brief 正在执行的最内层分段
+ * @return 分段编号+1，不在分段中时返回0
+ */
+uint8_t getActiveBreadcrumbSection() {
+  return (uint8_t)(current.sectionTrail & 0xFF);
+}
+
+// 辅助：把最后一条记录镜像到DS1307 NVRAM
+static void mirrorLastBreadcrumb() {
+  if (!BREADCRUMB_NVRAM_MIRROR || !systemState.rtcInitialized || current.count == 0) {
+    return;
+  }
+  uint8_t record[MIRROR_SIZE];
+  uint8_t last = (current.head + BREADCRUMB_CAPACITY - 1) % BREADCRUMB_CAPACITY;
+  record[0] = MIRROR_MAGIC;
+  record[1] = MIRROR_VERSION;
+  ESP.rtcUserMemoryRead(BREADCRUMB_RTC_BLOCK + HEADER_WORDS + last * ENTRY_WORDS,
+                        reinterpret_cast<uint32_t*>(record + 2), sizeof(Breadcrumb));
+  record[MIRROR_SIZE - 1] = breadcrumbCrc8(record, MIRROR_SIZE - 1);
+  rtc.writenvram(MIRROR_NVRAM_ADDR, record, MIRROR_SIZE);
+}
+
+/**
+ * @brief 记录主动重启并镜像到DS1307 NVRAM（在ESP.restart()之前调用）
+ * @param reason 重启原因
+ */
+void recordRestartBreadcrumb(const char* reason) {
+  addBreadcrumb(BREADCRUMB_RESTART, 0, 0, reason);
+  mirrorLastBreadcrumb();
+}
+
+/**
+ * @brief 上次启动留下的记录数
+ */
+uint8_t getPreviousBreadcrumbCount() {
+  return previous.valid ? previous.header.count : 0;
+}
+
+/**
+ * @brief 上次启动留下的记录
+ * @param index 0为最早的一条
+ * @return 记录，超出范围时返回NULL
+ */
+const Breadcrumb* getPreviousBreadcrumb(uint8_t index) {
+  return index < getPreviousBreadcrumbCount() ? &previous.entries[index] : NULL;
+}
+
+// 辅助：分段编号+1转为名称（本次启动尚未登记时显示编号）
+static void appendSectionName(String& out, uint8_t section) {
+  const char* name = getBreadcrumbSectionName(section - 1);
+  if (name != NULL) {
+    out += name;
+  } else {
+    out += '#';
+    out += (int)(section - 1);
+  }
+}
+
+/**
+ * @brief 复位原因和上次启动留下的记录（文本，每行一项）
+ */
+String getBreadcrumbReport() {
+  String report;
+  char line[80];
+  report += "Reset reason: ";
+  report += ESP.getResetReason();
+  report += "\nReset info: ";
+  report += ESP.getResetInfo();
+  report += '\n';
+
+  if (!previous.valid) {
+    report += "No breadcrumbs from previous boot\n";
+    return report;
+  }
+  if (previous.fromNvram) {
+    report += "Last breadcrumb before power loss (DS1307 NVRAM):\n";
+  } else {
+    snprintf(line, sizeof(line), "Breadcrumbs from boot #%lu:\n", (unsigned long)previous.header.bootCount);
+    report += line;
+    report += "Sections active at reset: ";
+    uint32_t trail = previous.header.sectionTrail;
+    if (trail == 0) {
+      report += "none";
+    }
+    // 最外层在高位
+    bool first = true;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      uint8_t section = (trail >> shift) & 0xFF;
+      if (section == 0) {
+        continue;
+      }
+      if (!first) {
+        report += " > ";
+      }
+      appendSectionName(report, section);
+      first = false;
+    }
+    report += '\n';
+  }
+
+  for (uint8_t i = 0; i < previous.header.count; i++) {
+    const Breadcrumb& entry = previous.entries[i];
+    switch (entry.type) {
+      case BREADCRUMB_LOG:
+        snprintf(line, sizeof(line), "[%08lu] %-7s ", (unsigned long)entry.millis, getLogLevelName((LogLevel)entry.code));
+        break;
+      case BREADCRUMB_ERROR:
+        snprintf(line, sizeof(line), "[%08lu] err %-3u ", (unsigned long)entry.millis, entry.code);
+        break;
+      case BREADCRUMB_RESTART:
+        snprintf(line, sizeof(line), "[%08lu] restart ", (unsigned long)entry.millis);
+        break;
+      default:
+        snprintf(line, sizeof(line), "[%08lu] ?%-6u ", (unsigned long)entry.millis, entry.type);
+        break;
+    }
+    report += line;
+    if (entry.section != 0) {
+      report += '(';
+      appendSectionName(report, entry.section);
+      report += ") ";
+    }
+    if (entry.type == BREADCRUMB_LOG && entry.level == BREADCRUMB_ARG_SIGNED) {
+      snprintf(line, sizeof(line), "%.*s [%ld]\n", (int)BREADCRUMB_TEXT_SIZE, entry.text, (long)(int32_t)entry.arg);
+    } else if (entry.type == BREADCRUMB_LOG && entry.level == BREADCRUMB_ARG_UNSIGNED) {
+      snprintf(line, sizeof(line), "%.*s [%lu]\n", (int)BREADCRUMB_TEXT_SIZE, entry.text, (unsigned long)entry.arg);
+    } else {
+      snprintf(line, sizeof(line), "%.*s\n", (int)BREADCRUMB_TEXT_SIZE, entry.text);
+    }
+    report += line;
+  }
+  return report;
+}
+
+/**
+ * @brief 把报告输出到串口（不受日志级别限制）
+ */
+void printBreadcrumbs() {
+  Serial.print(getBreadcrumbReport());
+}
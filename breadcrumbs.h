@@ -0,0 +1,90 @@
+/**
+ * @file breadcrumbs.h
+ * @brief 跨重启保留的诊断记录（面包屑）
+ *
+ * 最近的警告/错误日志、错误代码和正在执行的分段保存在ESP8266的RTC用户内存中，
+ * 软件重启、看门狗复位和异常复位后仍然保留。启动时连同复位原因一起输出，
+ * Web OTA服务器运行时也可以经/breadcrumbs查看，现场卡死不必接串口也能诊断。
+ * 主动重启前还把最后一条记录镜像到DS1307 NVRAM，断电后仍可查看。
+ * 在函数或代码块开头写BREADCRUMB_SECTION("名称")标记正在执行的分段，
+ * 堆分配跟踪也按这里的分段区分调用点
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef BREADCRUMBS_H
+#define BREADCRUMBS_H
+
+#include <Arduino.h>
+
+// 环形缓冲区可保存的记录数（受RTC用户内存可用空间限制）
+const uint8_t BREADCRUMB_CAPACITY = 13;
+
+// 每条记录保存的文字长度（不含结尾'\0'）
+const uint8_t BREADCRUMB_TEXT_SIZE = 16;
+
+// 最多可登记的分段数
+const uint8_t BREADCRUMB_MAX_SECTIONS = 16;
+
+// 记录类型
+enum BreadcrumbType {
+  BREADCRUMB_LOG = 1,      // 警告/错误日志，code为日志级别
+  BREADCRUMB_ERROR = 2,    // reportError()，code为ErrorCode，level为ErrorLevel
+  BREADCRUMB_RESTART = 3   // 主动重启
+};
+
+// 日志记录的第一个参数（保存在Breadcrumb::level中）
+enum BreadcrumbArg {
+  BREADCRUMB_ARG_NONE = 0,     // 没有整数参数
+  BREADCRUMB_ARG_SIGNED = 1,   // %d、%i等
+  BREADCRUMB_ARG_UNSIGNED = 2  // %u、%x、%p等
+};
+
+// 一条记录（28字节，按4字节对齐写入RTC用户内存）
+struct Breadcrumb {
+  uint32_t millis;                    // 记录时的millis()
+  uint8_t type;                       // BreadcrumbType
+  uint8_t code;
+  uint8_t level;                      // 日志记录为BreadcrumbArg
+  uint8_t section;                    // 记录时最内层的分段编号+1，0表示不在分段中
+  char text[BREADCRUMB_TEXT_SIZE];    // 不一定以'\0'结尾；日志记录为格式串开头
+  uint32_t arg;                       // 日志记录的第一个整数参数
+};
+
+// 函数声明
+void initBreadcrumbs();
+void loadBreadcrumbMirror();
+void addBreadcrumb(BreadcrumbType type, uint8_t code, uint8_t level, const char* text);
+void addLogBreadcrumb(uint8_t logLevel, const char* format, bool progmem, BreadcrumbArg argKind, uint32_t arg);
+uint8_t registerBreadcrumbSection(const char* name);
+const char* getBreadcrumbSectionName(uint8_t section);
+uint32_t enterBreadcrumbSection(uint8_t section);
+void leaveBreadcrumbSection(uint32_t previousTrail);
+uint8_t getActiveBreadcrumbSection();
+void recordRestartBreadcrumb(const char* reason);
+uint8_t getPreviousBreadcrumbCount();
+const Breadcrumb* getPreviousBreadcrumb(uint8_t index);
+String getBreadcrumbReport();
+void printBreadcrumbs();
+
+// 作用域分段：构造时压入分段记录，析构时恢复（看门狗复位后可以知道卡在哪一段）
+class BreadcrumbScope {
+public:
+  explicit BreadcrumbScope(uint8_t section) : previousTrail(enterBreadcrumbSection(section)) {}
+  ~BreadcrumbScope() { leaveBreadcrumbSection(previousTrail); }
+
+private:
+  uint32_t previousTrail;
+};
+
+#define BREADCRUMB_CONCAT_(a, b) a##b
+#define BREADCRUMB_CONCAT(a, b) BREADCRUMB_CONCAT_(a, b)
+
+// 标记所在作用域为一个分段，name须为字符串常量
+#define BREADCRUMB_SECTION(name) \
+  static const uint8_t BREADCRUMB_CONCAT(breadcrumbSection_, __LINE__) = registerBreadcrumbSection(name); \
+  BreadcrumbScope BREADCRUMB_CONCAT(breadcrumbScope_, __LINE__)(BREADCRUMB_CONCAT(breadcrumbSection_, __LINE__))
+
+#endif // BREADCRUMBS_H
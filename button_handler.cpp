@@ -1,3 +1,5 @@
+#define LOG_MODULE BUTTON
+
 #include "button_handler.h"
 #include "display_manager.h"
 #include "time_manager.h"
@@ -5,7 +7,15 @@
 #include "utils.h"
 #include <ESP8266WiFi.h>
 #include "config.h"
-#include "eeprom_config.h"
+#include "config_manager.h"
+#include "logger.h"
+#include "runtime_monitor.h"
+#include "loop_profiler.h"
+#include "breadcrumbs.h"
+#include <coredecls.h>
+extern "C" {
+#include <user_interface.h>
+}
 
 // 全局按钮状态数组声明 - 现在统一在global_config.cpp中定义
 extern ButtonStateArray buttonStates;
@@ -17,11 +27,74 @@ extern SettingState settingState;
 extern TimeState timeState;
 extern const unsigned long DISPLAY_UPDATE_INTERVAL;
 
+// 按键边沿环形缓冲区：GPIO中断是唯一的生产者，updateButtonStates()是唯一的消费者。
+// 主循环卡在I2C刷新、NTP或延时中时，边沿连同发生时刻一起排队，消抖按边沿的
+// 实际时刻进行，按下和释放都不会丢失，按下时长也不受主循环延迟影响
+struct ButtonEdge {
+  uint32_t micros;   // 边沿发生时的micros()
+  uint8_t index;     // 按键下标
+  uint8_t level;     // 边沿之后的电平
+};
+
+static const uint8_t BUTTON_EDGE_QUEUE_SIZE = 32;   // 必须是2的幂
+static const uint8_t BUTTON_EDGE_QUEUE_MASK = BUTTON_EDGE_QUEUE_SIZE - 1;
+
+static volatile ButtonEdge edgeQueue[BUTTON_EDGE_QUEUE_SIZE];
+static volatile uint8_t edgeHead = 0;          // 只由中断写入
+static volatile uint8_t edgeTail = 0;          // 只由主循环写入
+static volatile bool edgeOverflow = false;     // 缓冲区满时丢弃了边沿
+static volatile uint8_t edgeLastLevel[4];      // 每个按键最近入队的电平
+
+// 主循环空闲时按键作为唤醒源：边沿中断唤醒esp_delay()中的主循环；
+// 浅睡眠时引脚中断被改为低电平触发，按住期间会持续触发，触发一次后即关闭该引脚中断，
+// 空闲结束后恢复边沿中断
+static volatile bool wakeLoopOnEdge = false;
+static volatile bool wakeupLevelArmed = false;
+
+// 记录一个边沿（中断上下文）。触点抖动中读到的电平与上次相同时不入队
+static void IRAM_ATTR pushButtonEdge(uint8_t index) {
+  if (wakeupLevelArmed) {
+    detachInterrupt(digitalPinToInterrupt(buttonStates.buttons[index].pin));
+  }
+  uint8_t level = digitalRead(buttonStates.buttons[index].pin);
+  if (level == edgeLastLevel[index]) {
+    return;
+  }
+  uint8_t head = edgeHead;
+  uint8_t next = (head + 1) & BUTTON_EDGE_QUEUE_MASK;
+  if (next == edgeTail) {
+    edgeOverflow = true;
+    return;
+  }
+  edgeQueue[head].micros = micros();
+  edgeQueue[head].index = index;
+  edgeQueue[head].level = level;
+  edgeLastLevel[index] = level;
+  edgeHead = next;  // 最后发布，消费者看到新的head时条目已写完
+  if (wakeLoopOnEdge) {
+    esp_schedule();  // 唤醒空闲中的主循环
+  }
+}
+
+static void IRAM_ATTR onK1Edge() { pushButtonEdge(0); }
+static void IRAM_ATTR onK2Edge() { pushButtonEdge(1); }
+static void IRAM_ATTR onK3Edge() { pushButtonEdge(2); }
+static void IRAM_ATTR onK4Edge() { pushButtonEdge(3); }
+
+static void (*const edgeHandlers[4])(void) = {onK1Edge, onK2Edge, onK3Edge, onK4Edge};
+
 void initButtons() {
   // 定义按键引脚数组
   const uint8_t pins[] = {K1_PIN, K2_PIN, K3_PIN, K4_PIN};
   const int buttonCount = sizeof(pins) / sizeof(pins[0]);
 
+  noInterrupts();
+  edgeHead = 0;
+  edgeTail = 0;
+  edgeOverflow = false;
+  wakeLoopOnEdge = false;
+  wakeupLevelArmed = false;
+
   // 初始化每个按键的状态
   for (int i = 0; i < buttonCount; i++) {
     ButtonState& btn = buttonStates.buttons[i];
@@ -39,80 +112,103 @@ void initButtons() {
     btn.lastPressTime = 0;            // 上次按下时间
     btn.pressDuration = 0;            // 按下持续时间
     btn.longPressTriggered = false;   // 初始化长按触发标志
+
+    edgeLastLevel[i] = HIGH;
+    attachInterrupt(digitalPinToInterrupt(pins[i]), edgeHandlers[i], CHANGE);
+    // 初始化时已经按住的按键没有边沿，补记一个
+    pushButtonEdge(i);
   }
+  interrupts();
 }
 
-void updateButtonStates() {
-  unsigned long currentMillis = millis();
-
-  // 遍历所有按键
-  for (int i = 0; i < 4; i++) {
-    ButtonState& btn = buttonStates.buttons[i];
+// 辅助：原始电平自最近一个边沿起稳定了DEBOUNCE_DELAY时确认为稳定状态，
+// 按下和释放的时刻取该边沿的时刻
+static void settleButton(int i, unsigned long atMillis) {
+  ButtonState& btn = buttonStates.buttons[i];
+  if (btn.stableState == btn.lastState || (long)(atMillis - btn.lastDebounceTime) < (long)DEBOUNCE_DELAY) {
+    return;
+  }
+  btn.stableState = btn.lastState;
+  unsigned long edgeMillis = btn.lastDebounceTime;
+
+  // 检测按下事件 (从 HIGH 到 LOW)
+  if (btn.stableState == LOW) {
+    btn.isPressed = true;
+    btn.lastPressTime = edgeMillis;
+    btn.pressDuration = 0;
+    btn.longPressTriggered = false;  // 重置长按触发标志
+
+    // 记录按键按下时间
+    systemState.lastButtonPressTime[i] = edgeMillis;
+
+    // 为 K4 按键添加调试日志
+    if (i == 3) {  // K4 对应索引 3
+      LOG_DEBUG("K4 pressed detected, stableState=LOW, isPressed=true");
+    }
+  }
+  // 检测释放事件 (从 LOW 到 HIGH)
+  else if (btn.isPressed) {
+    btn.pressDuration = edgeMillis - btn.lastPressTime;
 
-    // 读取当前物理状态
-    bool currentState = digitalRead(btn.pin);
+    // 短按事件；整个长按都发生在主循环阻塞期间时，在释放时补发长按事件
+    if (!btn.longPressTriggered) {
+      processButtonEvent(i, btn.pressDuration);
+    }
 
-    // 消抖处理：只有当状态真正变化时才更新消抖时间
-    if (currentState != btn.lastState) {
-      btn.lastDebounceTime = currentMillis;
-      btn.lastState = currentState;  // 立即更新 lastState
+    // 为 K4 按键添加调试日志
+    if (i == 3) {  // K4 对应索引 3
+      LOG_DEBUG("K4 released, pressDuration=%lu ms", btn.pressDuration);
     }
 
-    // 计算消抖时间（使用安全的减法避免溢出问题）
-    unsigned long elapsed = (currentMillis >= btn.lastDebounceTime) ?
-                           (currentMillis - btn.lastDebounceTime) :
-                           (0xFFFFFFFF - btn.lastDebounceTime + currentMillis);
-    bool debounceExpired = (elapsed >= DEBOUNCE_DELAY);
+    // 重置按下状态
+    btn.isPressed = false;
+    btn.pressDuration = 0;
+    btn.longPressTriggered = false;  // 重置长按触发标志，确保下次长按可正常触发
+  }
+}
 
-    if (debounceExpired) {
-      // 只有当稳定状态真正发生变化时才处理事件
-      if (btn.stableState != currentState) {
-        btn.stableState = currentState;
+void updateButtonStates() {
+  PROFILE_SCOPE("updateButtons");
+  BREADCRUMB_SECTION("updateButtons");
+  unsigned long currentMillis = millis();
+  uint32_t currentMicros = micros();
 
-        // 检测按下事件 (从 HIGH 到 LOW)
-        if (btn.stableState == LOW) {
-          btn.isPressed = true;
-          btn.lastPressTime = currentMillis;
-          btn.pressDuration = 0;
-          btn.longPressTriggered = false;  // 重置长按触发标志
-
-          // 记录按键按下时间
-          systemState.lastButtonPressTime[i] = currentMillis;
-          
-          // 为 K4 按键添加调试日志
-#ifdef ENABLE_DEBUG_LOGS
-          if (i == 3) {  // K4 对应索引 3
-            LOG_DEBUG("K4 pressed detected, stableState=LOW, isPressed=true");
-          }
-#endif
-        }
-        // 检测释放事件 (从 LOW 到 HIGH)
-        else {
-          if (btn.isPressed) {
-            btn.pressDuration = (currentMillis >= btn.lastPressTime) ?
-                               (currentMillis - btn.lastPressTime) :
-                               (0xFFFFFFFF - btn.lastPressTime + currentMillis);
-
-            // 短按事件
-            if (btn.pressDuration < LONG_PRESS_TIME) {
-              processButtonEvent(i, btn.pressDuration);
-            }
-
-            // 重置按下状态
-            btn.isPressed = false;
-            btn.pressDuration = 0;
-            btn.longPressTriggered = false;  // 重置长按触发标志，确保下次长按可正常触发
-            
-            // 为 K4 按键添加调试日志
-#ifdef ENABLE_DEBUG_LOGS
-            if (i == 3) {  // K4 对应索引 3
-              LOG_DEBUG("K4 released, pressDuration=%lu ms", btn.pressDuration);
-            }
-#endif
-          }
-        }
+  // 按发生顺序取出中断记录的边沿：每个边沿之前的电平先按该边沿的时刻确认
+  while (edgeTail != edgeHead) {
+    uint8_t tail = edgeTail;
+    int i = edgeQueue[tail].index;
+    bool level = edgeQueue[tail].level;
+    unsigned long edgeMillis = currentMillis - (currentMicros - edgeQueue[tail].micros) / 1000;
+    edgeTail = (tail + 1) & BUTTON_EDGE_QUEUE_MASK;
+
+    settleButton(i, edgeMillis);
+    ButtonState& btn = buttonStates.buttons[i];
+    if (level != btn.lastState) {
+      btn.lastDebounceTime = edgeMillis;
+      btn.lastState = level;
+    }
+  }
+
+  // 缓冲区满时丢失了边沿：以当前物理状态重新同步
+  if (edgeOverflow) {
+    edgeOverflow = false;
+    LOG_WARNING("Button edge queue overflow, resyncing from pins");
+    for (int i = 0; i < 4; i++) {
+      ButtonState& btn = buttonStates.buttons[i];
+      bool currentState = digitalRead(btn.pin);
+      if (currentState != btn.lastState) {
+        btn.lastDebounceTime = currentMillis;
+        btn.lastState = currentState;
       }
     }
+  }
+
+  // 遍历所有按键
+  for (int i = 0; i < 4; i++) {
+    ButtonState& btn = buttonStates.buttons[i];
+
+    // 最后一个边沿之后电平已稳定够久时确认
+    settleButton(i, currentMillis);
 
     // 长按检测（只触发一次）
     if (btn.isPressed && btn.lastPressTime > 0 && !btn.longPressTriggered) {
@@ -126,17 +222,12 @@ void updateButtonStates() {
         btn.longPressTriggered = true;  // 标记长按已触发，防止重复触发
         
         // 为 K4 按键添加调试日志
-#ifdef ENABLE_DEBUG_LOGS
         if (i == 3) {  // K4 对应索引 3
           LOG_DEBUG("K4 long press detected, duration=%lu ms", currentPressDuration);
         }
-#endif
       }
     }
 
-    // 更新最后物理状态
-    btn.lastState = currentState;
-
     // 状态清理：防止按键长时间按下导致状态卡死
     if (btn.isPressed) {
       unsigned long pressElapsed = (currentMillis >= btn.lastPressTime) ?
@@ -168,9 +259,81 @@ void updateButtonStates() {
       }
     }
   }
+}
+
+// 是否有中断记录但尚未处理的边沿
+bool hasPendingButtonEdges() {
+  return edgeTail != edgeHead || edgeOverflow;
+}
+
+/**
+ * @brief 距按键状态机下一个时限的毫秒数（供主循环决定能空闲多久）
+ * @return 有未处理的边沿或按键仍按住（长按计时、Web OTA触发）时为0，
+ *         消抖未完成时为剩余的消抖时间，没有待处理的按键时为0xFFFFFFFF
+ */
+unsigned long getMillisUntilButtonDeadline() {
+  if (hasPendingButtonEdges()) {
+    return 0;
+  }
+  unsigned long currentMillis = millis();
+  unsigned long untilDeadline = 0xFFFFFFFF;
+  for (int i = 0; i < 4; i++) {
+    const ButtonState& btn = buttonStates.buttons[i];
+    if (btn.isPressed) {
+      return 0;
+    }
+    if (btn.lastState != btn.stableState) {
+      long remaining = (long)(btn.lastDebounceTime + DEBOUNCE_DELAY - currentMillis);
+      if (remaining <= 0) {
+        return 0;
+      }
+      if ((unsigned long)remaining < untilDeadline) {
+        untilDeadline = remaining;
+      }
+    }
+  }
+  return untilDeadline;
+}
+
+/**
+ * @brief 主循环进入空闲前把按键设为唤醒源
+ * @param lightSleep 空闲期间可能进入浅睡眠：另把按键引脚设为低电平唤醒
+ *
+ * 只在所有按键都已释放时调用，任一按键按下即唤醒
+ */
+void armButtonWakeup(bool lightSleep) {
+  noInterrupts();
+  wakeLoopOnEdge = true;
+  wakeupLevelArmed = lightSleep;
+  interrupts();
+  if (lightSleep) {
+    for (int i = 0; i < 4; i++) {
+      wifi_enable_gpio_wakeup(GPIO_ID_PIN(buttonStates.buttons[i].pin), GPIO_PIN_INTR_LOLEVEL);
+    }
+  }
+}
 
-  // 检查设置模式是否超时
-  checkSettingModeTimeout();
+/**
+ * @brief 空闲结束后恢复按键的边沿中断
+ */
+void disarmButtonWakeup() {
+  noInterrupts();
+  bool levelArmed = wakeupLevelArmed;
+  wakeLoopOnEdge = false;
+  wakeupLevelArmed = false;
+  interrupts();
+  if (!levelArmed) {
+    return;
+  }
+
+  wifi_disable_gpio_wakeup();
+  noInterrupts();
+  for (int i = 0; i < 4; i++) {
+    attachInterrupt(digitalPinToInterrupt(buttonStates.buttons[i].pin), edgeHandlers[i], CHANGE);
+    // 电平中断触发后该引脚的中断已关闭，补记其间可能错过的边沿
+    pushButtonEdge(i);
+  }
+  interrupts();
 }
 
 // 长按处理函数
@@ -258,8 +421,8 @@ void handleNormalMode(int buttonIndex) {
       displayState.largeFont = !displayState.largeFont;
       systemState.needsRefresh = true;
       
-      // 保存字体状态到 EEPROM
-      saveFontSize(displayState.largeFont);
+      // 保存字体状态
+      setConfigValue(CONFIG_FONT_SIZE, displayState.largeFont);
       
       displayTime();
       break;
@@ -286,6 +449,11 @@ void handleNormalMode(int buttonIndex) {
 // 主按键事件处理函数（已拆分）
 void processButtonEvent(int buttonIndex, unsigned long pressDuration) {
   bool isLongPress = pressDuration >= LONG_PRESS_TIME;
+
+  // 输入延迟从用户期望看到反应的时刻算起（含消抖）：短按为释放时刻，长按为按满长按时间的时刻
+  unsigned long pressedAt = buttonStates.buttons[buttonIndex].lastPressTime;
+  noteInputEvent(pressedAt + (isLongPress ? LONG_PRESS_TIME : pressDuration));
+  updateButtonStats(isLongPress);
   
   // 优先处理长按事件，无论处于何种模式
   if (isLongPress) {
@@ -9,6 +9,10 @@ extern ButtonStateArray buttonStates;
 void initButtons();
 void updateButtonStates();
 void processButtonEvent(int buttonIndex, unsigned long pressDuration);
+bool hasPendingButtonEdges();  // 是否有中断记录但尚未处理的边沿
+unsigned long getMillisUntilButtonDeadline();  // 距按键状态机下一个时限的毫秒数
+void armButtonWakeup(bool lightSleep);  // 主循环空闲前把按键设为唤醒源
+void disarmButtonWakeup();  // 空闲结束后恢复按键边沿中断
 
 // 拆分后的辅助函数
 void handleLongPress(int buttonIndex);
@@ -16,6 +20,6 @@ void handleBrightnessMode(int buttonIndex);
 void handleSettingMode(int buttonIndex);
 void handleTimeSourceMode(int buttonIndex);
 void handleNormalMode(int buttonIndex);
-void checkSettingModeTimeout();  // 检查设置模式超时
+void checkSettingModeTimeout();  // 检查设置模式超时（由调度器定期调用）
 
 #endif
\ No newline at end of file
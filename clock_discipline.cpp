@@ -0,0 +1,247 @@
+/**
+ * @file clock_discipline.cpp
+ * @brief 时钟频率修正实现
+ *
+ * DS1307没有频率微调寄存器，只能在读数上修正：记录最近一次写入RTC的时间，
+ * 读数扣除 频偏 × 自写入以来的走时。每次RTC同步先测量RTC相对NTP的偏差，
+ * 修正后的残差较大或原始偏差超过一秒时才重写RTC，并用这一段的平均频偏
+ * 更新估计；否则保留RTC原样，让下一段的测量基线更长、估计更准。
+ * 晶振频偏的估计只依赖millis()和NTP结果，修正后两次查询之间的外推误差很小，
+ * NTP轮询间隔因此能放长（见ntp_engine.cpp）
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#define LOG_MODULE TIME
+
+#include "clock_discipline.h"
+#include "global_config.h"
+#include "config.h"
+#include "logger.h"
+
+// DS1307 NVRAM中的记录：魔数(2) 版本(1) 标志(1) RTC频偏(4) 晶振频偏(4) RTC写入时间(4) CRC8(1)
+static const uint8_t DISCIPLINE_NVRAM_ADDR = 0;
+static const uint8_t DISCIPLINE_RECORD_SIZE = 17;
+static const uint16_t DISCIPLINE_MAGIC = 0xD15C;
+static const uint8_t DISCIPLINE_VERSION = 1;
+static const uint8_t FLAG_RTC_DRIFT = 0x01;
+static const uint8_t FLAG_CRYSTAL_DRIFT = 0x02;
+static const uint8_t FLAG_RTC_SET = 0x04;
+
+static struct {
+  uint8_t flags;                 // 上述FLAG_*，表示对应字段有效
+  int32_t rtcPpb;                // DS1307频偏（十亿分之一，正值表示走快）
+  int32_t crystalPpb;            // 晶振频偏（正值表示millis()走快）
+  uint32_t rtcSetUnix;           // 最近一次写入RTC的时间（RTC本地时间）
+  bool crystalAnchorValid;
+  unsigned long crystalAnchorMillis; // 晶振测量基线起点的millis()
+  uint64_t crystalAnchorNtpMs;   // 同一时刻的NTP时间（毫秒）
+} discipline = {0, 0, 0, 0, false, 0, 0};
+
+// 辅助：CRC8（多项式0x07，与EEPROM配置的校验一致）
+static uint8_t disciplineCrc8(const uint8_t* data, size_t len) {
+  uint8_t crc = 0x00;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+static void putU32(uint8_t* p, uint32_t value) {
+  for (uint8_t i = 0; i < 4; i++) {
+    p[i] = (uint8_t)(value >> (8 * i));
+  }
+}
+
+static uint32_t getU32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// 辅助：把当前估计写入DS1307 NVRAM（RTC不可用时跳过）
+static void saveDisciplineRecord() {
+  if (!systemState.rtcInitialized) {
+    return;
+  }
+  uint8_t record[DISCIPLINE_RECORD_SIZE];
+  record[0] = DISCIPLINE_MAGIC & 0xFF;
+  record[1] = DISCIPLINE_MAGIC >> 8;
+  record[2] = DISCIPLINE_VERSION;
+  record[3] = discipline.flags;
+  putU32(record + 4, (uint32_t)discipline.rtcPpb);
+  putU32(record + 8, (uint32_t)discipline.crystalPpb);
+  putU32(record + 12, discipline.rtcSetUnix);
+  record[16] = disciplineCrc8(record, DISCIPLINE_RECORD_SIZE - 1);
+  rtc.writenvram(DISCIPLINE_NVRAM_ADDR, record, DISCIPLINE_RECORD_SIZE);
+}
+
+// 辅助：频偏估计是否在合理范围内
+static bool isPlausiblePpb(int64_t ppb) {
+  int64_t limit = (int64_t)CLOCK_DISCIPLINE_MAX_PPM * 1000;
+  return ppb >= -limit && ppb <= limit;
+}
+
+/**
+ * @brief 从DS1307 NVRAM加载频偏估计（在RTC初始化后调用）
+ *
+ * 记录无效（首次使用、RTC掉电）时从零开始估计
+ */
+void initClockDiscipline() {
+  discipline.flags = 0;
+  discipline.crystalAnchorValid = false;
+  if (!systemState.rtcInitialized) {
+    return;
+  }
+
+  uint8_t record[DISCIPLINE_RECORD_SIZE];
+  rtc.readnvram(record, DISCIPLINE_RECORD_SIZE, DISCIPLINE_NVRAM_ADDR);
+  uint16_t magic = record[0] | (record[1] << 8);
+  if (magic != DISCIPLINE_MAGIC || record[2] != DISCIPLINE_VERSION ||
+      record[16] != disciplineCrc8(record, DISCIPLINE_RECORD_SIZE - 1)) {
+    LOG_DEBUG("No clock discipline record in RTC NVRAM");
+    return;
+  }
+
+  discipline.flags = record[3];
+  discipline.rtcPpb = (int32_t)getU32(record + 4);
+  discipline.crystalPpb = (int32_t)getU32(record + 8);
+  discipline.rtcSetUnix = getU32(record + 12);
+  if (!isPlausiblePpb(discipline.rtcPpb)) discipline.flags &= ~FLAG_RTC_DRIFT;
+  if (!isPlausiblePpb(discipline.crystalPpb)) discipline.flags &= ~FLAG_CRYSTAL_DRIFT;
+  LOG_INFO("Clock discipline loaded: RTC %+ld ppb, crystal %+ld ppb",
+           (long)discipline.rtcPpb, (long)discipline.crystalPpb);
+}
+
+/**
+ * @brief RTC读数自上次写入以来累积的误差
+ * @param rtcUnix RTC读数（本地时间）
+ * @return 误差（毫秒，正值表示RTC走快），频偏未知时为0
+ */
+int32_t getRtcCorrectionMs(uint32_t rtcUnix) {
+  if ((discipline.flags & (FLAG_RTC_DRIFT | FLAG_RTC_SET)) != (FLAG_RTC_DRIFT | FLAG_RTC_SET) ||
+      rtcUnix < discipline.rtcSetUnix) {
+    return 0;
+  }
+  return (int32_t)((int64_t)discipline.rtcPpb * (rtcUnix - discipline.rtcSetUnix) / 1000000);
+}
+
+/**
+ * @brief 处理一次RTC相对NTP的偏差测量
+ * @param rawOffsetMs RTC原始读数减NTP时间（毫秒）
+ * @param rtcUnix 测量时的RTC读数（本地时间）
+ * @return true 需要重写RTC（调用者写入后须调用noteRtcWritten）
+ */
+bool updateRtcDiscipline(int32_t rawOffsetMs, uint32_t rtcUnix) {
+  if (!(discipline.flags & FLAG_RTC_SET) || rtcUnix < discipline.rtcSetUnix) {
+    return true;  // 不知道RTC何时写入，先建立基线
+  }
+
+  uint32_t baselineS = rtcUnix - discipline.rtcSetUnix;
+  int32_t residualMs = rawOffsetMs - getRtcCorrectionMs(rtcUnix);
+  bool rewrite = abs(residualMs) > RTC_DISCIPLINE_MAX_RESIDUAL_MS || abs(rawOffsetMs) > RTC_DISCIPLINE_MAX_OFFSET_MS;
+  LOG_DEBUG("RTC offset %+ld ms over %lu s, residual %+ld ms",
+            (long)rawOffsetMs, (unsigned long)baselineS, (long)residualMs);
+
+  // 本段结束：用本段的平均频偏更新估计（基线太短时量化误差过大，只重写不估计）
+  if (rewrite && baselineS >= RTC_DISCIPLINE_BASELINE_S) {
+    int64_t segmentPpb = (int64_t)rawOffsetMs * 1000000 / baselineS;
+    if (!isPlausiblePpb(segmentPpb)) {
+      LOG_WARNING("RTC drift %+ld ppb implausible, RTC was probably set externally", (long)segmentPpb);
+    } else {
+      discipline.rtcPpb = (discipline.flags & FLAG_RTC_DRIFT) ?
+                          (int32_t)((discipline.rtcPpb + segmentPpb) / 2) : (int32_t)segmentPpb;
+      discipline.flags |= FLAG_RTC_DRIFT;
+      LOG_INFO("RTC drift estimate %+ld ppb (segment %+ld ppb over %lu s)",
+               (long)discipline.rtcPpb, (long)segmentPpb, (unsigned long)baselineS);
+    }
+  }
+  return rewrite;
+}
+
+/**
+ * @brief RTC被写入后开始新的测量段
+ * @param rtcUnix 写入的时间（本地时间）
+ */
+void noteRtcWritten(uint32_t rtcUnix) {
+  discipline.rtcSetUnix = rtcUnix;
+  discipline.flags |= FLAG_RTC_SET;
+  saveDisciplineRecord();
+}
+
+/**
+ * @brief RTC被设为非NTP来源的时间（手动设置、编译时间）
+ *
+ * 这一段的偏差不反映频偏，下一次RTC同步只重写RTC、不更新估计
+ */
+void noteRtcSetManually() {
+  discipline.flags &= ~FLAG_RTC_SET;
+  saveDisciplineRecord();
+}
+
+/**
+ * @brief 记录一次NTP结果，用于估计晶振频偏
+ * @param localMillis 结果对应的millis()
+ * @param ntpMillis 同一时刻的NTP时间（UTC毫秒）
+ */
+void recordCrystalSample(unsigned long localMillis, uint64_t ntpMillis) {
+  if (!discipline.crystalAnchorValid) {
+    discipline.crystalAnchorValid = true;
+    discipline.crystalAnchorMillis = localMillis;
+    discipline.crystalAnchorNtpMs = ntpMillis;
+    return;
+  }
+
+  unsigned long elapsed = localMillis - discipline.crystalAnchorMillis;
+  int64_t ntpElapsed = (int64_t)(ntpMillis - discipline.crystalAnchorNtpMs);
+  int64_t diff = (int64_t)elapsed - ntpElapsed;
+  // NTP时间跳变（服务器切换、时间被改写）时重新开始基线
+  if (ntpElapsed <= 0 || llabs(diff) > 1000 + ntpElapsed * CLOCK_DISCIPLINE_MAX_PPM / 1000000) {
+    discipline.crystalAnchorMillis = localMillis;
+    discipline.crystalAnchorNtpMs = ntpMillis;
+    return;
+  }
+  if (elapsed < CRYSTAL_DISCIPLINE_BASELINE) {
+    return;
+  }
+
+  int32_t ppb = (int32_t)(diff * 1000000000LL / ntpElapsed);
+  discipline.crystalPpb = (discipline.flags & FLAG_CRYSTAL_DRIFT) ?
+                          (int32_t)(((int64_t)discipline.crystalPpb * 3 + ppb) / 4) : ppb;
+  discipline.flags |= FLAG_CRYSTAL_DRIFT;
+  discipline.crystalAnchorMillis = localMillis;
+  discipline.crystalAnchorNtpMs = ntpMillis;
+  saveDisciplineRecord();
+  LOG_DEBUG("Crystal drift estimate %+ld ppb (sample %+ld ppb)", (long)discipline.crystalPpb, (long)ppb);
+}
+
+/**
+ * @brief 按晶振频偏修正一段millis()流逝时间
+ * @param elapsed millis()计得的毫秒数
+ * @return 真实流逝的毫秒数估计
+ */
+unsigned long correctElapsedMillis(unsigned long elapsed) {
+  if (!(discipline.flags & FLAG_CRYSTAL_DRIFT)) {
+    return elapsed;
+  }
+  return elapsed - (unsigned long)(long)((int64_t)elapsed * discipline.crystalPpb / 1000000000LL);
+}
+
+bool isRtcDriftKnown() {
+  return (discipline.flags & FLAG_RTC_DRIFT) != 0;
+}
+
+bool isCrystalDriftKnown() {
+  return (discipline.flags & FLAG_CRYSTAL_DRIFT) != 0;
+}
+
+int32_t getRtcDriftPpb() {
+  return discipline.rtcPpb;
+}
+
+int32_t getCrystalDriftPpb() {
+  return discipline.crystalPpb;
+}
@@ -0,0 +1,34 @@
+/**
+ * @file clock_discipline.h
+ * @brief 时钟频率修正：估计DS1307和ESP8266晶振的频偏并持续修正
+ *
+ * DS1307的频偏由每次RTC同步时RTC相对NTP的偏差除以距上次写入RTC的走时得到；
+ * 晶振频偏由相隔至少一小时的两次NTP结果比较millis()与NTP的走时得到。
+ * 两个估计保存在DS1307的电池供电NVRAM中，断电重启后仍然有效。
+ * RTC读数按频偏扣除自上次写入以来累积的误差，软件时钟和NTP外推按晶振频偏
+ * 修正流逝的毫秒数，断网时的走时误差从每天数秒降到亚秒级
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef CLOCK_DISCIPLINE_H
+#define CLOCK_DISCIPLINE_H
+
+#include <Arduino.h>
+
+// 函数声明
+void initClockDiscipline();
+int32_t getRtcCorrectionMs(uint32_t rtcUnix);
+bool updateRtcDiscipline(int32_t rawOffsetMs, uint32_t rtcUnix);
+void noteRtcWritten(uint32_t rtcUnix);
+void noteRtcSetManually();
+void recordCrystalSample(unsigned long localMillis, uint64_t ntpMillis);
+unsigned long correctElapsedMillis(unsigned long elapsed);
+bool isRtcDriftKnown();
+bool isCrystalDriftKnown();
+int32_t getRtcDriftPpb();
+int32_t getCrystalDriftPpb();
+
+#endif // CLOCK_DISCIPLINE_H
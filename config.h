@@ -21,9 +21,38 @@ const unsigned long BUTTON_RESET_TIME = 2000;    // 按键状态重置时间(毫
 // 系统监控相关常量
 const unsigned long WATCHDOG_INTERVAL = 30000;   // 系统状态恢复检查周期(30秒)
 const unsigned long NETWORK_CHECK_INTERVAL = 3000; // 网络状态监控间隔(3秒)
-const unsigned long NTP_SYNC_INTERVAL = 60000;   // NTP同步间隔(1分钟)
 const unsigned long RTC_SYNC_INTERVAL = 1800000; // RTC同步间隔(30分钟)
 const unsigned long SETTING_MODE_TIMEOUT = 15000; // 设置模式超时(15秒)
+const unsigned long SETTING_TIMEOUT_CHECK_INTERVAL = 500; // 设置模式超时检查间隔(毫秒)
+const unsigned long MAIN_LOOP_CHECK_INTERVAL = 1000; // 主循环卡死检查间隔(1秒)
+const unsigned long RUNTIME_MONITOR_INTERVAL = 1000; // 运行时统计更新间隔(1秒)
+const unsigned long RTC_SYNC_CHECK_INTERVAL = 60000; // RTC同步到期检查间隔(1分钟)
+const unsigned long TIME_SOURCE_SWITCH_CHECK_INTERVAL = 250; // 时间源切换后NTP检查的轮询间隔(毫秒)
+const unsigned long TIME_SOURCE_OPTIMIZE_INTERVAL = 300000; // 尝试升级到NTP时间源的间隔(5分钟)
+
+// 显示相关常量
+const unsigned long DISPLAY_FULL_REFRESH_INTERVAL = 60000; // 增量刷新之外强制整帧发送的间隔(1分钟)，修复丢失的I2C写入
+
+// 空闲与低功耗相关常量
+const unsigned long LOOP_IDLE_MAX = 1000;        // loop()单次空闲的上限(毫秒)
+const bool IDLE_LIGHT_SLEEP = true;              // 空闲时允许WiFi自动浅睡眠（否则只用调制解调器睡眠）
+const uint8_t IDLE_WIFI_LISTEN_INTERVAL = 3;     // 浅睡眠时每隔几个DTIM信标醒来接收一次
+const uint32_t POWER_ACTIVE_UA = 17000;          // CPU运行、调制解调器睡眠时的电流(微安，仅ESP8266模块，不含OLED)
+const uint32_t POWER_MODEM_SLEEP_UA = 15000;     // 空闲、仅调制解调器睡眠时的电流(微安)
+const uint32_t POWER_LIGHT_SLEEP_UA = 2000;      // 空闲、自动浅睡眠时的平均电流(微安，含信标唤醒)
+
+// 诊断记录相关常量
+const bool BREADCRUMB_NVRAM_MIRROR = true;       // 主动重启前把最后一条诊断记录镜像到DS1307 NVRAM
+const unsigned long HEAP_TRACE_WARMUP = 120000;  // 首次loop()后多久视为稳态，之后循环中的堆分配都会报告(毫秒)
+
+// 配置存储相关常量
+const uint8_t CONFIG_STORE_SECTORS = 4;          // 日志式配置存储轮流使用的闪存扇区数（文件系统区末尾）
+const unsigned long CONFIG_FLUSH_DELAY = 5000;   // 配置最后一次修改后多久写回闪存(毫秒)
+
+// 指标服务相关常量
+const uint16_t METRICS_PORT = 9100;              // Prometheus抓取/metrics的TCP端口
+const unsigned long METRICS_CLIENT_TIMEOUT = 3000; // 一次抓取从连接到发完应答的最长时间(毫秒)
+const unsigned long METRICS_POLL_INTERVAL = 2;   // 服务连接期间主循环单次空闲的上限(毫秒)
 
 // 时间相关常量
 const unsigned long SECS_PER_DAY = 86400;        // 一天的秒数
@@ -36,7 +65,28 @@ const unsigned long WIFI_RECONNECT_INTERVAL = 15000; // WiFi重连间隔15秒
 // NTP相关常量
 const int NTP_TIMEOUT = 2000;                    // NTP单次请求超时时间(毫秒)
 const unsigned long NTP_CHECK_COOLDOWN = 30000;  // NTP检查冷却时间(30秒)
-const unsigned long NTP_CHECK_TIMEOUT = 10000;   // NTP检查超时时间(10秒)，防止标志永久卡住
+const unsigned long NTP_CHECK_TIMEOUT = 20000;   // NTP检查超时时间(20秒，覆盖一组请求加服务器切换)，防止标志永久卡住
+const unsigned long NTP_DNS_TIMEOUT = 3000;      // 异步DNS解析超时(毫秒)，超时后换服务器，迟到的结果仍写入缓存
+const unsigned long NTP_DNS_CACHE_TTL = HOUR_IN_MILLIS; // NTP服务器地址的缓存时间
+const unsigned long NTP_DNS_RETRY_DELAY = 30000; // 解析失败后多久再解析该服务器(毫秒)，连续失败时逐次加倍
+const long NTP_TIME_OFFSET = 8 * 3600;           // 本地时区偏移(北京时间，秒)
+const uint8_t NTP_MIN_POLL = 6;                  // 最短NTP轮询间隔的2的幂(64秒)
+const uint8_t NTP_MAX_POLL = 10;                 // 最长NTP轮询间隔的2的幂(1024秒，约17分钟)
+const uint8_t NTP_POLL_RAISE_COUNT = 3;          // 连续多少次修正量都很小后轮询间隔加倍
+const long NTP_POLL_STEP_THRESHOLD_MS = 20;      // 修正量不超过此值视为时钟稳定(毫秒)
+const long NTP_POLL_STEP_RESET_MS = 128;         // 修正量超过此值时轮询间隔回到最短(毫秒)
+
+// 秒相位对齐相关常量
+const unsigned long RTC_PHASE_POLL_INTERVAL = 4;  // 在秒边界附近读取DS1307的间隔(毫秒)，决定相位误差上限
+const unsigned long RTC_CLOCK_RESYNC_INTERVAL = 60000; // DS1307时钟缓存重新锁定秒边界的间隔(1分钟)
+
+// 时钟频率修正相关常量
+const unsigned long CRYSTAL_DISCIPLINE_BASELINE = 3600000; // 估计晶振频偏所需的最短NTP样本间隔(1小时)
+const unsigned long RTC_DISCIPLINE_BASELINE_S = 1800;    // 估计DS1307频偏所需的最短走时(秒)
+const long RTC_DISCIPLINE_MAX_RESIDUAL_MS = 20;          // 修正后RTC偏差超过此值时重写RTC并更新频偏估计
+const long RTC_DISCIPLINE_MAX_OFFSET_MS = 1000;          // RTC原始读数偏差超过此值时重写RTC
+const long CLOCK_DISCIPLINE_MAX_PPM = 500;               // 频偏估计的合理范围(±ppm)，超出视为时间被外部改写
+const unsigned long RTC_OFFSET_MEASURE_TIMEOUT = 3000;   // 测量RTC偏差时等待秒边界的最长时间(毫秒)
 
 // 时间源切换相关常量
 const unsigned long TIME_SOURCE_SWITCH_DELAY = 3000; // 时间源切换后延迟检查时间(3秒)
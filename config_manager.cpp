@@ -2,444 +2,424 @@
  * @file config_manager.cpp
  * @brief 配置管理模块实现
  *
+ * 每个配置项在配置存储中占一个键，值按类型宽度以小端序保存；配置存储的记录
+ * 本身带长度和CRC，损坏或长度不符的记录视为不存在。解码时超出范围的值
+ * 回退为默认值，所以读取不需要再检查。迁移逐级进行，每一级成功后立即记录
+ * 新版本号，中途断电下次启动从中断的那一级继续
+ *
  * @author ESP8266 SSD1306 Clock Project
- * @version 1.0
- * @date 2026-02-04
+ * @version 2.0
+ * @date 2026-10-16
  */
 
 #include "config_manager.h"
+#include "config_store.h"
 #include "logger.h"
 #include <EEPROM.h>
 
-// 全局配置管理状态
-ConfigManagerState configManagerState = {
-    false,                          // initialized
-    1,                              // configVersion
-    0                               // checksum
-};
-
-// 配置项表
-static const ConfigItem configItems[] = {
-    // 亮度索引
-    {
-        CONFIG_BRIGHTNESS_INDEX,
-        CONFIG_TYPE_UINT8,
-        EEPROM_ADDR_BRIGHTNESS_INDEX,
-        1,
-        "brightness_index",
-        "Display brightness level (0-3)",
-        (void*)2  // 默认值：中等亮度
-    },
-    // 时间源
-    {
-        CONFIG_TIME_SOURCE,
-        CONFIG_TYPE_UINT8,
-        EEPROM_ADDR_CHECKSUM + 1,  // 紧接在基础配置之后
-        1,
-        "time_source",
-        "Time source (0:NONE, 1:RTC, 2:NTP, 3:MANUAL)",
-        (void*)2  // 默认值：NTP
-    },
-    // WiFi SSID
-    {
-        CONFIG_WIFI_SSID,
-        CONFIG_TYPE_STRING,
-        EEPROM_ADDR_CHECKSUM + 2,
-        32,
-        "wifi_ssid",
-        "WiFi network SSID",
-        nullptr  // 默认值：空字符串
-    },
-    // 时区偏移
-    {
-        CONFIG_TIMEZONE_OFFSET,
-        CONFIG_TYPE_INT,
-        EEPROM_ADDR_CHECKSUM + 34,
-        4,
-        "timezone_offset",
-        "Timezone offset in seconds",
-        (void*)28800  // 默认值：东八区（8小时）
-    },
-    // 自动更新启用
-    {
-        CONFIG_AUTO_UPDATE_ENABLED,
-        CONFIG_TYPE_BOOL,
-        EEPROM_ADDR_CHECKSUM + 38,
-        1,
-        "auto_update_enabled",
-        "Enable automatic OTA updates",
-        (void*)false  // 默认值：禁用
-    },
-    // 调试模式
-    {
-        CONFIG_DEBUG_MODE,
-        CONFIG_TYPE_BOOL,
-        EEPROM_ADDR_CHECKSUM + 39,
-        1,
-        "debug_mode",
-        "Enable debug logging",
-        (void*)false  // 默认值：禁用
-    }
+// 配置存储中保存模式版本的键（2字节）
+static const uint8_t CONFIG_KEY_SCHEMA_VERSION = 0;
+
+// 没有版本记录、但配置存储中已有配置项时的版本（版本记录之前的固件写入）
+static const uint16_t UNVERSIONED_STORE_VERSION = 2;
+
+// 旧版EEPROM布局（模式版本1）
+static const int LEGACY_EEPROM_SIZE = 64;
+static const int LEGACY_ADDR_VERSION = 0;            // 布局版本号 (1字节)
+static const int LEGACY_ADDR_BRIGHTNESS_INDEX = 1;   // 亮度索引 (1字节)
+static const int LEGACY_ADDR_MAGIC_NUMBER = 2;       // 魔数标识 (2字节)
+static const int LEGACY_ADDR_CHECKSUM = 4;           // CRC8校验和 (1字节)
+static const int LEGACY_ADDR_FONT_SIZE = 5;          // 字体大小 (1字节)
+static const uint16_t LEGACY_MAGIC_NUMBER = 0xA5C3;
+static const uint8_t LEGACY_LAYOUT_VERSION = 1;
+
+// 模式表：按ConfigId顺序排列
+static constexpr ConfigItem CONFIG_ITEMS[] = {
+  {CONFIG_BRIGHTNESS_INDEX, 1, CONFIG_TYPE_UINT8, 2, 0, 3, "brightness_index", "Display brightness level (0-3)"},
+  {CONFIG_FONT_SIZE, 2, CONFIG_TYPE_BOOL, 1, 0, 1, "font_size", "Clock font size (0:small, 1:large)"},
 };
 
-// 配置项数量
-static const int configItemCount = sizeof(configItems) / sizeof(configItems[0]);
-
-/**
- * @brief 初始化配置管理器
- */
-void initConfigManager() {
-    EEPROM.begin(512);  // 使用512字节EEPROM空间
-
-    // 读取配置版本
-    uint16_t storedVersion = EEPROM.read(EEPROM_ADDR_MAGIC_NUMBER + 2);
-    storedVersion |= (EEPROM.read(EEPROM_ADDR_MAGIC_NUMBER + 3) << 8);
-
-    if (storedVersion != configManagerState.configVersion) {
-        // 配置版本不匹配，重置配置
-        LOG_WARNING("Config version mismatch: stored=%d, current=%d",
-                   storedVersion, configManagerState.configVersion);
-        resetAllConfigs();
-    } else {
-        // 验证配置校验和
-        if (!verifyConfigChecksum()) {
-            LOG_WARNING("Config checksum invalid, resetting");
-            resetAllConfigs();
-        }
-    }
-
-    configManagerState.initialized = true;
-    configManagerState.checksum = calculateConfigChecksum();
+// 各类型在配置存储中占用的字节数
+static constexpr uint8_t typeSize(ConfigType type) {
+  return type == CONFIG_TYPE_INT32 ? 4 : (type == CONFIG_TYPE_UINT16 ? 2 : 1);
+}
 
-    LOG_INFO("Config Manager initialized (version %d)", configManagerState.configVersion);
+static constexpr int32_t typeMin(ConfigType type) {
+  return type == CONFIG_TYPE_INT32 ? INT32_MIN : 0;
 }
 
-/**
- * @brief 加载配置
- * @param id 配置ID
- * @param value 值指针
- * @param size 值大小
- * @return true 成功，false 失败
- */
-bool loadConfig(ConfigId id, void* value, size_t size) {
-    if (!configManagerState.initialized) {
-        LOG_WARNING("Config manager not initialized");
-        return false;
-    }
+static constexpr int32_t typeMax(ConfigType type) {
+  return type == CONFIG_TYPE_INT32 ? INT32_MAX :
+         type == CONFIG_TYPE_UINT16 ? 0xFFFF :
+         type == CONFIG_TYPE_UINT8 ? 0xFF : 1;
+}
 
-    if (id < 0 || id >= CONFIG_COUNT) {
-        LOG_WARNING("Invalid config ID: %d", id);
-        return false;
+// 编译期检查模式表：按ID排列，键不重复且不占用保留键，范围不超出类型，默认值在范围内
+static constexpr bool schemaIsValid() {
+  for (size_t i = 0; i < CONFIG_COUNT; i++) {
+    const ConfigItem& item = CONFIG_ITEMS[i];
+    if (item.id != (ConfigId)i || item.key == CONFIG_KEY_SCHEMA_VERSION || item.key == 0xFF ||
+        item.minValue < typeMin(item.type) || item.maxValue > typeMax(item.type) ||
+        item.defaultValue < item.minValue || item.defaultValue > item.maxValue) {
+      return false;
     }
-
-    const ConfigItem* item = &configItems[id];
-
-    if (size > item->maxSize) {
-        LOG_WARNING("Config size too large: %d > %d", size, item->maxSize);
+    for (size_t j = 0; j < i; j++) {
+      if (CONFIG_ITEMS[j].key == item.key) {
         return false;
+      }
     }
+  }
+  return true;
+}
 
-    // 从EEPROM读取
-    for (size_t i = 0; i < size; i++) {
-        ((uint8_t*)value)[i] = EEPROM.read(item->eepromAddress + i);
-    }
+static_assert(sizeof(CONFIG_ITEMS) / sizeof(CONFIG_ITEMS[0]) == CONFIG_COUNT, "every ConfigId needs a schema entry");
+static_assert(schemaIsValid(), "config schema entry out of order, duplicated or out of range");
+static_assert(CONFIG_COUNT + 1 <= CONFIG_STORE_MAX_KEYS, "config store too small for the schema");
 
-    // 如果值为空或无效，使用默认值
-    if (item->type == CONFIG_TYPE_STRING && strlen((char*)value) == 0) {
-        if (item->defaultValue != nullptr) {
-            strcpy((char*)value, (char*)item->defaultValue);
-        }
-    }
+// 迁移：第i项在版本CONFIG_SCHEMA_MIN_VERSION+i和下一版本之间双向转换
+struct ConfigMigration {
+  bool (*upgrade)();
+  bool (*downgrade)();
+};
 
-    LOG_DEBUG("Loaded config: %s", item->name);
-    return true;
-}
+static struct {
+  bool initialized;
+  bool versionStored;               // 配置存储中已有版本记录
+  uint16_t version;                 // 已保存数据的模式版本
+  int32_t values[CONFIG_COUNT];     // 解码后的配置值
+} manager;
 
 /**
- * @brief 保存配置
- * @param id 配置ID
- * @param value 值指针
- * @param size 值大小
- * @return true 成功，false 失败
+ * @brief CRC8校验算法（使用多项式0x07，与Dallas/Maxim格式兼容）
+ * @param data 数据指针
+ * @param len 数据长度
+ * @return CRC8校验值
  */
-bool saveConfig(ConfigId id, const void* value, size_t size) {
-    if (!configManagerState.initialized) {
-        LOG_WARNING("Config manager not initialized");
-        return false;
-    }
-
-    if (id < 0 || id >= CONFIG_COUNT) {
-        LOG_WARNING("Invalid config ID: %d", id);
-        return false;
-    }
-
-    const ConfigItem* item = &configItems[id];
-
-    if (size > item->maxSize) {
-        LOG_WARNING("Config size too large: %d > %d", size, item->maxSize);
-        return false;
+static uint8_t crc8(const uint8_t* data, size_t len) {
+  uint8_t crc = 0x00;
+  const uint8_t polynomial = 0x07;
+
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      if (crc & 0x80) {
+        crc = (crc << 1) ^ polynomial;
+      } else {
+        crc <<= 1;
+      }
     }
+  }
 
-    // 验证配置值
-    if (!validateConfig(id, value)) {
-        LOG_WARNING("Config validation failed: %s", item->name);
-        return false;
-    }
+  return crc;
+}
 
-    // 写入EEPROM
-    for (size_t i = 0; i < size; i++) {
-        EEPROM.write(item->eepromAddress + i, ((const uint8_t*)value)[i]);
-    }
+// 辅助：旧版布局的校验和（版本号、亮度、字体、魔数）
+static uint8_t legacyChecksum(uint8_t version, uint8_t brightnessIndex, uint8_t fontSize, uint16_t magicNumber) {
+  uint8_t data[5] = {version, brightnessIndex, fontSize, (uint8_t)(magicNumber & 0xFF), (uint8_t)(magicNumber >> 8)};
+  return crc8(data, sizeof(data));
+}
 
-    // 更新校验和
-    configManagerState.checksum = calculateConfigChecksum();
+// 辅助：读取旧版EEPROM布局，魔数、版本、范围或校验和不对时返回false
+static bool readLegacyLayout(uint8_t& brightnessIndex, uint8_t& fontSize) {
+  uint8_t version = EEPROM.read(LEGACY_ADDR_VERSION);
+  uint16_t magicNumber = EEPROM.read(LEGACY_ADDR_MAGIC_NUMBER) | (EEPROM.read(LEGACY_ADDR_MAGIC_NUMBER + 1) << 8);
+  brightnessIndex = EEPROM.read(LEGACY_ADDR_BRIGHTNESS_INDEX);
+  fontSize = EEPROM.read(LEGACY_ADDR_FONT_SIZE);
+
+  if (magicNumber != LEGACY_MAGIC_NUMBER || version > LEGACY_LAYOUT_VERSION || brightnessIndex > 3 || fontSize > 1) {
+    return false;
+  }
+  uint8_t checksum = legacyChecksum(version, brightnessIndex, fontSize, magicNumber);
+  if (EEPROM.read(LEGACY_ADDR_CHECKSUM) != checksum) {
+    LOG_DEBUG("Legacy EEPROM CRC8 mismatch: stored=0x%02X, calculated=0x%02X",
+              EEPROM.read(LEGACY_ADDR_CHECKSUM), checksum);
+    return false;
+  }
+  return true;
+}
 
-    // 提交更改
-    bool success = EEPROM.commit();
+// 辅助：按旧版EEPROM布局写入
+static bool writeLegacyLayout(uint8_t brightnessIndex, uint8_t fontSize) {
+  EEPROM.write(LEGACY_ADDR_VERSION, LEGACY_LAYOUT_VERSION);
+  EEPROM.write(LEGACY_ADDR_BRIGHTNESS_INDEX, brightnessIndex);
+  EEPROM.write(LEGACY_ADDR_MAGIC_NUMBER, LEGACY_MAGIC_NUMBER & 0xFF);
+  EEPROM.write(LEGACY_ADDR_MAGIC_NUMBER + 1, LEGACY_MAGIC_NUMBER >> 8);
+  EEPROM.write(LEGACY_ADDR_CHECKSUM,
+               legacyChecksum(LEGACY_LAYOUT_VERSION, brightnessIndex, fontSize, LEGACY_MAGIC_NUMBER));
+  EEPROM.write(LEGACY_ADDR_FONT_SIZE, fontSize);
+  return EEPROM.commit();
+}
 
-    if (success) {
-        LOG_DEBUG("Saved config: %s", item->name);
-    } else {
-        LOG_WARNING("Failed to save config: %s", item->name);
-    }
+// 辅助：按类型宽度编码后写入配置存储
+static bool storeItem(const ConfigItem& item, int32_t value) {
+  uint8_t bytes[4];
+  uint8_t size = typeSize(item.type);
+  for (uint8_t i = 0; i < size; i++) {
+    bytes[i] = (uint8_t)((uint32_t)value >> (8 * i));
+  }
+  return writeConfigValue(item.key, bytes, size);
+}
 
-    return success;
+// 辅助：从配置存储解码一项，不存在或超出范围时返回默认值
+static int32_t loadItem(const ConfigItem& item) {
+  uint8_t bytes[4];
+  uint8_t size = typeSize(item.type);
+  if (!readConfigValue(item.key, bytes, size)) {
+    return item.defaultValue;
+  }
+  uint32_t raw = 0;
+  for (uint8_t i = 0; i < size; i++) {
+    raw |= (uint32_t)bytes[i] << (8 * i);
+  }
+  int32_t value = (int32_t)raw;
+  if (value < item.minValue || value > item.maxValue) {
+    LOG_WARNING("Config %s out of range: %ld, using default", item.name, (long)value);
+    return item.defaultValue;
+  }
+  return value;
 }
 
-/**
- * @brief 重置单个配置
- * @param id 配置ID
- * @return true 成功，false 失败
- */
-bool resetConfig(ConfigId id) {
-    if (id < 0 || id >= CONFIG_COUNT) {
-        LOG_WARNING("Invalid config ID: %d", id);
-        return false;
-    }
+// 辅助：记录模式版本
+static bool storeSchemaVersion(uint16_t version) {
+  uint8_t bytes[2] = {(uint8_t)(version & 0xFF), (uint8_t)(version >> 8)};
+  if (!writeConfigValue(CONFIG_KEY_SCHEMA_VERSION, bytes, sizeof(bytes))) {
+    return false;
+  }
+  manager.version = version;
+  manager.versionStored = true;
+  return true;
+}
 
-    const ConfigItem* item = &configItems[id];
-
-    if (item->defaultValue == nullptr) {
-        // 无默认值，清零
-        uint8_t buffer[32] = {0};
-        return saveConfig(id, buffer, item->maxSize);
-    } else {
-        // 使用默认值
-        if (item->type == CONFIG_TYPE_STRING) {
-            return saveConfig(id, item->defaultValue, strlen((char*)item->defaultValue) + 1);
-        } else {
-            return saveConfig(id, &item->defaultValue, item->maxSize);
-        }
+// 辅助：判断已保存数据的模式版本
+static uint16_t detectSchemaVersion() {
+  uint8_t bytes[4];
+  manager.versionStored = readConfigValue(CONFIG_KEY_SCHEMA_VERSION, bytes, 2);
+  if (manager.versionStored) {
+    return bytes[0] | (bytes[1] << 8);
+  }
+  for (size_t i = 0; i < CONFIG_COUNT; i++) {
+    if (readConfigValue(CONFIG_ITEMS[i].key, bytes, typeSize(CONFIG_ITEMS[i].type))) {
+      return UNVERSIONED_STORE_VERSION;
     }
+  }
+  uint8_t brightnessIndex, fontSize;
+  if (readLegacyLayout(brightnessIndex, fontSize)) {
+    return CONFIG_SCHEMA_MIN_VERSION;
+  }
+  return CONFIG_SCHEMA_VERSION;  // 全新设备，没有需要迁移的数据
 }
 
-/**
- * @brief 重置所有配置
- * @return true 成功，false 失败
- */
-bool resetAllConfigs() {
-    LOG_INFO("Resetting all configs...");
+// 版本1 → 2：旧版EEPROM中的配置写入配置存储，EEPROM保持不变
+static bool upgradeLegacyToStore() {
+  uint8_t brightnessIndex, fontSize;
+  if (!readLegacyLayout(brightnessIndex, fontSize)) {
+    return true;  // 没有有效的旧配置，使用默认值
+  }
+  LOG_INFO("Migrating EEPROM config to config store (brightness %d, font %s)",
+           brightnessIndex, fontSize ? "Large" : "Small");
+  return storeItem(CONFIG_ITEMS[CONFIG_BRIGHTNESS_INDEX], brightnessIndex) &&
+         storeItem(CONFIG_ITEMS[CONFIG_FONT_SIZE], fontSize);
+}
 
-    for (int i = 0; i < configItemCount; i++) {
-        if (!resetConfig((ConfigId)i)) {
-            LOG_WARNING("Failed to reset config: %s", configItems[i].name);
-        }
-    }
+// 版本2 → 1：当前配置写回旧版EEPROM布局，供旧版固件读取
+static bool downgradeStoreToLegacy() {
+  return writeLegacyLayout((uint8_t)loadItem(CONFIG_ITEMS[CONFIG_BRIGHTNESS_INDEX]),
+                           (uint8_t)loadItem(CONFIG_ITEMS[CONFIG_FONT_SIZE]));
+}
 
-    // 重置配置版本
-    EEPROM.write(EEPROM_ADDR_MAGIC_NUMBER + 2, configManagerState.configVersion & 0xFF);
-    EEPROM.write(EEPROM_ADDR_MAGIC_NUMBER + 3, (configManagerState.configVersion >> 8) & 0xFF);
+static const ConfigMigration CONFIG_MIGRATIONS[] = {
+  {upgradeLegacyToStore, downgradeStoreToLegacy},   // 1 ↔ 2
+};
 
-    configManagerState.checksum = calculateConfigChecksum();
-    bool success = EEPROM.commit();
+static_assert(sizeof(CONFIG_MIGRATIONS) / sizeof(CONFIG_MIGRATIONS[0]) ==
+              CONFIG_SCHEMA_VERSION - CONFIG_SCHEMA_MIN_VERSION, "every schema version step needs a migration");
 
-    if (success) {
-        LOG_INFO("All configs reset successfully");
-    } else {
-        LOG_WARNING("Failed to reset all configs");
+// 辅助：已降级时把当前配置重新逐级降级到已保存的版本，保持旧版数据与配置存储一致
+static bool refreshDowngradedLayout() {
+  for (uint16_t version = CONFIG_SCHEMA_VERSION; version > manager.version; version--) {
+    if (!CONFIG_MIGRATIONS[version - 1 - CONFIG_SCHEMA_MIN_VERSION].downgrade()) {
+      return false;
     }
-
-    return success;
+  }
+  return true;
 }
 
 /**
- * @brief 验证配置
- * @param id 配置ID
- * @param value 值指针
- * @return true 有效，false 无效
+ * @brief 初始化配置管理器：打开配置存储，迁移到当前模式版本，解码全部配置到RAM
+ * @return true 成功，false 配置存储或迁移失败（读取返回默认值）
+ * @note 必须在setup()中、读取配置之前调用
  */
-bool validateConfig(ConfigId id, const void* value) {
-    if (id < 0 || id >= CONFIG_COUNT) {
-        return false;
-    }
-
-    const ConfigItem* item = &configItems[id];
-
-    switch (id) {
-        case CONFIG_BRIGHTNESS_INDEX:
-            return (*(uint8_t*)value >= 0 && *(uint8_t*)value <= 3);
-
-        case CONFIG_TIME_SOURCE:
-            return (*(uint8_t*)value >= 0 && *(uint8_t*)value <= 3);
-
-        case CONFIG_TIMEZONE_OFFSET:
-            return *(int*)value >= -43200 && *(int*)value <= 50400;  // -12到+14小时
-
-        default:
-            return true;
-    }
+bool initConfigManager() {
+  // ESP8266需要先调用EEPROM.begin()，旧版布局只在迁移时读写
+  EEPROM.begin(LEGACY_EEPROM_SIZE);
+
+  bool success = initConfigStore();
+  manager.version = detectSchemaVersion();
+  if (manager.version > CONFIG_SCHEMA_VERSION) {
+    LOG_WARNING("Config schema version %u is newer than %u, reading known keys only",
+                manager.version, CONFIG_SCHEMA_VERSION);
+  } else if (manager.version < CONFIG_SCHEMA_VERSION) {
+    success = migrateConfigSchema(CONFIG_SCHEMA_VERSION) && success;
+  }
+
+  for (size_t i = 0; i < CONFIG_COUNT; i++) {
+    manager.values[i] = loadItem(CONFIG_ITEMS[i]);
+  }
+  manager.initialized = true;
+
+  LOG_INFO("Config Manager initialized (schema version %u)", manager.version);
+  return success;
 }
 
 /**
- * @brief 获取配置名称
+ * @brief 读取配置（只访问RAM）
  * @param id 配置ID
- * @return 配置名称
+ * @return 配置值，未初始化时为默认值，ID无效时为0
  */
-const char* getConfigName(ConfigId id) {
-    if (id < 0 || id >= CONFIG_COUNT) {
-        return "Unknown";
-    }
-    return configItems[id].name;
+int32_t getConfigValue(ConfigId id) {
+  if ((unsigned)id >= CONFIG_COUNT) {
+    return 0;
+  }
+  return manager.initialized ? manager.values[id] : CONFIG_ITEMS[id].defaultValue;
 }
 
 /**
- * @brief 获取配置描述
+ * @brief 保存配置
  * @param id 配置ID
- * @return 配置描述
+ * @param value 配置值，须在模式表规定的范围内
+ * @return true 成功（写回模式下为已记入RAM），false 值无效或写入失败
  */
-const char* getConfigDescription(ConfigId id) {
-    if (id < 0 || id >= CONFIG_COUNT) {
-        return "Unknown config";
-    }
-    return configItems[id].description;
+bool setConfigValue(ConfigId id, int32_t value) {
+  if (!manager.initialized) {
+    LOG_WARNING("Config manager not initialized");
+    return false;
+  }
+  if (!validateConfig(id, value)) {
+    LOG_WARNING("Invalid config value: %s = %ld", getConfigName(id), (long)value);
+    return false;
+  }
+
+  const ConfigItem& item = CONFIG_ITEMS[id];
+  if ((!manager.versionStored && !storeSchemaVersion(CONFIG_SCHEMA_VERSION)) || !storeItem(item, value)) {
+    LOG_WARNING("Failed to save config: %s", item.name);
+    return false;
+  }
+  // 降级后、刷入旧版固件前：同时写入旧版布局，否则重启时升级会用降级时的旧值覆盖
+  if (manager.version < CONFIG_SCHEMA_VERSION && !refreshDowngradedLayout()) {
+    LOG_WARNING("Failed to save config to schema version %u: %s", manager.version, item.name);
+    return false;
+  }
+  manager.values[id] = value;
+
+  LOG_DEBUG("Saved config: %s = %ld", item.name, (long)value);
+  return true;
 }
 
 /**
- * @brief 获取配置类型
+ * @brief 重置单个配置为默认值
  * @param id 配置ID
- * @return 配置类型
+ * @return true 成功，false 失败
  */
-ConfigType getConfigType(ConfigId id) {
-    if (id < 0 || id >= CONFIG_COUNT) {
-        return CONFIG_TYPE_UINT8;
-    }
-    return configItems[id].type;
+bool resetConfig(ConfigId id) {
+  if ((unsigned)id >= CONFIG_COUNT) {
+    return false;
+  }
+  return setConfigValue(id, CONFIG_ITEMS[id].defaultValue);
 }
 
 /**
- * @brief 打印所有配置
+ * @brief 清除全部配置：擦除配置存储，旧版EEPROM字节设置为0xFF
+ * @return true 成功，false 失败
  */
-void printAllConfigs() {
-    LOG_INFO("========================================");
-    LOG_INFO("  Current Configuration");
-    LOG_INFO("========================================");
-
-    for (int i = 0; i < configItemCount; i++) {
-        const ConfigItem* item = &configItems[i];
-        LOG_INFO("%s (%s):", item->name, item->description);
-
-        // 读取并显示配置值
-        switch (item->type) {
-            case CONFIG_TYPE_UINT8: {
-                uint8_t value;
-                loadConfig((ConfigId)i, &value, sizeof(value));
-                LOG_INFO("  Value: %u", value);
-                break;
-            }
-            case CONFIG_TYPE_UINT16: {
-                uint16_t value;
-                loadConfig((ConfigId)i, &value, sizeof(value));
-                LOG_INFO("  Value: %u", value);
-                break;
-            }
-            case CONFIG_TYPE_UINT32: {
-                uint32_t value;
-                loadConfig((ConfigId)i, &value, sizeof(value));
-                LOG_INFO("  Value: %lu", value);
-                break;
-            }
-            case CONFIG_TYPE_INT: {
-                int value;
-                loadConfig((ConfigId)i, &value, sizeof(value));
-                LOG_INFO("  Value: %d", value);
-                break;
-            }
-            case CONFIG_TYPE_STRING: {
-                char value[32];
-                loadConfig((ConfigId)i, value, sizeof(value));
-                LOG_INFO("  Value: %s", value);
-                break;
-            }
-            case CONFIG_TYPE_BOOL: {
-                bool value;
-                loadConfig((ConfigId)i, &value, sizeof(value));
-                LOG_INFO("  Value: %s", value ? "true" : "false");
-                break;
-            }
-        }
-    }
-
-    LOG_INFO("========================================");
+bool resetAllConfigs() {
+  bool success = clearConfigStore();
+  for (int i = 0; i < LEGACY_EEPROM_SIZE; i++) {
+    EEPROM.write(i, 0xFF);
+  }
+  success = EEPROM.commit() && success;  // 字节未改变时不会擦写闪存
+
+  manager.version = CONFIG_SCHEMA_VERSION;
+  manager.versionStored = false;
+  for (size_t i = 0; i < CONFIG_COUNT; i++) {
+    manager.values[i] = CONFIG_ITEMS[i].defaultValue;
+  }
+
+  LOG_DEBUG("All configs reset to defaults");
+  return success;
 }
 
 /**
- * @brief 获取配置版本
- * @return 配置版本号
+ * @brief 检查配置值是否在模式表规定的范围内
+ * @param id 配置ID
+ * @param value 配置值
+ * @return true 有效，false 无效
  */
-uint16_t getConfigVersion() {
-    return configManagerState.configVersion;
+bool validateConfig(ConfigId id, int32_t value) {
+  if ((unsigned)id >= CONFIG_COUNT) {
+    return false;
+  }
+  return value >= CONFIG_ITEMS[id].minValue && value <= CONFIG_ITEMS[id].maxValue;
+}
+
+const char* getConfigName(ConfigId id) {
+  return (unsigned)id < CONFIG_COUNT ? CONFIG_ITEMS[id].name : "unknown";
+}
+
+const char* getConfigDescription(ConfigId id) {
+  return (unsigned)id < CONFIG_COUNT ? CONFIG_ITEMS[id].description : "Unknown config";
+}
+
+ConfigType getConfigType(ConfigId id) {
+  return (unsigned)id < CONFIG_COUNT ? CONFIG_ITEMS[id].type : CONFIG_TYPE_UINT8;
 }
 
 /**
- * @brief 设置配置版本
- * @param version 版本号
- * @return true 成功，false 失败
+ * @brief 已保存数据的模式版本
  */
-bool setConfigVersion(uint16_t version) {
-    configManagerState.configVersion = version;
-    EEPROM.write(EEPROM_ADDR_MAGIC_NUMBER + 2, version & 0xFF);
-    EEPROM.write(EEPROM_ADDR_MAGIC_NUMBER + 3, (version >> 8) & 0xFF);
-    return EEPROM.commit();
+uint16_t getConfigSchemaVersion() {
+  return manager.version;
 }
 
 /**
- * @brief 计算配置校验和
- * @return 校验和
+ * @brief 把已保存的数据逐级迁移到指定版本
+ * @param targetVersion 目标版本（CONFIG_SCHEMA_MIN_VERSION ~ CONFIG_SCHEMA_VERSION）
+ * @return true 成功，false 目标无效、数据来自更新的固件或某一级迁移失败
+ *
+ * 降级用于刷入旧版固件之前；降级后RAM中的配置值不变，之后的保存同时写入旧版数据
  */
-uint32_t calculateConfigChecksum() {
-    uint32_t checksum = 0;
-
-    // 计算所有配置项的校验和
-    for (int i = 0; i < configItemCount; i++) {
-        const ConfigItem* item = &configItems[i];
-        for (uint16_t j = 0; j < item->maxSize; j++) {
-            checksum ^= EEPROM.read(item->eepromAddress + j);
-            checksum = (checksum << 1) | (checksum >> 31);
-        }
+bool migrateConfigSchema(uint16_t targetVersion) {
+  if (targetVersion < CONFIG_SCHEMA_MIN_VERSION || targetVersion > CONFIG_SCHEMA_VERSION ||
+      manager.version > CONFIG_SCHEMA_VERSION) {
+    LOG_WARNING("Config schema: cannot migrate from version %u to %u", manager.version, targetVersion);
+    return false;
+  }
+
+  while (manager.version != targetVersion) {
+    uint16_t from = manager.version;
+    bool upgrade = from < targetVersion;
+    uint16_t to = upgrade ? from + 1 : from - 1;
+    const ConfigMigration& step = CONFIG_MIGRATIONS[(upgrade ? from : to) - CONFIG_SCHEMA_MIN_VERSION];
+    if (!(upgrade ? step.upgrade() : step.downgrade()) || !storeSchemaVersion(to)) {
+      LOG_ERROR("Config schema: migration %u -> %u failed", from, to);
+      return false;
     }
-
-    return checksum;
+    LOG_INFO("Config schema migrated: %u -> %u", from, to);
+  }
+  return flushConfigStore();
 }
 
 /**
- * @brief 验证配置校验和
- * @return true 有效，false 无效
+ * @brief 打印所有配置
  */
-bool verifyConfigChecksum() {
-    uint32_t storedChecksum = 0;
-    uint16_t checksumAddr = EEPROM_ADDR_CHECKSUM + 40;  // 配置校验和地址
-
-    for (int i = 0; i < 4; i++) {
-        storedChecksum |= (EEPROM.read(checksumAddr + i) << (i * 8));
-    }
-
-    uint32_t calculatedChecksum = calculateConfigChecksum();
+void printAllConfigs() {
+  LOG_INFO("========================================");
+  LOG_INFO("  Current Configuration (schema version %u)", manager.version);
+  LOG_INFO("========================================");
 
-    if (storedChecksum != calculatedChecksum) {
-        LOG_WARNING("Checksum mismatch: stored=%lu, calculated=%lu",
-                   storedChecksum, calculatedChecksum);
-        return false;
-    }
+  for (size_t i = 0; i < CONFIG_COUNT; i++) {
+    const ConfigItem& item = CONFIG_ITEMS[i];
+    LOG_INFO("%s = %ld (%s)", item.name, (long)getConfigValue(item.id), item.description);
+  }
 
-    return true;
+  LOG_INFO("========================================");
 }
@@ -2,80 +2,70 @@
  * @file config_manager.h
  * @brief 配置管理模块
  *
- * 提供统一的配置管理接口，支持配置的加载、保存和验证
+ * 所有需要持久化的配置由一张编译期校验的模式表描述（键、类型、默认值、范围），
+ * 每项在日志式配置存储（config_store.h）中保存为一条键-长度-值记录并带CRC。
+ * 启动时解码全部配置到RAM，读取只访问RAM；保存时先按模式检查范围。
+ *
+ * 模式版本保存在配置存储中，启动时按迁移表逐级升级到当前版本；
+ * 每一级迁移同时提供降级函数，刷入旧版固件前可先降级。
+ * 版本1为旧版固件的EEPROM布局，版本2起保存在配置存储中。
+ * 键编号一经使用不再改作他用，较新固件写入的配置旧版本也能读出已知的键
  *
  * @author ESP8266 SSD1306 Clock Project
- * @version 1.0
- * @date 2026-02-04
+ * @version 2.0
+ * @date 2026-10-16
  */
 
 #ifndef CONFIG_MANAGER_H
 #define CONFIG_MANAGER_H
 
 #include <Arduino.h>
-#include "eeprom_config.h"
 
-// 配置项ID枚举
+// 当前模式版本
+const uint16_t CONFIG_SCHEMA_VERSION = 2;
+
+// 可迁移到的最旧版本（旧版固件的EEPROM布局）
+const uint16_t CONFIG_SCHEMA_MIN_VERSION = 1;
+
+// 配置项ID枚举（模式表按此顺序排列）
 typedef enum {
-    CONFIG_BRIGHTNESS_INDEX = 0,     // 亮度索引
-    CONFIG_TIME_SOURCE,              // 时间源
-    CONFIG_WIFI_SSID,                // WiFi SSID
-    CONFIG_WIFI_PASSWORD,            // WiFi密码（加密）
-    CONFIG_NTP_SERVER,               // NTP服务器
-    CONFIG_TIMEZONE_OFFSET,          // 时区偏移
-    CONFIG_AUTO_UPDATE_ENABLED,      // 自动更新启用
-    CONFIG_DEBUG_MODE,               // 调试模式
-    CONFIG_COUNT                     // 配置项总数
+  CONFIG_BRIGHTNESS_INDEX = 0,     // 亮度索引 (0-3)
+  CONFIG_FONT_SIZE,                // 字体大小 (0=小, 1=大)
+  CONFIG_COUNT                     // 配置项总数
 } ConfigId;
 
-// 配置项类型枚举
+// 配置项类型枚举（决定在存储中占用的字节数）
 typedef enum {
-    CONFIG_TYPE_UINT8,               // 8位无符号整数
-    CONFIG_TYPE_UINT16,              // 16位无符号整数
-    CONFIG_TYPE_UINT32,              // 32位无符号整数
-    CONFIG_TYPE_INT,                 // 有符号整数
-    CONFIG_TYPE_STRING,              // 字符串
-    CONFIG_TYPE_BOOL                 // 布尔值
+  CONFIG_TYPE_UINT8,               // 8位无符号整数
+  CONFIG_TYPE_UINT16,              // 16位无符号整数
+  CONFIG_TYPE_INT32,               // 32位有符号整数
+  CONFIG_TYPE_BOOL                 // 布尔值
 } ConfigType;
 
-// 配置项结构体
-typedef struct {
-    ConfigId id;                     // 配置ID
-    ConfigType type;                 // 配置类型
-    uint16_t eepromAddress;          // EEPROM地址
-    uint16_t maxSize;               // 最大大小
-    const char* name;               // 配置名称
-    const char* description;        // 配置描述
-    void* defaultValue;             // 默认值
-} ConfigItem;
-
-// 配置验证函数类型
-typedef bool (*ConfigValidator)(const void* value);
-
-// 配置管理结构体
-typedef struct {
-    bool initialized;                // 是否初始化
-    uint16_t configVersion;         // 配置版本
-    uint32_t checksum;              // 校验和
-} ConfigManagerState;
-
-// 全局配置管理状态
-extern ConfigManagerState configManagerState;
+// 配置项描述
+struct ConfigItem {
+  ConfigId id;                     // 配置ID，与表中位置一致
+  uint8_t key;                     // 配置存储中的键
+  ConfigType type;                 // 配置类型
+  int32_t defaultValue;            // 默认值
+  int32_t minValue;                // 允许的最小值
+  int32_t maxValue;                // 允许的最大值
+  const char* name;                // 配置名称
+  const char* description;         // 配置描述
+};
 
 // 函数声明
-void initConfigManager();
-bool loadConfig(ConfigId id, void* value, size_t size);
-bool saveConfig(ConfigId id, const void* value, size_t size);
+bool initConfigManager();
+int32_t getConfigValue(ConfigId id);
+bool setConfigValue(ConfigId id, int32_t value);
 bool resetConfig(ConfigId id);
 bool resetAllConfigs();
-bool validateConfig(ConfigId id, const void* value);
+bool validateConfig(ConfigId id, int32_t value);
 const char* getConfigName(ConfigId id);
 const char* getConfigDescription(ConfigId id);
 ConfigType getConfigType(ConfigId id);
+uint16_t getConfigSchemaVersion();
+bool migrateConfigSchema(uint16_t targetVersion);
 void printAllConfigs();
-uint16_t getConfigVersion();
-bool setConfigVersion(uint16_t version);
-uint32_t calculateConfigChecksum();
-bool verifyConfigChecksum();
 
 #endif // CONFIG_MANAGER_H
@@ -0,0 +1,416 @@
+/**
+ * @file config_store.cpp
+ * @brief 日志式配置存储实现
+ *
+ * 扇区布局：8字节扇区头（魔数 + 代号）之后依次是记录，每条记录4字节记录头
+ * （键、长度、CRC16）加上补齐到4字节的值。扇区头在整理时最后写入，
+ * 整理中途断电的扇区没有有效扇区头，启动时被忽略，旧扇区仍然完整。
+ * 追加时断电留下的残缺记录CRC不符，扫描到此为止，下次保存先整理。
+ * 写回模式下修改过的键带dirty标记，整理会写入全部键，同时清除所有标记
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#include "config_store.h"
+#include "config.h"
+#include "logger.h"
+#include "task_scheduler.h"
+#include <flash_hal.h>
+
+static const uint32_t CONFIG_STORE_MAGIC = 0x31534643;   // "CFS1"
+static const uint8_t CONFIG_KEY_ERASED = 0xFF;            // 擦除后的记录头，表示后面没有记录
+static const uint16_t SECTOR_HEADER_SIZE = 8;
+static const uint16_t RECORD_HEADER_SIZE = 4;
+
+static_assert(CONFIG_STORE_SECTORS >= 2, "config store needs at least two sectors to rotate");
+static_assert(SECTOR_HEADER_SIZE + CONFIG_STORE_MAX_KEYS * (RECORD_HEADER_SIZE + CONFIG_STORE_MAX_VALUE) <=
+              FLASH_SECTOR_SIZE, "all values must fit in one sector");
+
+// 一个键的最新值
+struct ConfigEntry {
+  uint8_t key;
+  uint8_t length;
+  bool dirty;                  // 写回模式下已修改、尚未写入闪存
+  uint8_t value[CONFIG_STORE_MAX_VALUE];
+};
+
+static struct {
+  bool ready;
+  uint8_t entryCount;
+  uint32_t firstSector;        // 存储区的第一个扇区号：文件系统区的最后CONFIG_STORE_SECTORS个扇区
+  uint16_t writeOffset;        // 当前扇区下一条记录的偏移，FLASH_SECTOR_SIZE表示已满
+  ConfigEntry entries[CONFIG_STORE_MAX_KEYS];
+} store;
+
+static ConfigStoreStats stats;
+
+// 写回任务，-1表示未启用写回、每次保存立即写入（不随initConfigStore()复位）
+static int flushTaskId = -1;
+
+// 辅助：CRC16-CCITT（多项式0x1021）
+static uint16_t crc16(uint16_t crc, const uint8_t* data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+static uint16_t recordCrc(uint8_t key, uint8_t length, const uint8_t* value) {
+  uint8_t head[2] = {key, length};
+  return crc16(crc16(0xFFFF, head, sizeof(head)), value, length);
+}
+
+static uint16_t recordSize(uint8_t length) {
+  return RECORD_HEADER_SIZE + ((length + 3) & ~3);
+}
+
+static uint32_t sectorAddress(uint8_t sector) {
+  return (store.firstSector + sector) * FLASH_SECTOR_SIZE;
+}
+
+static ConfigEntry* findEntry(uint8_t key) {
+  for (uint8_t i = 0; i < store.entryCount; i++) {
+    if (store.entries[i].key == key) {
+      return &store.entries[i];
+    }
+  }
+  return nullptr;
+}
+
+// 辅助：在sector的offset处写一条记录（未用的补齐字节保持0xFF，不编程）
+static bool programRecord(uint8_t sector, uint16_t offset, const ConfigEntry& entry) {
+  uint32_t words[(RECORD_HEADER_SIZE + CONFIG_STORE_MAX_VALUE) / 4];
+  uint8_t* bytes = (uint8_t*)words;
+  uint16_t size = recordSize(entry.length);
+  memset(bytes, 0xFF, size);
+  uint16_t crc = recordCrc(entry.key, entry.length, entry.value);
+  bytes[0] = entry.key;
+  bytes[1] = entry.length;
+  bytes[2] = crc & 0xFF;
+  bytes[3] = crc >> 8;
+  memcpy(bytes + RECORD_HEADER_SIZE, entry.value, entry.length);
+  return ESP.flashWrite(sectorAddress(sector) + offset, words, size);
+}
+
+// 辅助：读sector的扇区头，有效时返回代号
+static bool readSectorHeader(uint8_t sector, uint32_t* sequence) {
+  uint32_t header[2];
+  if (!ESP.flashRead(sectorAddress(sector), header, sizeof(header)) || header[0] != CONFIG_STORE_MAGIC) {
+    return false;
+  }
+  *sequence = header[1];
+  return true;
+}
+
+// 辅助：依次读出当前扇区的记录，重建全部键的最新值和追加位置
+static void scanActiveSector() {
+  uint16_t offset = SECTOR_HEADER_SIZE;
+  while (offset + RECORD_HEADER_SIZE <= FLASH_SECTOR_SIZE) {
+    uint32_t words[(RECORD_HEADER_SIZE + CONFIG_STORE_MAX_VALUE) / 4];
+    uint8_t* bytes = (uint8_t*)words;
+    ESP.flashRead(sectorAddress(stats.activeSector) + offset, words, RECORD_HEADER_SIZE);
+    if (words[0] == 0xFFFFFFFF) {
+      store.writeOffset = offset;
+      return;
+    }
+
+    uint8_t key = bytes[0];
+    uint8_t length = bytes[1];
+    uint16_t crc = bytes[2] | (bytes[3] << 8);
+    bool valid = key != CONFIG_KEY_ERASED && length > 0 && length <= CONFIG_STORE_MAX_VALUE &&
+                 offset + recordSize(length) <= FLASH_SECTOR_SIZE;
+    if (valid) {
+      ESP.flashRead(sectorAddress(stats.activeSector) + offset + RECORD_HEADER_SIZE, words,
+                    recordSize(length) - RECORD_HEADER_SIZE);
+      valid = recordCrc(key, length, bytes) == crc;
+    }
+    if (!valid) {
+      // 残缺记录之后的位置不可信，不再追加，下次保存时整理到下一个扇区
+      stats.corruptRecords++;
+      LOG_WARNING("Config store: corrupt record at sector %u offset %u", stats.activeSector, offset);
+      break;
+    }
+
+    ConfigEntry* entry = findEntry(key);
+    if (entry == nullptr) {
+      if (store.entryCount >= CONFIG_STORE_MAX_KEYS) {
+        stats.corruptRecords++;
+        break;
+      }
+      entry = &store.entries[store.entryCount++];
+      entry->key = key;
+    }
+    entry->length = length;
+    memcpy(entry->value, bytes, length);
+    offset += recordSize(length);
+  }
+  store.writeOffset = FLASH_SECTOR_SIZE;
+}
+
+// 辅助：擦除下一个扇区，写入全部最新值，最后写扇区头使它成为当前扇区
+static bool compactToNextSector() {
+  uint8_t next = (stats.activeSector + 1) % CONFIG_STORE_SECTORS;
+  if (!ESP.flashEraseSector(store.firstSector + next)) {
+    LOG_ERROR("Config store: failed to erase sector %u", next);
+    return false;
+  }
+  stats.sectorErases++;
+
+  uint16_t offset = SECTOR_HEADER_SIZE;
+  for (uint8_t i = 0; i < store.entryCount; i++) {
+    if (!programRecord(next, offset, store.entries[i])) {
+      return false;
+    }
+    offset += recordSize(store.entries[i].length);
+  }
+
+  uint32_t header[2] = {CONFIG_STORE_MAGIC, stats.sequence + 1};
+  if (!ESP.flashWrite(sectorAddress(next), header, sizeof(header))) {
+    return false;
+  }
+  for (uint8_t i = 0; i < store.entryCount; i++) {
+    store.entries[i].dirty = false;
+  }
+  stats.pendingKeys = 0;
+  stats.sequence++;
+  stats.activeSector = next;
+  store.writeOffset = offset;
+  stats.freeBytes = FLASH_SECTOR_SIZE - offset;
+  LOG_DEBUG("Config store: compacted %u keys into sector %u (sequence %u)", store.entryCount, next, stats.sequence);
+  return true;
+}
+
+/**
+ * @brief 初始化配置存储：找出扇区头最新的扇区并读出全部记录
+ * @return true 成功（没有有效扇区时视为空存储，第一次保存时初始化），
+ *         false 文件系统区不足CONFIG_STORE_SECTORS个扇区，存储不可用
+ *
+ * 文件系统区的位置和大小来自链接脚本（FS_PHYS_ADDR/FS_PHYS_SIZE在核心中由
+ * 链接符号算出，不是常量），只能在运行时检查
+ */
+bool initConfigStore() {
+  memset(&store, 0, sizeof(store));
+  memset(&stats, 0, sizeof(stats));
+
+  uint32_t regionSize = FS_PHYS_SIZE;
+  if (regionSize < (uint32_t)CONFIG_STORE_SECTORS * FLASH_SECTOR_SIZE) {
+    LOG_ERROR("Config store: filesystem region is %u bytes, need %u; settings will not be saved",
+              (unsigned)regionSize, (unsigned)(CONFIG_STORE_SECTORS * FLASH_SECTOR_SIZE));
+    return false;
+  }
+  store.firstSector = (FS_PHYS_ADDR + regionSize) / FLASH_SECTOR_SIZE - CONFIG_STORE_SECTORS;
+
+  bool found = false;
+  for (uint8_t sector = 0; sector < CONFIG_STORE_SECTORS; sector++) {
+    uint32_t sequence;
+    if (readSectorHeader(sector, &sequence) && (!found || (int32_t)(sequence - stats.sequence) > 0)) {
+      found = true;
+      stats.sequence = sequence;
+      stats.activeSector = sector;
+    }
+  }
+
+  if (found) {
+    scanActiveSector();
+  } else {
+    // 空存储：第一次保存时整理到扇区0
+    stats.activeSector = CONFIG_STORE_SECTORS - 1;
+    store.writeOffset = FLASH_SECTOR_SIZE;
+  }
+  stats.freeBytes = FLASH_SECTOR_SIZE - store.writeOffset;
+  store.ready = true;
+
+  LOG_DEBUG("Config store: %u keys, sector %u (sequence %u), %u bytes free", store.entryCount, stats.activeSector,
+            stats.sequence, stats.freeBytes);
+  return true;
+}
+
+/**
+ * @brief 读取一个键的最新值
+ * @param key 键
+ * @param value 输出缓冲区
+ * @param length 期望的长度，与保存时不同视为不存在
+ * @return true 读取成功，false 键不存在
+ */
+bool readConfigValue(uint8_t key, void* value, uint8_t length) {
+  if (!store.ready || value == nullptr) {
+    return false;
+  }
+  const ConfigEntry* entry = findEntry(key);
+  if (entry == nullptr || entry->length != length) {
+    return false;
+  }
+  memcpy(value, entry->value, length);
+  return true;
+}
+
+// 辅助：把一个键的值写入闪存：当前扇区放得下时追加，否则整理到下一个扇区
+static bool persistEntry(ConfigEntry& entry) {
+  if (store.writeOffset + recordSize(entry.length) > FLASH_SECTOR_SIZE) {
+    return compactToNextSector();
+  }
+  if (!programRecord(stats.activeSector, store.writeOffset, entry)) {
+    // 这个位置可能已部分编程，不再追加
+    store.writeOffset = FLASH_SECTOR_SIZE;
+    return false;
+  }
+  store.writeOffset += recordSize(entry.length);
+  stats.freeBytes = FLASH_SECTOR_SIZE - store.writeOffset;
+  return true;
+}
+
+// 辅助：写回任务，写入失败时稍后重试
+static void configFlushTask() {
+  if (!flushConfigStore()) {
+    rescheduleTask(flushTaskId, CONFIG_FLUSH_DELAY);
+  }
+}
+
+/**
+ * @brief 保存一个键的值
+ * @param key 键（0xFF保留）
+ * @param value 值
+ * @param length 值的字节数（1 ~ CONFIG_STORE_MAX_VALUE）
+ * @return true 保存成功（写回模式下为已记入RAM），false 保存失败
+ *
+ * 立即写入时追加一条记录，当前扇区满时先整理到下一个扇区；
+ * 写回模式下只更新RAM，并把写回任务推迟到CONFIG_FLUSH_DELAY之后
+ */
+bool writeConfigValue(uint8_t key, const void* value, uint8_t length) {
+  if (!store.ready || key == CONFIG_KEY_ERASED || value == nullptr || length == 0 ||
+      length > CONFIG_STORE_MAX_VALUE) {
+    return false;
+  }
+
+  ConfigEntry* entry = findEntry(key);
+  if (entry != nullptr && entry->length == length && memcmp(entry->value, value, length) == 0) {
+    stats.unchangedWrites++;
+    return true;
+  }
+  if (entry == nullptr && store.entryCount >= CONFIG_STORE_MAX_KEYS) {
+    LOG_ERROR("Config store: no room for key %u", key);
+    return false;
+  }
+
+  // 先更新RAM中的值，整理时一并写入；失败时恢复
+  ConfigEntry previous;
+  bool existed = (entry != nullptr);
+  if (existed) {
+    previous = *entry;
+  } else {
+    entry = &store.entries[store.entryCount++];
+    entry->key = key;
+    entry->dirty = false;
+  }
+  entry->length = length;
+  memcpy(entry->value, value, length);
+
+  if (flushTaskId >= 0) {
+    if (!entry->dirty) {
+      entry->dirty = true;
+      stats.pendingKeys++;
+    }
+    stats.deferredWrites++;
+    rescheduleTask(flushTaskId, CONFIG_FLUSH_DELAY);
+    return true;
+  }
+
+  if (!persistEntry(*entry)) {
+    if (existed) {
+      *entry = previous;
+    } else {
+      store.entryCount--;
+    }
+    LOG_WARNING("Config store: failed to write key %u", key);
+    return false;
+  }
+  stats.recordsWritten++;
+  return true;
+}
+
+/**
+ * @brief 把写回模式下修改过的键一次写入闪存
+ * @return true 没有待写入的键或全部写入成功，false 写入失败（修改保留在RAM中）
+ */
+bool flushConfigStore() {
+  if (stats.pendingKeys == 0) {
+    return true;
+  }
+
+  uint32_t start = micros();
+  uint8_t written = stats.pendingKeys;
+  for (uint8_t i = 0; i < store.entryCount && stats.pendingKeys > 0; i++) {
+    ConfigEntry& entry = store.entries[i];
+    if (!entry.dirty) {
+      continue;
+    }
+    // 整理会写入全部键并清除所有标记
+    if (!persistEntry(entry)) {
+      LOG_WARNING("Config store: flush failed, %u keys pending", stats.pendingKeys);
+      return false;
+    }
+    if (entry.dirty) {
+      entry.dirty = false;
+      stats.pendingKeys--;
+    }
+  }
+
+  uint32_t elapsed = micros() - start;
+  stats.recordsWritten += written;
+  stats.flushes++;
+  stats.lastFlushMicros = elapsed;
+  if (elapsed > stats.maxFlushMicros) {
+    stats.maxFlushMicros = elapsed;
+  }
+  LOG_DEBUG("Config store: flushed %u keys in %lu us", written, (unsigned long)elapsed);
+  return true;
+}
+
+/**
+ * @brief 启用写回：注册写回任务，之后的保存只更新RAM
+ */
+void startConfigWriteBack() {
+  if (flushTaskId < 0) {
+    flushTaskId = addTask("cfg-flush", configFlushTask, 0, CONFIG_FLUSH_DELAY);
+  }
+}
+
+/**
+ * @brief 停用写回：写入全部修改并注销写回任务，之后的保存立即写入
+ */
+void stopConfigWriteBack() {
+  flushConfigStore();
+  cancelTask(flushTaskId);
+  flushTaskId = -1;
+}
+
+/**
+ * @brief 擦除全部扇区，清空所有键
+ * @return true 成功，false 存储不可用或有扇区擦除失败
+ */
+bool clearConfigStore() {
+  if (!store.ready && !initConfigStore()) {
+    return false;
+  }
+  bool success = true;
+  for (uint8_t sector = 0; sector < CONFIG_STORE_SECTORS; sector++) {
+    if (ESP.flashEraseSector(store.firstSector + sector)) {
+      stats.sectorErases++;
+    } else {
+      success = false;
+    }
+  }
+  uint32_t erases = stats.sectorErases;
+  initConfigStore();
+  stats.sectorErases = erases;
+  return success;
+}
+
+const ConfigStoreStats& getConfigStoreStats() {
+  return stats;
+}
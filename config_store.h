@@ -0,0 +1,58 @@
+/**
+ * @file config_store.h
+ * @brief 日志式配置存储
+ *
+ * 配置项按键值记录追加写入闪存文件系统区末尾的CONFIG_STORE_SECTORS个扇区，
+ * 每条记录带CRC。保存一项只编程几个字（几十微秒），不擦除扇区；当前扇区写满时
+ * 擦除轮到的下一个扇区，把全部最新值写进去后再写扇区头，各扇区轮流擦除。
+ * 启动时只扫描扇区头最新的那个扇区即得到全部最新值，保存在RAM中供读取
+ *
+ * 调用startConfigWriteBack()后保存改为写回：只更新RAM并标记，最后一次修改
+ * CONFIG_FLUSH_DELAY之后由调度器任务一次写入全部修改；退出设置模式、
+ * 计划重启和OTA前调用flushConfigStore()立即写入。连续调节只写最终值
+ *
+ * 占用文件系统区的最后几个扇区，本项目不使用SPIFFS/LittleFS
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+
+// 最多可保存的键数（RAM中保存每个键的最新值）
+const uint8_t CONFIG_STORE_MAX_KEYS = 8;
+
+// 单个值的最大字节数
+const uint8_t CONFIG_STORE_MAX_VALUE = 16;
+
+// 配置存储统计
+struct ConfigStoreStats {
+  uint32_t recordsWritten;     // 本次启动以来追加的记录数（不含整理时复制的）
+  uint32_t unchangedWrites;    // 值未变、未写闪存的保存次数
+  uint32_t deferredWrites;     // 写回模式下只更新了RAM的保存次数
+  uint32_t flushes;            // 写回次数
+  uint32_t lastFlushMicros;    // 最近一次写回的耗时
+  uint32_t maxFlushMicros;     // 单次写回的最长耗时
+  uint32_t sectorErases;       // 本次启动以来的扇区擦除次数
+  uint32_t corruptRecords;     // 启动扫描时遇到的损坏记录（如写入时断电）
+  uint32_t sequence;           // 当前扇区的代号，每擦除一个扇区加1
+  uint8_t activeSector;        // 当前扇区（0 ~ CONFIG_STORE_SECTORS-1）
+  uint16_t freeBytes;          // 当前扇区剩余可追加的字节数
+  uint8_t pendingKeys;         // 已修改、尚未写入闪存的键数
+};
+
+// 函数声明
+bool initConfigStore();
+bool readConfigValue(uint8_t key, void* value, uint8_t length);
+bool writeConfigValue(uint8_t key, const void* value, uint8_t length);
+bool clearConfigStore();
+bool flushConfigStore();
+void startConfigWriteBack();
+void stopConfigWriteBack();
+const ConfigStoreStats& getConfigStoreStats();
+
+#endif // CONFIG_STORE_H
@@ -0,0 +1,163 @@
+/**
+ * @file display_flush.cpp
+ * @brief OLED脏区增量刷新模块实现
+ *
+ * U8g2全缓冲模式下帧缓冲按页(tile行)组织：每页8像素高，每列1字节，
+ * 一个8x8 tile即连续的8字节。逐行找出变化tile的最小/最大列，
+ * 并把列范围相同的相邻行合并为一次updateDisplayArea调用
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#define LOG_MODULE DISPLAY
+
+#include "display_flush.h"
+#include "global_config.h"
+#include "logger.h"
+#include "runtime_monitor.h"
+#include "loop_profiler.h"
+#include "breadcrumbs.h"
+#include <string.h>
+
+// 脏区刷新统计
+DisplayFlushStats displayFlushStats = {
+  0,    // frameCount
+  0,    // fullFrameCount
+  0,    // partialFrameCount
+  0,    // skippedFrameCount
+  0,    // lastFrameBytes
+  0,    // totalBytesSent
+  0     // fullFrameBytes
+};
+
+// 上次已发送到屏幕的帧内容
+static uint8_t shadowFrame[DISPLAY_FRAME_BYTES];
+static bool shadowValid = false;
+static unsigned long lastFullFrameTime = 0;  // 最近一次整帧发送的时间
+
+// 增量数据量超过整帧的3/4时，直接整帧发送（减少逐区域寻址命令开销）
+static const uint16_t FULL_FRAME_THRESHOLD = DISPLAY_FRAME_BYTES * 3 / 4;
+
+// 辅助：比较指定tile是否发生变化
+static inline bool isTileDirty(const uint8_t* frame, uint16_t offset) {
+  return memcmp(frame + offset, shadowFrame + offset, 8) != 0;
+}
+
+// 辅助：整帧发送并同步影子帧
+static uint16_t sendFullFrame(const uint8_t* frame, uint16_t frameBytes) {
+  u8g2.sendBuffer();
+  memcpy(shadowFrame, frame, frameBytes);
+  shadowValid = true;
+  lastFullFrameTime = millis();
+  displayFlushStats.fullFrameCount++;
+  return frameBytes;
+}
+
+/**
+ * @brief 将帧缓冲中相对上次发送发生变化的区域推送到屏幕
+ * @return 本次推送的字节数（0表示内容未变化）
+ */
+uint16_t flushDisplay() {
+  PROFILE_SCOPE("sendBuffer");
+  BREADCRUMB_SECTION("sendBuffer");
+  uint8_t* frame = u8g2.getBufferPtr();
+  uint8_t tileWidth = u8g2.getBufferTileWidth();
+  uint8_t tileHeight = u8g2.getBufferTileHeight();
+  uint16_t frameBytes = (uint16_t)tileWidth * tileHeight * 8;
+  uint16_t bytesSent = 0;
+
+  displayFlushStats.frameCount++;
+  displayFlushStats.fullFrameBytes += frameBytes;
+
+  // U8g2写面板失败时不报错，影子帧可能与面板不符：定期整帧发送一次，
+  // 让丢失的增量写入在不变的区域上也能自愈
+  bool refreshDue = (unsigned long)(millis() - lastFullFrameTime) >= DISPLAY_FULL_REFRESH_INTERVAL;
+
+  if (!shadowValid || refreshDue || frameBytes > DISPLAY_FRAME_BYTES ||
+      tileHeight > DISPLAY_MAX_TILE_ROWS) {
+    bytesSent = sendFullFrame(frame, frameBytes);
+  } else {
+    // 第一遍：统计脏区总字节数，决定走增量还是整帧
+    uint8_t spanStart[DISPLAY_MAX_TILE_ROWS];
+    uint8_t spanEnd[DISPLAY_MAX_TILE_ROWS];
+    uint16_t dirtyBytes = 0;
+
+    for (uint8_t ty = 0; ty < tileHeight; ty++) {
+      uint16_t rowOffset = (uint16_t)ty * tileWidth * 8;
+      int16_t first = -1;
+      int16_t last = -1;
+      for (uint8_t tx = 0; tx < tileWidth; tx++) {
+        if (isTileDirty(frame, rowOffset + tx * 8)) {
+          if (first < 0) first = tx;
+          last = tx;
+        }
+      }
+      if (first < 0) {
+        spanStart[ty] = 0xFF;  // 本行无变化
+        spanEnd[ty] = 0;
+      } else {
+        spanStart[ty] = (uint8_t)first;
+        spanEnd[ty] = (uint8_t)last;
+        dirtyBytes += (uint16_t)(last - first + 1) * 8;
+      }
+    }
+
+    if (dirtyBytes == 0) {
+      displayFlushStats.skippedFrameCount++;
+    } else if (dirtyBytes > FULL_FRAME_THRESHOLD) {
+      bytesSent = sendFullFrame(frame, frameBytes);
+    } else {
+      // 第二遍：列范围相同的相邻行合并为一个矩形区域推送
+      uint8_t ty = 0;
+      while (ty < tileHeight) {
+        if (spanStart[ty] == 0xFF) {
+          ty++;
+          continue;
+        }
+        uint8_t runStart = ty;
+        while (ty + 1 < tileHeight &&
+               spanStart[ty + 1] == spanStart[runStart] &&
+               spanEnd[ty + 1] == spanEnd[runStart]) {
+          ty++;
+        }
+        uint8_t tw = spanEnd[runStart] - spanStart[runStart] + 1;
+        uint8_t th = ty - runStart + 1;
+        u8g2.updateDisplayArea(spanStart[runStart], runStart, tw, th);
+        bytesSent += (uint16_t)tw * th * 8;
+        ty++;
+      }
+      memcpy(shadowFrame, frame, frameBytes);
+      displayFlushStats.partialFrameCount++;
+    }
+  }
+
+  displayFlushStats.lastFrameBytes = bytesSent;
+  displayFlushStats.totalBytesSent += bytesSent;
+  if (bytesSent > 0) {
+    noteFrameSent();  // 按键事件的延迟到第一帧实际上屏为止
+  }
+  return bytesSent;
+}
+
+/**
+ * @brief 使影子帧失效，下次刷新强制整帧发送
+ *
+ * 屏幕内容可能被外部改变时调用（如u8g2.begin()重新初始化控制器，
+ * 或I2C总线/设备恢复后面板上的内容不可信）
+ */
+void invalidateDisplayShadow() {
+  shadowValid = false;
+  LOG_DEBUG("Display shadow frame invalidated");
+}
+
+/**
+ * @brief 获取相对整帧发送节省的I2C数据量百分比
+ * @return 节省百分比 (0-100)
+ */
+uint8_t getDisplayFlushSavingPercent() {
+  if (displayFlushStats.fullFrameBytes == 0) return 0;
+  uint64_t saved = displayFlushStats.fullFrameBytes - displayFlushStats.totalBytesSent;
+  return (uint8_t)(saved * 100 / displayFlushStats.fullFrameBytes);
+}
@@ -0,0 +1,42 @@
+/**
+ * @file display_flush.h
+ * @brief OLED脏区增量刷新模块
+ *
+ * 在U8g2全帧缓冲之上维护一份"上次已发送帧"的影子副本，逐8x8像素tile
+ * 比较新旧帧，只通过updateDisplayArea推送发生变化的tile区域，
+ * 并统计每帧实际通过I2C推送的字节数
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef DISPLAY_FLUSH_H
+#define DISPLAY_FLUSH_H
+
+#include <Arduino.h>
+
+// 128x64单色屏的帧缓冲大小（16x8个tile，每个tile 8字节）
+#define DISPLAY_FRAME_BYTES 1024
+// 增量刷新支持的最大tile行数（更高的缓冲直接整帧发送）
+#define DISPLAY_MAX_TILE_ROWS 8
+
+// 脏区刷新统计
+struct DisplayFlushStats {
+  uint32_t frameCount;          // flushDisplay调用次数
+  uint32_t fullFrameCount;      // 整帧发送次数
+  uint32_t partialFrameCount;   // 增量发送次数
+  uint32_t skippedFrameCount;   // 内容未变化而跳过的次数
+  uint32_t lastFrameBytes;      // 最近一帧推送的字节数
+  uint64_t totalBytesSent;      // 累计推送字节数（64位：每秒1KB时32位约48天回绕）
+  uint64_t fullFrameBytes;      // 若每帧整帧发送的累计字节数（对照基线）
+};
+
+extern DisplayFlushStats displayFlushStats;
+
+// 函数声明
+uint16_t flushDisplay();
+void invalidateDisplayShadow();
+uint8_t getDisplayFlushSavingPercent();
+
+#endif // DISPLAY_FLUSH_H
@@ -1,5 +1,8 @@
+#define LOG_MODULE DISPLAY
+
 #include "display_manager.h"
 #include "time_manager.h"
+#include "clock_discipline.h"
 #include "button_handler.h"
 #include "system_manager.h"
 #include "utils.h"
@@ -7,8 +10,13 @@
 #include <RTClib.h>
 #include <U8g2lib.h>
 #include "logger.h"
-#include "eeprom_config.h"
+#include "config_manager.h"
+#include "config_store.h"
 #include "version.h"
+#include "display_flush.h"
+#include "glyph_cache.h"
+#include "loop_profiler.h"
+#include "breadcrumbs.h"
 
 // UI 布局常量
 const int PADDING_X = 4;
@@ -25,7 +33,6 @@ extern DisplayState displayState;
 extern SettingState settingState;
 extern TimeState timeState;
 extern RTC_DS1307 rtc;
-extern NTPClient timeClient;
 extern const uint8_t BRIGHTNESS_LEVELS[];
 extern const char* const BRIGHTNESS_LABELS[];
 extern const char* const MARKET_DAYS[];
@@ -58,6 +65,35 @@ void displayDate(const DateTime& now) {
   u8g2.drawUTF8(dateX, dateY, dateStr);
 }
 
+// 辅助：当前字号对应的时间字体
+static const uint8_t* getTimeFont() {
+  return displayState.largeFont ? u8g2_font_logisoso26_tr : u8g2_font_logisoso18_tr;
+}
+
+// 辅助：当前字号对应的时间基线
+static int getTimeBaselineY() {
+  return displayState.largeFont ? 48 : 42;
+}
+
+// 确保时间字形缓存与当前字号一致（会借用帧缓冲，须在clearBuffer之前调用）
+void prepareTimeGlyphCache() {
+  static const uint8_t* lastFont = nullptr;
+  static int lastBaselineY = -1;
+
+  const uint8_t* font = getTimeFont();
+  int baselineY = getTimeBaselineY();
+  // 同一字号只尝试生成一次，失败后保持drawUTF8回退路径
+  if (font == lastFont && baselineY == lastBaselineY) {
+    return;
+  }
+  lastFont = font;
+  lastBaselineY = baselineY;
+
+  if (!buildGlyphCache(font, baselineY)) {
+    LOG_WARNING("Glyph cache unavailable, falling back to drawUTF8");
+  }
+}
+
 // 辅助函数：显示时间（复古风格 - 核心区域，带分隔线）
 void displayTimeValue(const DateTime& now) {
   int hour = now.hour();
@@ -78,39 +114,27 @@ void displayTimeValue(const DateTime& now) {
   int lineStartX = (SCREEN_WIDTH - lineWidth) / 2;
   u8g2.drawLine(lineStartX, 54, lineStartX + lineWidth, 54);
 
-  if (displayState.largeFont) {
-    u8g2.setFont(u8g2_font_logisoso26_tr);
-  } else {
-    u8g2.setFont(u8g2_font_logisoso18_tr);
-  }
+  const uint8_t* timeFont = getTimeFont();
+  u8g2.setFont(timeFont);
   
   // 固定时间显示位置，防止非等宽字体导致的跳动
   // 针对不同字号使用不同的固定起始坐标，以确保视觉居中
   int fixedX = displayState.largeFont ? 2 : 22; 
-  int fixedY = displayState.largeFont ? 48 : 42;
+  int fixedY = getTimeBaselineY();
   
-  u8g2.drawUTF8(fixedX, fixedY, timeStr);
+  // 优先使用预解码的字形位图，缓存不可用时回退到drawUTF8
+  if (!isGlyphCacheValid(timeFont, fixedY) || drawCachedGlyphString(fixedX, timeStr) < 0) {
+    u8g2.drawUTF8(fixedX, fixedY, timeStr);
+  }
 }
 
 // 辅助函数：显示市场日和星期（复古风格 - 底部区域，带底线）
 void displayMarketDayAndWeekday(const DateTime& now) {
   u8g2.setFont(u8g2_font_wqy12_t_gb2312);
 
-  tm timeInfo = {};
-  timeInfo.tm_year = now.year() - 1900;
-  timeInfo.tm_mon = now.month() - 1;
-  timeInfo.tm_mday = now.day();
-  timeInfo.tm_hour = 0;
-  timeInfo.tm_min = 0;
-  timeInfo.tm_sec = 0;
-  time_t currentTime = mktime(&timeInfo);
-
-  if (currentTime == (time_t)-1) {
-    currentTime = now.unixtime();
-  }
-
-  int marketIndex;
-  calculateMarketDay(currentTime, marketIndex);
+  // 圩日和星期只在日期变化时重新计算
+  const MarketDayInfo& dayInfo = getMarketDayInfo(now.year(), now.month(), now.day());
+  int marketIndex = dayInfo.marketIndex;
   if (marketIndex < 0 || marketIndex >= 3) {
     marketIndex = 0;
   }
@@ -121,7 +145,7 @@ void displayMarketDayAndWeekday(const DateTime& now) {
   const int infoY = SCREEN_HEIGHT - 4;
   drawProgmemString((const char*)pgm_read_ptr(&MARKET_DAYS[marketIndex]), PADDING_X, infoY);
 
-  int weekdayIndex = now.dayOfTheWeek();
+  int weekdayIndex = dayInfo.weekdayIndex;
   if (weekdayIndex < 0 || weekdayIndex >= 7) weekdayIndex = 0;
 
   char weekBuffer[10];
@@ -147,10 +171,20 @@ void displayTimeSourceIcon() {
   // }
 }
 
+// 时间界面的下一帧是否已到计划时刻（溢出安全）
+bool isTimeFrameDue(unsigned long currentMillis) {
+  return (long)(currentMillis - displayState.nextTimeFrameMillis) >= 0;
+}
+
 // 优化的显示刷新策略
 void displayTime() {
+  PROFILE_SCOPE("displayTime");
+  BREADCRUMB_SECTION("displayTime");
   DateTime now;
-  if (!getCurrentTime(now)) {
+  bool haveTime = getCurrentTime(now);
+  // 下一帧安排在当前时间源的下一个秒边界，使屏幕上的秒与真实秒同时跳变
+  displayState.nextTimeFrameMillis = millis() + getMillisToNextSecond();
+  if (!haveTime) {
     // 检查是否刚切换到NTP时间源（在10秒内），如果是，则暂时不显示错误信息
     unsigned long currentTime = millis();
     unsigned long timeSinceSwitch = (currentTime >= timeState.lastTimeSourceSwitch) ?
@@ -165,8 +199,8 @@ void displayTime() {
         systemState.rtcInitialized && systemState.rtcTimeValid && 
         (!justSwitchedToNtp || timeSinceSwitch >= 3000)) {
       // 临时使用RTC时间显示，但保持时间源为NTP
-      DateTime rtcNow = rtc.now();
-      now = rtcNow;  // 使用拷贝构造而非赋值操作符
+      uint16_t rtcSubsecondMs;
+      getRtcClockTime(now, rtcSubsecondMs);
       if (!isRtcTimeValid(now)) {
         // RTC时间也无效，显示错误
         if (!systemState.forceDisplayTimeError && !justSwitchedToNtp) {
@@ -177,7 +211,7 @@ void displayTime() {
           u8g2.drawUTF8(0, 20, "正在获取网络时间");
           u8g2.drawUTF8(0, 35, "请稍候...");
           // displayTimeSourceIcon(); // 已禁用时间源图标显示
-          u8g2.sendBuffer();
+          flushDisplay();
         }
         return;
       }
@@ -192,7 +226,7 @@ void displayTime() {
         u8g2.drawUTF8(0, 20, "正在获取网络时间");
         u8g2.drawUTF8(0, 35, "请稍候...");
         // displayTimeSourceIcon(); // 已禁用时间源图标显示
-        u8g2.sendBuffer();
+        flushDisplay();
       }
       return;
     }
@@ -229,6 +263,7 @@ void displayTime() {
     displayState.lastDisplayedSecond = now.second();
     systemState.lastForceDisplayTimeError = systemState.forceDisplayTimeError;
     
+    prepareTimeGlyphCache();
     u8g2.clearBuffer();
     
     // 调用辅助函数来显示各个部分
@@ -237,7 +272,8 @@ void displayTime() {
     displayMarketDayAndWeekday(now);
     // displayTimeSourceIcon(); // 已禁用时间源图标显示
     
-    u8g2.sendBuffer();
+    // 仅推送发生变化的tile区域（通常只有秒数位）
+    flushDisplay();
   }
 }
 
@@ -328,7 +364,7 @@ void displayOtaUpdating() {
   int textX2 = (128 - textWidth2) / 2;
   u8g2.drawUTF8(textX2, 62, prompt2);
 
-  u8g2.sendBuffer();
+  flushDisplay();
 }
 
 // 显示OTA更新完成界面
@@ -355,7 +391,7 @@ void displayOtaComplete() {
   u8g2.drawLine(60, 54, 62, 56);
   u8g2.drawLine(62, 56, 68, 50);
 
-  u8g2.sendBuffer();
+  flushDisplay();
 }
 
 // 显示OTA更新失败界面
@@ -382,7 +418,7 @@ void displayOtaFailed() {
   u8g2.drawLine(60, 50, 68, 58);
   u8g2.drawLine(68, 50, 60, 58);
 
-  u8g2.sendBuffer();
+  flushDisplay();
 }
 
 // 显示OTA更新进度界面
@@ -427,65 +463,44 @@ void displayOtaProgress(uint8_t progress, uint32_t uploadedSize, uint32_t totalS
   int sizeTextX = (128 - sizeTextWidth) / 2;
   u8g2.drawUTF8(sizeTextX, 62, sizeStr);
 
-  u8g2.sendBuffer();
+  flushDisplay();
 }
 
-// 辅助：判断是否为闰年
-static bool isLeapYear(int year) {
-  return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+// 辅助：计算从基准日期到指定日期的天数差（常数时间）
+static long getDaysSinceBaseDate(int year, int month, int day) {
+  static constexpr long BASE_DAYS = daysFromCivil(MarketConfig::BASE_YEAR,
+                                                  MarketConfig::BASE_MONTH,
+                                                  MarketConfig::BASE_DAY);
+  return daysFromCivil(year, month, day) - BASE_DAYS;
 }
 
-// 辅助：获取指定月份的天数
-static int getDaysInMonth(int month, int year) {
-  if (month == 2) return isLeapYear(year) ? 29 : 28;
-  if (month == 4 || month == 6 || month == 9 || month == 11) return 30;
-  return 31;
+// 计算指定日期的圩日索引 (0 ~ CYCLE_DAYS-1)
+int getMarketIndexForDate(int year, int month, int day) {
+  long daysDiff = getDaysSinceBaseDate(year, month, day);
+  // ((daysDiff % 3) + 3) % 3 直接处理负数情况，确保结果在0-2范围内
+  return (int)(((daysDiff % MarketConfig::CYCLE_DAYS) + MarketConfig::CYCLE_DAYS) % MarketConfig::CYCLE_DAYS);
 }
 
-// 辅助：计算从基准日期到指定日期的天数差
-static long getDaysSinceBaseDate(int year, int month, int day) {
-  // 使用配置的基准日期
-  int baseYear = MarketConfig::BASE_YEAR;
-  int baseMonth = MarketConfig::BASE_MONTH;
-  int baseDay = MarketConfig::BASE_DAY;
-  
-  // 计算目标日期相对于基准日期的天数
-  long days = 0;
-  
-  if (year > baseYear || (year == baseYear && month > baseMonth) || 
-      (year == baseYear && month == baseMonth && day >= baseDay)) {
-    // 目标日期在基准日期之后
-    for (int y = baseYear; y < year; y++) {
-      days += isLeapYear(y) ? 366 : 365;
-    }
-    for (int m = 1; m < month; m++) {
-      days += getDaysInMonth(m, year);
-    }
-    days += (day - 1);
-    
-    // 减去基准日期之前的天数
-    for (int m = 1; m < baseMonth; m++) {
-      days -= getDaysInMonth(m, baseYear);
-    }
-    days -= (baseDay - 1);
-  } else {
-    // 目标日期在基准日期之前（返回负数）
-    for (int y = year; y < baseYear; y++) {
-      days -= isLeapYear(y) ? 366 : 365;
-    }
-    for (int m = 1; m < baseMonth; m++) {
-      days -= getDaysInMonth(m, baseYear);
-    }
-    days -= (baseDay - 1);
-    
-    // 加上目标日期之前的天数
-    for (int m = 1; m < month; m++) {
-      days += getDaysInMonth(m, year);
-    }
-    days += (day - 1);
+/**
+ * @brief 获取指定日期的圩日和星期（按日缓存）
+ *
+ * 同一天内的重复调用只做一次日期比较，跨日时才重新计算
+ */
+const MarketDayInfo& getMarketDayInfo(int year, int month, int day) {
+  static MarketDayInfo cache = {
+    -1,  // dateKey
+    0,   // marketIndex
+    0    // weekdayIndex
+  };
+
+  int32_t dateKey = (int32_t)year * 10000 + month * 100 + day;
+  if (dateKey != cache.dateKey) {
+    long days = daysFromCivil(year, month, day);
+    cache.marketIndex = (int8_t)getMarketIndexForDate(year, month, day);
+    cache.weekdayIndex = (int8_t)weekdayFromDays(days);
+    cache.dateKey = dateKey;
   }
-  
-  return days;
+  return cache;
 }
 
 void calculateMarketDay(time_t currentTime, int& marketIndex) {
@@ -496,7 +511,9 @@ void calculateMarketDay(time_t currentTime, int& marketIndex) {
   }
 
   // 检查时间是否在合理范围内（2000年到2099年）
-  if (currentTime < 946684800UL || currentTime > 4102444799UL) {
+  // 按有符号64位比较：time_t为有符号类型，上限超出32位有符号范围
+  int64_t seconds = (int64_t)currentTime;
+  if (seconds < 946684800LL || seconds > 4102444799LL) {
     marketIndex = 0;
     return;
   }
@@ -512,12 +529,7 @@ void calculateMarketDay(time_t currentTime, int& marketIndex) {
   int month = currentTm.tm_mon + 1;
   int day = currentTm.tm_mday;
 
-  // 计算从基准日期到当前日期的天数差
-  long daysDiff = getDaysSinceBaseDate(year, month, day);
-  
-  // 使用简化的公式计算市场索引：((daysDiff % 3) + 3) % 3
-  // 这个公式直接处理负数情况，确保结果在0-2范围内
-  marketIndex = ((daysDiff % MarketConfig::CYCLE_DAYS) + MarketConfig::CYCLE_DAYS) % MarketConfig::CYCLE_DAYS;
+  marketIndex = getMarketIndexForDate(year, month, day);
 }
 
 void oledShowLines(const char* l1, const char* l2, const char* l3, const char* l4) {
@@ -528,7 +540,7 @@ void oledShowLines(const char* l1, const char* l2, const char* l3, const char* l
   if (l2) { u8g2.drawUTF8(0, y, l2); y += 14; }
   if (l3) { u8g2.drawUTF8(0, y, l3); y += 14; }
   if (l4) { u8g2.drawUTF8(0, y, l4); }
-  u8g2.sendBuffer();
+  flushDisplay();
 }
 
 void oledShowLinesSmall(const char* l1, const char* l2, const char* l3, const char* l4) {
@@ -539,7 +551,7 @@ void oledShowLinesSmall(const char* l1, const char* l2, const char* l3, const ch
   if (l2) { u8g2.drawUTF8(0, y, l2); y += 12; }
   if (l3) { u8g2.drawUTF8(0, y, l3); y += 12; }
   if (l4) { u8g2.drawUTF8(0, y, l4); }
-  u8g2.sendBuffer();
+  flushDisplay();
 }
 
 // 统一的错误显示函数，使用一致的字体大小
@@ -582,7 +594,7 @@ void displayError(const char* l1, const char* l2, const char* l3, const char* l4
     u8g2.drawUTF8((128 - w) / 2, y, l4);  // 水平居中
   }
   
-  u8g2.sendBuffer();
+  flushDisplay();
 }
 
 void drawClockIcon() {
@@ -625,7 +637,7 @@ void drawClockIcon() {
   u8g2.setFont(u8g2_font_unifont_t_chinese3);
   u8g2.drawUTF8(centerX - 16, centerY + 4, "时钟");
   
-  u8g2.sendBuffer();
+  flushDisplay();
 }
 
 void displayErrorScreen(const char* errorMessage, const char* errorDetail) {
@@ -665,7 +677,7 @@ void displayErrorScreen(const char* errorMessage, const char* errorDetail) {
     u8g2.drawUTF8(2, 56, "K4长按: 重置WiFi");
   }
   
-  u8g2.sendBuffer();
+  flushDisplay();
 }
 
 // 设置模式相关函数
@@ -712,6 +724,8 @@ void exitSettingMode() {
     if (systemState.rtcInitialized) {
       // rtc.adjust()函数返回void，无法检查返回值
       rtc.adjust(newTime);
+      noteRtcSetManually();
+      anchorRtcClock(newTime);
       systemState.rtcTimeValid = true;
     }
     
@@ -798,7 +812,7 @@ void displaySettingScreen() {
   u8g2.drawHLine(fieldStartX, highlightY, fieldWidth);
   u8g2.drawHLine(fieldStartX, highlightY + 1, fieldWidth);
 
-  u8g2.sendBuffer();
+  flushDisplay();
 }
 
 void updateSettingValue(int direction) {
@@ -839,11 +853,12 @@ void exitBrightnessSettingMode() {
   // 应用亮度设置
   u8g2.setContrast(BRIGHTNESS_LEVELS[displayState.brightnessIndex]);
 
-  // 保存亮度设置到EEPROM
-  if (saveBrightnessIndex(displayState.brightnessIndex)) {
-    LOG_DEBUG("Brightness setting saved to EEPROM: %d", displayState.brightnessIndex);
+  // 保存亮度设置
+  // 调节过程中不写闪存，退出时立即写回最终值
+  if (setConfigValue(CONFIG_BRIGHTNESS_INDEX, displayState.brightnessIndex) && flushConfigStore()) {
+    LOG_DEBUG("Brightness setting saved: %d", displayState.brightnessIndex);
   } else {
-    LOG_WARNING("Failed to save brightness setting to EEPROM");
+    LOG_WARNING("Failed to save brightness setting");
   }
 
   // 使用PROGMEM安全方式读取亮度标签用于日志输出
@@ -926,7 +941,7 @@ void displayBrightnessSettingScreen() {
   int filledWidth = (barWidth * (safeBrightnessIndex + 1)) / 4;
   u8g2.drawBox(barX + 1, barY + 1, filledWidth - 2, barHeight - 2);
 
-  u8g2.sendBuffer();
+  flushDisplay();
 }
 
 void updateBrightnessSetting(int direction) {
@@ -981,5 +996,5 @@ void displayVersionInfo() {
   snprintf(chipIdLine, sizeof(chipIdLine), "芯片ID: %X", ESP.getChipId());
   u8g2.drawUTF8(0, 62, chipIdLine);
 
-  u8g2.sendBuffer();
+  flushDisplay();
 }
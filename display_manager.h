@@ -4,8 +4,17 @@
 #include <U8g2lib.h>
 #include "global_config.h"
 
+// 按日缓存的圩日和星期
+struct MarketDayInfo {
+  int32_t dateKey;        // 缓存对应的日期 (YYYYMMDD)
+  int8_t marketIndex;     // 圩日索引 (0-2)
+  int8_t weekdayIndex;    // 星期 (0=星期日)
+};
+
 // 函数声明
 void displayTime();
+bool isTimeFrameDue(unsigned long currentMillis);
+void prepareTimeGlyphCache();
 void displayStatusOverlay();
 void displayOtaMode();
 void displayOtaUpdating();
@@ -13,6 +22,8 @@ void displayOtaComplete();
 void displayOtaFailed();
 void displayOtaProgress(uint8_t progress, uint32_t uploadedSize, uint32_t totalSize);
 void calculateMarketDay(time_t currentTime, int& marketIndex);
+int getMarketIndexForDate(int year, int month, int day);
+const MarketDayInfo& getMarketDayInfo(int year, int month, int day);
 void oledShowLines(const char* l1, const char* l2 = nullptr, const char* l3 = nullptr, const char* l4 = nullptr);
 void oledShowLinesSmall(const char* l1, const char* l2 = nullptr, const char* l3 = nullptr, const char* l4 = nullptr);
 void displayError(const char* l1, const char* l2 = nullptr, const char* l3 = nullptr, const char* l4 = nullptr);
@@ -1,279 +0,0 @@
-/**
- * @file eeprom_config.cpp
- * @brief EEPROM配置管理实现文件
- *
- * 实现使用EEPROM持久化存储的配置项
- *
- * @author ESP8266 SSD1306 Clock Project
- * @version 2.1
- * @date 2025-02-03
- */
-
-#include "eeprom_config.h"
-#include "logger.h"
-
-/**
- * @brief CRC8校验算法（使用多项式0x07，与Dallas/Maxim格式兼容）
- * @param data 数据指针
- * @param len 数据长度
- * @return CRC8校验值
- */
-static uint8_t crc8(const uint8_t* data, size_t len) {
-    uint8_t crc = 0x00;
-    const uint8_t polynomial = 0x07;
-
-    for (size_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (uint8_t bit = 0; bit < 8; bit++) {
-            if (crc & 0x80) {
-                crc = (crc << 1) ^ polynomial;
-            } else {
-                crc <<= 1;
-            }
-        }
-    }
-
-    return crc;
-}
-
-/**
- * @brief 初始化EEPROM
- * @note 必须在setup()中调用
- */
-void initEEPROM() {
-    // ESP8266需要先调用EEPROM.begin()来初始化
-    EEPROM.begin(EEPROM_SIZE);
-    LOG_DEBUG("EEPROM initialized, size: %d bytes", EEPROM_SIZE);
-}
-
-/**
- * @brief 计算校验和（使用CRC8算法）
- * @param config 配置结构体指针
- * @return CRC8校验值
- */
-uint8_t calculateChecksum(const EEPROMConfig* config) {
-    if (config == nullptr) return 0;
-
-    // 构建用于CRC计算的数据数组（包含版本号）
-    uint8_t data[5];
-    data[0] = config->version;
-    data[1] = config->brightnessIndex;
-    data[2] = config->fontSize;
-    data[3] = config->magicNumber & 0xFF;
-    data[4] = (config->magicNumber >> 8) & 0xFF;
-
-    // 返回CRC8校验值
-    return crc8(data, sizeof(data));
-}
-
-/**
- * @brief 验证EEPROM数据有效性
- * @return true 数据有效，false 数据无效
- */
-bool validateEEPROM() {
-    // 读取版本号
-    uint8_t version = EEPROM.read(EEPROM_ADDR_VERSION);
-
-    // 读取魔数
-    uint16_t magicNumber = EEPROM.read(EEPROM_ADDR_MAGIC_NUMBER);
-    magicNumber |= (EEPROM.read(EEPROM_ADDR_MAGIC_NUMBER + 1) << 8);
-
-    // 读取校验和
-    uint8_t storedChecksum = EEPROM.read(EEPROM_ADDR_CHECKSUM);
-
-    // 读取亮度索引
-    uint8_t brightnessIndex = EEPROM.read(EEPROM_ADDR_BRIGHTNESS_INDEX);
-
-    // 读取字体大小
-    uint8_t fontSize = EEPROM.read(EEPROM_ADDR_FONT_SIZE);
-
-    // 构建配置结构体
-    EEPROMConfig config;
-    config.version = version;
-    config.brightnessIndex = brightnessIndex;
-    config.fontSize = fontSize;
-    config.magicNumber = magicNumber;
-    config.checksum = storedChecksum;
-
-    // 验证版本号（如果版本号大于当前版本，返回无效）
-    if (config.version > EEPROM_CONFIG_VERSION) {
-        LOG_DEBUG("EEPROM version too new: %d (current: %d)", config.version, EEPROM_CONFIG_VERSION);
-        return false;
-    }
-
-    // 验证魔数
-    if (config.magicNumber != EEPROM_MAGIC_NUMBER) {
-        LOG_DEBUG("EEPROM magic number mismatch: 0x%04X (expected: 0x%04X)",
-                  config.magicNumber, EEPROM_MAGIC_NUMBER);
-        return false;
-    }
-
-    // 验证亮度索引范围
-    if (config.brightnessIndex > 3) {
-        LOG_DEBUG("EEPROM brightness index out of range: %d", config.brightnessIndex);
-        return false;
-    }
-
-    // 验证字体大小范围
-    if (config.fontSize > 1) {
-        LOG_DEBUG("EEPROM font size out of range: %d", config.fontSize);
-        return false;
-    }
-
-    // 计算并验证CRC8校验和
-    uint8_t calculatedChecksum = calculateChecksum(&config);
-    if (config.checksum != calculatedChecksum) {
-        LOG_DEBUG("EEPROM CRC8 checksum mismatch: stored=0x%02X, calculated=0x%02X",
-                  config.checksum, calculatedChecksum);
-        return false;
-    }
-
-    LOG_DEBUG("EEPROM data validated successfully (version: %d)", config.version);
-    return true;
-}
-
-/**
- * @brief 保存亮度索引到EEPROM
- * @param brightnessIndex 亮度索引 (0-3)
- * @return true 保存成功，false 保存失败
- */
-bool saveBrightnessIndex(uint8_t brightnessIndex) {
-    // 验证亮度索引范围
-    if (brightnessIndex > 3) {
-        LOG_WARNING("Invalid brightness index: %d", brightnessIndex);
-        return false;
-    }
-
-    // 先读取当前的字体大小状态，以保持数据一致性
-    bool currentFontSize = loadFontSize();
-
-    // 构建配置结构体
-    EEPROMConfig config;
-    config.version = EEPROM_CONFIG_VERSION;
-    config.brightnessIndex = brightnessIndex;
-    config.fontSize = currentFontSize ? 1 : 0;
-    config.magicNumber = EEPROM_MAGIC_NUMBER;
-    config.checksum = 0;
-
-    // 计算CRC8校验和
-    config.checksum = calculateChecksum(&config);
-
-    // 写入EEPROM
-    EEPROM.write(EEPROM_ADDR_VERSION, config.version);
-    EEPROM.write(EEPROM_ADDR_BRIGHTNESS_INDEX, config.brightnessIndex);
-    EEPROM.write(EEPROM_ADDR_FONT_SIZE, config.fontSize);
-    EEPROM.write(EEPROM_ADDR_MAGIC_NUMBER, config.magicNumber & 0xFF);
-    EEPROM.write(EEPROM_ADDR_MAGIC_NUMBER + 1, (config.magicNumber >> 8) & 0xFF);
-    EEPROM.write(EEPROM_ADDR_CHECKSUM, config.checksum);
-
-    // 提交更改到Flash
-    bool success = EEPROM.commit();
-
-    if (success) {
-        LOG_DEBUG("Brightness index saved to EEPROM: %d (version: %d, CRC8: 0x%02X)",
-                  brightnessIndex, config.version, config.checksum);
-    } else {
-        LOG_WARNING("Failed to save brightness index to EEPROM");
-    }
-
-    return success;
-}
-
-/**
- * @brief 保存字体大小状态到EEPROM
- * @param isLargeFont true为大字体，false为小字体
- * @return true 保存成功，false 保存失败
- */
-bool saveFontSize(bool isLargeFont) {
-    // 先读取当前的亮度索引，以保持数据一致性
-    uint8_t currentBrightness = loadBrightnessIndex();
-
-    // 构建配置结构体
-    EEPROMConfig config;
-    config.version = EEPROM_CONFIG_VERSION;
-    config.brightnessIndex = currentBrightness;
-    config.fontSize = isLargeFont ? 1 : 0;
-    config.magicNumber = EEPROM_MAGIC_NUMBER;
-    config.checksum = 0;
-
-    // 计算CRC8校验和
-    config.checksum = calculateChecksum(&config);
-
-    // 写入EEPROM
-    EEPROM.write(EEPROM_ADDR_VERSION, config.version);
-    EEPROM.write(EEPROM_ADDR_BRIGHTNESS_INDEX, config.brightnessIndex);
-    EEPROM.write(EEPROM_ADDR_FONT_SIZE, config.fontSize);
-    EEPROM.write(EEPROM_ADDR_MAGIC_NUMBER, config.magicNumber & 0xFF);
-    EEPROM.write(EEPROM_ADDR_MAGIC_NUMBER + 1, (config.magicNumber >> 8) & 0xFF);
-    EEPROM.write(EEPROM_ADDR_CHECKSUM, config.checksum);
-
-    // 提交更改到Flash
-    bool success = EEPROM.commit();
-
-    if (success) {
-        LOG_DEBUG("Font size saved to EEPROM: %s (version: %d, CRC8: 0x%02X)",
-                  isLargeFont ? "Large" : "Small", config.version, config.checksum);
-    } else {
-        LOG_WARNING("Failed to save font size to EEPROM");
-    }
-
-    return success;
-}
-
-/**
- * @brief 从EEPROM加载字体大小状态
- * @return true为大字体，false为小字体。如果EEPROM无效则返回默认值true
- */
-bool loadFontSize() {
-    // 验证EEPROM数据有效性
-    if (!validateEEPROM()) {
-        LOG_DEBUG("EEPROM data invalid, using default font size: Large");
-        return true;  // 返回默认大字体
-    }
-
-    // 读取字体大小
-    uint8_t fontSize = EEPROM.read(EEPROM_ADDR_FONT_SIZE);
-
-    LOG_DEBUG("Font size loaded from EEPROM: %s", fontSize ? "Large" : "Small");
-    return (fontSize != 0);
-}
-
-/**
- * @brief 从EEPROM加载亮度索引
- * @return 亮度索引 (0-3)，如果EEPROM无效则返回默认值2
- */
-uint8_t loadBrightnessIndex() {
-    // 验证EEPROM数据有效性
-    if (!validateEEPROM()) {
-        LOG_DEBUG("EEPROM data invalid, using default brightness index: 2");
-        return 2;  // 返回默认亮度索引
-    }
-
-    // 读取版本号
-    uint8_t version = EEPROM.read(EEPROM_ADDR_VERSION);
-
-    // 读取亮度索引
-    uint8_t brightnessIndex = EEPROM.read(EEPROM_ADDR_BRIGHTNESS_INDEX);
-
-    // 版本兼容性处理
-    if (version < EEPROM_CONFIG_VERSION) {
-        LOG_DEBUG("EEPROM version %d is outdated (current: %d), migrating...", version, EEPROM_CONFIG_VERSION);
-        // 重新保存以升级版本号
-        saveBrightnessIndex(brightnessIndex);
-    }
-
-    LOG_DEBUG("Brightness index loaded from EEPROM: %d (version: %d)", brightnessIndex, version);
-    return brightnessIndex;
-}
-
-/**
- * @brief 清除EEPROM中的所有数据
- * @note 将所有字节设置为0xFF
- */
-void clearEEPROM() {
-    for (int i = 0; i < EEPROM_SIZE; i++) {
-        EEPROM.write(i, 0xFF);
-    }
-    EEPROM.commit();
-    LOG_DEBUG("EEPROM cleared");
-}
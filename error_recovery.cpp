@@ -12,6 +12,8 @@
 #include "time_manager.h"
 #include "button_handler.h"
 #include "utils.h"
+#include "breadcrumbs.h"
+#include "config_store.h"
 #include <ESP8266WiFi.h>
 
 // 全局错误恢复配置
@@ -199,6 +201,9 @@ bool attemptRecovery(ErrorCode code, ErrorLevel level) {
 
         case RECOVERY_STRATEGY_RESTART:
             LOG_WARNING("Critical error, restarting system");
+            recordRestartBreadcrumb("critical error");
+            flushConfigStore();
+            flushLogBuffer();
             nonBlockingDelay(1000);  // 给日志时间输出
             ESP.restart();
             break;
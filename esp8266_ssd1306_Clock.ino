@@ -1,8 +1,6 @@
 #include <ESP8266WiFi.h>
 #include <Wire.h>
 #include <U8g2lib.h>
-#include <NTPClient.h>
-#include <WiFiUdp.h>
 #include <time.h>
 #include <WiFiManager.h>
 #include <RTClib.h> // 添加DS1307库的引用
@@ -11,33 +9,188 @@
 #include "production_config.h"
 #include "button_handler.h"
 #include "time_manager.h"
+#include "ntp_engine.h"
 #include "display_manager.h"
 #include "system_manager.h"
 #include "utils.h"
 #include "logger.h"
-#include "eeprom_config.h"
+#include "config_manager.h"
+#include "config_store.h"
 #include "web_ota_manager.h"
 #include "setup_manager.h"
+#include "task_scheduler.h"
+#include "idle_manager.h"
+#include "runtime_monitor.h"
+#include "monitoring_system.h"
+#include "metrics_server.h"
+#include "loop_profiler.h"
+#include "breadcrumbs.h"
+#include "heap_tracer.h"
 #include "version.h"
 
 // 全局对象声明 - 现在统一在global_config.cpp中定义
-extern WiFiUDP ntpUDP;
-extern NTPClient timeClient;
 extern RTC_DS1307 rtc;
 
 // 全局变量定义
 
+// 调度器任务ID（在setup()中注册）
+static int displayTaskId = -1;
+static int ntpPollTaskId = -1;
+
 // 函数声明
 void setup();
 void loop();
+static void registerLoopTasks();
 
 void setup() {
   // 调用系统初始化管理器中的系统初始化函数
   // 将原本冗长的setup()函数拆分为模块化的初始化流程
   systemSetup();
+
+  // 周期性工作交给调度器，loop()只运行到期的任务
+  registerLoopTasks();
 }
 
-void loop() {
+// 辅助：按当前界面绘制一帧
+static void drawCurrentScreen(unsigned long currentMillis) {
+  if (settingState.timeSourceSettingMode) {
+    displayTimeSourceSettingScreen();
+  } else if (settingState.brightnessSettingMode) {
+    displayBrightnessSettingScreen();
+  } else if (settingState.settingMode) {
+    displaySettingScreen();
+  } else if (displayState.statusOverlayUntil != 0) {
+    // 使用溢出安全的时间比较检查是否超时
+    if ((long)(currentMillis - displayState.statusOverlayUntil) >= 0) {
+      displayState.statusOverlayUntil = 0;
+      displayState.showStatus = false;  // 超时后同步重置showStatus，避免下次按键无效
+      displayTime();
+    } else {
+      displayStatusOverlay();
+    }
+  } else {
+    displayTime();
+  }
+}
+
+// 辅助：距下一帧的毫秒数。时间界面按秒边界安排，避免最多1秒的显示滞后；
+// 其他界面按DISPLAY_UPDATE_INTERVAL刷新
+static unsigned long millisToNextFrame(unsigned long currentMillis) {
+  bool timeScreen = !settingState.timeSourceSettingMode && !settingState.brightnessSettingMode &&
+                    !settingState.settingMode && displayState.statusOverlayUntil == 0;
+  if (timeScreen) {
+    long toFrame = (long)(displayState.nextTimeFrameMillis - currentMillis);
+    if (toFrame <= 0) {
+      return 0;
+    }
+    if ((unsigned long)toFrame < DISPLAY_UPDATE_INTERVAL) {
+      return toFrame;
+    }
+  }
+  return DISPLAY_UPDATE_INTERVAL;
+}
+
+// 显示刷新任务：每次运行后按下一帧的时刻改期；强制刷新请求把它提前到立即运行
+static void displayTask() {
+  unsigned long currentMillis = millis();
+  drawCurrentScreen(currentMillis);
+  systemState.lastDisplayUpdate = currentMillis;
+  if (systemState.needsRefresh) {
+    systemState.lastForcedRefresh = currentMillis;
+    systemState.needsRefresh = false; // 确保重置刷新标记
+  }
+  rescheduleTask(displayTaskId, millisToNextFrame(millis()));
+}
+
+// NTP轮询任务：自适应轮询间隔（64秒到约17分钟），每次运行后按最新间隔改期
+static void ntpPollTask() {
+  rescheduleTask(ntpPollTaskId, getNtpPollInterval());
+  // checkNtpConnection只发出请求，应答由updateNtpSync()在后续循环中处理
+  if (timeState.currentTimeSource == TIME_SOURCE_NTP && !timeState.ntpCheckInProgress) {
+    checkNtpConnection(false);
+  }
+}
+
+// 时间源切换跟踪任务：切换到NTP后延迟检查，成功后从此刻起计NTP轮询间隔
+static void timeSourceSwitchTask() {
+  // 首次进入NTP模式时从此刻起计轮询间隔，避免启动后立即重复检查
+  static bool ntpMode = false;
+  bool nowNtp = (timeState.currentTimeSource == TIME_SOURCE_NTP);
+  if (nowNtp && !ntpMode) {
+    rescheduleTask(ntpPollTaskId, getNtpPollInterval());
+  }
+  ntpMode = nowNtp;
+
+  // 检查是否需要立即进行NTP连接检查（例如在切换到NTP时间源后）
+  // 添加时间源切换后延迟检查机制，避免立即检查导致失败
+  if (!nowNtp || !systemState.networkConnected || timeState.lastNtpCheckAttempt != 0 ||
+      timeState.ntpCheckInProgress) {
+    return;
+  }
+  unsigned long currentMillis = millis();
+  unsigned long switchElapsed = (currentMillis >= timeState.lastTimeSourceSwitch) ?
+      (currentMillis - timeState.lastTimeSourceSwitch) :
+      (0xFFFFFFFF - timeState.lastTimeSourceSwitch + currentMillis);
+  if (switchElapsed < TIME_SOURCE_SWITCH_DELAY) { // 等待3秒后再检查
+    LOG_DEBUG("Waiting for time source switch delay: %lums", switchElapsed);
+    return;
+  }
+  // 尝试进行NTP连接检查
+  if (checkNtpConnection(true)) {
+    LOG_DEBUG("Successfully got NTP time after source switch");
+    // 成功获取NTP时间后，强制刷新显示
+    systemState.needsRefresh = true;
+    rescheduleTask(ntpPollTaskId, getNtpPollInterval());
+  } else {
+    LOG_DEBUG("Failed to get NTP time after source switch");
+  }
+}
+
+// 智能时间源优化任务：定期检查并尝试升级到更精确的时间源
+static void timeSourceOptimizeTask() {
+  // 如果当前使用RTC或软件时钟，且网络已连接，尝试切换到NTP
+  if ((timeState.currentTimeSource != TIME_SOURCE_RTC &&
+       timeState.currentTimeSource != TIME_SOURCE_MANUAL) ||
+      !systemState.networkConnected) {
+    return;
+  }
+  unsigned long currentMillis = millis();
+  unsigned long switchElapsed = (currentMillis >= timeState.lastTimeSourceSwitch) ?
+      (currentMillis - timeState.lastTimeSourceSwitch) :
+      (0xFFFFFFFF - timeState.lastTimeSourceSwitch + currentMillis);
+
+  const unsigned long OPTIMIZATION_COOLDOWN = 60000; // 1分钟冷却时间
+
+  if (switchElapsed >= OPTIMIZATION_COOLDOWN) {
+    LOG_DEBUG("Checking for time source optimization opportunity");
+    DateTime ntpTime;
+    if (getCurrentTimeFromNtp(ntpTime)) {
+      LOG_INFO("NTP available, upgrading time source to NTP");
+      switchTimeSource(TIME_SOURCE_NTP);
+    }
+  }
+}
+
+// 注册主循环的周期任务
+static void registerLoopTasks() {
+  displayTaskId = addTask("display", displayTask, 0, 0);
+  ntpPollTaskId = addTask("ntp-poll", ntpPollTask, 0, getNtpPollInterval());
+  addTask("src-switch", timeSourceSwitchTask, TIME_SOURCE_SWITCH_CHECK_INTERVAL, 0);
+  addTask("src-optimize", timeSourceOptimizeTask, TIME_SOURCE_OPTIMIZE_INTERVAL, TIME_SOURCE_OPTIMIZE_INTERVAL);
+  addTask("rtc-sync", checkRtcSync, RTC_SYNC_CHECK_INTERVAL, RTC_SYNC_CHECK_INTERVAL);
+  addTask("network", checkNetworkStatus, NETWORK_CHECK_INTERVAL, NETWORK_CHECK_INTERVAL);
+  addTask("setting-tmo", checkSettingModeTimeout, SETTING_TIMEOUT_CHECK_INTERVAL, SETTING_TIMEOUT_CHECK_INTERVAL);
+  addTask("watchdog", systemWatchdog, MAIN_LOOP_CHECK_INTERVAL, MAIN_LOOP_CHECK_INTERVAL);
+  addTask("monitor", updateRuntimeMonitor, RUNTIME_MONITOR_INTERVAL, RUNTIME_MONITOR_INTERVAL);
+  addTask("health", updateMonitoringSystem, MONITOR_SYSTEM_INTERVAL, MONITOR_SYSTEM_INTERVAL);
+  startConfigWriteBack();
+}
+
+// 辅助：一次主循环的工作（不含空闲和让出CPU）
+static void runLoopWork() {
+  PROFILE_SCOPE("loop");
+  BREADCRUMB_SECTION("loop");
+
   // 更新按键状态
   updateButtonStates();
 
@@ -47,11 +200,9 @@ void loop() {
   // 更新WiFi断开状态（非阻塞）
   updateWifiDisconnect();
 
-  // 执行系统看门狗检查
-  systemWatchdog();
-  
-  unsigned long currentMillis = millis();
-  
+  // 服务Prometheus抓取（每次最多读一段请求或写一块应答）
+  handleMetricsServer();
+
   // 检查Web OTA触发（长按K1键5秒）
   bool k1Pressed = buttonStates.buttons[0].isPressed;
   if (checkWebOtaTrigger(k1Pressed)) {
@@ -61,169 +212,33 @@ void loop() {
   // 更新Web OTA管理器
   updateWebOtaManager();
   
-  // 如果Web OTA服务器正在运行，持续显示OTA模式界面并跳过其他显示更新
+  // 如果Web OTA服务器正在运行，持续显示OTA模式界面并跳过其他任务
   if (webOtaState.status == WEB_OTA_STATUS_ACTIVE) {
     // 重置状态覆盖层，避免OTA期间按键事件导致退出后状态残留
     displayState.showStatus = false;
     displayState.statusOverlayUntil = 0;
     displayOtaMode();
-    // 更新主循环时间戳（用于看门狗监控）
-    systemState.lastMainLoopTime = currentMillis;
-    // 喂狗(重置硬件看门狗)
-    ESP.wdtFeed();
-    // 小延迟以避免CPU过度使用，但保证按键响应
-    yield(); // 让出控制权给WiFi等后台任务
     return; // 跳过后续的显示更新
   }
   
-  // 优先处理强制刷新请求
+  // 优先处理强制刷新请求：显示任务提前到本次循环运行
   if (systemState.needsRefresh) {
-    if (settingState.timeSourceSettingMode) {
-      displayTimeSourceSettingScreen();
-    } else if (settingState.brightnessSettingMode) {
-      displayBrightnessSettingScreen();
-    } else if (settingState.settingMode) {
-      displaySettingScreen();
-    } else if (displayState.statusOverlayUntil != 0) {
-      // 使用溢出安全的时间比较检查是否超时
-      if (currentMillis >= displayState.statusOverlayUntil) {
-        displayState.statusOverlayUntil = 0;
-        displayState.showStatus = false;  // 超时后同步重置showStatus，避免下次按键无效
-        displayTime();
-      } else {
-        displayStatusOverlay();
-      }
-    } else {
-      displayTime();
-    }
-    systemState.lastDisplayUpdate = currentMillis;
-    systemState.lastForcedRefresh = currentMillis;
-    systemState.needsRefresh = false; // 确保重置刷新标记
+    rescheduleTask(displayTaskId, 0);
   }
-  // 按正常时间间隔更新显示（使用溢出安全的时间比较）
-  else {
-    unsigned long displayElapsed = (currentMillis >= systemState.lastDisplayUpdate) ?
-                                   (currentMillis - systemState.lastDisplayUpdate) :
-                                   (0xFFFFFFFF - systemState.lastDisplayUpdate + currentMillis);
-    if (displayElapsed > DISPLAY_UPDATE_INTERVAL) {
-      if (settingState.timeSourceSettingMode) {
-        displayTimeSourceSettingScreen();
-      } else if (settingState.brightnessSettingMode) {
-        displayBrightnessSettingScreen();
-      } else if (settingState.settingMode) {
-        displaySettingScreen();
-      } else if (displayState.statusOverlayUntil != 0) {
-        // 使用溢出安全的时间比较检查是否超时
-        if (currentMillis >= displayState.statusOverlayUntil) {
-          displayState.statusOverlayUntil = 0;
-          displayState.showStatus = false;  // 超时后同步重置showStatus，避免下次按键无效
-          displayTime();
-        } else {
-          displayStatusOverlay();
-        }
-      } else {
-        displayTime();
-      }
 
-      systemState.lastDisplayUpdate = currentMillis;
-    }
-  }
-  
-  // 如果当前使用NTP时间源，更频繁地检查时间更新
-  // 这有助于在RTC故障后更快地获取网络时间
-  static unsigned long lastNtpUpdateTime = 0;
-  static bool ntpUpdateTimeInitialized = false;
-
-  // 首次进入NTP模式时初始化，避免启动后5秒内频繁检查
-  if (timeState.currentTimeSource == TIME_SOURCE_NTP && !ntpUpdateTimeInitialized) {
-    lastNtpUpdateTime = currentMillis;
-    ntpUpdateTimeInitialized = true;
-  } else if (timeState.currentTimeSource != TIME_SOURCE_NTP) {
-    ntpUpdateTimeInitialized = false;
-  }
+  // 运行到期的任务：显示刷新、NTP轮询、RTC同步、网络检查、设置超时、看门狗
+  runDueTasks();
+}
 
-  // 检查是否需要立即进行NTP连接检查（例如在切换到NTP时间源后）
-  // 添加时间源切换后延迟检查机制，避免立即检查导致失败
-  if (timeState.currentTimeSource == TIME_SOURCE_NTP && systemState.networkConnected &&
-      timeState.lastNtpCheckAttempt == 0 && !timeState.ntpCheckInProgress) {
-    // 检查时间源切换后是否等待足够时间
-    unsigned long switchElapsed = (currentMillis >= timeState.lastTimeSourceSwitch) ?
-        (currentMillis - timeState.lastTimeSourceSwitch) :
-        (0xFFFFFFFF - timeState.lastTimeSourceSwitch + currentMillis);
-    
-    if (switchElapsed >= TIME_SOURCE_SWITCH_DELAY) { // 等待3秒后再检查
-      // 尝试进行NTP连接检查
-      if (checkNtpConnection(true)) {
-        LOG_DEBUG("Successfully got NTP time after source switch");
-        // 成功获取NTP时间后，强制刷新显示
-        systemState.needsRefresh = true;
-        lastNtpUpdateTime = currentMillis; // 更新最后更新时间
-      } else {
-        LOG_DEBUG("Failed to get NTP time after source switch");
-      }
-    } else {
-      LOG_DEBUG("Waiting for time source switch delay: %lums", switchElapsed);
-    }
-  }
+void loop() {
+  // 空闲放在循环开头：醒来后立即处理按键和到期的任务
+  bool idled = idleUntilNextDeadline();
 
-  // 如果当前使用NTP时间源且时间已有一段时间未更新，检查NTP更新
-  unsigned long ntpElapsed = (currentMillis >= lastNtpUpdateTime) ?
-      (currentMillis - lastNtpUpdateTime) :
-      (0xFFFFFFFF - lastNtpUpdateTime + currentMillis);
-  if (timeState.currentTimeSource == TIME_SOURCE_NTP &&
-      ntpElapsed > NTP_SYNC_INTERVAL) { // 使用配置的NTP同步间隔(60秒)
-    // 使用非阻塞的checkNtpConnection替代timeClient.update()
-    if (!timeState.ntpCheckInProgress) {  // 确保不在已有NTP检查进行时
-      checkNtpConnection(false);
-    }
-    lastNtpUpdateTime = currentMillis;
-  }
-  
-  // RTC定期同步检查：每30分钟同步一次NTP时间到RTC
-  static unsigned long lastRtcSyncCheck = 0;
-  if (systemState.rtcInitialized && systemState.networkConnected &&
-      timeState.currentTimeSource == TIME_SOURCE_NTP) {
-    unsigned long rtcSyncElapsed = (currentMillis >= lastRtcSyncCheck) ?
-        (currentMillis - lastRtcSyncCheck) :
-        (0xFFFFFFFF - lastRtcSyncCheck + currentMillis);
-    if (rtcSyncElapsed >= RTC_SYNC_INTERVAL) { // 30分钟同步一次
-      syncNtpToRtc(); // 触发RTC同步（非阻塞）
-      lastRtcSyncCheck = currentMillis;
-      LOG_DEBUG("Triggered RTC sync from main loop");
-    }
-  }
-  
-  // 智能时间源优化：定期检查并尝试升级到更精确的时间源
-  static unsigned long lastTimeSourceOptimization = 0;
-  unsigned long optimizationElapsed = (currentMillis >= lastTimeSourceOptimization) ?
-      (currentMillis - lastTimeSourceOptimization) :
-      (0xFFFFFFFF - lastTimeSourceOptimization + currentMillis);
-  
-  // 每5分钟检查一次是否需要优化时间源
-  if (optimizationElapsed >= 300000) { // 5分钟
-    lastTimeSourceOptimization = currentMillis;
-    
-    // 如果当前使用RTC或软件时钟，且网络已连接，尝试切换到NTP
-    if ((timeState.currentTimeSource == TIME_SOURCE_RTC || 
-         timeState.currentTimeSource == TIME_SOURCE_MANUAL) &&
-        systemState.networkConnected) {
-      
-      unsigned long switchElapsed = (currentMillis >= timeState.lastTimeSourceSwitch) ?
-          (currentMillis - timeState.lastTimeSourceSwitch) :
-          (0xFFFFFFFF - timeState.lastTimeSourceSwitch + currentMillis);
-      
-      const unsigned long OPTIMIZATION_COOLDOWN = 60000; // 1分钟冷却时间
-      
-      if (switchElapsed >= OPTIMIZATION_COOLDOWN) {
-        LOG_DEBUG("Checking for time source optimization opportunity");
-        DateTime ntpTime;
-        if (getCurrentTimeFromNtp(ntpTime)) {
-          LOG_INFO("NTP available, upgrading time source to NTP");
-          switchTimeSource(TIME_SOURCE_NTP);
-        }
-      }
-    }
-  }
+  unsigned long currentMillis = millis();
+  beginHeapTraceLoop();
+  runLoopWork();
+  endHeapTraceLoop();
+  recordLoopTime(millis() - currentMillis);
   
   // 更新主循环时间戳（用于看门狗监控）
   systemState.lastMainLoopTime = currentMillis;
@@ -231,31 +246,8 @@ void loop() {
   // 喂狗(重置硬件看门狗)
   ESP.wdtFeed();
   
-  // 小延迟以避免CPU过度使用，但保证按键响应
-  yield(); // 让出控制权给WiFi等后台任务
+  // 本次循环没有空闲时让出控制权给WiFi等后台任务
+  if (!idled) {
+    yield();
+  }
 }
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
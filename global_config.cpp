@@ -11,17 +11,13 @@
 
 #include "global_config.h"
 #include <U8g2lib.h>
-#include <NTPClient.h>
 #include <RTClib.h>
-#include <WiFiUdp.h>
 
 // 测试模式标志
 bool g_testMode = false;
 
 // 全局对象定义
 U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, U8X8_PIN_NONE);
-WiFiUDP ntpUDP;
-NTPClient timeClient(ntpUDP, "pool.ntp.org", 8 * 3600, 60000);
 RTC_DS1307 rtc;
 
 // 按钮状态定义
@@ -55,7 +51,8 @@ DisplayState displayState = {
     true,   // largeFont
     2,      // brightnessIndex
     false,  // showStatus
-    ""      // timeSourceStatus
+    "",     // timeSourceStatus
+    0       // nextTimeFrameMillis
 };
 
 // 设置状态定义
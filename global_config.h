@@ -14,9 +14,7 @@
 
 #include <Arduino.h>
 #include <U8g2lib.h>
-#include <NTPClient.h>
 #include <RTClib.h>
-#include <WiFiUdp.h>
 #include "config.h"
 
 // AES加密相关常量
@@ -29,8 +27,6 @@ extern bool g_testMode;
 
 // 全局对象声明
 extern U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2;
-extern WiFiUDP ntpUDP;
-extern NTPClient timeClient;
 extern RTC_DS1307 rtc;
 
 // 时间源枚举
@@ -92,6 +88,7 @@ struct DisplayState {
     int brightnessIndex;
     bool showStatus;
     char timeSourceStatus[40];
+    unsigned long nextTimeFrameMillis;  // 时间界面下一帧的计划时刻（紧靠下一个秒边界）
 };
 
 extern DisplayState displayState;
@@ -0,0 +1,178 @@
+/**
+ * @file glyph_cache.cpp
+ * @brief 时间数字字形缓存模块实现
+ *
+ * 字形位图按"渲染时的基线位置"截取，纵向相位与最终绘制位置一致，
+ * 因此绘制时只需整字节按列OR进帧缓冲，无需任何移位
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#define LOG_MODULE DISPLAY
+
+#include "glyph_cache.h"
+#include "global_config.h"
+#include "logger.h"
+#include <string.h>
+
+// 缓存的字符集，顺序即缓存索引
+static const char GLYPH_CHARS[GLYPH_CACHE_COUNT + 1] = "0123456789:";
+
+// 字形缓存
+struct GlyphCache {
+  const uint8_t* font;                 // 生成缓存时使用的字体
+  int16_t baselineY;                   // 生成缓存时使用的基线
+  bool valid;                          // 缓存是否可用
+  uint8_t firstPage;                   // 字形占用的起始页
+  uint8_t pageCount;                   // 字形占用的页数
+  uint8_t width[GLYPH_CACHE_COUNT];    // 每个字形截取的列数
+  uint8_t advance[GLYPH_CACHE_COUNT];  // 每个字形的步进宽度
+  uint8_t bitmap[GLYPH_CACHE_COUNT][GLYPH_CACHE_MAX_PAGES][GLYPH_CACHE_MAX_WIDTH];
+};
+
+static GlyphCache glyphCache = {
+  nullptr,  // font
+  0,        // baselineY
+  false,    // valid
+  0,        // firstPage
+  0,        // pageCount
+  {0},      // width
+  {0},      // advance
+  {{{0}}}   // bitmap
+};
+
+// 辅助：字符到缓存索引，不在缓存字符集内返回-1
+static int8_t glyphIndex(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c == ':') return 10;
+  return -1;
+}
+
+// 辅助：在清空的帧缓冲左上角渲染单个字形
+static void renderGlyph(char c, int16_t baselineY) {
+  u8g2.clearBuffer();
+  u8g2.drawGlyph(0, baselineY, (uint16_t)c);
+}
+
+/**
+ * @brief 解码指定字体的11个时间字形并缓存为页对齐位图
+ *
+ * 会借用并清空帧缓冲，调用方需在之后重绘整帧
+ *
+ * @param font U8g2字体
+ * @param baselineY 时间行的绘制基线
+ * @return true 缓存生成成功，false 字形超出缓存容量（调用方应回退到drawUTF8）
+ */
+bool buildGlyphCache(const uint8_t* font, int16_t baselineY) {
+  glyphCache.valid = false;
+  glyphCache.font = font;
+  glyphCache.baselineY = baselineY;
+
+  uint8_t* frame = u8g2.getBufferPtr();
+  uint8_t tileWidth = u8g2.getBufferTileWidth();
+  uint8_t tileHeight = u8g2.getBufferTileHeight();
+  uint16_t pageStride = (uint16_t)tileWidth * 8;
+
+  u8g2.setFont(font);
+  char probe[3] = {0, '0', '\0'};
+  int16_t zeroWidth = u8g2.getUTF8Width("0");
+
+  // 第一遍：确定步进宽度、截取宽度以及所有字形共同占用的页范围
+  uint8_t minPage = 0xFF;
+  uint8_t maxPage = 0;
+  for (uint8_t i = 0; i < GLYPH_CACHE_COUNT; i++) {
+    char c = GLYPH_CHARS[i];
+    probe[0] = c;
+    int16_t advance = u8g2.getUTF8Width(probe) - zeroWidth;  // drawUTF8中相邻字形的间距
+    probe[1] = '\0';
+    int16_t inkWidth = u8g2.getUTF8Width(probe);             // 字形墨迹的右边界
+    probe[1] = '0';
+
+    int16_t width = (inkWidth > advance) ? inkWidth : advance;
+    if (advance <= 0 || width > GLYPH_CACHE_MAX_WIDTH) {
+      LOG_WARNING("Glyph '%c' too wide for cache: %d", c, width);
+      return false;
+    }
+    glyphCache.advance[i] = (uint8_t)advance;
+    glyphCache.width[i] = (uint8_t)width;
+
+    renderGlyph(c, baselineY);
+    for (uint8_t page = 0; page < tileHeight; page++) {
+      const uint8_t* row = frame + page * pageStride;
+      for (uint8_t col = 0; col < width; col++) {
+        if (row[col] != 0) {
+          if (page < minPage) minPage = page;
+          if (page > maxPage) maxPage = page;
+          break;
+        }
+      }
+    }
+  }
+
+  if (minPage == 0xFF || (maxPage - minPage + 1) > GLYPH_CACHE_MAX_PAGES) {
+    LOG_WARNING("Glyph cache page range invalid");
+    u8g2.clearBuffer();
+    return false;
+  }
+  glyphCache.firstPage = minPage;
+  glyphCache.pageCount = maxPage - minPage + 1;
+
+  // 第二遍：截取位图
+  for (uint8_t i = 0; i < GLYPH_CACHE_COUNT; i++) {
+    renderGlyph(GLYPH_CHARS[i], baselineY);
+    for (uint8_t p = 0; p < glyphCache.pageCount; p++) {
+      memcpy(glyphCache.bitmap[i][p], frame + (glyphCache.firstPage + p) * pageStride, glyphCache.width[i]);
+    }
+  }
+
+  u8g2.clearBuffer();
+  glyphCache.valid = true;
+  LOG_DEBUG("Glyph cache built: pages %d-%d", glyphCache.firstPage, maxPage);
+  return true;
+}
+
+/**
+ * @brief 检查缓存是否对应指定字体和基线
+ */
+bool isGlyphCacheValid(const uint8_t* font, int16_t baselineY) {
+  return glyphCache.valid && glyphCache.font == font && glyphCache.baselineY == baselineY;
+}
+
+/**
+ * @brief 使缓存失效
+ */
+void invalidateGlyphCache() {
+  glyphCache.valid = false;
+}
+
+/**
+ * @brief 用缓存位图在基线位置绘制字符串（效果等同于drawUTF8）
+ * @param x 起始X坐标
+ * @param str 仅包含 0-9 和 ':' 的字符串
+ * @return 绘制结束后的X坐标；缓存无效或含有未缓存字符时返回-1且不绘制
+ */
+int16_t drawCachedGlyphString(int16_t x, const char* str) {
+  if (!glyphCache.valid || str == nullptr) return -1;
+  for (const char* p = str; *p; p++) {
+    if (glyphIndex(*p) < 0) return -1;
+  }
+
+  uint8_t* frame = u8g2.getBufferPtr();
+  uint8_t tileWidth = u8g2.getBufferTileWidth();
+  int16_t screenWidth = (int16_t)tileWidth * 8;
+
+  for (const char* p = str; *p; p++) {
+    uint8_t i = (uint8_t)glyphIndex(*p);
+    for (uint8_t col = 0; col < glyphCache.width[i]; col++) {
+      int16_t dx = x + col;
+      if (dx < 0 || dx >= screenWidth) continue;
+      for (uint8_t page = 0; page < glyphCache.pageCount; page++) {
+        frame[(glyphCache.firstPage + page) * screenWidth + dx] |= glyphCache.bitmap[i][page][col];
+      }
+    }
+    x += glyphCache.advance[i];
+  }
+  return x;
+}
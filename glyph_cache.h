@@ -0,0 +1,30 @@
+/**
+ * @file glyph_cache.h
+ * @brief 时间数字字形缓存模块
+ *
+ * 时间行只会出现 0-9 和 ':' 共11个字符。启动时（或切换字号时）把这些
+ * 字形用U8g2解码一次，按页(8像素tile行)对齐保存为原始位图；之后每帧
+ * 直接把位图按列拷贝进帧缓冲，免去drawUTF8逐帧解压字形的开销
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <Arduino.h>
+
+// 缓存容量
+#define GLYPH_CACHE_COUNT 11         // '0'-'9' 和 ':'
+#define GLYPH_CACHE_MAX_WIDTH 24     // 单个字形最大列数
+#define GLYPH_CACHE_MAX_PAGES 5      // 单个字形最多跨越的页数（26像素高且未对齐时为5）
+
+// 函数声明
+bool buildGlyphCache(const uint8_t* font, int16_t baselineY);
+bool isGlyphCacheValid(const uint8_t* font, int16_t baselineY);
+void invalidateGlyphCache();
+int16_t drawCachedGlyphString(int16_t x, const char* str);
+
+#endif // GLYPH_CACHE_H
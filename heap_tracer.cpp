@@ -0,0 +1,302 @@
+/**
+ * @file heap_tracer.cpp
+ * @brief 堆分配跟踪实现
+ *
+ * 稳态检查和统计接口总是编译；包装函数和调用点表只在ENABLE_HEAP_TRACER时编译。
+ * 包装函数只更新静态计数和调用点表（线性查找，最多HEAP_TRACE_MAX_SITES项），
+ * 不输出日志也不再分配内存；稳态循环中出现的新调用点在endHeapTraceLoop()中报告。
+ * Arduino的String和operator new最终都经malloc/realloc，同样被统计
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#include "heap_tracer.h"
+#include "config.h"
+#include "logger.h"
+#include "breadcrumbs.h"
+#include <stdlib.h>
+#include <string.h>
+
+static HeapTraceStats stats;
+
+static struct {
+  bool started;               // 已进入过主循环
+  bool steady;                // 预热结束，主循环处于稳态
+  bool inLoop;                // 正在执行loop()
+  uint8_t pauseDepth;         // pauseHeapTrace()嵌套层数，非0时不统计
+  unsigned long firstLoopMillis;
+  uint32_t loopAllocationsAtBegin;
+  uint32_t freeHeapAtBegin;   // 循环开始时的空闲堆
+  uint32_t maxBlockAtBegin;   // 循环开始时的最大可分配块
+} trace = {false, false, false, 0, 0, 0, 0, 0};
+
+#if ENABLE_HEAP_TRACER
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+}
+
+static HeapAllocSite sites[HEAP_TRACE_MAX_SITES];
+static uint8_t siteCount = 0;
+
+// 上层分配函数（operator new等）提供的调用者，由下一次包装函数调用取走
+static const void* pendingCaller = NULL;
+
+// 辅助：本次分配的调用点，有上层提供的调用者时用它代替包装函数的返回地址
+static const void* takeCaller(const void* returnAddress) {
+  const void* caller = pendingCaller ? pendingCaller : returnAddress;
+  pendingCaller = NULL;
+  return caller;
+}
+
+// 辅助：记录一次分配（在包装函数中调用，不得分配内存或输出日志）
+static void noteAllocation(const void* caller, size_t size) {
+  if (trace.pauseDepth > 0) {
+    return;
+  }
+  bool inLoop = trace.steady && trace.inLoop;
+  stats.allocations++;
+  stats.bytesAllocated += size;
+  if (inLoop) {
+    stats.loopAllocations++;
+  }
+
+  uintptr_t address = (uintptr_t)caller;
+  uint8_t section = getActiveBreadcrumbSection();
+  HeapAllocSite* site = NULL;
+  for (uint8_t i = 0; i < siteCount; i++) {
+    if (sites[i].caller == address && sites[i].section == section) {
+      site = &sites[i];
+      break;
+    }
+  }
+  if (site == NULL) {
+    if (siteCount >= HEAP_TRACE_MAX_SITES) {
+      stats.untracked++;
+      return;
+    }
+    site = &sites[siteCount++];
+    site->caller = address;
+    site->section = section;
+  }
+  site->count++;
+  site->bytes += size;
+  if (inLoop) {
+    site->loopCount++;
+  }
+}
+
+extern "C" {
+
+void* __wrap_malloc(size_t size) {
+  const void* caller = takeCaller(__builtin_return_address(0));
+  void* ptr = __real_malloc(size);
+  if (ptr != NULL) {
+    noteAllocation(caller, size);
+  }
+  return ptr;
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+  const void* caller = takeCaller(__builtin_return_address(0));
+  void* ptr = __real_calloc(count, size);
+  if (ptr != NULL) {
+    noteAllocation(caller, count * size);
+  }
+  return ptr;
+}
+
+// 原地扩展和搬移都计为一次分配：二者都会在堆上找空闲块
+void* __wrap_realloc(void* ptr, size_t size) {
+  const void* caller = takeCaller(__builtin_return_address(0));
+  void* result = __real_realloc(ptr, size);
+  if (result != NULL && size > 0) {
+    noteAllocation(caller, size);
+  } else if (size == 0 && ptr != NULL && trace.pauseDepth == 0) {
+    stats.frees++;
+  }
+  return result;
+}
+
+void __wrap_free(void* ptr) {
+  if (ptr != NULL && trace.pauseDepth == 0) {
+    stats.frees++;
+  }
+  __real_free(ptr);
+}
+
+} // extern "C"
+
+// 辅助：分段编号+1转为名称
+static const char* siteSectionName(const HeapAllocSite& site) {
+  if (site.section == 0) {
+    return "-";
+  }
+  const char* name = getBreadcrumbSectionName(site.section - 1);
+  return name ? name : "?";
+}
+
+// 辅助：报告稳态循环中第一次分配的调用点
+static void reportLoopAllocationSites() {
+  for (uint8_t i = 0; i < siteCount; i++) {
+    HeapAllocSite& site = sites[i];
+    if (site.loopCount > 0 && !site.reported) {
+      site.reported = true;
+      LOG_WARNING("Heap allocation in steady loop: %u bytes at 0x%08lx in %s", site.bytes / site.count,
+                  (unsigned long)site.caller, siteSectionName(site));
+    }
+  }
+}
+
+/**
+ * @brief 指定下一次分配的调用点（由经malloc实现的上层分配函数调用）
+ * @param caller 上层分配函数的调用者，通常为其__builtin_return_address(0)
+ *
+ * 否则经operator new和String的分配都归到上层分配函数内部的同一个调用点
+ */
+void noteHeapAllocCaller(const void* caller) {
+  pendingCaller = caller;
+}
+
+uint8_t getHeapAllocSiteCount() {
+  return siteCount;
+}
+
+/**
+ * @brief 调用点统计（按首次出现的顺序）
+ * @return 统计，超出范围时返回NULL
+ */
+const HeapAllocSite* getHeapAllocSite(uint8_t index) {
+  return index < siteCount ? &sites[index] : NULL;
+}
+
+/**
+ * @brief 暂停统计，可嵌套；与resumeHeapTrace()成对使用
+ *
+ * 供不属于固件代码的分配使用：固件中lwIP的pbuf不经malloc，
+ * 主机替身模拟网络栈时的分配也应排除在外
+ */
+void pauseHeapTrace() {
+  trace.pauseDepth++;
+}
+
+void resumeHeapTrace() {
+  if (trace.pauseDepth > 0) {
+    trace.pauseDepth--;
+  }
+}
+
+#endif // ENABLE_HEAP_TRACER
+
+// 辅助：比较循环开始和结束时的堆状态，空闲堆或最大可分配块变小即计数
+static void checkHeapShrink() {
+  uint32_t freeHeap;
+  uint32_t maxBlock;
+  uint8_t fragmentation;
+  ESP.getHeapStats(&freeHeap, &maxBlock, &fragmentation);
+  if (freeHeap >= trace.freeHeapAtBegin && maxBlock >= trace.maxBlockAtBegin) {
+    return;
+  }
+  stats.heapShrinkLoops++;
+  uint32_t shrink = (freeHeap < trace.freeHeapAtBegin) ? trace.freeHeapAtBegin - freeHeap : 0;
+  // 第一次和缩小量创新高时报告
+  if (stats.heapShrinkLoops == 1 || shrink > stats.maxHeapShrink) {
+    if (shrink > stats.maxHeapShrink) {
+      stats.maxHeapShrink = shrink;
+    }
+    LOG_WARNING("Heap shrank in steady loop: free %u -> %u, max block %u -> %u", trace.freeHeapAtBegin, freeHeap,
+                trace.maxBlockAtBegin, maxBlock);
+  }
+}
+
+/**
+ * @brief 主循环开始（loop()开头调用），预热结束后进入稳态
+ */
+void beginHeapTraceLoop() {
+  if (!trace.started) {
+    trace.started = true;
+    trace.firstLoopMillis = millis();
+  }
+  if (!trace.steady && millis() - trace.firstLoopMillis >= HEAP_TRACE_WARMUP) {
+    setHeapTraceSteadyState(true);
+  }
+  trace.inLoop = true;
+  trace.loopAllocationsAtBegin = stats.loopAllocations;
+  if (trace.steady) {
+    uint8_t fragmentation;
+    ESP.getHeapStats(&trace.freeHeapAtBegin, &trace.maxBlockAtBegin, &fragmentation);
+  }
+}
+
+/**
+ * @brief 主循环结束（loop()末尾调用），检查空闲堆并报告稳态循环中新出现的分配调用点
+ */
+void endHeapTraceLoop() {
+  trace.inLoop = false;
+  if (!trace.steady) {
+    return;
+  }
+  stats.steadyLoops++;
+  checkHeapShrink();
+#if ENABLE_HEAP_TRACER
+  if (stats.loopAllocations == trace.loopAllocationsAtBegin) {
+    return;
+  }
+  stats.loopsWithAllocations++;
+  reportLoopAllocationSites();
+#endif
+}
+
+/**
+ * @brief 手动进入或退出稳态（测试用；正常由预热时间决定）
+ */
+void setHeapTraceSteadyState(bool steady) {
+  if (steady && !trace.steady) {
+    LOG_DEBUG("Heap trace: steady state after %lu allocations", (unsigned long)stats.allocations);
+  }
+  trace.steady = steady;
+  trace.started = true;
+}
+
+bool isHeapTraceSteadyState() {
+  return trace.steady;
+}
+
+const HeapTraceStats& getHeapTraceStats() {
+  return stats;
+}
+
+/**
+ * @brief 清零统计和调用点表（稳态标志保留）
+ */
+void resetHeapTrace() {
+#if ENABLE_HEAP_TRACER
+  memset(sites, 0, sizeof(sites));
+  siteCount = 0;
+#endif
+  memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * @brief 输出分配统计到串口
+ */
+void printHeapTraceReport() {
+  LOG_INFO("  Steady loop: heap shrank in %u of %u loops (max %u bytes)", stats.heapShrinkLoops, stats.steadyLoops,
+           stats.maxHeapShrink);
+#if ENABLE_HEAP_TRACER
+  LOG_INFO("  Heap: %u allocs (%u bytes), %u frees, %u untracked", stats.allocations, stats.bytesAllocated,
+           stats.frees, stats.untracked);
+  LOG_INFO("  Steady loop: %u allocs in %u of %u loops", stats.loopAllocations, stats.loopsWithAllocations,
+           stats.steadyLoops);
+  for (uint8_t i = 0; i < siteCount; i++) {
+    const HeapAllocSite& site = sites[i];
+    LOG_INFO("  0x%08lx %-16s %6u allocs %8u bytes %6u in loop", (unsigned long)site.caller, siteSectionName(site),
+             site.count, site.bytes, site.loopCount);
+  }
+#endif
+}
@@ -0,0 +1,83 @@
+/**
+ * @file heap_tracer.h
+ * @brief 堆分配跟踪
+ *
+ * 稳态检查（固件和主机构建都启用）：启动预热结束后主循环进入稳态，每次稳态循环
+ * 比较开始和结束时ESP.getHeapStats()的空闲堆和最大可分配块，任一变小即计数，
+ * 出现更大的缩小量时输出警告。循环中分配后又释放的内存看不到，
+ * 循环中yield()时WiFi SDK和lwIP的分配也会计入，只作粗略的常驻检查。
+ *
+ * 调用点跟踪（只在主机构建中启用）：链接时用--wrap把malloc/calloc/realloc/free
+ * 换成本模块的包装函数，按调用点（分配函数的返回地址 + 当时最内层的
+ * BREADCRUMB_SECTION分段）统计分配次数和字节数；operator new等上层分配函数
+ * 用noteHeapAllocCaller()把自己的调用者作为调用点。稳态循环中的分配单独计数，
+ * 每个调用点第一次在稳态循环中分配时于循环结束后输出警告。
+ * CMakeLists.txt定义ENABLE_HEAP_TRACER=1并加上--wrap链接选项；固件不启用：
+ * boards.local.txt启用了LTO，--wrap对LTO目标文件中的符号不可靠
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HEAP_TRACER_H
+#define HEAP_TRACER_H
+
+#include <Arduino.h>
+
+#ifndef ENABLE_HEAP_TRACER
+#define ENABLE_HEAP_TRACER 0
+#endif
+
+// 最多可区分的调用点数
+const uint8_t HEAP_TRACE_MAX_SITES = 16;
+
+// 一个分配调用点的统计
+struct HeapAllocSite {
+  uintptr_t caller;      // 分配函数的返回地址（固件可用addr2line对照.elf）
+  uint8_t section;       // 分配时最内层的分段编号+1，0表示不在分段中
+  bool reported;         // 已报告过稳态循环中的分配
+  uint32_t count;        // 分配次数
+  uint32_t bytes;        // 累计申请的字节数
+  uint32_t loopCount;    // 其中在稳态主循环中的次数
+};
+
+struct HeapTraceStats {
+  uint32_t allocations;          // 成功的malloc/calloc/realloc次数
+  uint32_t frees;                // free次数（不含free(NULL)）
+  uint32_t bytesAllocated;       // 累计申请的字节数
+  uint32_t untracked;            // 调用点表已满、未能归类的分配次数
+  uint32_t loopAllocations;      // 稳态主循环中的分配次数
+  uint32_t loopsWithAllocations; // 有分配的稳态循环次数
+  uint32_t steadyLoops;          // 稳态循环次数
+  uint32_t heapShrinkLoops;      // 结束时空闲堆或最大可分配块比开始时小的稳态循环次数
+  uint32_t maxHeapShrink;        // 单次稳态循环中空闲堆减少的最大字节数
+};
+
+void beginHeapTraceLoop();
+void endHeapTraceLoop();
+void setHeapTraceSteadyState(bool steady);
+bool isHeapTraceSteadyState();
+const HeapTraceStats& getHeapTraceStats();
+void resetHeapTrace();
+void printHeapTraceReport();
+
+#if ENABLE_HEAP_TRACER
+
+void noteHeapAllocCaller(const void* caller);
+uint8_t getHeapAllocSiteCount();
+const HeapAllocSite* getHeapAllocSite(uint8_t index);
+void pauseHeapTrace();
+void resumeHeapTrace();
+
+#else
+
+inline void noteHeapAllocCaller(const void*) {}
+inline uint8_t getHeapAllocSiteCount() { return 0; }
+inline const HeapAllocSite* getHeapAllocSite(uint8_t) { return nullptr; }
+inline void pauseHeapTrace() {}
+inline void resumeHeapTrace() {}
+
+#endif // ENABLE_HEAP_TRACER
+
+#endif // HEAP_TRACER_H
@@ -0,0 +1,30 @@
+/**
+ * @file host_benchmarks.cpp
+ * @brief 主机端基准测试运行器（使用真实单调时钟计时）
+ *
+ * 主机上的绝对耗时与ESP8266不可比，只用于比较优化前后的相对差异
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#define LOG_MODULE TEST
+
+#include <Arduino.h>
+#include "host_hardware.h"
+#include "benchmark_suites.h"
+#include "logger.h"
+
+int main() {
+    Serial.begin(115200);
+    hostSetVirtualTime(false);
+
+    setLogLevel(LOG_LEVEL_INFO);
+    enableLogger(true);
+    initLogger();
+
+    runAllBenchmarks();
+    Serial.flush();
+    return 0;
+}
@@ -0,0 +1,1498 @@
+/**
+ * @file host_tests.cpp
+ * @brief 主机端测试运行器
+ *
+ * 与test_main.ino相同的初始化顺序运行全部单元测试套件，再运行只能在主机上检查的套件：
+ * - HostDisplay：增量刷新与字形缓存（模拟面板显存）
+ * - HostNtp：NTP引擎、秒相位与时钟频率修正（模拟NTP服务器、DS1307及其NVRAM）
+ * - HostButtons：按键中断捕获、空闲唤醒与按键延迟（模拟GPIO中断）
+ * - HostScheduler、HostProfiler、HostLogger、HostMonitoring：任务调度、分段性能分析、
+ *   延迟日志与监控历史（虚拟时钟；HostProfiler只在启用ENABLE_LOOP_PROFILER时运行）
+ * - HostBreadcrumbs：跨重启诊断记录（模拟RTC用户内存和DS1307 NVRAM）
+ * - HostMetrics：/metrics指标服务（模拟TCP连接）
+ * - HostHeap：堆分配跟踪（链接时的malloc包装）
+ * - HostConfigStore：日志式配置存储、延迟写回与配置版本迁移（模拟闪存和EEPROM）
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#define LOG_MODULE TEST
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <ESP8266WiFi.h>
+#include "host_hardware.h"
+#include "test_framework.h"
+#include "test_suites.h"
+#include "logger.h"
+#include "global_config.h"
+#include "button_handler.h"
+#include "time_manager.h"
+#include "display_manager.h"
+#include "display_flush.h"
+#include "i2c_manager.h"
+#include "glyph_cache.h"
+#include "ntp_engine.h"
+#include "clock_discipline.h"
+#include "config_manager.h"
+#include "runtime_monitor.h"
+#include "error_recovery.h"
+#include "task_scheduler.h"
+#include "idle_manager.h"
+#include "loop_profiler.h"
+#include "breadcrumbs.h"
+#include "system_manager.h"
+#include "monitoring_system.h"
+#include "metrics_server.h"
+#include "heap_tracer.h"
+#include "config_store.h"
+#include <EEPROM.h>
+#include <flash_hal.h>
+#include <math.h>
+#include <string>
+
+// 面板显存与帧缓冲一致
+static bool panelMatchesBuffer() {
+    return memcmp(u8g2.hostPanel(), u8g2.getBufferPtr(), DISPLAY_FRAME_BYTES) == 0;
+}
+
+/**
+ * @brief 显示输出测试（依赖模拟面板，只在主机端运行）
+ */
+static void runTestSuite_hostDisplay() {
+    TEST_SUITE_START(HostDisplay);
+
+    TEST_CASE(test_flush_keeps_panel_in_sync) {
+        invalidateDisplayShadow();
+        u8g2.clearBuffer();
+        u8g2.drawFrame(0, 0, 128, 64);
+        flushDisplay();
+        ASSERT_TRUE(panelMatchesBuffer());
+
+        // 只改动一个图块，面板仍然一致且传输量远小于整帧
+        u8g2.hostResetStats();
+        u8g2.drawPixel(40, 20);
+        uint16_t sent = flushDisplay();
+        ASSERT_TRUE(panelMatchesBuffer());
+        ASSERT_EQ(8, sent);
+        ASSERT_EQ(8, (int)u8g2.hostBytesSent());
+
+        // 内容不变时不传输
+        ASSERT_EQ(0, flushDisplay());
+        ASSERT_EQ(8, (int)u8g2.hostBytesSent());
+    } TEST_CASE_END();
+
+    TEST_CASE(test_flush_heals_lost_panel_write) {
+        invalidateDisplayShadow();
+        u8g2.clearBuffer();
+        u8g2.drawFrame(0, 0, 128, 64);
+        flushDisplay();
+
+        // 一次增量写入丢失：影子帧已更新，内容不变时不会再发送
+        hostDropDisplayTransfers(1);
+        u8g2.drawPixel(40, 20);
+        ASSERT_EQ(8, flushDisplay());
+        ASSERT_FALSE(panelMatchesBuffer());
+        ASSERT_EQ(0, flushDisplay());
+        ASSERT_FALSE(panelMatchesBuffer());
+
+        // I2C总线恢复后整帧发送
+        ASSERT_TRUE(resetI2CBus());
+        ASSERT_EQ(DISPLAY_FRAME_BYTES, flushDisplay());
+        ASSERT_TRUE(panelMatchesBuffer());
+
+        // 没有恢复过程时，定期整帧刷新也能修复
+        hostDropDisplayTransfers(1);
+        u8g2.drawPixel(90, 50);
+        flushDisplay();
+        ASSERT_FALSE(panelMatchesBuffer());
+        hostAdvanceMillis(DISPLAY_FULL_REFRESH_INTERVAL / 2);
+        ASSERT_EQ(0, flushDisplay());
+        ASSERT_FALSE(panelMatchesBuffer());
+        hostAdvanceMillis(DISPLAY_FULL_REFRESH_INTERVAL / 2);
+        ASSERT_EQ(DISPLAY_FRAME_BYTES, flushDisplay());
+        ASSERT_TRUE(panelMatchesBuffer());
+    } TEST_CASE_END();
+
+    TEST_CASE(test_flush_saving_survives_32bit_wrap) {
+        // 每秒一帧运行约48天后，整帧对照字节数超过32位
+        DisplayFlushStats saved = displayFlushStats;
+        displayFlushStats.fullFrameBytes = 0xFFFFFC00ULL;
+        displayFlushStats.totalBytesSent = 0xFFFFFC00ULL / 10;
+        invalidateDisplayShadow();
+        u8g2.clearBuffer();
+        flushDisplay();  // 整帧
+        for (int i = 0; i < 8; i++) {
+            u8g2.drawPixel(i * 16, 0);
+            flushDisplay();  // 各8字节
+        }
+        ASSERT_TRUE(displayFlushStats.fullFrameBytes > 0xFFFFFFFFULL);
+        ASSERT_EQ(89, (int)getDisplayFlushSavingPercent());
+        displayFlushStats = saved;
+    } TEST_CASE_END();
+
+    TEST_CASE(test_glyph_cache_matches_drawUTF8) {
+        const char* timeStr = "12:34:56";
+        u8g2.setFont(u8g2_font_logisoso26_tr);
+        ASSERT_TRUE(buildGlyphCache(u8g2_font_logisoso26_tr, 48));
+
+        static uint8_t expected[DISPLAY_FRAME_BYTES];
+        u8g2.clearBuffer();
+        u8g2.drawUTF8(3, 48, timeStr);
+        memcpy(expected, u8g2.getBufferPtr(), DISPLAY_FRAME_BYTES);
+
+        u8g2.clearBuffer();
+        int16_t end = drawCachedGlyphString(3, timeStr);
+        ASSERT_EQ(3 + u8g2.getUTF8Width("12:34:56") + 1, end);
+        ASSERT_TRUE(memcmp(expected, u8g2.getBufferPtr(), DISPLAY_FRAME_BYTES) == 0);
+        invalidateGlyphCache();
+    } TEST_CASE_END();
+
+    TEST_SUITE_END();
+}
+
+// 让所有NTP服务器以相同的偏差应答或回应同一个KoD代码（code为nullptr取消）
+static void setAllNtpServers(int32_t offsetMs, const char* code) {
+    for (int i = 0; i < NTP_SERVER_COUNT; i++) {
+        hostSetNtpServer(NTP_SERVERS[i], true, 40, offsetMs);
+        hostSetNtpKissCode(NTP_SERVERS[i], code);
+    }
+}
+
+// 驱动NTP引擎直到查询结束，检查每次调用都不消耗虚拟时间
+static NtpResult runNtpQuery(bool& neverBlocked) {
+    neverBlocked = true;
+    if (!startNtpQuery()) return NTP_RESULT_FAILED;
+    for (int i = 0; i < 60000; i++) {
+        unsigned long before = millis();
+        NtpResult result = updateNtpEngine();
+        if (millis() != before) neverBlocked = false;
+        if (result != NTP_RESULT_NONE) return result;
+        hostAdvanceMillis(1);
+    }
+    return NTP_RESULT_NONE;
+}
+
+/**
+ * @brief NTP引擎与秒相位测试（依赖模拟NTP服务器和DS1307，只在主机端运行）
+ */
+static void runTestSuite_hostNtp() {
+    TEST_SUITE_START(HostNtp);
+
+    TEST_CASE(test_ntp_burst_picks_lowest_delay_sample) {
+        hostSetTrueUnixTime(1800000000UL);
+        hostSetNtpServer(nullptr, true, 20, 0);
+        hostSetNtpJitter(nullptr, 400);
+        restartNtpEngine();
+
+        // 去程随机排队0~400ms，单个样本的偏差误差可达200ms
+        uint32_t sentBefore = ntpEngineStats.requestsSent;
+        bool neverBlocked = false;
+        ASSERT_EQ(NTP_RESULT_OK, runNtpQuery(neverBlocked));
+        ASSERT_TRUE(neverBlocked);
+        ASSERT_FALSE(isNtpQueryInProgress());
+        ASSERT_EQ(NTP_BURST_SAMPLES, (int)(ntpEngineStats.requestsSent - sentBefore));
+
+        // 所选样本的偏差误差不超过其时延的一半
+        int64_t errorMs = (int64_t)getNtpEpochMillis() - (int64_t)(hostGetTrueUnixMicros() / 1000);
+        ASSERT_TRUE(llabs(errorMs) <= ntpEngineStats.lastRttMs / 2 + 1);
+        hostSetNtpJitter(nullptr, 0);
+    } TEST_CASE_END();
+
+    TEST_CASE(test_ntp_servers_ranked_by_delay) {
+        hostSetNtpServer("pool.ntp.org", true, 150, 0);
+        hostSetNtpServer("cn.pool.ntp.org", true, 200, 0);
+        hostSetNtpServer("ntp.aliyun.com", true, 30, 0);
+        hostSetNtpServer("time.windows.com", true, 100, 0);
+
+        // 每个服务器都测量过之后，查询固定在时延最小的服务器上
+        bool neverBlocked = false;
+        for (int i = 0; i < 8; i++) {
+            ASSERT_EQ(NTP_RESULT_OK, runNtpQuery(neverBlocked));
+        }
+        ASSERT_EQ(2, timeState.currentNtpServerIndex);
+        ASSERT_TRUE(getNtpServerScore(2) < getNtpServerScore(3));
+        ASSERT_TRUE(getNtpServerScore(3) < getNtpServerScore(1));
+
+        // 最好的服务器失联后切换到次好的服务器，而不是按顺序轮换
+        hostSetNtpServer("ntp.aliyun.com", false, 30, 0);
+        ASSERT_EQ(NTP_RESULT_OK, runNtpQuery(neverBlocked));
+        ASSERT_TRUE(neverBlocked);
+        ASSERT_EQ(3, timeState.currentNtpServerIndex);
+        ASSERT_EQ(1, (int)getNtpServerRank(2).failStreak);
+
+        hostSetNtpServer("pool.ntp.org", true, 40, 0);
+        hostSetNtpServer("cn.pool.ntp.org", true, 40, 0);
+        hostSetNtpServer("ntp.aliyun.com", true, 40, 0);
+        hostSetNtpServer("time.windows.com", true, 40, 0);
+    } TEST_CASE_END();
+
+    TEST_CASE(test_ntp_poll_interval_adapts) {
+        // 网络变化后从最短间隔开始，修正量连续很小时逐级加倍
+        restartNtpEngine();
+        ASSERT_EQ(NTP_MIN_POLL, (int)getNtpPollExponent());
+        ASSERT_EQ(64000UL, getNtpPollInterval());
+        bool neverBlocked = false;
+        for (int i = 0; i < 2 * NTP_POLL_RAISE_COUNT; i++) {
+            ASSERT_EQ(NTP_RESULT_OK, runNtpQuery(neverBlocked));
+        }
+        ASSERT_EQ(NTP_MIN_POLL + 2, (int)getNtpPollExponent());
+
+        // 修正量变大时减半，超过NTP_POLL_STEP_RESET_MS时回到最短
+        setAllNtpServers(60, nullptr);
+        ASSERT_EQ(NTP_RESULT_OK, runNtpQuery(neverBlocked));
+        ASSERT_EQ(NTP_MIN_POLL + 1, (int)getNtpPollExponent());
+        setAllNtpServers(500, nullptr);
+        ASSERT_EQ(NTP_RESULT_OK, runNtpQuery(neverBlocked));
+        ASSERT_EQ(NTP_MIN_POLL, (int)getNtpPollExponent());
+
+        // KoD RATE：直接放长到最长间隔，状态可在RuntimeStats中看到
+        uint32_t kodBefore = ntpEngineStats.kissOfDeath;
+        setAllNtpServers(500, "RATE");
+        ASSERT_EQ(NTP_RESULT_FAILED, runNtpQuery(neverBlocked));
+        ASSERT_EQ(NTP_MAX_POLL, (int)getNtpPollExponent());
+        ASSERT_EQ(1024000UL, getNtpPollInterval());
+        updateRuntimeMonitor();
+        ASSERT_EQ(NTP_MAX_POLL, (int)runtimeStats.ntpPollExponent);
+        ASSERT_EQ(kodBefore + NTP_SERVER_COUNT, runtimeStats.ntpKissOfDeathCount);
+
+        // KoD DENY：该服务器排到最后，查询由其他服务器完成
+        setAllNtpServers(0, nullptr);
+        restartNtpEngine();
+        ASSERT_EQ(NTP_MIN_POLL, (int)getNtpPollExponent());
+        ASSERT_EQ(NTP_RESULT_OK, runNtpQuery(neverBlocked));
+        int denied = timeState.currentNtpServerIndex;
+        hostSetNtpKissCode(NTP_SERVERS[denied], "DENY");
+        ASSERT_EQ(NTP_RESULT_OK, runNtpQuery(neverBlocked));
+        ASSERT_TRUE(timeState.currentNtpServerIndex != denied);
+        ASSERT_TRUE(getNtpServerScore(denied) > getNtpServerScore(timeState.currentNtpServerIndex));
+        hostSetNtpKissCode(NTP_SERVERS[denied], nullptr);
+    } TEST_CASE_END();
+
+    TEST_CASE(test_ntp_dns_resolves_async_and_caches) {
+        // 地址缓存全部过期：查询时只解析当前服务器，等待解析期间不阻塞
+        restartNtpEngine();
+        hostSetDnsLatency(500);
+        hostAdvanceMillis(NTP_DNS_CACHE_TTL);
+        uint32_t lookups = hostGetDnsLookupCount();
+        bool neverBlocked = false;
+        ASSERT_EQ(NTP_RESULT_OK, runNtpQuery(neverBlocked));
+        ASSERT_TRUE(neverBlocked);
+        ASSERT_EQ(1, (int)(hostGetDnsLookupCount() - lookups));
+
+        // 缓存有效期内不再解析
+        ASSERT_EQ(NTP_RESULT_OK, runNtpQuery(neverBlocked));
+        ASSERT_EQ(1, (int)(hostGetDnsLookupCount() - lookups));
+
+        // 缓存过期后解析失败：继续使用旧地址，退避期内不再解析
+        int current = timeState.currentNtpServerIndex;
+        hostSetDnsResolvable(NTP_SERVERS[current], false);
+        hostAdvanceMillis(NTP_DNS_CACHE_TTL);
+        uint32_t failures = ntpEngineStats.dnsFailures;
+        ASSERT_EQ(NTP_RESULT_OK, runNtpQuery(neverBlocked));
+        ASSERT_TRUE(neverBlocked);
+        ASSERT_EQ(current, timeState.currentNtpServerIndex);
+        ASSERT_EQ(failures + 1, ntpEngineStats.dnsFailures);
+        lookups = hostGetDnsLookupCount();
+        ASSERT_EQ(NTP_RESULT_OK, runNtpQuery(neverBlocked));
+        ASSERT_EQ(0, (int)(hostGetDnsLookupCount() - lookups));
+
+        // 解析超过NTP_DNS_TIMEOUT时放弃等待，同样不阻塞主循环
+        hostSetDnsResolvable(NTP_SERVERS[current], true);
+        hostSetDnsLatency(NTP_DNS_TIMEOUT * 4);
+        hostAdvanceMillis(NTP_DNS_CACHE_TTL);
+        ASSERT_EQ(NTP_RESULT_OK, runNtpQuery(neverBlocked));
+        ASSERT_TRUE(neverBlocked);
+        ASSERT_EQ(failures + 2, ntpEngineStats.dnsFailures);
+        hostSetDnsLatency(30);
+        hostAdvanceMillis(NTP_DNS_TIMEOUT * 4);
+        hostDeliverDnsResults();
+
+        // 间隔数小时的同步会得到晶振频偏估计，清除记录，避免影响其他测试
+        uint8_t blank[17] = {0};
+        rtc.writenvram(0, blank, sizeof(blank));
+        initClockDiscipline();
+    } TEST_CASE_END();
+
+    TEST_CASE(test_rtc_phase_follows_seconds_register) {
+        TimeSource savedSource = timeState.currentTimeSource;
+        timeState.currentTimeSource = TIME_SOURCE_RTC;
+        systemState.rtcInitialized = true;
+        systemState.rtcTimeValid = true;
+
+        // 写入时间复位DS1307的秒分频链，此刻即为秒边界
+        hostSetRtcUnixTime(1800000000UL);
+        unsigned long boundary = millis();
+        initializeRTC();  // 绕过固件改写了DS1307，时钟缓存需要重新锁定
+        hostAdvanceMillis(300);
+
+        // 按getMillisToNextSecond()安排读取，几秒内锁定相位且每秒读取次数有限
+        DateTime now;
+        uint16_t subsecondMs = 0;
+        uint32_t readsBefore = hostGetRtcReadCount();
+        while (millis() - boundary < 5000) {
+            getCurrentTime(now, subsecondMs);
+            hostAdvanceMillis(getMillisToNextSecond());
+        }
+        ASSERT_TRUE(hostGetRtcReadCount() - readsBefore < 300);
+
+        hostAdvanceMillis(437);
+        ASSERT_TRUE(getCurrentTime(now, subsecondMs));
+        int expectedMs = (int)((millis() - boundary) % 1000);
+        ASSERT_TRUE(abs((int)subsecondMs - expectedMs) <= (int)RTC_PHASE_POLL_INTERVAL);
+
+        // 下一帧安排在距真实秒边界不超过一个轮询间隔处
+        unsigned long wakeAt = millis() + getMillisToNextSecond();
+        int phase = (int)((wakeAt - boundary) % 1000);
+        ASSERT_TRUE(phase <= (int)RTC_PHASE_POLL_INTERVAL || 1000 - phase <= (int)RTC_PHASE_POLL_INTERVAL);
+
+        timeState.currentTimeSource = savedSource;
+    } TEST_CASE_END();
+
+    TEST_CASE(test_rtc_clock_cache_avoids_i2c_reads) {
+        TimeSource savedSource = timeState.currentTimeSource;
+        timeState.currentTimeSource = TIME_SOURCE_RTC;
+        systemState.rtcInitialized = true;
+        systemState.rtcTimeValid = true;
+
+        hostSetRtcUnixTime(1800000000UL);
+        unsigned long boundary = millis();
+        initializeRTC();
+        DateTime now;
+        uint16_t subsecondMs = 0;
+        while (millis() - boundary < 3000) {
+            getCurrentTime(now, subsecondMs);
+            hostAdvanceMillis(getMillisToNextSecond());
+        }
+
+        // 锁定后每帧及帧间的时间查询都由millis()外推，不访问I2C
+        uint32_t readsBefore = hostGetRtcReadCount();
+        for (int i = 0; i < 20; i++) {
+            for (int j = 0; j < 50; j++) {
+                getCurrentTime(now, subsecondMs);
+            }
+            hostAdvanceMillis(getMillisToNextSecond());
+            getCurrentTime(now, subsecondMs);
+            hostAdvanceMillis(500);
+            ASSERT_TRUE(getCurrentTime(now, subsecondMs));
+            ASSERT_EQ(hostGetRtcUnixTime(), now.unixtime());
+        }
+        ASSERT_EQ(0, (int)(hostGetRtcReadCount() - readsBefore));
+
+        // DS1307被外部改写后，下一次重新锁定时发现偏差并跟上新时间
+        hostSetRtcUnixTime(hostGetRtcUnixTime() + 5);
+        unsigned long changedAt = millis();
+        while (millis() - changedAt < RTC_CLOCK_RESYNC_INTERVAL + 5000) {
+            getCurrentTime(now, subsecondMs);
+            hostAdvanceMillis(getMillisToNextSecond());
+        }
+        hostAdvanceMillis(500);
+        ASSERT_TRUE(getCurrentTime(now, subsecondMs));
+        ASSERT_EQ(hostGetRtcUnixTime(), now.unixtime());
+
+        timeState.currentTimeSource = savedSource;
+    } TEST_CASE_END();
+
+    TEST_CASE(test_clock_discipline_learns_and_persists_drift) {
+        // RTC写入后走了2小时，比NTP快288ms（+40ppm）：重写RTC并得到频偏估计
+        const uint32_t setAt = 1800000000UL;
+        noteRtcWritten(setAt);
+        ASSERT_EQ(0, (int)getRtcCorrectionMs(setAt + 7200));
+        ASSERT_TRUE(updateRtcDiscipline(288, setAt + 7200));
+        ASSERT_TRUE(isRtcDriftKnown());
+        ASSERT_EQ(40000, (int)getRtcDriftPpb());
+
+        // 新的一段：修正后残差很小时保留RTC，一天后的修正量约3.5秒
+        noteRtcWritten(setAt + 7200);
+        ASSERT_FALSE(updateRtcDiscipline(148, setAt + 7200 + 3600));
+        ASSERT_EQ(3456, (int)getRtcCorrectionMs(setAt + 7200 + 86400));
+
+        // millis()两小时少走180ms（-25ppm）：修正流逝时间
+        recordCrystalSample(1000, 5000000ULL);
+        recordCrystalSample(1000 + 7200000 - 180, 5000000ULL + 7200000);
+        ASSERT_TRUE(isCrystalDriftKnown());
+        ASSERT_EQ(-25000, (int)getCrystalDriftPpb());
+        ASSERT_EQ(1000025UL, correctElapsedMillis(1000000));
+
+        // 估计保存在DS1307 NVRAM中，重新初始化后仍然有效
+        initClockDiscipline();
+        ASSERT_EQ(40000, (int)getRtcDriftPpb());
+        ASSERT_EQ(-25000, (int)getCrystalDriftPpb());
+        ASSERT_EQ(3456, (int)getRtcCorrectionMs(setAt + 7200 + 86400));
+
+        // 手动设置的时间不作为频偏测量的基线
+        noteRtcSetManually();
+        ASSERT_EQ(0, (int)getRtcCorrectionMs(setAt + 7200 + 86400));
+        ASSERT_TRUE(updateRtcDiscipline(5, setAt + 7200 + 86400));
+
+        // 清除记录，避免影响其他测试
+        uint8_t blank[17] = {0};
+        rtc.writenvram(0, blank, sizeof(blank));
+        initClockDiscipline();
+        ASSERT_FALSE(isCrystalDriftKnown());
+        ASSERT_EQ(1000000UL, correctElapsedMillis(1000000));
+    } TEST_CASE_END();
+
+    TEST_SUITE_END();
+}
+
+// 空闲测试：空闲开始200ms后按下K3
+static uint64_t idlePressAtUs = 0;
+
+static void pressK3DuringIdle() {
+    if (idlePressAtUs != 0 && hostElapsedMicros() >= idlePressAtUs) {
+        idlePressAtUs = 0;
+        hostSetPinLevel(K3_PIN, LOW);
+    }
+}
+
+/**
+ * @brief 按键中断捕获测试（依赖模拟GPIO中断，只在主机端运行）
+ */
+static void runTestSuite_hostButtons() {
+    TEST_SUITE_START(HostButtons);
+
+    TEST_CASE(test_button_edges_survive_blocked_loop) {
+        initButtons();
+        bool savedShowStatus = displayState.showStatus;
+
+        // 主循环阻塞期间完成的一次短按：带抖动按下，120ms后释放
+        unsigned long pressedAt = millis();
+        hostSetPinLevel(K4_PIN, LOW);
+        hostAdvanceMillis(2);
+        hostSetPinLevel(K4_PIN, HIGH);
+        hostAdvanceMillis(1);
+        hostSetPinLevel(K4_PIN, LOW);
+        hostAdvanceMillis(117);
+        hostSetPinLevel(K4_PIN, HIGH);
+        hostAdvanceMillis(400);
+
+        // 阻塞结束后的一次调用处理整个按键过程，按下时刻为实际的边沿时刻
+        updateButtonStates();
+        ASSERT_EQ(!savedShowStatus, displayState.showStatus);
+        ASSERT_FALSE(buttonStates.buttons[3].isPressed);
+        ASSERT_TRUE(labs((long)(systemState.lastButtonPressTime[3] - (pressedAt + 3))) <= 1);
+        updateButtonStates();
+        ASSERT_EQ(!savedShowStatus, displayState.showStatus);
+
+        // 阻塞期间完成的长按在释放时补发
+        hostSetPinLevel(K2_PIN, LOW);
+        hostAdvanceMillis(LONG_PRESS_TIME + 100);
+        hostSetPinLevel(K2_PIN, HIGH);
+        hostAdvanceMillis(100);
+        updateButtonStates();
+        ASSERT_TRUE(settingState.timeSourceSettingMode);
+        ASSERT_FALSE(buttonStates.buttons[1].isPressed);
+
+        settingState.timeSourceSettingMode = false;
+        displayState.showStatus = savedShowStatus;
+        displayState.statusOverlayUntil = 0;
+    } TEST_CASE_END();
+
+    TEST_CASE(test_press_to_photon_latency_histogram) {
+        resetRuntimeStats();
+        initButtons();
+        bool savedShowStatus = displayState.showStatus;
+
+        // 短按：释放后经过消抖才被接受，再过20ms发送反映它的帧
+        hostSetPinLevel(K4_PIN, LOW);
+        hostAdvanceMillis(100);
+        hostSetPinLevel(K4_PIN, HIGH);
+        hostAdvanceMillis(DEBOUNCE_DELAY + 10);
+        updateButtonStates();
+        ASSERT_EQ(!savedShowStatus, displayState.showStatus);
+        hostAdvanceMillis(20);
+        u8g2.clearBuffer();
+        u8g2.drawBox(0, 0, savedShowStatus ? 8 : 16, 8);
+        ASSERT_TRUE(flushDisplay() > 0);
+        ASSERT_EQ(1, (int)runtimeStats.inputLatencyCount);
+        // 延迟到帧发送完成为止，包括整帧I2C发送的约20ms
+        ASSERT_TRUE(runtimeStats.inputLatencyMaxMs >= DEBOUNCE_DELAY + 30);
+        ASSERT_TRUE(runtimeStats.inputLatencyMaxMs <= DEBOUNCE_DELAY + 60);
+        ASSERT_EQ(1, (int)runtimeStats.buttonPressCount);
+
+        // 没有等待中的事件时发送的帧不计入
+        u8g2.clearBuffer();
+        ASSERT_TRUE(flushDisplay() > 0);
+        ASSERT_EQ(1, (int)runtimeStats.inputLatencyCount);
+
+        // 百分位数取所在区间的上限，不超过最大值
+        for (int i = 0; i < 97; i++) recordInputLatency(10);
+        recordInputLatency(120);
+        recordInputLatency(900);
+        ASSERT_EQ(16UL, getInputLatencyPercentile(50));
+        ASSERT_EQ(16UL, getInputLatencyPercentile(95));
+        ASSERT_EQ(150UL, getInputLatencyPercentile(99));
+        ASSERT_EQ(900UL, getInputLatencyPercentile(100));
+        ASSERT_TRUE(strstr(getRuntimeStatsJson(), "\"inputLatencyP99\":150,\"inputLatencyMax\":900}") != nullptr);
+
+        displayState.showStatus = savedShowStatus;
+        displayState.statusOverlayUntil = 0;
+        resetRuntimeStats();
+    } TEST_CASE_END();
+
+    TEST_CASE(test_button_press_ends_light_sleep_idle) {
+        initButtons();
+        bool savedConnected = systemState.networkConnected;
+        systemState.networkConnected = true;
+        systemState.needsRefresh = false;
+        initIdleManager();
+        ASSERT_EQ(WIFI_LIGHT_SLEEP, WiFi.getSleepMode());
+
+        // 没有任务和按键时限时空闲LOOP_IDLE_MAX，期间按键设为低电平唤醒源
+        uint32_t scheduled = hostGetScheduleCount();
+        uint64_t start = hostElapsedMicros();
+        ASSERT_TRUE(idleUntilNextDeadline());
+        ASSERT_EQ((int)LOOP_IDLE_MAX, (int)((hostElapsedMicros() - start) / 1000));
+        ASSERT_EQ(0, (int)hostGetGpioWakeupMask());
+        ASSERT_EQ(0, (int)(hostGetScheduleCount() - scheduled));
+        ASSERT_TRUE(getCpuDutyCyclePermille() < 10);
+        ASSERT_TRUE(getEstimatedCurrentMicroamps() < POWER_MODEM_SLEEP_UA);
+
+        // 按键按下立即结束空闲，空闲后恢复边沿中断并记录按下
+        idlePressAtUs = hostElapsedMicros() + 200000;
+        hostSetDelayHook(pressK3DuringIdle);
+        start = hostElapsedMicros();
+        ASSERT_TRUE(idleUntilNextDeadline());
+        hostSetDelayHook(nullptr);
+        ASSERT_TRUE((hostElapsedMicros() - start) / 1000 <= 201);
+        ASSERT_EQ(1, (int)(hostGetScheduleCount() - scheduled));
+        ASSERT_EQ(0, (int)hostGetGpioWakeupMask());
+        ASSERT_TRUE(hasPendingButtonEdges());
+        ASSERT_EQ(0, (int)getMillisUntilButtonDeadline());
+
+        // 消抖期间只空闲到消抖时限；按住期间不空闲
+        updateButtonStates();
+        ASSERT_TRUE(getMillisUntilButtonDeadline() <= DEBOUNCE_DELAY);
+        ASSERT_TRUE(getMillisUntilButtonDeadline() > 0);
+        hostAdvanceMillis(DEBOUNCE_DELAY);
+        updateButtonStates();
+        ASSERT_TRUE(buttonStates.buttons[2].isPressed);
+        ASSERT_FALSE(idleUntilNextDeadline());
+
+        // 恢复的边沿中断照常记录释放
+        hostSetPinLevel(K3_PIN, HIGH);
+        ASSERT_TRUE(hasPendingButtonEdges());
+        hostAdvanceMillis(DEBOUNCE_DELAY + 10);
+        updateButtonStates();
+        ASSERT_FALSE(buttonStates.buttons[2].isPressed);
+
+        systemState.networkConnected = savedConnected;
+        displayState.showStatus = false;
+        displayState.statusOverlayUntil = 0;
+        systemState.needsRefresh = false;
+    } TEST_CASE_END();
+
+    TEST_SUITE_END();
+}
+
+// 调度器测试用的任务：记录运行顺序
+static char schedulerTrace[16];
+static int schedulerTraceLen = 0;
+static int selfCancelTaskId = -1;
+
+static void traceTaskA() { if (schedulerTraceLen < 15) schedulerTrace[schedulerTraceLen++] = 'A'; }
+static void traceTaskB() { if (schedulerTraceLen < 15) schedulerTrace[schedulerTraceLen++] = 'B'; }
+static void traceTaskC() {
+    if (schedulerTraceLen < 15) schedulerTrace[schedulerTraceLen++] = 'C';
+    cancelTask(selfCancelTaskId);
+}
+
+static const char* takeSchedulerTrace() {
+    schedulerTrace[schedulerTraceLen] = '\0';
+    schedulerTraceLen = 0;
+    return schedulerTrace;
+}
+
+/**
+ * @brief 任务调度器测试（依赖设置虚拟时钟，只在主机端运行）
+ */
+static void runTestSuite_hostScheduler() {
+    TEST_SUITE_START(HostScheduler);
+
+    TEST_CASE(test_scheduler_orders_and_rearms_tasks) {
+        // 跨越millis()回绕运行，单调时钟和排期都不受影响
+        hostSetMillis(0xFFFFFFFF - 150);
+        takeSchedulerTrace();
+        uint64_t startMono = getMonotonicMillis();
+        int a = addTask("test-a", traceTaskA, 100, 100);
+        int b = addTask("test-b", traceTaskB, 0, 50);
+        selfCancelTaskId = addTask("test-c", traceTaskC, 10, 250);
+        ASSERT_TRUE(a >= 0 && b >= 0 && selfCancelTaskId >= 0);
+        ASSERT_EQ(50UL, getMillisUntilNextTask());
+
+        // 未到期时不运行；到期后按时刻先后运行，单次任务运行后不再排期
+        ASSERT_EQ(0, (int)runDueTasks());
+        hostAdvanceMillis(120);
+        ASSERT_EQ(2, (int)runDueTasks());
+        ASSERT_STR_EQ("BA", takeSchedulerTrace());
+        ASSERT_FALSE(isTaskScheduled(b));
+        ASSERT_TRUE(isTaskScheduled(a));
+
+        // 周期任务按计划时刻加周期重新排期，不随运行时刻漂移
+        ASSERT_EQ(80UL, getMillisUntilNextTask());
+        hostAdvanceMillis(80);
+        ASSERT_TRUE(millis() < 1000);
+        ASSERT_EQ(200ULL, getMonotonicMillis() - startMono);
+        ASSERT_EQ(1, (int)runDueTasks());
+        ASSERT_STR_EQ("A", takeSchedulerTrace());
+
+        // 改期单次任务；任务在回调中注销自己
+        rescheduleTask(b, 30);
+        hostAdvanceMillis(100);
+        ASSERT_EQ(3, (int)runDueTasks());
+        ASSERT_STR_EQ("BCA", takeSchedulerTrace());
+        ASSERT_TRUE(getTaskStats(selfCancelTaskId) == nullptr);
+
+        // 落后超过一个周期时不补运行，记为一次迟到
+        hostAdvanceMillis(450);
+        ASSERT_EQ(1, (int)runDueTasks());
+        ASSERT_STR_EQ("A", takeSchedulerTrace());
+        const TaskStats* stats = getTaskStats(a);
+        ASSERT_TRUE(stats != nullptr);
+        ASSERT_EQ(4, (int)stats->runCount);
+        ASSERT_EQ(1, (int)stats->lateCount);
+        ASSERT_EQ(100UL, getMillisUntilNextTask());
+
+        // 注销后槽位可以重新使用
+        cancelTask(a);
+        cancelTask(b);
+        ASSERT_FALSE(isTaskScheduled(a));
+        ASSERT_EQ(TASK_NEVER, getMillisUntilNextTask());
+        int reused = addTask("test-a", traceTaskA, 0, 0);
+        ASSERT_EQ(a, reused);
+        ASSERT_EQ(1, (int)runDueTasks());
+        cancelTask(reused);
+        takeSchedulerTrace();
+    } TEST_CASE_END();
+
+    TEST_SUITE_END();
+}
+
+// 分段性能分析测试用的分段：耗时由虚拟时钟决定
+static void profiledWork(uint32_t us) {
+    PROFILE_SCOPE("testWork");
+    hostAdvanceMicros(us);
+}
+
+static void profiledWorkElsewhere(uint32_t us) {
+    PROFILE_SCOPE("testWork");
+    hostAdvanceMicros(us);
+}
+
+/**
+ * @brief 分段性能分析测试（依赖虚拟时钟，只在主机端运行）
+ */
+static void runTestSuite_hostProfiler() {
+    TEST_SUITE_START(HostProfiler);
+
+    TEST_CASE(test_profile_scope_records_sections) {
+        resetProfiler();
+        profiledWork(100);
+        profiledWork(300);
+        // 同名的调用点计入同一分段
+        profiledWorkElsewhere(200);
+
+        const ProfilerSection* section = getProfilerSection("testWork");
+        ASSERT_TRUE(section != nullptr);
+        ASSERT_EQ(3, (int)section->count);
+        ASSERT_EQ(100 * 80, (int)section->minCycles);
+        ASSERT_EQ(300 * 80, (int)section->maxCycles);
+        ASSERT_EQ(600 * 80, (int)section->totalCycles);
+        ASSERT_TRUE(getProfilerSection("noSuchSection") == nullptr);
+
+        // 报告按微秒列出次数、最小、平均、最大
+        ASSERT_TRUE(strstr(getProfilerReport(), "testWork                3      100      200      300") != nullptr);
+
+        resetProfiler();
+        ASSERT_EQ(0, (int)getProfilerSection("testWork")->count);
+    } TEST_CASE_END();
+
+    TEST_SUITE_END();
+}
+
+/**
+ * @brief 延迟日志测试（依赖虚拟时钟，只在主机端运行）
+ */
+static void runTestSuite_hostLogger() {
+    TEST_SUITE_START(HostLogger);
+
+    TEST_CASE(test_deferred_log_formats_saved_args_later) {
+        char line[256];
+        char expected[160];
+        flushLogBuffer();
+        setLogDeferred(true);
+
+        // 字符串参数在记录时复制；%.4s的参数不以'\0'结尾
+        char server[16];
+        strcpy(server, "pool.ntp.org");
+        const char kiss[4] = {'R', 'A', 'T', 'E'};
+        unsigned long loggedAt = millis();
+        LOG_WARNING("%s: %.4s, step %+ld ms [%-4s] %5.1f%% %02X %c|%*d", server, kiss, -42L, "ab", 12.34, 0xA, 'z', 4, 7);
+        strcpy(server, "changed");
+        hostAdvanceMillis(1234);
+
+        // 输出时才格式化，时间戳仍是记录时刻
+        ASSERT_TRUE(hasPendingLogs());
+        ASSERT_TRUE(popLogLine(line, sizeof(line)));
+        snprintf(expected, sizeof(expected), "[%08lu] [WARN] pool.ntp.org: RATE, step -42 ms [ab  ]  12.3%% 0A z|   7", loggedAt);
+        ASSERT_STR_EQ(expected, line);
+        ASSERT_FALSE(popLogLine(line, sizeof(line)));
+
+        // 缓冲区满时丢弃并计数，腾出空间后的下一条之前插入丢弃提示
+        uint32_t droppedBefore = getLogDroppedCount();
+        for (int i = 0; i < 200; i++) {
+            LOG_WARNING("filler %d", i);
+        }
+        int dropped = (int)(getLogDroppedCount() - droppedBefore);
+        ASSERT_GT(dropped, 0);
+        int lines = 0;
+        while (popLogLine(line, sizeof(line))) {
+            lines++;
+        }
+        ASSERT_EQ(200 - dropped, lines);
+        LOG_WARNING("after drop");
+        ASSERT_TRUE(popLogLine(line, sizeof(line)));
+        snprintf(expected, sizeof(expected), "%d log messages dropped (buffer full)", dropped);
+        ASSERT_TRUE(strstr(line, expected) != nullptr);
+        ASSERT_TRUE(popLogLine(line, sizeof(line)));
+        ASSERT_TRUE(strstr(line, "[WARN] after drop") != nullptr);
+
+        // 关闭延迟日志时先输出缓冲区
+        LOG_INFO("flushed on disable");
+        ASSERT_TRUE(setLogDeferred(false));
+        ASSERT_FALSE(hasPendingLogs());
+    } TEST_CASE_END();
+
+    TEST_CASE(test_log_calls_above_module_level_compiled_out) {
+        char line[256];
+        int evaluated = 0;
+        LogLevel previousLevel = logConfig.currentLevel;
+        setLogLevel(LOG_LEVEL_VERBOSE);
+        flushLogBuffer();
+        setLogDeferred(true);
+
+        // 编译期级别为WARNING的模块：DEBUG调用点连同参数求值一起去掉
+#define LOG_COMPILE_LEVEL_HOSTQUIET LOG_LEVEL_WARNING
+#undef LOG_MODULE
+#define LOG_MODULE HOSTQUIET
+        LOG_DEBUG("quiet debug %d", ++evaluated);
+        LOG_WARNING("quiet warning %d", ++evaluated);
+#undef LOG_MODULE
+#define LOG_MODULE TEST
+        LOG_DEBUG("test debug %d", ++evaluated);
+
+        ASSERT_EQ(2, evaluated);
+        ASSERT_TRUE(popLogLine(line, sizeof(line)));
+        ASSERT_TRUE(strstr(line, "[WARN] quiet warning 1") != nullptr);
+        ASSERT_TRUE(popLogLine(line, sizeof(line)));
+        ASSERT_TRUE(strstr(line, "[DEBUG] test debug 2") != nullptr);
+        ASSERT_FALSE(popLogLine(line, sizeof(line)));
+
+        setLogDeferred(false);
+        setLogLevel(previousLevel);
+    } TEST_CASE_END();
+
+    TEST_SUITE_END();
+}
+
+// 在分段中途"复位"：重新初始化诊断记录即模拟看门狗复位后的启动
+static String breadcrumbReportAfterStall;
+
+static void stallInSection() {
+    BREADCRUMB_SECTION("testStall");
+    LOG_WARNING("stalled at step %d of the sync", 7);
+    initBreadcrumbs();
+    breadcrumbReportAfterStall = getBreadcrumbReport();
+}
+
+/**
+ * @brief 跨重启诊断记录测试（依赖模拟RTC用户内存和DS1307 NVRAM）
+ */
+static void runTestSuite_hostBreadcrumbs() {
+    TEST_SUITE_START(HostBreadcrumbs);
+
+    TEST_CASE(test_breadcrumbs_survive_restart) {
+        initBreadcrumbs();
+        reportError(ERROR_NTP_CONNECTION_FAILED, ERROR_LEVEL_WARNING, "NTP timeout");
+        LOG_INFO("info messages are not recorded");
+        stallInSection();
+
+        ASSERT_EQ(2, (int)getPreviousBreadcrumbCount());
+        const Breadcrumb* error = getPreviousBreadcrumb(0);
+        ASSERT_EQ((int)BREADCRUMB_ERROR, (int)error->type);
+        ASSERT_EQ((int)ERROR_NTP_CONNECTION_FAILED, (int)error->code);
+        ASSERT_EQ((int)ERROR_LEVEL_WARNING, (int)error->level);
+        ASSERT_EQ(0, (int)error->section);
+        const Breadcrumb* warning = getPreviousBreadcrumb(1);
+        ASSERT_EQ((int)BREADCRUMB_LOG, (int)warning->type);
+        ASSERT_EQ((int)LOG_LEVEL_WARNING, (int)warning->code);
+        ASSERT_TRUE(strncmp(warning->text, "stalled at step ", BREADCRUMB_TEXT_SIZE) == 0);
+        ASSERT_EQ((int)BREADCRUMB_ARG_SIGNED, (int)warning->level);
+        ASSERT_EQ(7, (int)warning->arg);
+        ASSERT_TRUE(getPreviousBreadcrumb(2) == nullptr);
+
+        // 复位时所在的分段和每条记录所在的分段
+        const char* report = breadcrumbReportAfterStall.c_str();
+        ASSERT_TRUE(strstr(report, "Sections active at reset: testStall\n") != nullptr);
+        ASSERT_TRUE(strstr(report, "(testStall) stalled at step  [7]\n") != nullptr);
+        ASSERT_TRUE(strstr(report, "NTP timeout") != nullptr);
+    } TEST_CASE_END();
+
+    TEST_CASE(test_breadcrumb_ring_keeps_latest) {
+        initBreadcrumbs();
+        char text[8];
+        for (int i = 0; i < BREADCRUMB_CAPACITY + 5; i++) {
+            snprintf(text, sizeof(text), "e%d", i);
+            addBreadcrumb(BREADCRUMB_ERROR, (uint8_t)i, 0, text);
+        }
+        initBreadcrumbs();
+        ASSERT_EQ((int)BREADCRUMB_CAPACITY, (int)getPreviousBreadcrumbCount());
+        ASSERT_EQ(5, (int)getPreviousBreadcrumb(0)->code);
+        ASSERT_EQ(BREADCRUMB_CAPACITY + 4, (int)getPreviousBreadcrumb(BREADCRUMB_CAPACITY - 1)->code);
+    } TEST_CASE_END();
+
+    TEST_CASE(test_restart_breadcrumb_mirrored_to_nvram) {
+        ASSERT_TRUE(systemState.rtcInitialized);
+        initBreadcrumbs();
+        recordRestartBreadcrumb("test restart");
+
+        // 断电：RTC用户内存丢失，改从DS1307 NVRAM取最后一条
+        uint32_t blank[128];
+        memset(blank, 0, sizeof(blank));
+        ESP.rtcUserMemoryWrite(0, blank, sizeof(blank));
+        initBreadcrumbs();
+        ASSERT_EQ(0, (int)getPreviousBreadcrumbCount());
+        loadBreadcrumbMirror();
+        ASSERT_EQ(1, (int)getPreviousBreadcrumbCount());
+        ASSERT_EQ((int)BREADCRUMB_RESTART, (int)getPreviousBreadcrumb(0)->type);
+        ASSERT_TRUE(strstr(getBreadcrumbReport().c_str(), "before power loss") != nullptr);
+        ASSERT_TRUE(strstr(getBreadcrumbReport().c_str(), "restart test restart") != nullptr);
+
+        // 镜像只显示一次
+        ESP.rtcUserMemoryWrite(0, blank, sizeof(blank));
+        initBreadcrumbs();
+        loadBreadcrumbMirror();
+        ASSERT_EQ(0, (int)getPreviousBreadcrumbCount());
+    } TEST_CASE_END();
+
+    TEST_SUITE_END();
+}
+
+// 监控任务按调度周期运行hours小时；每小时开始时产生errorsPerHour(hour)个错误
+static void runMonitoringHours(int firstHour, int hours, int (*errorsPerHour)(int)) {
+    const int runsPerHour = METRICS_HISTORY_INTERVAL / MONITOR_SYSTEM_INTERVAL;
+    for (int hour = firstHour; hour < firstHour + hours; hour++) {
+        runtimeStats.totalErrors += errorsPerHour(hour);
+        for (int run = 0; run < runsPerHour; run++) {
+            hostAdvanceMillis(MONITOR_SYSTEM_INTERVAL);
+            updateMonitoringSystem();
+        }
+    }
+}
+
+static int errorsInHour(int hour) {
+    return hour % 7;
+}
+
+// 最近hours小时（最后一小时为lastHour）错误率的期望平均值
+static float expectedErrorRate(int lastHour, int hours) {
+    float sum = 0;
+    for (int hour = lastHour - hours + 1; hour <= lastHour; hour++) {
+        sum += errorsInHour(hour);
+    }
+    return sum / hours;
+}
+
+/**
+ * @brief 监控历史与健康检查测试（依赖虚拟时钟，只在主机端运行）
+ */
+static void runTestSuite_hostMonitoring() {
+    TEST_SUITE_START(HostMonitoring);
+
+    TEST_CASE(test_metrics_history_keeps_running_averages) {
+        initMonitoringSystem();
+        MonitoringConfig config = monitoringConfig;
+        config.alertingEnabled = false;
+        updateMonitoringConfig(config);
+
+        // 30小时后环形历史只保留最近24个小时快照，每个快照的错误率是该小时的错误数
+        runMonitoringHours(0, 30, errorsInHour);
+        ASSERT_EQ(METRICS_HISTORY_SIZE, (int)metricsHistory.sampleCount);
+        ASSERT_TRUE(fabsf(getAverageMetrics(0).errorRatePerHour - expectedErrorRate(29, 24)) < 0.01f);
+
+        // 全部窗口、短窗口和长窗口的平均值都与逐个快照计算的一致
+        const uint8_t windows[] = {1, 5, 20, 24};
+        for (uint8_t hours : windows) {
+            ASSERT_TRUE(fabsf(getAverageMetrics(hours).errorRatePerHour - expectedErrorRate(29, hours)) < 0.01f);
+        }
+        // 计数类字段取最新快照的值
+        ASSERT_EQ(currentMetrics.totalErrorCount, getAverageMetrics(5).totalErrorCount);
+
+        // 缩短保留时长立即淘汰最旧的快照，之后的平均值仍然正确
+        config.metricsRetentionHours = 6;
+        updateMonitoringConfig(config);
+        ASSERT_EQ(6, (int)metricsHistory.sampleCount);
+        ASSERT_TRUE(fabsf(getAverageMetrics(0).errorRatePerHour - expectedErrorRate(29, 6)) < 0.01f);
+        runMonitoringHours(30, 3, errorsInHour);
+        ASSERT_EQ(6, (int)metricsHistory.sampleCount);
+        ASSERT_TRUE(fabsf(getAverageMetrics(0).errorRatePerHour - expectedErrorRate(32, 6)) < 0.01f);
+        ASSERT_TRUE(fabsf(getAverageMetrics(2).errorRatePerHour - expectedErrorRate(32, 2)) < 0.01f);
+    } TEST_CASE_END();
+
+    TEST_CASE(test_health_check_flags_error_burst) {
+        // 上一个用例结束于快照时刻，此后没有新错误
+        MonitoringConfig config = monitoringConfig;
+        config.alertingEnabled = true;
+        updateMonitoringConfig(config);
+        performSystemMonitoring();
+        HealthCheckResult before = performHealthCheck();
+        ASSERT_TRUE(strstr(before.summaryMessage, "errors") == nullptr);
+
+        // 不满一小时的错误不外推：25个错误即每小时25个，超过严重阈值
+        runtimeStats.totalErrors += 25;
+        hostAdvanceMillis(MONITOR_SYSTEM_INTERVAL);
+        performSystemMonitoring();
+        ASSERT_TRUE(fabsf(currentMetrics.errorRatePerHour - 25.0f) < 0.01f);
+        HealthCheckResult burst = performHealthCheck();
+        ASSERT_EQ(HEALTH_CRITICAL, burst.overallStatus);
+        ASSERT_TRUE(burst.criticalIssuesCount > before.criticalIssuesCount);
+        ASSERT_TRUE(strstr(burst.summaryMessage, "errors") != nullptr);
+        ASSERT_EQ(HEALTH_CRITICAL, lastHealthCheck.overallStatus);
+        ASSERT_TRUE(calculateSystemScore(currentMetrics) < 100.0f);
+
+        // 同一级别一小时内只报警一次
+        ASSERT_TRUE(shouldSendAlert(burst));
+        sendHealthAlert(burst);
+        ASSERT_FALSE(shouldSendAlert(burst));
+        hostAdvanceMillis(METRICS_HISTORY_INTERVAL);
+        ASSERT_TRUE(shouldSendAlert(burst));
+    } TEST_CASE_END();
+
+    TEST_SUITE_END();
+}
+
+// 推进指标服务直到它关闭连接；每推进drainEvery次取走一次写出的数据（取走即确认）
+// largestWrite记录两次取走之间写出的最多字节数
+static std::string runMetricsClient(int connection, int drainEvery, size_t* largestWrite) {
+    std::string response;
+    char buffer[4096];
+    for (int poll = 1; poll <= 2000; poll++) {
+        handleMetricsServer();
+        if (poll % drainEvery == 0 || hostTcpIsClosed(connection)) {
+            size_t n = hostTcpReceive(connection, buffer, sizeof(buffer));
+            response.append(buffer, n);
+            if (largestWrite && n > *largestWrite) *largestWrite = n;
+        }
+        if (hostTcpIsClosed(connection)) break;
+        hostAdvanceMillis(1);
+    }
+    return response;
+}
+
+// 去掉HTTP头并拼接分块正文；分块格式错误时返回false
+static bool dechunkMetrics(const std::string& response, std::string& body) {
+    size_t pos = response.find("\r\n\r\n");
+    if (pos == std::string::npos) return false;
+    pos += 4;
+    body.clear();
+    while (true) {
+        size_t lineEnd = response.find("\r\n", pos);
+        if (lineEnd == std::string::npos) return false;
+        size_t size = strtoul(response.substr(pos, lineEnd - pos).c_str(), nullptr, 16);
+        pos = lineEnd + 2;
+        if (size == 0) return response.compare(pos, std::string::npos, "\r\n") == 0;
+        if (pos + size + 2 > response.size() || response.compare(pos + size, 2, "\r\n") != 0) return false;
+        body.append(response, pos, size);
+        pos += size + 2;
+    }
+}
+
+// 每行都是注释或"名称[{标签}] 数值"，每个指标族的TYPE只出现一次
+static bool isValidExposition(const std::string& body) {
+    size_t pos = 0;
+    while (pos < body.size()) {
+        size_t end = body.find('\n', pos);
+        if (end == std::string::npos) return false;
+        std::string line = body.substr(pos, end - pos);
+        pos = end + 1;
+        if (line.compare(0, 7, "# TYPE ") == 0) {
+            std::string family = line.substr(0, line.find(' ', 7) + 1);
+            if (body.find(family, pos) != std::string::npos) return false;
+            continue;
+        }
+        if (line[0] == '#') continue;
+        size_t space = line.rfind(' ');
+        if (space == std::string::npos || space == 0) return false;
+        char* parsed = nullptr;
+        strtod(line.c_str() + space + 1, &parsed);
+        if (parsed == line.c_str() + space + 1 || *parsed != '\0') return false;
+    }
+    return true;
+}
+
+/**
+ * @brief /metrics指标服务测试（依赖模拟TCP连接）
+ */
+static void runTestSuite_hostMetrics() {
+    TEST_SUITE_START(HostMetrics);
+
+    TEST_CASE(test_metrics_endpoint_streams_chunked_exposition) {
+        initMetricsServer();
+        hostSetFreeHeap(41234);
+        updateMemoryStats();
+        uint32_t scrapes = getMetricsServerStats().scrapes;
+
+        int connection = hostTcpConnect(METRICS_PORT,
+                                        "GET /metrics HTTP/1.1\r\nHost: clock\r\nAccept: text/plain\r\n\r\n");
+        ASSERT_TRUE(connection >= 0);
+        size_t largestWrite = 0;
+        std::string response = runMetricsClient(connection, 1, &largestWrite);
+        ASSERT_TRUE(hostTcpIsClosed(connection));
+        ASSERT_FALSE(isMetricsClientActive());
+        ASSERT_EQ(scrapes + 1, getMetricsServerStats().scrapes);
+
+        ASSERT_EQ(0, (int)response.compare(0, 17, "HTTP/1.1 200 OK\r\n"));
+        ASSERT_TRUE(response.find("Transfer-Encoding: chunked\r\n") != std::string::npos);
+        std::string body;
+        ASSERT_TRUE(dechunkMetrics(response, body));
+        ASSERT_TRUE(isValidExposition(body));
+
+        ASSERT_TRUE(body.find("clock_heap_free_bytes 41234\n") != std::string::npos);
+        char expected[64];
+        snprintf(expected, sizeof(expected), "clock_ntp_requests_total %u\n", ntpEngineStats.requestsSent);
+        ASSERT_TRUE(body.find(expected) != std::string::npos);
+        snprintf(expected, sizeof(expected), "clock_input_latency_seconds_count %u\n", runtimeStats.inputLatencyCount);
+        ASSERT_TRUE(body.find(expected) != std::string::npos);
+        ASSERT_TRUE(body.find("# TYPE clock_input_latency_seconds histogram\n") != std::string::npos);
+        ASSERT_TRUE(body.find("clock_input_latency_seconds_bucket{le=\"0.016\"}") != std::string::npos);
+        ASSERT_TRUE(body.find("clock_loop_max_seconds ") != std::string::npos);
+        ASSERT_TRUE(body.find("clock_heap_loop_allocations_total ") != std::string::npos);
+        ASSERT_TRUE(body.find("clock_heap_loop_shrink_total ") != std::string::npos);
+
+        // 每次推进最多写一块（块缓冲区512字节），不会一次写出整个应答
+        ASSERT_TRUE(largestWrite <= 512);
+        ASSERT_TRUE(body.size() > 4 * 512);
+    } TEST_CASE_END();
+
+    TEST_CASE(test_metrics_endpoint_waits_for_send_window) {
+        // 发送窗口只比一块稍大、对端很少确认时，应答分多次推进仍然完整
+        hostSetTcpSendWindow(600);
+        int connection = hostTcpConnect(METRICS_PORT, "GET /metrics HTTP/1.0\r\n\r\n");
+        std::string response = runMetricsClient(connection, 7, nullptr);
+        hostSetTcpSendWindow(2920);
+        std::string body;
+        ASSERT_TRUE(dechunkMetrics(response, body));
+        ASSERT_TRUE(isValidExposition(body));
+        ASSERT_TRUE(body.find("clock_input_latency_seconds_count ") != std::string::npos);
+    } TEST_CASE_END();
+
+    TEST_CASE(test_metrics_endpoint_rejects_other_requests) {
+        MetricsServerStats before = getMetricsServerStats();
+        int connection = hostTcpConnect(METRICS_PORT, "GET /metricsx HTTP/1.1\r\n\r\n");
+        std::string response = runMetricsClient(connection, 1, nullptr);
+        ASSERT_EQ(0, (int)response.compare(0, 22, "HTTP/1.1 404 Not Found"));
+        ASSERT_EQ(before.notFound + 1, getMetricsServerStats().notFound);
+
+        // 请求不完整的连接超时后被放弃，之后的连接照常服务
+        connection = hostTcpConnect(METRICS_PORT, "GET /metr");
+        handleMetricsServer();
+        ASSERT_TRUE(isMetricsClientActive());
+        hostAdvanceMillis(METRICS_CLIENT_TIMEOUT);
+        handleMetricsServer();
+        ASSERT_TRUE(hostTcpIsClosed(connection));
+        ASSERT_EQ(before.aborted + 1, getMetricsServerStats().aborted);
+
+        connection = hostTcpConnect(METRICS_PORT, "GET /metrics?format=text HTTP/1.1\r\n\r\n");
+        response = runMetricsClient(connection, 1, nullptr);
+        ASSERT_EQ(0, (int)response.compare(0, 17, "HTTP/1.1 200 OK\r\n"));
+        ASSERT_EQ(before.scrapes + 1, getMetricsServerStats().scrapes);
+    } TEST_CASE_END();
+
+    TEST_SUITE_END();
+}
+
+// 在分段中申请一块堆内存；volatile防止编译器消去成对的malloc/free
+static void allocateInSection(size_t size) {
+    BREADCRUMB_SECTION("heapWork");
+    void* volatile ptr = malloc(size);
+    free(ptr);
+}
+
+// 同一分段中两处构造String（超出短字符串缓冲区，一定在堆上分配）
+static void allocateStringsInSection() {
+    BREADCRUMB_SECTION("heapStrings");
+    String first("first string, longer than the inline buffer");
+    String second("second string, longer than the inline buffer");
+}
+
+/**
+ * @brief 堆分配跟踪测试（依赖链接时的malloc包装，只在主机端运行）
+ */
+static void runTestSuite_hostHeap() {
+    TEST_SUITE_START(HostHeap);
+
+    TEST_CASE(test_heap_tracer_flags_steady_loop_allocations) {
+        bool steady = isHeapTraceSteadyState();
+        setHeapTraceSteadyState(true);
+        resetHeapTrace();
+
+        // 稳态循环外的分配只计总数
+        allocateInSection(40);
+        ASSERT_EQ(0, (int)getHeapTraceStats().loopAllocations);
+
+        beginHeapTraceLoop();
+        allocateInSection(24);
+        allocateInSection(24);
+        endHeapTraceLoop();
+        beginHeapTraceLoop();
+        endHeapTraceLoop();
+
+        const HeapTraceStats& stats = getHeapTraceStats();
+        ASSERT_EQ(3, (int)stats.allocations);
+        ASSERT_EQ(3, (int)stats.frees);
+        ASSERT_EQ(2, (int)stats.loopAllocations);
+        ASSERT_EQ(1, (int)stats.loopsWithAllocations);
+        ASSERT_EQ(2, (int)stats.steadyLoops);
+
+        // 同一调用点按分配所在的分段归类，且只报告一次
+        ASSERT_EQ(1, (int)getHeapAllocSiteCount());
+        const HeapAllocSite* site = getHeapAllocSite(0);
+        ASSERT_TRUE(site != nullptr);
+        ASSERT_EQ(3, (int)site->count);
+        ASSERT_EQ(88, (int)site->bytes);
+        ASSERT_EQ(2, (int)site->loopCount);
+        ASSERT_TRUE(site->reported);
+        ASSERT_STR_EQ("heapWork", getBreadcrumbSectionName(site->section - 1));
+        ASSERT_TRUE(getHeapAllocSite(1) == nullptr);
+
+        // 暂停期间（主机替身模拟网络栈）的分配不计入
+        beginHeapTraceLoop();
+        pauseHeapTrace();
+        allocateInSection(16);
+        resumeHeapTrace();
+        endHeapTraceLoop();
+        ASSERT_EQ(2, (int)getHeapTraceStats().loopAllocations);
+        ASSERT_EQ(3, (int)getHeapTraceStats().allocations);
+
+        resetHeapTrace();
+        setHeapTraceSteadyState(steady);
+    } TEST_CASE_END();
+
+    TEST_CASE(test_heap_tracer_separates_string_call_sites) {
+        resetHeapTrace();
+        allocateStringsInSection();
+
+        // 经operator new的分配归到构造String的位置，而不是operator new内部
+        ASSERT_EQ(2, (int)getHeapAllocSiteCount());
+        const HeapAllocSite* first = getHeapAllocSite(0);
+        const HeapAllocSite* second = getHeapAllocSite(1);
+        ASSERT_TRUE(first != nullptr && second != nullptr);
+        if (first != nullptr && second != nullptr) {
+            ASSERT_TRUE(first->caller != second->caller);
+            ASSERT_EQ(1, (int)first->count);
+            ASSERT_EQ(1, (int)second->count);
+            ASSERT_EQ((int)first->section, (int)second->section);
+            ASSERT_STR_EQ("heapStrings", getBreadcrumbSectionName(first->section - 1));
+        }
+
+        // 在同一位置再构造一次不会产生新的调用点
+        allocateStringsInSection();
+        ASSERT_EQ(2, (int)getHeapAllocSiteCount());
+        ASSERT_EQ(2, (int)(first ? first->count : 0));
+        resetHeapTrace();
+    } TEST_CASE_END();
+
+    TEST_CASE(test_steady_loop_heap_shrink_counted_without_wrappers) {
+        // 固件没有包装函数，只能比较循环前后的ESP.getHeapStats()
+        bool steady = isHeapTraceSteadyState();
+        setHeapTraceSteadyState(true);
+        resetHeapTrace();
+        hostSetFreeHeap(41000);
+
+        beginHeapTraceLoop();
+        hostSetFreeHeap(40800);  // 循环中留下200字节
+        endHeapTraceLoop();
+        beginHeapTraceLoop();
+        endHeapTraceLoop();
+        beginHeapTraceLoop();
+        hostSetFreeHeap(41000);  // 释放不计
+        endHeapTraceLoop();
+
+        const HeapTraceStats& stats = getHeapTraceStats();
+        ASSERT_EQ(3, (int)stats.steadyLoops);
+        ASSERT_EQ(1, (int)stats.heapShrinkLoops);
+        ASSERT_EQ(200, (int)stats.maxHeapShrink);
+
+        resetHeapTrace();
+        setHeapTraceSteadyState(steady);
+    } TEST_CASE_END();
+
+    TEST_CASE(test_heap_fragmentation_tracked_over_time) {
+        // 替身的最大可分配块为空闲堆的90%
+        hostSetFreeHeap(30000);
+        updateMemoryStats();
+        hostSetFreeHeap(41234);
+        updateMemoryStats();
+        ASSERT_EQ(41234 * 9 / 10, (int)runtimeStats.maxFreeBlock);
+        ASSERT_TRUE(runtimeStats.minMaxFreeBlock <= 27000);
+        ASSERT_EQ(10, (int)runtimeStats.heapFragmentation);
+        ASSERT_TRUE(runtimeStats.maxHeapFragmentation >= 10);
+
+        collectCpuMemoryMetrics();
+        ASSERT_EQ(41234 * 9 / 10, (int)currentMetrics.maxFreeBlockSize);
+        ASSERT_EQ(10, (int)currentMetrics.heapFragmentation);
+    } TEST_CASE_END();
+
+    TEST_SUITE_END();
+}
+
+/**
+ * @brief 日志式配置存储测试（依赖模拟闪存，只在主机端运行）
+ */
+static void runTestSuite_hostConfigStore() {
+    TEST_SUITE_START(HostConfigStore);
+
+    TEST_CASE(test_config_saves_append_without_erasing) {
+        resetAllConfigs();
+        uint32_t erases = hostGetFlashEraseCount();
+
+        // 第一次保存初始化一个扇区，之后每次保存只追加一条记录
+        uint32_t slowest = 0;
+        for (int i = 0; i < 200; i++) {
+            uint32_t start = micros();
+            ASSERT_TRUE(setConfigValue(CONFIG_BRIGHTNESS_INDEX, i % 4));
+            if (i > 0 && micros() - start > slowest) slowest = micros() - start;
+        }
+        ASSERT_EQ(1, (int)(hostGetFlashEraseCount() - erases));
+        ASSERT_TRUE(slowest < 1000);
+        ASSERT_EQ(199 % 4, (int)getConfigValue(CONFIG_BRIGHTNESS_INDEX));
+
+        // 值未变的保存不写闪存
+        uint16_t freeBytes = getConfigStoreStats().freeBytes;
+        ASSERT_TRUE(setConfigValue(CONFIG_BRIGHTNESS_INDEX, 199 % 4));
+        ASSERT_EQ(freeBytes, getConfigStoreStats().freeBytes);
+        ASSERT_EQ(0, (int)hostGetEepromCommitCount());
+    } TEST_CASE_END();
+
+    TEST_CASE(test_config_store_rotates_sectors_and_rebuilds_at_boot) {
+        resetAllConfigs();
+        uint32_t erases = hostGetFlashEraseCount();
+        ASSERT_TRUE(setConfigValue(CONFIG_FONT_SIZE, false));
+
+        // 每条1字节记录占8字节，一个扇区约500条；写满几个扇区，各扇区轮流擦除
+        for (int i = 0; i < 2000; i++) {
+            ASSERT_TRUE(setConfigValue(CONFIG_BRIGHTNESS_INDEX, i % 4));
+        }
+        uint32_t used = hostGetFlashEraseCount() - erases;
+        ASSERT_TRUE(used >= 4 && used <= 6);
+        ASSERT_EQ((int)used, (int)getConfigStoreStats().sequence);
+        uint8_t sector = getConfigStoreStats().activeSector;
+        uint16_t freeBytes = getConfigStoreStats().freeBytes;
+
+        // 重启后扫描当前扇区即得到全部最新值和追加位置，整理时复制的旧键也在
+        initConfigManager();
+        ASSERT_EQ(1999 % 4, (int)getConfigValue(CONFIG_BRIGHTNESS_INDEX));
+        ASSERT_FALSE(getConfigValue(CONFIG_FONT_SIZE));
+        ASSERT_EQ(sector, getConfigStoreStats().activeSector);
+        ASSERT_EQ(freeBytes, getConfigStoreStats().freeBytes);
+        ASSERT_EQ(0, (int)getConfigStoreStats().corruptRecords);
+    } TEST_CASE_END();
+
+    TEST_CASE(test_config_store_ignores_torn_record) {
+        resetAllConfigs();
+        ASSERT_TRUE(setConfigValue(CONFIG_BRIGHTNESS_INDEX, 1));
+        ASSERT_TRUE(setConfigValue(CONFIG_BRIGHTNESS_INDEX, 3));
+
+        // 模拟写最后一条记录时断电：记录头中的CRC没有写完整
+        const ConfigStoreStats& stats = getConfigStoreStats();
+        uint32_t address = FS_PHYS_ADDR + FS_PHYS_SIZE - (CONFIG_STORE_SECTORS - stats.activeSector) * FLASH_SECTOR_SIZE +
+                           (FLASH_SECTOR_SIZE - stats.freeBytes) - 8;
+        uint32_t torn = 0x0000FFFF;
+        ASSERT_TRUE(ESP.flashWrite(address, &torn, sizeof(torn)));
+
+        initConfigManager();
+        ASSERT_EQ(1, (int)getConfigStoreStats().corruptRecords);
+        ASSERT_EQ(1, (int)getConfigValue(CONFIG_BRIGHTNESS_INDEX));
+
+        // 下一次保存整理到下一个扇区，重启后不再看到损坏的记录
+        ASSERT_TRUE(setConfigValue(CONFIG_BRIGHTNESS_INDEX, 2));
+        initConfigManager();
+        ASSERT_EQ(0, (int)getConfigStoreStats().corruptRecords);
+        ASSERT_EQ(2, (int)getConfigValue(CONFIG_BRIGHTNESS_INDEX));
+    } TEST_CASE_END();
+
+    TEST_CASE(test_legacy_eeprom_config_migrated) {
+        resetAllConfigs();
+        initConfigManager();
+        ASSERT_EQ((int)CONFIG_SCHEMA_VERSION, (int)getConfigSchemaVersion());
+        ASSERT_TRUE(setConfigValue(CONFIG_BRIGHTNESS_INDEX, 1));
+        ASSERT_TRUE(setConfigValue(CONFIG_FONT_SIZE, 0));
+
+        // 降级到版本1：按旧版固件的EEPROM布局写入（地址1亮度、2~3魔数、5字体）
+        ASSERT_TRUE(migrateConfigSchema(CONFIG_SCHEMA_MIN_VERSION));
+        ASSERT_EQ((int)CONFIG_SCHEMA_MIN_VERSION, (int)getConfigSchemaVersion());
+        ASSERT_EQ(1, (int)EEPROM.read(1));
+        ASSERT_EQ(0xA5C3, (int)(EEPROM.read(2) | (EEPROM.read(3) << 8)));
+        ASSERT_EQ(0, (int)EEPROM.read(5));
+
+        // 只有旧版EEPROM数据的设备：启动时升级到当前版本
+        ASSERT_TRUE(clearConfigStore());
+        ASSERT_TRUE(initConfigManager());
+        ASSERT_EQ((int)CONFIG_SCHEMA_VERSION, (int)getConfigSchemaVersion());
+        ASSERT_EQ(1, (int)getConfigValue(CONFIG_BRIGHTNESS_INDEX));
+        ASSERT_FALSE(getConfigValue(CONFIG_FONT_SIZE));
+
+        // 迁移后以配置存储为准
+        ASSERT_TRUE(setConfigValue(CONFIG_BRIGHTNESS_INDEX, 3));
+        initConfigManager();
+        ASSERT_EQ(3, (int)getConfigValue(CONFIG_BRIGHTNESS_INDEX));
+
+        resetAllConfigs();
+        ASSERT_EQ(2, (int)getConfigValue(CONFIG_BRIGHTNESS_INDEX));
+    } TEST_CASE_END();
+
+    TEST_CASE(test_config_saved_after_downgrade_survives_reboot) {
+        resetAllConfigs();
+        initConfigManager();
+        ASSERT_TRUE(setConfigValue(CONFIG_BRIGHTNESS_INDEX, 1));
+        ASSERT_TRUE(migrateConfigSchema(CONFIG_SCHEMA_MIN_VERSION));
+
+        // 降级后（还没刷入旧版固件）继续调节：旧版布局同步更新
+        ASSERT_TRUE(setConfigValue(CONFIG_BRIGHTNESS_INDEX, 3));
+        ASSERT_TRUE(setConfigValue(CONFIG_FONT_SIZE, 0));
+        ASSERT_EQ(3, (int)EEPROM.read(1));
+        ASSERT_EQ(0, (int)EEPROM.read(5));
+
+        // 重启：升级不会用降级时的旧值覆盖之后保存的配置
+        ASSERT_TRUE(initConfigManager());
+        ASSERT_EQ((int)CONFIG_SCHEMA_VERSION, (int)getConfigSchemaVersion());
+        ASSERT_EQ(3, (int)getConfigValue(CONFIG_BRIGHTNESS_INDEX));
+        ASSERT_FALSE(getConfigValue(CONFIG_FONT_SIZE));
+
+        resetAllConfigs();
+    } TEST_CASE_END();
+
+    TEST_CASE(test_config_schema_checks_values_and_newer_versions) {
+        resetAllConfigs();
+        ASSERT_FALSE(setConfigValue(CONFIG_BRIGHTNESS_INDEX, 4));
+        ASSERT_FALSE(setConfigValue(CONFIG_FONT_SIZE, 2));
+        ASSERT_FALSE(setConfigValue(CONFIG_COUNT, 0));
+        ASSERT_EQ(2, (int)getConfigValue(CONFIG_BRIGHTNESS_INDEX));
+
+        // 较新固件写入的数据：版本号更高，还有不认识的键和超出本版范围的值
+        uint8_t newer[2] = {CONFIG_SCHEMA_VERSION + 1, 0};
+        uint8_t unknown = 7, brightness = 1, fontSize = 5;
+        ASSERT_TRUE(writeConfigValue(0, newer, sizeof(newer)));
+        ASSERT_TRUE(writeConfigValue(9, &unknown, 1));
+        ASSERT_TRUE(writeConfigValue(1, &brightness, 1));
+        ASSERT_TRUE(writeConfigValue(2, &fontSize, 1));
+
+        // 读出认识的键，超出范围的用默认值，不降级也不改动存储中的数据
+        initConfigManager();
+        ASSERT_EQ((int)CONFIG_SCHEMA_VERSION + 1, (int)getConfigSchemaVersion());
+        ASSERT_EQ(1, (int)getConfigValue(CONFIG_BRIGHTNESS_INDEX));
+        ASSERT_TRUE(getConfigValue(CONFIG_FONT_SIZE));
+        ASSERT_FALSE(migrateConfigSchema(CONFIG_SCHEMA_MIN_VERSION));
+        ASSERT_TRUE(readConfigValue(9, &unknown, 1));
+        ASSERT_EQ(7, (int)unknown);
+        ASSERT_TRUE(readConfigValue(2, &fontSize, 1));
+        ASSERT_EQ(5, (int)fontSize);
+        resetAllConfigs();
+    } TEST_CASE_END();
+
+    TEST_CASE(test_config_writeback_coalesces_saves) {
+        resetAllConfigs();
+        ASSERT_TRUE(setConfigValue(CONFIG_FONT_SIZE, true));
+        startConfigWriteBack();
+        const ConfigStoreStats& stats = getConfigStoreStats();
+        uint16_t freeBytes = stats.freeBytes;
+        uint32_t flushes = stats.flushes;
+        uint64_t flashTime = hostGetTimeSpentMicros(HOST_TIME_FLASH);
+
+        // 连续调节只更新RAM，按键路径上不写闪存
+        for (int i = 0; i < 10; i++) {
+            ASSERT_TRUE(setConfigValue(CONFIG_BRIGHTNESS_INDEX, i % 4));
+            hostAdvanceMillis(200);
+            runDueTasks();
+        }
+        ASSERT_TRUE(setConfigValue(CONFIG_FONT_SIZE, false));
+        ASSERT_EQ(9 % 4, (int)getConfigValue(CONFIG_BRIGHTNESS_INDEX));
+        ASSERT_EQ(2, (int)stats.pendingKeys);
+        ASSERT_EQ(freeBytes, stats.freeBytes);
+        ASSERT_TRUE(hostGetTimeSpentMicros(HOST_TIME_FLASH) == flashTime);
+
+        // 最后一次修改后CONFIG_FLUSH_DELAY才写回，每个键只写最终值
+        hostAdvanceMillis(CONFIG_FLUSH_DELAY - 1);
+        runDueTasks();
+        ASSERT_EQ((int)flushes, (int)stats.flushes);
+        hostAdvanceMillis(1);
+        runDueTasks();
+        ASSERT_EQ((int)flushes + 1, (int)stats.flushes);
+        ASSERT_EQ(0, (int)stats.pendingKeys);
+        ASSERT_EQ(freeBytes - 16, (int)stats.freeBytes);
+        initConfigManager();
+        ASSERT_EQ(9 % 4, (int)getConfigValue(CONFIG_BRIGHTNESS_INDEX));
+        ASSERT_FALSE(getConfigValue(CONFIG_FONT_SIZE));
+
+        // 退出亮度设置时立即写回，不等空闲
+        enterBrightnessSettingMode();
+        updateBrightnessSetting(1);
+        uint8_t brightness = displayState.brightnessIndex;
+        exitBrightnessSettingMode();
+        ASSERT_EQ(0, (int)stats.pendingKeys);
+        initConfigManager();
+        ASSERT_EQ((int)brightness, (int)getConfigValue(CONFIG_BRIGHTNESS_INDEX));
+
+        // 停止写回模式时写入未保存的修改并注销任务
+        ASSERT_TRUE(setConfigValue(CONFIG_FONT_SIZE, true));
+        stopConfigWriteBack();
+        ASSERT_EQ(0, (int)stats.pendingKeys);
+        ASSERT_TRUE(getConfigValue(CONFIG_FONT_SIZE));
+        resetAllConfigs();
+    } TEST_CASE_END();
+
+    TEST_SUITE_END();
+}
+
+int main() {
+    Serial.begin(115200);
+
+    g_testMode = true;
+    setLogLevel(LOG_LEVEL_DEBUG);
+    enableLogger(true);
+    enableTimestamp(true);
+
+    initConfigManager();
+    initLogger();
+    initRuntimeMonitor();
+    initErrorRecovery();
+
+    Wire.begin();
+    u8g2.begin();
+    u8g2.setPowerSave(false);
+    initButtons();
+    initializeRTC();
+
+    runAllTests();
+
+    runTestSuite_hostDisplay();
+    runTestSuite_hostNtp();
+    runTestSuite_hostButtons();
+    runTestSuite_hostScheduler();
+#if ENABLE_LOOP_PROFILER
+    runTestSuite_hostProfiler();
+#endif
+    runTestSuite_hostLogger();
+    runTestSuite_hostBreadcrumbs();
+    runTestSuite_hostMonitoring();
+    runTestSuite_hostMetrics();
+    runTestSuite_hostHeap();
+    runTestSuite_hostConfigStore();
+    printTestSummary();
+    Serial.flush();
+
+    return g_testStats.failedTests == 0 ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file EEPROM.h
+ * @brief EEPROM闪存模拟层的主机替身
+ *
+ * 与ESP8266核心一致：begin()把闪存内容读入RAM缓存，write()只修改缓存，
+ * commit()才写回闪存（并计数）。未commit的修改在hostResetHardware()后丢失
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <Arduino.h>
+
+class EEPROMClass {
+public:
+    void begin(size_t size);
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    bool commit();
+    bool end();
+    size_t length() { return size; }
+    uint8_t* getDataPtr() { dirty = true; return data; }
+    const uint8_t* getConstDataPtr() const { return data; }
+    uint8_t& operator[](int address) { dirty = true; return data[address]; }
+
+    template <typename T>
+    T& get(int address, T& t) {
+        if (address >= 0 && address + sizeof(T) <= size) memcpy((uint8_t*)&t, data + address, sizeof(T));
+        return t;
+    }
+
+    template <typename T>
+    const T& put(int address, const T& t) {
+        if (address >= 0 && address + sizeof(T) <= size && memcmp(data + address, (const uint8_t*)&t, sizeof(T)) != 0) {
+            memcpy(data + address, (const uint8_t*)&t, sizeof(T));
+            dirty = true;
+        }
+        return t;
+    }
+
+private:
+    uint8_t data[4096];
+    size_t size = 0;
+    bool dirty = false;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // HOST_EEPROM_H
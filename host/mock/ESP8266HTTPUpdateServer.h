@@ -0,0 +1,28 @@
+/**
+ * @file ESP8266HTTPUpdateServer.h
+ * @brief ESP8266HTTPUpdateServer的主机替身
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_ESP8266HTTPUPDATESERVER_H
+#define HOST_ESP8266HTTPUPDATESERVER_H
+
+#include <ESP8266WebServer.h>
+#include <ESP8266httpUpdate.h>
+
+class ESP8266HTTPUpdateServer {
+public:
+    explicit ESP8266HTTPUpdateServer(bool serialDebugging = false) { (void)serialDebugging; }
+    void setup(ESP8266WebServer* server, const String& path = "/update",
+               const String& username = String(), const String& password = String()) {
+        (void)server;
+        (void)path;
+        (void)username;
+        (void)password;
+    }
+};
+
+#endif // HOST_ESP8266HTTPUPDATESERVER_H
@@ -0,0 +1,109 @@
+/**
+ * @file ESP8266WebServer.h
+ * @brief ESP8266WebServer的主机替身
+ *
+ * 不监听端口；测试可以用hostRequest()直接调用已注册的处理函数，
+ * 最近一次send()的状态码和内容保存在hostLastResponse中
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_ESP8266WEBSERVER_H
+#define HOST_ESP8266WEBSERVER_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <functional>
+#include <vector>
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+enum HTTPUploadStatus { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END, UPLOAD_FILE_ABORTED };
+
+#define HTTP_UPLOAD_BUFLEN 2048
+
+struct HTTPUpload {
+    HTTPUploadStatus status;
+    String filename;
+    String name;
+    String type;
+    size_t totalSize;
+    size_t currentSize;
+    uint8_t buf[HTTP_UPLOAD_BUFLEN];
+};
+
+struct HostHttpResponse {
+    int code;
+    String contentType;
+    String content;
+};
+
+class ESP8266WebServer {
+public:
+    typedef std::function<void(void)> THandlerFunction;
+
+    explicit ESP8266WebServer(int port = 80) : _port(port) {}
+
+    void begin() { _running = true; }
+    void stop() { _running = false; }
+    void close() { stop(); }
+    void handleClient() {}
+
+    void on(const String& uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+    void on(const String& uri, HTTPMethod method, THandlerFunction fn) { on(uri, method, fn, nullptr); }
+    void on(const String& uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn) {
+        _routes.push_back(Route{uri, method, fn, ufn});
+    }
+    void onNotFound(THandlerFunction fn) { _notFound = fn; }
+
+    void send(int code, const char* contentType = nullptr, const String& content = String()) {
+        hostLastResponse.code = code;
+        hostLastResponse.contentType = contentType ? contentType : "";
+        hostLastResponse.content = content;
+    }
+    void send(int code, const String& contentType, const String& content) { send(code, contentType.c_str(), content); }
+    void send_P(int code, PGM_P contentType, PGM_P content) { send(code, contentType, String(content)); }
+    void sendHeader(const String& name, const String& value, bool first = false) {
+        (void)name;
+        (void)value;
+        (void)first;
+    }
+    void setContentLength(size_t length) { (void)length; }
+
+    String arg(const String& name) const { (void)name; return String(); }
+    bool hasArg(const String& name) const { (void)name; return false; }
+    HTTPUpload& upload() { return _upload; }
+
+    // ---- 仅主机端 ----
+    bool hostIsRunning() const { return _running; }
+    // 调用匹配的处理函数，返回是否找到路由
+    bool hostRequest(HTTPMethod method, const String& uri) {
+        for (const Route& route : _routes) {
+            if (route.uri == uri && (route.method == HTTP_ANY || route.method == method)) {
+                if (route.handler) route.handler();
+                return true;
+            }
+        }
+        if (_notFound) _notFound();
+        return false;
+    }
+
+    HostHttpResponse hostLastResponse = {0, String(), String()};
+
+private:
+    struct Route {
+        String uri;
+        HTTPMethod method;
+        THandlerFunction handler;
+        THandlerFunction uploadHandler;
+    };
+
+    int _port;
+    bool _running = false;
+    std::vector<Route> _routes;
+    THandlerFunction _notFound;
+    HTTPUpload _upload = {};
+};
+
+#endif // HOST_ESP8266WEBSERVER_H
@@ -0,0 +1,133 @@
+/**
+ * @file ESP8266WiFi.h
+ * @brief WiFi对象、IPAddress与TCP服务器/客户端的主机替身
+ *
+ * WiFiServer::accept()取到的连接由hostTcpConnect()注入；固件写出的数据
+ * 留在连接上直到测试用hostTcpReceive()取走，未取走的数据占用发送窗口
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_ESP8266WIFI_H
+#define HOST_ESP8266WIFI_H
+
+#include <Arduino.h>
+#include <lwip/ip_addr.h>
+#include <memory>
+#include <string>
+
+typedef enum {
+    WL_NO_SHIELD = 255,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_WRONG_PASSWORD = 6,
+    WL_DISCONNECTED = 7
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} WiFiMode_t;
+
+typedef enum {
+    WIFI_NONE_SLEEP = 0,
+    WIFI_LIGHT_SLEEP = 1,
+    WIFI_MODEM_SLEEP = 2
+} WiFiSleepType_t;
+
+class IPAddress {
+public:
+    IPAddress() : addr{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : addr{a, b, c, d} {}
+    IPAddress(const ip_addr_t* lwipAddr)
+        : addr{(uint8_t)lwipAddr->addr, (uint8_t)(lwipAddr->addr >> 8), (uint8_t)(lwipAddr->addr >> 16),
+               (uint8_t)(lwipAddr->addr >> 24)} {}
+    uint8_t operator[](int index) const { return addr[index & 3]; }
+    uint8_t& operator[](int index) { return addr[index & 3]; }
+    operator uint32_t() const {
+        return (uint32_t)addr[0] | ((uint32_t)addr[1] << 8) | ((uint32_t)addr[2] << 16) | ((uint32_t)addr[3] << 24);
+    }
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", addr[0], addr[1], addr[2], addr[3]);
+        return String(buf);
+    }
+private:
+    uint8_t addr[4];
+};
+
+class ESP8266WiFiClass {
+public:
+    wl_status_t status();
+    bool isConnected() { return status() == WL_CONNECTED; }
+    String SSID();
+    int32_t RSSI();
+    IPAddress localIP();
+    String macAddress();
+    uint8_t* macAddress(uint8_t* mac) {
+        static const uint8_t hostMac[6] = {0x5C, 0xCF, 0x7F, 0xC0, 0xFF, 0xEE};
+        memcpy(mac, hostMac, sizeof(hostMac));
+        return mac;
+    }
+    bool disconnect(bool wifiOff = false);
+    bool mode(WiFiMode_t mode) { (void)mode; return true; }
+    void persistent(bool persistent) { (void)persistent; }
+    bool setAutoConnect(bool autoConnect) { (void)autoConnect; return true; }
+    bool setAutoReconnect(bool autoReconnect) { (void)autoReconnect; return true; }
+    bool setSleepMode(WiFiSleepType_t type, uint8_t listenInterval = 0);
+    WiFiSleepType_t getSleepMode();
+    wl_status_t begin(const char* ssid, const char* passphrase = nullptr);
+    int hostByName(const char* host, IPAddress& result);
+};
+
+extern ESP8266WiFiClass WiFi;
+
+// 一条模拟的TCP连接
+struct HostTcpConnection {
+    std::string rx;         // 对端发来的数据
+    size_t rxPos = 0;
+    std::string tx;         // 固件写出、对端尚未取走的数据
+    bool closed = false;    // 固件已stop()
+};
+
+class WiFiClient : public Print {
+public:
+    WiFiClient() {}
+    explicit WiFiClient(std::shared_ptr<HostTcpConnection> connection) : conn(connection) {}
+    uint8_t connected() { return conn && !conn->closed; }
+    operator bool() { return connected(); }
+    int available();
+    int read();
+    int read(uint8_t* buffer, size_t size);
+    // 发送窗口剩余字节数；超出窗口的写入在真实硬件上会阻塞等待确认，替身只接受窗口内的部分
+    size_t availableForWrite();
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    size_t write_P(PGM_P buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+    void setNoDelay(bool noDelay) { (void)noDelay; }
+    bool stop(unsigned int maxWaitMs = 0);
+private:
+    std::shared_ptr<HostTcpConnection> conn;
+};
+
+class WiFiServer {
+public:
+    explicit WiFiServer(uint16_t port) : _port(port) {}
+    void begin();
+    void stop();
+    bool hasClient();
+    WiFiClient accept();
+private:
+    uint16_t _port;
+};
+
+#endif // HOST_ESP8266WIFI_H
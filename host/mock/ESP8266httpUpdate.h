@@ -0,0 +1,61 @@
+/**
+ * @file ESP8266httpUpdate.h
+ * @brief 固件更新对象（Update）的主机替身
+ *
+ * 只统计写入的字节数，不会真正写入闪存
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_ESP8266HTTPUPDATE_H
+#define HOST_ESP8266HTTPUPDATE_H
+
+#include <Arduino.h>
+
+#define UPDATE_ERROR_OK 0
+#define UPDATE_ERROR_SPACE 4
+#define UPDATE_ERROR_ABORT 9
+
+class UpdaterClass {
+public:
+    bool begin(size_t size) {
+        _size = size;
+        _progress = 0;
+        _error = (size == 0) ? UPDATE_ERROR_SPACE : UPDATE_ERROR_OK;
+        _running = !_error;
+        return _running;
+    }
+    size_t write(const uint8_t* data, size_t len) {
+        (void)data;
+        if (!_running || _progress + len > _size) {
+            _error = UPDATE_ERROR_SPACE;
+            return 0;
+        }
+        _progress += len;
+        return len;
+    }
+    bool end(bool evenIfRemaining = false) {
+        bool ok = _running && !_error && (evenIfRemaining || _progress == _size);
+        if (!evenIfRemaining && _progress != _size) _error = UPDATE_ERROR_ABORT;
+        _running = false;
+        return ok;
+    }
+    size_t size() const { return _size; }
+    size_t progress() const { return _progress; }
+    bool hasError() const { return _error != UPDATE_ERROR_OK; }
+    uint8_t getError() const { return _error; }
+    void printError(Print& out) { out.printf("Update error %u\n", _error); }
+    bool isRunning() const { return _running; }
+
+private:
+    size_t _size = 0;
+    size_t _progress = 0;
+    uint8_t _error = UPDATE_ERROR_OK;
+    bool _running = false;
+};
+
+inline UpdaterClass Update;
+
+#endif // HOST_ESP8266HTTPUPDATE_H
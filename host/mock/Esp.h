@@ -0,0 +1,50 @@
+/**
+ * @file Esp.h
+ * @brief ESP对象（EspClass）的主机替身
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_ESP_H
+#define HOST_ESP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "WString.h"
+
+class EspClass {
+public:
+    void wdtEnable(uint32_t timeoutMs = 0);
+    void wdtDisable();
+    void wdtFeed();
+
+    void restart();
+    void reset();
+    void deepSleep(uint64_t timeUs);
+
+    uint32_t getChipId();
+    uint32_t getFreeHeap();
+    uint32_t getMaxFreeBlockSize();
+    uint8_t getHeapFragmentation();
+    void getHeapStats(uint32_t* freeHeap, uint32_t* maxBlock, uint8_t* fragmentation);
+    uint32_t getFlashChipSize();
+    uint32_t getFlashChipRealSize();
+    uint32_t getFreeSketchSpace();
+    bool flashEraseSector(uint32_t sector);
+    bool flashWrite(uint32_t address, const uint32_t* data, size_t size);
+    bool flashRead(uint32_t address, uint32_t* data, size_t size);
+    uint32_t getSketchSize();
+    uint8_t getCpuFreqMHz();
+    uint32_t getCycleCount();
+    String getResetReason();
+    String getResetInfo();
+
+    bool rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size);
+    bool rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size);
+};
+
+extern EspClass ESP;
+
+#endif // HOST_ESP_H
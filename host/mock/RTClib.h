@@ -0,0 +1,109 @@
+/**
+ * @file RTClib.h
+ * @brief RTClib（DateTime、TimeSpan、RTC_DS1307）的主机替身
+ *
+ * DateTime与Adafruit RTClib的实现保持一致；RTC_DS1307的走时由虚拟时钟
+ * 按配置的晶振频偏推算，可用于验证漂移补偿
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_RTCLIB_H
+#define HOST_RTCLIB_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define SECONDS_PER_DAY 86400L
+#define SECONDS_FROM_1970_TO_2000 946684800
+
+class TimeSpan;
+
+class DateTime {
+public:
+    DateTime(uint32_t t = SECONDS_FROM_1970_TO_2000);
+    DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0, uint8_t min = 0, uint8_t sec = 0);
+    DateTime(const DateTime& copy) = default;
+    DateTime& operator=(const DateTime& other) = default;
+    DateTime(const char* date, const char* time);
+    DateTime(const __FlashStringHelper* date, const __FlashStringHelper* time)
+        : DateTime(reinterpret_cast<const char*>(date), reinterpret_cast<const char*>(time)) {}
+
+    bool isValid() const;
+    uint16_t year() const { return 2000U + yOff; }
+    uint8_t month() const { return m; }
+    uint8_t day() const { return d; }
+    uint8_t hour() const { return hh; }
+    uint8_t twelveHour() const { return hh == 0 || hh == 12 ? 12 : hh % 12; }
+    uint8_t isPM() const { return hh >= 12; }
+    uint8_t minute() const { return mm; }
+    uint8_t second() const { return ss; }
+    uint8_t dayOfTheWeek() const;
+    uint32_t secondstime() const;
+    uint32_t unixtime() const;
+
+    DateTime operator+(const TimeSpan& span) const;
+    DateTime operator-(const TimeSpan& span) const;
+    TimeSpan operator-(const DateTime& right) const;
+    bool operator<(const DateTime& right) const { return unixtime() < right.unixtime(); }
+    bool operator>(const DateTime& right) const { return right < *this; }
+    bool operator<=(const DateTime& right) const { return !(*this > right); }
+    bool operator>=(const DateTime& right) const { return !(*this < right); }
+    bool operator==(const DateTime& right) const { return unixtime() == right.unixtime(); }
+    bool operator!=(const DateTime& right) const { return !(*this == right); }
+
+protected:
+    uint8_t yOff;
+    uint8_t m;
+    uint8_t d;
+    uint8_t hh;
+    uint8_t mm;
+    uint8_t ss;
+};
+
+class TimeSpan {
+public:
+    TimeSpan(int32_t seconds = 0) : _seconds(seconds) {}
+    TimeSpan(int16_t days, int8_t hours, int8_t minutes, int8_t seconds)
+        : _seconds((int32_t)days * 86400L + (int32_t)hours * 3600 + (int32_t)minutes * 60 + seconds) {}
+    int16_t days() const { return _seconds / 86400L; }
+    int8_t hours() const { return _seconds / 3600 % 24; }
+    int8_t minutes() const { return _seconds / 60 % 60; }
+    int8_t seconds() const { return _seconds % 60; }
+    int32_t totalseconds() const { return _seconds; }
+    TimeSpan operator+(const TimeSpan& right) const { return TimeSpan(_seconds + right._seconds); }
+    TimeSpan operator-(const TimeSpan& right) const { return TimeSpan(_seconds - right._seconds); }
+
+protected:
+    int32_t _seconds;
+};
+
+enum Ds1307SqwPinMode {
+    DS1307_OFF = 0x00,
+    DS1307_ON = 0x80,
+    DS1307_SquareWave1HZ = 0x10,
+    DS1307_SquareWave4kHz = 0x11,
+    DS1307_SquareWave8kHz = 0x12,
+    DS1307_SquareWave32kHz = 0x13
+};
+
+class RTC_DS1307 {
+public:
+    bool begin();
+    void adjust(const DateTime& dt);
+    uint8_t isrunning();
+    DateTime now();
+    Ds1307SqwPinMode readSqwPinMode() { return sqwMode; }
+    void writeSqwPinMode(Ds1307SqwPinMode mode) { sqwMode = mode; }
+    uint8_t readnvram(uint8_t address);
+    void readnvram(uint8_t* buf, uint8_t size, uint8_t address);
+    void writenvram(uint8_t address, uint8_t data);
+    void writenvram(uint8_t address, const uint8_t* buf, uint8_t size);
+
+private:
+    Ds1307SqwPinMode sqwMode = DS1307_OFF;
+};
+
+#endif // HOST_RTCLIB_H
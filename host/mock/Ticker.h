@@ -0,0 +1,34 @@
+/**
+ * @file Ticker.h
+ * @brief Ticker定时器的主机替身（只记录配置，不会触发回调）
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_TICKER_H
+#define HOST_TICKER_H
+
+#include <Arduino.h>
+
+class Ticker {
+public:
+    typedef void (*callback_t)(void);
+
+    void attach(float seconds, callback_t callback) { attach_ms((uint32_t)(seconds * 1000), callback); }
+    void attach_ms(uint32_t milliseconds, callback_t callback) {
+        _intervalMs = milliseconds;
+        _callback = callback;
+    }
+    void once(float seconds, callback_t callback) { attach(seconds, callback); }
+    void once_ms(uint32_t milliseconds, callback_t callback) { attach_ms(milliseconds, callback); }
+    void detach() { _callback = nullptr; }
+    bool active() const { return _callback != nullptr; }
+
+private:
+    uint32_t _intervalMs = 0;
+    callback_t _callback = nullptr;
+};
+
+#endif // HOST_TICKER_H
@@ -0,0 +1,122 @@
+/**
+ * @file U8g2lib.h
+ * @brief U8g2（SSD1306 128x64全缓冲模式）的主机替身
+ *
+ * 帧缓冲布局与真实库一致：8页×128字节，每字节纵向8个像素，LSB在上。
+ * sendBuffer()/updateDisplayArea()把对应图块复制到模拟的面板显存并统计
+ * 传输字节数，测试可以直接比较面板内容和帧缓冲。
+ *
+ * 字体只模拟度量：每个字体给出上升/下降高度和数字、ASCII、中文、冒号的
+ * 步进宽度，字形墨迹宽度为步进减1，像素图案由码点确定性生成
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_U8G2LIB_H
+#define HOST_U8G2LIB_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define U8X8_PIN_NONE 255
+#define U8G2_DRAW_UPPER_RIGHT 0x01
+#define U8G2_DRAW_UPPER_LEFT 0x02
+#define U8G2_DRAW_LOWER_LEFT 0x04
+#define U8G2_DRAW_LOWER_RIGHT 0x08
+#define U8G2_DRAW_ALL (U8G2_DRAW_UPPER_RIGHT | U8G2_DRAW_UPPER_LEFT | U8G2_DRAW_LOWER_RIGHT | U8G2_DRAW_LOWER_LEFT)
+
+struct u8g2_cb_t {
+    uint8_t rotation;
+};
+extern const u8g2_cb_t u8g2_cb_r0;
+#define U8G2_R0 (&u8g2_cb_r0)
+
+// 模拟字体：{上升高度, 下降高度(负值), 数字步进, ASCII步进, 中文步进, 冒号步进}
+extern const uint8_t u8g2_font_logisoso26_tr[];
+extern const uint8_t u8g2_font_logisoso18_tr[];
+extern const uint8_t u8g2_font_wqy12_t_gb2312[];
+extern const uint8_t u8g2_font_wqy16_t_gb2312[];
+extern const uint8_t u8g2_font_unifont_t_chinese3[];
+extern const uint8_t u8g2_font_6x10_tf[];
+
+#define HOST_DISPLAY_WIDTH 128
+#define HOST_DISPLAY_HEIGHT 64
+#define HOST_DISPLAY_BUFFER_SIZE (HOST_DISPLAY_WIDTH * HOST_DISPLAY_HEIGHT / 8)
+
+class U8G2 {
+public:
+    explicit U8G2(const u8g2_cb_t* rotation) { (void)rotation; }
+
+    bool begin();
+    void clearBuffer() { memset(buffer, 0, sizeof(buffer)); }
+    void sendBuffer();
+    void updateDisplayArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th);
+    void clearDisplay() { clearBuffer(); sendBuffer(); }
+    void clear() { clearDisplay(); }
+
+    uint8_t* getBufferPtr() { return buffer; }
+    uint8_t getBufferTileWidth() const { return HOST_DISPLAY_WIDTH / 8; }
+    uint8_t getBufferTileHeight() const { return HOST_DISPLAY_HEIGHT / 8; }
+    uint16_t getDisplayWidth() const { return HOST_DISPLAY_WIDTH; }
+    uint16_t getDisplayHeight() const { return HOST_DISPLAY_HEIGHT; }
+
+    void setFont(const uint8_t* f) { font = f; }
+    void setFontMode(uint8_t mode) { (void)mode; }
+    void setDrawColor(uint8_t color) { drawColor = color; }
+    int8_t getAscent() const { return font ? (int8_t)font[0] : 0; }
+    int8_t getDescent() const { return font ? (int8_t)font[1] : 0; }
+    int8_t getMaxCharHeight() const { return getAscent() - getDescent(); }
+
+    uint16_t drawUTF8(int16_t x, int16_t y, const char* str);
+    uint16_t drawStr(int16_t x, int16_t y, const char* str) { return drawUTF8(x, y, str); }
+    uint16_t drawGlyph(int16_t x, int16_t y, uint16_t encoding);
+    uint16_t getUTF8Width(const char* str);
+    uint16_t getStrWidth(const char* str) { return getUTF8Width(str); }
+
+    void drawPixel(int16_t x, int16_t y);
+    void drawHLine(int16_t x, int16_t y, int16_t w);
+    void drawVLine(int16_t x, int16_t y, int16_t h);
+    void drawLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+    void drawBox(int16_t x, int16_t y, int16_t w, int16_t h);
+    void drawFrame(int16_t x, int16_t y, int16_t w, int16_t h);
+    void drawRFrame(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r);
+    void drawCircle(int16_t x0, int16_t y0, int16_t rad, uint8_t opt = U8G2_DRAW_ALL);
+    void drawDisc(int16_t x0, int16_t y0, int16_t rad, uint8_t opt = U8G2_DRAW_ALL);
+
+    void setContrast(uint8_t value) { contrast = value; }
+    void setPowerSave(uint8_t isEnable) { powerSave = isEnable; }
+
+    // ---- 仅主机端：检查面板状态 ----
+    const uint8_t* hostPanel() const { return panel; }
+    uint32_t hostBytesSent() const { return bytesSent; }
+    void hostResetStats() { bytesSent = 0; }
+    uint8_t hostContrast() const { return contrast; }
+    uint8_t hostPowerSave() const { return powerSave; }
+
+private:
+    uint8_t glyphAdvance(uint16_t encoding) const;
+    void drawCircleSection(int16_t x, int16_t y, int16_t x0, int16_t y0, uint8_t opt);
+
+    uint8_t buffer[HOST_DISPLAY_BUFFER_SIZE] = {0};
+    uint8_t panel[HOST_DISPLAY_BUFFER_SIZE] = {0};
+    const uint8_t* font = nullptr;
+    uint8_t drawColor = 1;
+    uint8_t contrast = 255;
+    uint8_t powerSave = 0;
+    uint32_t bytesSent = 0;
+};
+
+class U8G2_SSD1306_128X64_NONAME_F_HW_I2C : public U8G2 {
+public:
+    U8G2_SSD1306_128X64_NONAME_F_HW_I2C(const u8g2_cb_t* rotation, uint8_t reset = U8X8_PIN_NONE,
+                                         uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE)
+        : U8G2(rotation) {
+        (void)reset;
+        (void)clock;
+        (void)data;
+    }
+};
+
+#endif // HOST_U8G2LIB_H
@@ -0,0 +1,108 @@
+/**
+ * @file WString.h
+ * @brief Arduino String类的主机替身（基于std::string）
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+#include <string>
+#include <stdint.h>
+
+class __FlashStringHelper;
+
+class String {
+public:
+    String(const char* cstr = "") : s(cstr ? cstr : "") {}
+    String(const char* cstr, unsigned int length) : s(cstr, length) {}
+    String(const __FlashStringHelper* str) : s(reinterpret_cast<const char*>(str)) {}
+    String(const String& other) = default;
+    String(String&& other) = default;
+    explicit String(char c) : s(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10) : s(format((unsigned long)value, base)) {}
+    explicit String(int value, unsigned char base = 10) : s(formatSigned(value, base)) {}
+    explicit String(unsigned int value, unsigned char base = 10) : s(format(value, base)) {}
+    explicit String(long value, unsigned char base = 10) : s(formatSigned(value, base)) {}
+    explicit String(unsigned long value, unsigned char base = 10) : s(format(value, base)) {}
+    explicit String(float value, unsigned char decimalPlaces = 2) : s(formatFloat(value, decimalPlaces)) {}
+    explicit String(double value, unsigned char decimalPlaces = 2) : s(formatFloat(value, decimalPlaces)) {}
+
+    String& operator=(const String& rhs) = default;
+    String& operator=(String&& rhs) = default;
+    String& operator=(const char* cstr) { s = cstr ? cstr : ""; return *this; }
+
+    unsigned int length() const { return (unsigned int)s.size(); }
+    bool isEmpty() const { return s.empty(); }
+    const char* c_str() const { return s.c_str(); }
+    bool reserve(unsigned int size) { s.reserve(size); return true; }
+
+    bool concat(const String& str) { s += str.s; return true; }
+    bool concat(const char* cstr) { if (cstr) s += cstr; return true; }
+    bool concat(char c) { s += c; return true; }
+    bool concat(int num) { s += formatSigned(num, 10); return true; }
+    bool concat(unsigned int num) { s += format(num, 10); return true; }
+    bool concat(long num) { s += formatSigned(num, 10); return true; }
+    bool concat(unsigned long num) { s += format(num, 10); return true; }
+
+    String& operator+=(const String& rhs) { concat(rhs); return *this; }
+    String& operator+=(const char* cstr) { concat(cstr); return *this; }
+    String& operator+=(char c) { concat(c); return *this; }
+    String& operator+=(int num) { concat(num); return *this; }
+    String& operator+=(unsigned int num) { concat(num); return *this; }
+    String& operator+=(long num) { concat(num); return *this; }
+    String& operator+=(unsigned long num) { concat(num); return *this; }
+
+    bool equals(const String& other) const { return s == other.s; }
+    bool equals(const char* cstr) const { return s == (cstr ? cstr : ""); }
+    bool operator==(const String& rhs) const { return equals(rhs); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& rhs) const { return !equals(rhs); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+    bool startsWith(const String& prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+    bool endsWith(const String& suffix) const {
+        return s.size() >= suffix.s.size() && s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+    }
+
+    char charAt(unsigned int index) const { return index < s.size() ? s[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index) { return s[index]; }
+    void setCharAt(unsigned int index, char c) { if (index < s.size()) s[index] = c; }
+
+    int indexOf(char c, unsigned int from = 0) const { return toIndex(s.find(c, from)); }
+    int indexOf(const String& str, unsigned int from = 0) const { return toIndex(s.find(str.s, from)); }
+    int lastIndexOf(char c) const { return toIndex(s.rfind(c)); }
+
+    String substring(unsigned int beginIndex) const { return substring(beginIndex, length()); }
+    String substring(unsigned int beginIndex, unsigned int endIndex) const {
+        if (beginIndex > endIndex) std::swap(beginIndex, endIndex);
+        if (beginIndex >= s.size()) return String();
+        if (endIndex > s.size()) endIndex = (unsigned int)s.size();
+        return String(s.substr(beginIndex, endIndex - beginIndex).c_str(), endIndex - beginIndex);
+    }
+
+    void trim();
+    void toUpperCase();
+    void toLowerCase();
+    long toInt() const { return strtol(s.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(s.c_str(), nullptr); }
+    void toCharArray(char* buf, unsigned int bufsize, unsigned int index = 0) const;
+
+    friend String operator+(const String& lhs, const String& rhs) { String r(lhs); r += rhs; return r; }
+    friend String operator+(const String& lhs, const char* rhs) { String r(lhs); r += rhs; return r; }
+    friend String operator+(const char* lhs, const String& rhs) { String r(lhs); r += rhs; return r; }
+    friend String operator+(const String& lhs, char rhs) { String r(lhs); r += rhs; return r; }
+
+private:
+    std::string s;
+
+    static int toIndex(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+    static std::string format(unsigned long value, unsigned char base);
+    static std::string formatSigned(long value, unsigned char base);
+    static std::string formatFloat(double value, unsigned char decimalPlaces);
+};
+
+#endif // HOST_WSTRING_H
@@ -0,0 +1,49 @@
+/**
+ * @file WiFiManager.h
+ * @brief WiFiManager配网库的主机替身
+ *
+ * autoConnect()不开启配置门户，直接返回模拟WiFi的连接状态
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_WIFIMANAGER_H
+#define HOST_WIFIMANAGER_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+class WiFiManagerParameter {
+public:
+    WiFiManagerParameter(const char* id, const char* placeholder, const char* defaultValue, int length)
+        : _id(id), _placeholder(placeholder), _length(length), _value(defaultValue ? defaultValue : "") {}
+    const char* getID() const { return _id; }
+    const char* getPlaceholder() const { return _placeholder; }
+    const char* getValue() const { return _value.c_str(); }
+    int getValueLength() const { return _length; }
+
+private:
+    const char* _id;
+    const char* _placeholder;
+    int _length;
+    String _value;
+};
+
+class WiFiManager {
+public:
+    void setTimeout(unsigned long seconds) { setConfigPortalTimeout(seconds); }
+    void setConfigPortalTimeout(unsigned long seconds) { (void)seconds; }
+    void setConnectTimeout(unsigned long seconds) { (void)seconds; }
+    void setDebugOutput(bool debug) { (void)debug; }
+    bool addParameter(WiFiManagerParameter* p) { (void)p; return true; }
+    bool autoConnect(const char* apName = nullptr, const char* apPassword = nullptr) {
+        (void)apName;
+        (void)apPassword;
+        return WiFi.status() == WL_CONNECTED;
+    }
+    void resetSettings() { WiFi.disconnect(); }
+};
+
+#endif // HOST_WIFIMANAGER_H
@@ -0,0 +1,78 @@
+/**
+ * @file WiFiUdp.h
+ * @brief WiFiUDP的主机替身
+ *
+ * 发往123端口的数据包由内置的模拟NTP服务器按配置的时延和时钟偏差应答，
+ * 应答在虚拟时钟到达送达时刻后才能被parsePacket()取到
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_WIFIUDP_H
+#define HOST_WIFIUDP_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+class UDP : public Print {
+public:
+    virtual uint8_t begin(uint16_t port) = 0;
+    virtual void stop() = 0;
+    virtual int beginPacket(const char* host, uint16_t port) = 0;
+    virtual int beginPacket(IPAddress ip, uint16_t port) = 0;
+    virtual int endPacket() = 0;
+    virtual int parsePacket() = 0;
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int read(unsigned char* buffer, size_t len) = 0;
+    int read(char* buffer, size_t len) { return read((unsigned char*)buffer, len); }
+    virtual IPAddress remoteIP() = 0;
+    virtual uint16_t remotePort() = 0;
+};
+
+class WiFiUDP : public UDP {
+public:
+    uint8_t begin(uint16_t port) override;
+    void stop() override;
+    int beginPacket(const char* host, uint16_t port) override;
+    int beginPacket(IPAddress ip, uint16_t port) override;
+    int endPacket() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int parsePacket() override;
+    int available() override;
+    int read() override;
+    int read(unsigned char* buffer, size_t len) override;
+    using UDP::read;
+    void flush() override;
+    IPAddress remoteIP() override { return rxRemoteIp; }
+    uint16_t remotePort() override { return rxRemotePort; }
+
+    static void stopAll() {}
+
+private:
+    struct Packet {
+        uint64_t deliverAtMicros;
+        IPAddress remoteIp;
+        uint16_t remotePort;
+        std::vector<uint8_t> data;
+    };
+
+    bool open = false;
+    std::string txHost;
+    uint16_t txPort = 0;
+    std::vector<uint8_t> txBuffer;
+    std::deque<Packet> rxQueue;
+    std::vector<uint8_t> rxBuffer;
+    size_t rxPos = 0;
+    IPAddress rxRemoteIp;
+    uint16_t rxRemotePort = 0;
+};
+
+#endif // HOST_WIFIUDP_H
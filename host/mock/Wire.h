@@ -0,0 +1,40 @@
+/**
+ * @file Wire.h
+ * @brief I2C总线（TwoWire）的主机替身
+ *
+ * 只模拟设备是否应答；读取寄存器返回0。传输的字节数计入统计，
+ * 供显示刷新等带宽相关测试使用
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+    void begin() {}
+    void begin(int sda, int scl) { (void)sda; (void)scl; }
+    void setClock(uint32_t frequency);
+    void beginTransmission(uint8_t address);
+    void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+    uint8_t endTransmission(bool sendStop = true);
+    size_t write(uint8_t data);
+    size_t write(const uint8_t* data, size_t quantity);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity);
+    uint8_t requestFrom(int address, int quantity) { return requestFrom((uint8_t)address, (uint8_t)quantity); }
+    int available() { return rxAvailable; }
+    int read();
+
+private:
+    uint8_t txAddress = 0;
+    int rxAvailable = 0;
+};
+
+extern TwoWire Wire;
+
+#endif // HOST_WIRE_H
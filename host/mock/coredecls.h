@@ -0,0 +1,27 @@
+/**
+ * @file coredecls.h
+ * @brief ESP8266核心调度接口（esp_delay/esp_schedule）的主机替身
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_COREDECLS_H
+#define HOST_COREDECLS_H
+
+#include <Arduino.h>
+
+// 唤醒在esp_delay()中挂起的主循环（可在中断中调用）
+void esp_schedule();
+
+// 挂起主循环直到超时或blocked()返回false。设备上由esp_schedule()唤醒后重新检查条件，
+// 替身按1ms推进虚拟时间，相当于中断后立即唤醒
+template <typename T>
+inline void esp_delay(uint32_t timeout_ms, T&& blocked) {
+    for (uint32_t waited = 0; waited < timeout_ms && blocked(); waited++) {
+        delay(1);
+    }
+}
+
+#endif // HOST_COREDECLS_H
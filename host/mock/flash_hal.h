@@ -0,0 +1,31 @@
+/**
+ * @file flash_hal.h
+ * @brief ESP8266核心flash_hal.h的主机替身
+ *
+ * 只提供文件系统区的位置和扇区大小。模拟的文件系统区只有HOST_FS_SECTORS个扇区，
+ * 经ESP.flashRead()/flashWrite()/flashEraseSector()访问。
+ * 与核心一样，FS_PHYS_ADDR/FS_PHYS_SIZE经外部符号_FS_start/_FS_end得出，
+ * 不是常量表达式，依赖它们为常量的代码在主机端同样无法编译
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_FLASH_HAL_H
+#define HOST_FLASH_HAL_H
+
+#include <stdint.h>
+
+#define FLASH_SECTOR_SIZE 0x1000
+#define HOST_FS_SECTORS 8
+#define HOST_FS_PHYS_ADDR 0x300000
+
+// 核心中是链接脚本给出的符号（取地址得到位置），这里是在host_peripherals.cpp中定义的变量
+extern "C" const uint32_t _FS_start;
+extern "C" const uint32_t _FS_end;
+
+#define FS_PHYS_ADDR ((uint32_t)_FS_start)
+#define FS_PHYS_SIZE ((uint32_t)(_FS_end - _FS_start))
+
+#endif // HOST_FLASH_HAL_H
@@ -0,0 +1,418 @@
+/**
+ * @file host_core.cpp
+ * @brief Arduino核心替身实现：虚拟时钟、GPIO、串口、String、ESP
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#include <Arduino.h>
+#include <chrono>
+#include <ctype.h>
+#include "host_hardware.h"
+#include "host_state.h"
+#include "coredecls.h"
+#include "user_interface.h"
+
+HostState hostState;
+HardwareSerial Serial;
+EspClass ESP;
+
+// 上电时闪存为全0xFF，其余外设进入默认状态
+static struct HostPowerOn {
+    HostPowerOn() {
+        hostEraseEeprom();
+        hostResetHardware();
+    }
+} hostPowerOn;
+
+void hostResetHardware() {
+    hostState.virtualTime = true;
+    hostState.virtualMicros = 0;
+    hostState.millisOffset = 0;
+    hostState.yieldQuantumUs = 1000;
+    hostState.trueUnixBaseMicros = 1767225600ULL * 1000000ULL;  // 2026-01-01 00:00:00 UTC
+    hostState.crystalDriftPpm = 0.0;
+    hostState.crystalBaseMicros = 0;
+    hostState.crystalBaseLocal = 0;
+    hostResetTimeSpent();
+    hostState.delayCategory = HOST_TIME_DELAY;
+    hostState.delayHook = nullptr;
+
+    for (int i = 0; i < HOST_PIN_COUNT; i++) {
+        hostState.pinLevel[i] = HIGH;
+        hostState.pinHandler[i] = nullptr;
+        hostState.pinHandlerMode[i] = 0;
+    }
+    hostState.interruptsDisabled = 0;
+    hostState.gpioWakeupMask = 0;
+    hostState.gpioWakeupLevel = LOW;
+    hostState.scheduleCount = 0;
+
+    hostState.wifiConnected = true;
+    hostState.wifiRssi = -55;
+    hostState.ntpRequestCount = 0;
+    hostState.dnsLookupCount = 0;
+
+    hostState.rtcPresent = true;
+    hostState.rtcRunning = true;
+    hostState.rtcDriftPpm = 0.0;
+    hostState.rtcBaseMicros = 0;
+    hostState.rtcBaseUnix = 1767225600UL + 8 * 3600;  // RTC保存本地时间
+    hostState.rtcReadCount = 0;
+    memset(hostState.rtcNvram, 0, sizeof(hostState.rtcNvram));
+
+    for (int i = 0; i < 128; i++) hostState.i2cPresent[i] = false;
+    hostState.i2cPresent[0x68] = true;  // DS1307
+    hostState.i2cPresent[0x3C] = true;  // SSD1306
+    hostState.i2cBytes = 0;
+    hostState.i2cClockHz = 100000;
+    hostState.displayDropCount = 0;
+
+    hostState.eepromCommits = 0;
+    hostState.flashErases = 0;
+    hostState.restartCount = 0;
+    hostState.freeHeap = 45000;
+    memset(hostState.rtcUserMemory, 0, sizeof(hostState.rtcUserMemory));
+
+    hostResetNetwork();
+}
+
+// =============================================================================
+// 时钟
+// =============================================================================
+
+static uint64_t realMicros() {
+    static const auto start = std::chrono::steady_clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+static uint64_t nowMicros() {
+    return hostState.virtualTime ? hostState.virtualMicros : realMicros();
+}
+
+// ESP8266晶振计得的微秒数（含频偏），millis()/micros()据此计时
+static uint64_t localMicros() {
+    uint64_t now = nowMicros();
+    if (now < hostState.crystalBaseMicros) return now;  // 基准测试切换到真实时钟
+    uint64_t elapsed = now - hostState.crystalBaseMicros;
+    return hostState.crystalBaseLocal + elapsed + (int64_t)((double)elapsed * hostState.crystalDriftPpm * 1e-6);
+}
+
+void hostSetCrystalDriftPpm(double ppm) {
+    hostState.crystalBaseLocal = localMicros();
+    hostState.crystalBaseMicros = nowMicros();
+    hostState.crystalDriftPpm = ppm;
+}
+
+void hostSetVirtualTime(bool enabled) { hostState.virtualTime = enabled; }
+bool hostIsVirtualTime() { return hostState.virtualTime; }
+void hostAdvanceMicros(uint64_t us) { hostState.virtualMicros += us; }
+void hostAdvanceMillis(uint32_t ms) { hostState.virtualMicros += (uint64_t)ms * 1000; }
+void hostSetYieldQuantumMicros(uint32_t us) { hostState.yieldQuantumUs = us; }
+void hostSetDelayHook(void (*hook)()) { hostState.delayHook = hook; }
+uint64_t hostElapsedMicros() { return nowMicros(); }
+
+void hostSetMillis(uint32_t ms) {
+    hostState.millisOffset = ms - (uint32_t)(localMicros() / 1000);
+}
+
+void hostSetTrueUnixTime(uint32_t unixTime) {
+    hostState.trueUnixBaseMicros = (uint64_t)unixTime * 1000000ULL - nowMicros();
+}
+
+uint64_t hostGetTrueUnixMicros() {
+    return hostState.trueUnixBaseMicros + nowMicros();
+}
+
+uint32_t hostGetTrueUnixTime() {
+    return (uint32_t)(hostGetTrueUnixMicros() / 1000000ULL);
+}
+
+unsigned long millis() {
+    return (uint32_t)(localMicros() / 1000) + hostState.millisOffset;
+}
+
+unsigned long micros() {
+    return (uint32_t)(localMicros() + (uint64_t)hostState.millisOffset * 1000);
+}
+
+void delay(unsigned long ms) {
+    hostConsumeMicros((HostTimeCategory)hostState.delayCategory, (uint64_t)ms * 1000);
+    // 只对固件自己的delay()回调，外设模拟内部的等待不触发
+    if (hostState.delayHook && hostState.delayCategory == HOST_TIME_DELAY) hostState.delayHook();
+}
+
+void delayMicroseconds(unsigned int us) {
+    hostConsumeMicros((HostTimeCategory)hostState.delayCategory, us);
+}
+
+void yield() {
+    hostConsumeMicros(HOST_TIME_YIELD, hostState.yieldQuantumUs);
+}
+
+// =============================================================================
+// 虚拟时间的去向
+// =============================================================================
+
+static const char* const timeCategoryNames[HOST_TIME_CATEGORY_COUNT] = {
+    "yield", "delay", "ntp wait", "i2c display", "i2c rtc", "flash commit"
+};
+
+const char* hostTimeCategoryName(HostTimeCategory category) {
+    return category < HOST_TIME_CATEGORY_COUNT ? timeCategoryNames[category] : "?";
+}
+
+uint64_t hostGetTimeSpentMicros(HostTimeCategory category) {
+    return category < HOST_TIME_CATEGORY_COUNT ? hostState.timeSpent[category] : 0;
+}
+
+void hostResetTimeSpent() {
+    for (int i = 0; i < HOST_TIME_CATEGORY_COUNT; i++) hostState.timeSpent[i] = 0;
+}
+
+void hostConsumeMicros(HostTimeCategory category, uint64_t us) {
+    if (category < HOST_TIME_CATEGORY_COUNT) hostState.timeSpent[category] += us;
+    if (hostState.virtualTime) hostAdvanceMicros(us);
+}
+
+HostTimeScope::HostTimeScope(HostTimeCategory category)
+    : previous((HostTimeCategory)hostState.delayCategory) {
+    hostState.delayCategory = category;
+}
+
+HostTimeScope::~HostTimeScope() {
+    hostState.delayCategory = previous;
+}
+
+// =============================================================================
+// GPIO与中断
+// =============================================================================
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < HOST_PIN_COUNT && mode == INPUT_PULLUP) {
+        hostState.pinLevel[pin] = HIGH;
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < HOST_PIN_COUNT ? hostState.pinLevel[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < HOST_PIN_COUNT) hostState.pinLevel[pin] = value ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin) {
+    (void)pin;
+    return 0;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode) {
+    if (interrupt < HOST_PIN_COUNT) {
+        hostState.pinHandler[interrupt] = handler;
+        hostState.pinHandlerMode[interrupt] = mode;
+    }
+}
+
+void detachInterrupt(uint8_t interrupt) {
+    if (interrupt < HOST_PIN_COUNT) hostState.pinHandler[interrupt] = nullptr;
+}
+
+void noInterrupts() { hostState.interruptsDisabled++; }
+void interrupts() { if (hostState.interruptsDisabled > 0) hostState.interruptsDisabled--; }
+
+void hostSetPinLevel(uint8_t pin, int level) {
+    if (pin >= HOST_PIN_COUNT) return;
+    int old = hostState.pinLevel[pin];
+    hostState.pinLevel[pin] = level ? HIGH : LOW;
+    if (old == hostState.pinLevel[pin] || hostState.pinHandler[pin] == nullptr) return;
+
+    // 设为浅睡眠唤醒源的引脚按电平触发，不论注册的中断类型
+    if (hostState.gpioWakeupMask & (1UL << pin)) {
+        if (hostState.pinLevel[pin] == hostState.gpioWakeupLevel) hostState.pinHandler[pin]();
+        return;
+    }
+    int mode = hostState.pinHandlerMode[pin];
+    bool rising = (old == LOW);
+    if (mode == CHANGE || (mode == RISING && rising) || (mode == FALLING && !rising)) {
+        hostState.pinHandler[pin]();
+    }
+}
+
+void wifi_enable_gpio_wakeup(uint32_t i, GPIO_INT_TYPE intr_status) {
+    if (i >= HOST_PIN_COUNT) return;
+    hostState.gpioWakeupMask |= 1UL << i;
+    hostState.gpioWakeupLevel = (intr_status == GPIO_PIN_INTR_HILEVEL) ? HIGH : LOW;
+}
+
+void wifi_disable_gpio_wakeup(void) {
+    hostState.gpioWakeupMask = 0;
+}
+
+uint32_t hostGetGpioWakeupMask() { return hostState.gpioWakeupMask; }
+
+void esp_schedule() { hostState.scheduleCount++; }
+
+uint32_t hostGetScheduleCount() { return hostState.scheduleCount; }
+
+int hostGetPinLevel(uint8_t pin) {
+    return pin < HOST_PIN_COUNT ? hostState.pinLevel[pin] : LOW;
+}
+
+// =============================================================================
+// 随机数（固定种子，保证可重复）
+// =============================================================================
+
+static uint32_t randomState = 1;
+
+void randomSeed(unsigned long seed) { randomState = seed ? (uint32_t)seed : 1; }
+
+long random(long howBig) {
+    if (howBig <= 0) return 0;
+    randomState = randomState * 1103515245u + 12345u;
+    return (long)((randomState >> 1) % (uint32_t)howBig);
+}
+
+long random(long howSmall, long howBig) {
+    if (howSmall >= howBig) return howSmall;
+    return howSmall + random(howBig - howSmall);
+}
+
+// =============================================================================
+// Print / Serial
+// =============================================================================
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    if (len >= (int)sizeof(buffer)) len = sizeof(buffer) - 1;
+    return write((const uint8_t*)buffer, (size_t)len);
+}
+
+int HardwareSerial::available() { return 0; }
+int HardwareSerial::read() { return -1; }
+int HardwareSerial::peek() { return -1; }
+
+size_t HardwareSerial::write(uint8_t c) {
+    fputc(c, stdout);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush() { fflush(stdout); }
+
+// =============================================================================
+// String
+// =============================================================================
+
+std::string String::format(unsigned long value, unsigned char base) {
+    if (base < 2 || base > 36) base = 10;
+    char buf[8 * sizeof(unsigned long) + 1];
+    char* p = buf + sizeof(buf) - 1;
+    *p = '\0';
+    do {
+        unsigned digit = value % base;
+        *--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+        value /= base;
+    } while (value);
+    return std::string(p);
+}
+
+std::string String::formatSigned(long value, unsigned char base) {
+    if (value < 0 && base == 10) return "-" + format((unsigned long)(-value), base);
+    return format((unsigned long)value, base);
+}
+
+std::string String::formatFloat(double value, unsigned char decimalPlaces) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+    return std::string(buf);
+}
+
+void String::trim() {
+    size_t begin = 0;
+    while (begin < s.size() && isspace((unsigned char)s[begin])) begin++;
+    size_t end = s.size();
+    while (end > begin && isspace((unsigned char)s[end - 1])) end--;
+    s = s.substr(begin, end - begin);
+}
+
+void String::toUpperCase() {
+    for (auto& c : s) c = (char)toupper((unsigned char)c);
+}
+
+void String::toLowerCase() {
+    for (auto& c : s) c = (char)tolower((unsigned char)c);
+}
+
+void String::toCharArray(char* buf, unsigned int bufsize, unsigned int index) const {
+    if (!buf || bufsize == 0) return;
+    size_t n = 0;
+    while (index + n < s.size() && n + 1 < bufsize) {
+        buf[n] = s[index + n];
+        n++;
+    }
+    buf[n] = '\0';
+}
+
+// =============================================================================
+// ESP
+// =============================================================================
+
+void EspClass::wdtEnable(uint32_t timeoutMs) { (void)timeoutMs; }
+void EspClass::wdtDisable() {}
+void EspClass::wdtFeed() {}
+void EspClass::restart() { hostState.restartCount++; }
+void EspClass::reset() { hostState.restartCount++; }
+void EspClass::deepSleep(uint64_t timeUs) { hostAdvanceMicros(timeUs); }
+
+uint32_t EspClass::getChipId() { return 0x00C0FFEE; }
+uint32_t EspClass::getFreeHeap() { return hostState.freeHeap; }
+uint32_t EspClass::getMaxFreeBlockSize() { return hostState.freeHeap * 9 / 10; }
+uint8_t EspClass::getHeapFragmentation() { return 10; }
+
+void EspClass::getHeapStats(uint32_t* freeHeap, uint32_t* maxBlock, uint8_t* fragmentation) {
+    if (freeHeap) *freeHeap = getFreeHeap();
+    if (maxBlock) *maxBlock = getMaxFreeBlockSize();
+    if (fragmentation) *fragmentation = getHeapFragmentation();
+}
+
+uint32_t EspClass::getFlashChipSize() { return 4194304; }
+uint32_t EspClass::getFlashChipRealSize() { return 4194304; }
+uint32_t EspClass::getFreeSketchSpace() { return 1044480; }
+uint32_t EspClass::getSketchSize() { return 520000; }
+uint8_t EspClass::getCpuFreqMHz() { return 80; }
+uint32_t EspClass::getCycleCount() { return (uint32_t)(localMicros() * 80); }
+String EspClass::getResetReason() { return String("Power On"); }
+String EspClass::getResetInfo() { return getResetReason(); }
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size) {
+    if (offset * 4 + size > HOST_RTC_USER_MEMORY_SIZE || size % 4 != 0) return false;
+    memcpy(data, &hostState.rtcUserMemory[offset], size);
+    return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size) {
+    if (offset * 4 + size > HOST_RTC_USER_MEMORY_SIZE || size % 4 != 0) return false;
+    memcpy(&hostState.rtcUserMemory[offset], data, size);
+    return true;
+}
+
+uint32_t hostGetRestartCount() { return hostState.restartCount; }
+void hostSetFreeHeap(uint32_t freeHeap) { hostState.freeHeap = freeHeap; }
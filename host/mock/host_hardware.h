@@ -0,0 +1,158 @@
+/**
+ * @file host_hardware.h
+ * @brief 主机构建的模拟硬件控制接口
+ *
+ * 测试与基准程序通过这些函数控制虚拟时钟、按键电平、WiFi/NTP网络、
+ * RTC芯片、EEPROM闪存等模拟外设，并读取各外设的访问计数
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_HARDWARE_H
+#define HOST_HARDWARE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// =============================================================================
+// 整体复位
+// =============================================================================
+
+// 把所有模拟外设恢复到上电默认状态（虚拟时钟归零、WiFi已连接、RTC在线等）
+void hostResetHardware();
+
+// =============================================================================
+// 时钟
+// =============================================================================
+
+// true: 虚拟时钟（默认）；false: millis()/micros()跟随真实单调时钟（基准测试用）
+void hostSetVirtualTime(bool enabled);
+bool hostIsVirtualTime();
+
+void hostAdvanceMicros(uint64_t us);
+void hostAdvanceMillis(uint32_t ms);
+// 把虚拟时钟直接设到指定millis()值（用于测试49.7天回绕）
+void hostSetMillis(uint32_t ms);
+// 自复位以来流逝的虚拟微秒数（不回绕）
+uint64_t hostElapsedMicros();
+// 每次yield()推进的虚拟时间，默认1000us
+void hostSetYieldQuantumMicros(uint32_t us);
+// 固件自己的delay()每推进一次虚拟时间后调用（模拟器借此在loop()空闲期间注入事件），nullptr取消
+void hostSetDelayHook(void (*hook)());
+// ESP8266晶振频偏（ppm，正值表示millis()走快）；虚拟时钟和外设仍按真实时间
+void hostSetCrystalDriftPpm(double ppm);
+
+// 真实世界的UTC时间（NTP服务器据此应答）
+void hostSetTrueUnixTime(uint32_t unixTime);
+uint32_t hostGetTrueUnixTime();
+// 包含小数部分的真实UTC时间（微秒）
+uint64_t hostGetTrueUnixMicros();
+
+// =============================================================================
+// 虚拟时间的去向
+// =============================================================================
+
+// 外设操作按真实硬件的大致耗时推进虚拟时钟，并按类别累计，
+// 模拟器据此报告时间花在了哪些代码路径上
+enum HostTimeCategory {
+    HOST_TIME_YIELD = 0,     // yield()让出给后台
+    HOST_TIME_DELAY,         // 固件主动delay()
+    HOST_TIME_NTP_WAIT,      // 阻塞等待NTP应答
+    HOST_TIME_I2C_DISPLAY,   // OLED帧传输（400kHz）
+    HOST_TIME_I2C_RTC,       // DS1307读写（Wire时钟）
+    HOST_TIME_FLASH,         // EEPROM提交和闪存扇区擦写
+    HOST_TIME_CATEGORY_COUNT
+};
+
+const char* hostTimeCategoryName(HostTimeCategory category);
+uint64_t hostGetTimeSpentMicros(HostTimeCategory category);
+void hostResetTimeSpent();
+// 模拟一次耗时操作：推进虚拟时钟并计入指定类别（真实时钟模式下只计数）
+void hostConsumeMicros(HostTimeCategory category, uint64_t us);
+
+// 作用域内的delay()计入指定类别，离开作用域时恢复
+class HostTimeScope {
+public:
+    explicit HostTimeScope(HostTimeCategory category);
+    ~HostTimeScope();
+private:
+    HostTimeCategory previous;
+};
+
+// =============================================================================
+// GPIO
+// =============================================================================
+
+void hostSetPinLevel(uint8_t pin, int level);
+int hostGetPinLevel(uint8_t pin);
+// 当前设为浅睡眠唤醒源的引脚（按位）
+uint32_t hostGetGpioWakeupMask();
+// esp_schedule()被调用的次数（中断唤醒空闲的主循环）
+uint32_t hostGetScheduleCount();
+
+// =============================================================================
+// 网络
+// =============================================================================
+
+void hostSetWifiConnected(bool connected);
+bool hostIsWifiConnected();
+void hostSetWifiRssi(int rssi);
+
+// 配置某个NTP服务器的行为；name为nullptr时设置所有服务器的默认行为
+// offsetMs: 服务器时钟相对真实时间的偏差；rttMs: 往返时延（对称）
+void hostSetNtpServer(const char* name, bool reachable, uint32_t rttMs, int32_t offsetMs);
+// 给去程加上0~jitterMs的随机排队时延（模拟拥塞的WiFi）；name为nullptr时设置默认行为
+void hostSetNtpJitter(const char* name, uint32_t jitterMs);
+// 让服务器回应Kiss-o'-Death（stratum 0 + 参考ID，如"RATE"）；code为nullptr取消
+void hostSetNtpKissCode(const char* name, const char* code);
+uint32_t hostGetNtpRequestCount();
+
+// DNS：解析结果在latencyMs之后经回调送达（默认30ms）；不可解析的名字回调得到失败
+void hostSetDnsLatency(uint32_t latencyMs);
+void hostSetDnsResolvable(const char* name, bool resolvable);
+uint32_t hostGetDnsLookupCount();
+// 调用已到时刻的DNS回调（WiFi.status()和parsePacket()中自动调用）
+void hostDeliverDnsResults();
+
+// 模拟对端连上port并发送request（可为nullptr）；没有服务器监听或WiFi未连接时返回-1
+int hostTcpConnect(uint16_t port, const char* request);
+// 取走固件已写到连接上的数据（取走即视为对端已确认，腾出发送窗口），返回取走的字节数
+size_t hostTcpReceive(int connection, char* buffer, size_t size);
+// 固件是否已关闭连接
+bool hostTcpIsClosed(int connection);
+// 每条连接的发送窗口（字节），默认2920（lwIP低内存配置的TCP_SND_BUF）
+void hostSetTcpSendWindow(size_t bytes);
+
+// =============================================================================
+// RTC (DS1307)
+// =============================================================================
+
+void hostSetRtcPresent(bool present);
+void hostSetRtcRunning(bool running);
+// RTC晶振频偏（ppm，正值表示走快）
+void hostSetRtcDriftPpm(double ppm);
+void hostSetRtcUnixTime(uint32_t unixTime);
+uint32_t hostGetRtcUnixTime();
+uint32_t hostGetRtcReadCount();
+
+// =============================================================================
+// I2C / EEPROM / ESP
+// =============================================================================
+
+void hostSetI2cDevicePresent(uint8_t address, bool present);
+uint32_t hostGetI2cBytesTransferred();
+// 丢弃接下来count次面板写入（模拟总线故障，U8g2不报告错误）
+void hostDropDisplayTransfers(uint32_t count);
+
+uint32_t hostGetEepromCommitCount();
+// ESP.flashEraseSector()擦除文件系统区扇区的次数
+uint32_t hostGetFlashEraseCount();
+// 模拟全新芯片（闪存全部为0xFF）
+void hostEraseEeprom();
+
+uint32_t hostGetRestartCount();
+void hostSetFreeHeap(uint32_t freeHeap);
+
+#endif // HOST_HARDWARE_H
@@ -0,0 +1,111 @@
+/**
+ * @file host_heap.cpp
+ * @brief operator new/delete的主机替身
+ *
+ * 与ESP8266内核一样经malloc/free分配，使C++对象和String（基于std::string）的分配
+ * 也经过堆分配跟踪的包装函数。标准库自身（共享库中）的malloc调用不经过包装。
+ *
+ * 分配前把调用点告诉堆分配跟踪：沿调用栈跳过共享库、std::和String替身的栈帧，
+ * 取第一个固件栈帧，不同位置构造的String因此归为不同的调用点。
+ * 按符号判断需要可执行文件导出符号（CMakeLists.txt中的-rdynamic）
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <link.h>
+#include "heap_tracer.h"
+
+// 调用栈最多查看的层数
+static const int CALLER_SEARCH_DEPTH = 24;
+
+// 辅助：栈帧属于分配层（共享库、标准库模板实例、String替身、operator new本身）
+static bool isAllocatorFrame(void* address) {
+    static void* executableBase = nullptr;
+    Dl_info info;
+    const ElfW(Sym)* symbol = nullptr;
+    if (dladdr1(address, &info, (void**)&symbol, RTLD_DL_SYMENT) == 0) {
+        return false;
+    }
+    if (executableBase == nullptr) {
+        Dl_info self;
+        if (dladdr((void*)&isAllocatorFrame, &self) != 0) executableBase = self.dli_fbase;
+    }
+    if (info.dli_fbase != executableBase) {
+        return true;
+    }
+    // 未导出的静态函数取到的是前面最近的符号，须确认地址落在该符号范围内
+    if (info.dli_sname == nullptr || symbol == nullptr ||
+        (char*)address >= (char*)info.dli_saddr + symbol->st_size) {
+        return false;
+    }
+    const char* name = info.dli_sname;
+    static const char* const ALLOCATOR_PREFIXES[] = {
+        "_ZNSt", "_ZNKSt", "_ZSt", "_ZN9__gnu_cxx",  // std::和libstdc++内部
+        "_ZN6String", "_ZNK6String", "_ZplRK6String", "_ZplPKcRK6String",  // String替身（含operator+）
+        "_Znw", "_Zna"                               // operator new
+    };
+    for (const char* prefix : ALLOCATOR_PREFIXES) {
+        if (strncmp(name, prefix, strlen(prefix)) == 0) return true;
+    }
+    return false;
+}
+
+// 辅助：从operator new的返回地址起沿调用栈找第一个固件栈帧
+static void* firmwareCaller(void* returnAddress) {
+    if (!isAllocatorFrame(returnAddress)) {
+        return returnAddress;
+    }
+    void* frames[CALLER_SEARCH_DEPTH];
+    int depth = backtrace(frames, CALLER_SEARCH_DEPTH);
+    int i = 0;
+    while (i < depth && frames[i] != returnAddress) i++;
+    for (; i < depth; i++) {
+        if (!isAllocatorFrame(frames[i])) return frames[i];
+    }
+    return returnAddress;
+}
+
+// backtrace()第一次调用时加载libgcc_s并分配内存，在进入main()前先调用一次
+static struct BacktraceWarmup {
+    BacktraceWarmup() {
+        void* frame;
+        backtrace(&frame, 1);
+    }
+} backtraceWarmup;
+
+static void* allocate(size_t size, void* returnAddress) {
+    noteHeapAllocCaller(firmwareCaller(returnAddress));
+    return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size) {
+    void* ptr = allocate(size, __builtin_return_address(0));
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    void* ptr = allocate(size, __builtin_return_address(0));
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size, __builtin_return_address(0));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size, __builtin_return_address(0));
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
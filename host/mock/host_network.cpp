@@ -0,0 +1,471 @@
+/**
+ * @file host_network.cpp
+ * @brief WiFi、WiFiUDP与模拟NTP服务器实现
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+#include <lwip/dns.h>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <set>
+#include <vector>
+#include "host_hardware.h"
+#include "host_state.h"
+#include "heap_tracer.h"
+
+ESP8266WiFiClass WiFi;
+
+// NTP时间戳纪元（1900年）与Unix纪元之差
+static const uint64_t NTP_UNIX_OFFSET = 2208988800ULL;
+
+struct HostNtpServer {
+    bool reachable;
+    uint32_t rttMs;
+    int32_t offsetMs;
+    uint32_t jitterMs;
+    char kissCode[5];
+};
+
+static HostNtpServer defaultNtpServer;
+static std::map<std::string, HostNtpServer> ntpServers;
+static std::map<uint32_t, std::string> resolvedHosts;   // 解析结果的反查表
+
+// 进行中的DNS解析
+struct HostDnsLookup {
+    std::string name;
+    bool found;
+    ip_addr_t addr;
+    dns_found_callback callback;
+    void* arg;
+    uint64_t deliverAtMicros;
+};
+static std::deque<HostDnsLookup> dnsLookups;
+static std::set<std::string> unresolvableHosts;
+static uint32_t dnsLatencyMs = 30;
+static WiFiSleepType_t wifiSleepMode = WIFI_NONE_SLEEP;
+static uint32_t jitterRandomState = 1;   // 独立于固件random()，不影响固件的随机序列
+
+static std::set<uint16_t> listeningPorts;
+static std::map<uint16_t, std::deque<std::shared_ptr<HostTcpConnection>>> pendingConnections;
+static std::vector<std::shared_ptr<HostTcpConnection>> tcpConnections;   // 下标即连接编号
+static size_t tcpSendWindow = 2920;
+
+// 模拟网络栈时的分配不计入堆跟踪：固件中这些缓冲区由lwIP管理，不经malloc
+struct NetworkStackHeap {
+    NetworkStackHeap() { pauseHeapTrace(); }
+    ~NetworkStackHeap() { resumeHeapTrace(); }
+};
+
+void hostResetNetwork() {
+    defaultNtpServer.reachable = true;
+    defaultNtpServer.rttMs = 40;
+    defaultNtpServer.offsetMs = 0;
+    defaultNtpServer.jitterMs = 0;
+    defaultNtpServer.kissCode[0] = '\0';
+    ntpServers.clear();
+    dnsLookups.clear();
+    unresolvableHosts.clear();
+    dnsLatencyMs = 30;
+    jitterRandomState = 1;
+    wifiSleepMode = WIFI_NONE_SLEEP;
+    listeningPorts.clear();
+    pendingConnections.clear();
+    tcpConnections.clear();
+    tcpSendWindow = 2920;
+}
+
+static HostNtpServer& ntpServerFor(const std::string& name) {
+    auto it = ntpServers.find(name);
+    return it != ntpServers.end() ? it->second : defaultNtpServer;
+}
+
+// 取得指定服务器的配置，首次配置时从默认行为复制
+static HostNtpServer& configurableServer(const char* name) {
+    if (name == nullptr) return defaultNtpServer;
+    auto it = ntpServers.find(name);
+    if (it == ntpServers.end()) {
+        it = ntpServers.emplace(name, defaultNtpServer).first;
+    }
+    return it->second;
+}
+
+void hostSetNtpServer(const char* name, bool reachable, uint32_t rttMs, int32_t offsetMs) {
+    HostNtpServer& server = configurableServer(name);
+    server.reachable = reachable;
+    server.rttMs = rttMs;
+    server.offsetMs = offsetMs;
+}
+
+void hostSetNtpJitter(const char* name, uint32_t jitterMs) {
+    configurableServer(name).jitterMs = jitterMs;
+}
+
+void hostSetNtpKissCode(const char* name, const char* code) {
+    HostNtpServer& server = configurableServer(name);
+    if (code) {
+        strncpy(server.kissCode, code, 4);
+        server.kissCode[4] = '\0';
+    } else {
+        server.kissCode[0] = '\0';
+    }
+}
+
+uint32_t hostGetNtpRequestCount() { return hostState.ntpRequestCount; }
+
+int hostTcpConnect(uint16_t port, const char* request) {
+    if (!hostState.wifiConnected || listeningPorts.count(port) == 0) return -1;
+    auto connection = std::make_shared<HostTcpConnection>();
+    if (request) connection->rx = request;
+    pendingConnections[port].push_back(connection);
+    tcpConnections.push_back(connection);
+    return (int)tcpConnections.size() - 1;
+}
+
+size_t hostTcpReceive(int connection, char* buffer, size_t size) {
+    if (connection < 0 || (size_t)connection >= tcpConnections.size()) return 0;
+    std::string& tx = tcpConnections[connection]->tx;
+    size_t n = std::min(size, tx.size());
+    memcpy(buffer, tx.data(), n);
+    tx.erase(0, n);
+    return n;
+}
+
+bool hostTcpIsClosed(int connection) {
+    return connection < 0 || (size_t)connection >= tcpConnections.size() || tcpConnections[connection]->closed;
+}
+
+void hostSetTcpSendWindow(size_t bytes) { tcpSendWindow = bytes; }
+
+void hostSetWifiConnected(bool connected) { hostState.wifiConnected = connected; }
+bool hostIsWifiConnected() { return hostState.wifiConnected; }
+void hostSetWifiRssi(int rssi) { hostState.wifiRssi = rssi; }
+
+// =============================================================================
+// WiFi
+// =============================================================================
+
+wl_status_t ESP8266WiFiClass::status() {
+    hostDeliverDnsResults();
+    return hostState.wifiConnected ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+String ESP8266WiFiClass::SSID() {
+    return hostState.wifiConnected ? String("HostNet") : String();
+}
+
+int32_t ESP8266WiFiClass::RSSI() {
+    return hostState.wifiConnected ? hostState.wifiRssi : 31;
+}
+
+IPAddress ESP8266WiFiClass::localIP() {
+    return hostState.wifiConnected ? IPAddress(192, 168, 1, 50) : IPAddress();
+}
+
+String ESP8266WiFiClass::macAddress() {
+    return String("5C:CF:7F:C0:FF:EE");
+}
+
+bool ESP8266WiFiClass::disconnect(bool wifiOff) {
+    (void)wifiOff;
+    hostState.wifiConnected = false;
+    return true;
+}
+
+bool ESP8266WiFiClass::setSleepMode(WiFiSleepType_t type, uint8_t listenInterval) {
+    (void)listenInterval;
+    wifiSleepMode = type;
+    return true;
+}
+
+WiFiSleepType_t ESP8266WiFiClass::getSleepMode() {
+    return wifiSleepMode;
+}
+
+wl_status_t ESP8266WiFiClass::begin(const char* ssid, const char* passphrase) {
+    (void)ssid;
+    (void)passphrase;
+    return status();
+}
+
+// 辅助：主机名对应的模拟地址（10.x.x.x，由名字散列得到），并记入反查表
+static IPAddress hostAddressFor(const char* host) {
+    uint32_t h = 2166136261u;
+    for (const char* p = host; *p; p++) h = (h ^ (uint8_t)*p) * 16777619u;
+    IPAddress result(10, (uint8_t)(h >> 16), (uint8_t)(h >> 8), (uint8_t)h);
+    resolvedHosts[(uint32_t)result] = host;
+    return result;
+}
+
+int ESP8266WiFiClass::hostByName(const char* host, IPAddress& result) {
+    NetworkStackHeap heapScope;
+    if (!hostState.wifiConnected || host == nullptr || unresolvableHosts.count(host)) return 0;
+    result = hostAddressFor(host);
+    return 1;
+}
+
+// =============================================================================
+// DNS（lwIP异步接口）
+// =============================================================================
+
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg) {
+    NetworkStackHeap heapScope;
+    if (hostname == nullptr || addr == nullptr || found == nullptr) return ERR_ARG;
+
+    HostDnsLookup lookup;
+    lookup.name = hostname;
+    lookup.found = hostState.wifiConnected && !unresolvableHosts.count(hostname);
+    lookup.addr.addr = lookup.found ? (uint32_t)hostAddressFor(hostname) : 0;
+    lookup.callback = found;
+    lookup.arg = callback_arg;
+    lookup.deliverAtMicros = hostElapsedMicros() + (uint64_t)dnsLatencyMs * 1000;
+    dnsLookups.push_back(lookup);
+    hostState.dnsLookupCount++;
+    return ERR_INPROGRESS;
+}
+
+void hostDeliverDnsResults() {
+    uint64_t now = hostElapsedMicros();
+    while (!dnsLookups.empty() && dnsLookups.front().deliverAtMicros <= now) {
+        HostDnsLookup lookup;
+        {
+            NetworkStackHeap heapScope;
+            lookup = dnsLookups.front();
+            dnsLookups.pop_front();
+        }
+        lookup.callback(lookup.name.c_str(), lookup.found ? &lookup.addr : nullptr, lookup.arg);
+    }
+}
+
+void hostSetDnsLatency(uint32_t latencyMs) {
+    dnsLatencyMs = latencyMs;
+}
+
+void hostSetDnsResolvable(const char* name, bool resolvable) {
+    NetworkStackHeap heapScope;
+    if (resolvable) {
+        unresolvableHosts.erase(name);
+    } else {
+        unresolvableHosts.insert(name);
+    }
+}
+
+uint32_t hostGetDnsLookupCount() {
+    return hostState.dnsLookupCount;
+}
+
+// =============================================================================
+// WiFiServer / WiFiClient
+// =============================================================================
+
+void WiFiServer::begin() {
+    NetworkStackHeap heapScope;
+    listeningPorts.insert(_port);
+}
+
+void WiFiServer::stop() {
+    NetworkStackHeap heapScope;
+    listeningPorts.erase(_port);
+    pendingConnections.erase(_port);
+}
+
+bool WiFiServer::hasClient() {
+    auto it = pendingConnections.find(_port);
+    return it != pendingConnections.end() && !it->second.empty();
+}
+
+WiFiClient WiFiServer::accept() {
+    NetworkStackHeap heapScope;
+    if (!hasClient()) return WiFiClient();
+    std::deque<std::shared_ptr<HostTcpConnection>>& queue = pendingConnections[_port];
+    std::shared_ptr<HostTcpConnection> connection = queue.front();
+    queue.pop_front();
+    return WiFiClient(connection);
+}
+
+int WiFiClient::available() {
+    return connected() ? (int)(conn->rx.size() - conn->rxPos) : 0;
+}
+
+int WiFiClient::read() {
+    return available() > 0 ? (uint8_t)conn->rx[conn->rxPos++] : -1;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+    size_t n = std::min(size, (size_t)available());
+    if (n > 0) {
+        memcpy(buffer, conn->rx.data() + conn->rxPos, n);
+        conn->rxPos += n;
+    }
+    return (int)n;
+}
+
+size_t WiFiClient::availableForWrite() {
+    if (!connected()) return 0;
+    return conn->tx.size() < tcpSendWindow ? tcpSendWindow - conn->tx.size() : 0;
+}
+
+size_t WiFiClient::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+    NetworkStackHeap heapScope;
+    size_t n = std::min(size, availableForWrite());
+    if (n > 0) conn->tx.append((const char*)buffer, n);
+    return n;
+}
+
+bool WiFiClient::stop(unsigned int maxWaitMs) {
+    NetworkStackHeap heapScope;
+    (void)maxWaitMs;
+    if (conn) conn->closed = true;
+    conn.reset();
+    return true;
+}
+
+// =============================================================================
+// WiFiUDP
+// =============================================================================
+
+static void writeNtpTimestamp(uint8_t* p, uint64_t unixMicros) {
+    uint64_t secs = unixMicros / 1000000ULL + NTP_UNIX_OFFSET;
+    uint64_t frac = ((unixMicros % 1000000ULL) << 32) / 1000000ULL;
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(secs >> (24 - 8 * i));
+        p[4 + i] = (uint8_t)(frac >> (24 - 8 * i));
+    }
+}
+
+uint8_t WiFiUDP::begin(uint16_t port) {
+    (void)port;
+    open = true;
+    return 1;
+}
+
+void WiFiUDP::stop() {
+    NetworkStackHeap heapScope;
+    open = false;
+    rxQueue.clear();
+    rxBuffer.clear();
+    rxPos = 0;
+}
+
+int WiFiUDP::beginPacket(const char* host, uint16_t port) {
+    NetworkStackHeap heapScope;
+    txHost = host ? host : "";
+    txPort = port;
+    txBuffer.clear();
+    return 1;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+    NetworkStackHeap heapScope;
+    // 按地址发送时还原出解析前的服务器名，使按名称配置的服务器行为仍然生效
+    auto it = resolvedHosts.find((uint32_t)ip);
+    if (it != resolvedHosts.end()) return beginPacket(it->second.c_str(), port);
+    return beginPacket(ip.toString().c_str(), port);
+}
+
+size_t WiFiUDP::write(uint8_t c) {
+    NetworkStackHeap heapScope;
+    txBuffer.push_back(c);
+    return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t* buffer, size_t size) {
+    NetworkStackHeap heapScope;
+    txBuffer.insert(txBuffer.end(), buffer, buffer + size);
+    return size;
+}
+
+int WiFiUDP::endPacket() {
+    NetworkStackHeap heapScope;
+    if (!hostState.wifiConnected) return 0;
+    if (txPort != 123 || txBuffer.size() < 48) return 1;
+
+    hostState.ntpRequestCount++;
+    const HostNtpServer& server = ntpServerFor(txHost);
+    if (!server.reachable) return 1;  // 数据包丢失，永远不会有应答
+
+    uint64_t now = hostElapsedMicros();
+    uint64_t rttUs = (uint64_t)server.rttMs * 1000;
+    // 排队时延只加在去程上，使往返不对称（拥塞WiFi上单个样本的偏差误差来源）
+    uint64_t queueUs = 0;
+    if (server.jitterMs > 0) {
+        jitterRandomState = jitterRandomState * 1103515245u + 12345u;
+        queueUs = (uint64_t)((jitterRandomState >> 1) % (server.jitterMs * 1000 + 1));
+    }
+    uint64_t serverMicros = hostGetTrueUnixMicros() + rttUs / 2 + queueUs + (int64_t)server.offsetMs * 1000;
+
+    Packet reply;
+    reply.deliverAtMicros = now + rttUs + queueUs;
+    WiFi.hostByName(txHost.c_str(), reply.remoteIp);
+    reply.remotePort = 123;
+    reply.data.assign(48, 0);
+    uint8_t* p = reply.data.data();
+    p[0] = 0x24;            // LI=0, VN=4, Mode=4(server)
+    p[1] = 2;               // stratum
+    p[2] = txBuffer[2];     // poll
+    p[3] = 0xEC;            // precision 2^-20
+    if (server.kissCode[0] != '\0') {
+        p[1] = 0;           // Kiss-o'-Death
+        memcpy(p + 12, server.kissCode, 4);
+    } else {
+        p[12] = 'G'; p[13] = 'P'; p[14] = 'S'; p[15] = 0;
+        writeNtpTimestamp(p + 16, serverMicros - 64000000ULL);  // 参考时间戳
+        writeNtpTimestamp(p + 32, serverMicros);                // 接收时间戳
+        writeNtpTimestamp(p + 40, serverMicros);                // 发送时间戳
+    }
+    memcpy(p + 24, txBuffer.data() + 40, 8);                    // 原始时间戳 = 请求的发送时间戳
+    rxQueue.push_back(reply);
+    return 1;
+}
+
+int WiFiUDP::parsePacket() {
+    hostDeliverDnsResults();
+    NetworkStackHeap heapScope;
+    rxBuffer.clear();
+    rxPos = 0;
+    if (!open) return 0;
+
+    // 取已到达的数据包中最早送达的一个（不同服务器时延不同，到达顺序可能与发送顺序不同）
+    uint64_t now = hostElapsedMicros();
+    auto ready = rxQueue.end();
+    for (auto it = rxQueue.begin(); it != rxQueue.end(); ++it) {
+        if (it->deliverAtMicros <= now && (ready == rxQueue.end() || it->deliverAtMicros < ready->deliverAtMicros)) {
+            ready = it;
+        }
+    }
+    if (ready == rxQueue.end()) return 0;
+
+    Packet packet = *ready;
+    rxQueue.erase(ready);
+    rxBuffer = packet.data;
+    rxRemoteIp = packet.remoteIp;
+    rxRemotePort = packet.remotePort;
+    return (int)rxBuffer.size();
+}
+
+int WiFiUDP::available() {
+    return (int)(rxBuffer.size() - rxPos);
+}
+
+int WiFiUDP::read() {
+    return rxPos < rxBuffer.size() ? rxBuffer[rxPos++] : -1;
+}
+
+int WiFiUDP::read(unsigned char* buffer, size_t len) {
+    size_t n = 0;
+    while (n < len && rxPos < rxBuffer.size()) buffer[n++] = rxBuffer[rxPos++];
+    return (int)n;
+}
+
+void WiFiUDP::flush() {
+    rxPos = rxBuffer.size();
+}
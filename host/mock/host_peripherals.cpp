@@ -0,0 +1,163 @@
+/**
+ * @file host_peripherals.cpp
+ * @brief Wire、EEPROM与闪存替身实现
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#include <EEPROM.h>
+#include <Wire.h>
+#include "host_hardware.h"
+#include "host_state.h"
+
+TwoWire Wire;
+EEPROMClass EEPROM;
+
+// =============================================================================
+// Wire
+// =============================================================================
+
+void TwoWire::setClock(uint32_t frequency) {
+    if (frequency > 0) hostState.i2cClockHz = frequency;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    txAddress = address;
+    hostState.i2cBytes++;  // 地址字节
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    (void)sendStop;
+    if (txAddress >= 128 || !hostState.i2cPresent[txAddress]) return 2;  // 地址NACK
+    if (txAddress == 0x68 && !hostState.rtcPresent) return 2;
+    return 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+    (void)data;
+    hostState.i2cBytes++;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t quantity) {
+    (void)data;
+    hostState.i2cBytes += quantity;
+    return quantity;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity) {
+    if (address >= 128 || !hostState.i2cPresent[address]) {
+        rxAvailable = 0;
+        return 0;
+    }
+    hostState.i2cBytes += 1 + quantity;
+    rxAvailable = quantity;
+    return quantity;
+}
+
+int TwoWire::read() {
+    if (rxAvailable <= 0) return -1;
+    rxAvailable--;
+    return 0;
+}
+
+void hostSetI2cDevicePresent(uint8_t address, bool present) {
+    if (address < 128) hostState.i2cPresent[address] = present;
+}
+
+uint32_t hostGetI2cBytesTransferred() { return hostState.i2cBytes; }
+
+void hostDropDisplayTransfers(uint32_t count) { hostState.displayDropCount = count; }
+
+// =============================================================================
+// EEPROM
+// =============================================================================
+
+void EEPROMClass::begin(size_t requested) {
+    if (requested == 0) return;
+    if (requested > HOST_FLASH_SIZE) requested = HOST_FLASH_SIZE;
+    requested = (requested + 3) & ~(size_t)3;
+    size = requested;
+    memcpy(data, hostState.flash, size);
+    dirty = false;
+}
+
+uint8_t EEPROMClass::read(int address) {
+    if (address < 0 || (size_t)address >= size) return 0;
+    return data[address];
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+    if (address < 0 || (size_t)address >= size) return;
+    if (data[address] != value) {
+        data[address] = value;
+        dirty = true;
+    }
+}
+
+bool EEPROMClass::commit() {
+    if (size == 0) return false;
+    if (!dirty) return true;
+    memcpy(hostState.flash, data, size);
+    hostState.eepromCommits++;
+    hostConsumeMicros(HOST_TIME_FLASH, 30000);  // 4KB扇区擦除+写入约30ms
+    dirty = false;
+    return true;
+}
+
+bool EEPROMClass::end() {
+    bool ok = commit();
+    size = 0;
+    return ok;
+}
+
+uint32_t hostGetEepromCommitCount() { return hostState.eepromCommits; }
+uint32_t hostGetFlashEraseCount() { return hostState.flashErases; }
+
+void hostEraseEeprom() {
+    memset(hostState.flash, 0xFF, sizeof(hostState.flash));
+    memset(hostState.fsFlash, 0xFF, sizeof(hostState.fsFlash));
+}
+
+// =============================================================================
+// 闪存（文件系统区）
+// =============================================================================
+
+// 文件系统区的边界（核心中由链接脚本给出）
+const uint32_t _FS_start = HOST_FS_PHYS_ADDR;
+const uint32_t _FS_end = HOST_FS_PHYS_ADDR + HOST_FS_SECTORS * FLASH_SECTOR_SIZE;
+
+// 辅助：地址范围是否落在模拟的文件系统区内且按4字节对齐
+static uint8_t* fsFlashAt(uint32_t address, size_t size) {
+    if ((address & 3) != 0 || (size & 3) != 0) return nullptr;
+    if (address < FS_PHYS_ADDR || address + size > FS_PHYS_ADDR + FS_PHYS_SIZE) return nullptr;
+    return hostState.fsFlash + (address - FS_PHYS_ADDR);
+}
+
+bool EspClass::flashEraseSector(uint32_t sector) {
+    uint8_t* p = fsFlashAt(sector * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE);
+    if (p == nullptr) return false;
+    memset(p, 0xFF, FLASH_SECTOR_SIZE);
+    hostState.flashErases++;
+    hostConsumeMicros(HOST_TIME_FLASH, 30000);  // 4KB扇区擦除约30ms
+    return true;
+}
+
+// 与NOR闪存一样只能把位从1写成0，写入未擦除的位置得到按位与的结果
+bool EspClass::flashWrite(uint32_t address, const uint32_t* data, size_t size) {
+    uint8_t* p = fsFlashAt(address, size);
+    if (p == nullptr || data == nullptr) return false;
+    const uint8_t* src = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) p[i] &= src[i];
+    hostConsumeMicros(HOST_TIME_FLASH, 20 + size / 4);  // 页编程：几十微秒
+    return true;
+}
+
+bool EspClass::flashRead(uint32_t address, uint32_t* data, size_t size) {
+    const uint8_t* p = fsFlashAt(address, size);
+    if (p == nullptr || data == nullptr) return false;
+    memcpy(data, p, size);
+    return true;
+}
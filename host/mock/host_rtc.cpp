@@ -0,0 +1,222 @@
+/**
+ * @file host_rtc.cpp
+ * @brief DateTime与模拟DS1307实现
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#include <RTClib.h>
+#include "host_hardware.h"
+#include "host_state.h"
+
+// =============================================================================
+// DateTime（算法与Adafruit RTClib相同）
+// =============================================================================
+
+static const uint8_t daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+static uint16_t date2days(uint16_t y, uint8_t m, uint8_t d) {
+    if (y >= 2000U) y -= 2000U;
+    uint16_t days = d;
+    for (uint8_t i = 1; i < m; ++i) days += daysInMonth[i - 1];
+    if (m > 2 && y % 4 == 0) ++days;
+    return days + 365 * y + (y + 3) / 4 - 1;
+}
+
+static uint32_t time2ulong(uint16_t days, uint8_t h, uint8_t m, uint8_t s) {
+    return ((days * 24UL + h) * 60 + m) * 60 + s;
+}
+
+static uint8_t conv2d(const char* p) {
+    uint8_t v = 0;
+    if ('0' <= *p && *p <= '9') v = *p - '0';
+    return 10 * v + *++p - '0';
+}
+
+DateTime::DateTime(uint32_t t) {
+    t -= SECONDS_FROM_1970_TO_2000;
+    ss = t % 60;
+    t /= 60;
+    mm = t % 60;
+    t /= 60;
+    hh = t % 24;
+    uint16_t days = t / 24;
+    uint8_t leap;
+    for (yOff = 0;; ++yOff) {
+        leap = yOff % 4 == 0;
+        if (days < 365U + leap) break;
+        days -= 365 + leap;
+    }
+    for (m = 1; m < 12; ++m) {
+        uint8_t daysPerMonth = daysInMonth[m - 1];
+        if (leap && m == 2) ++daysPerMonth;
+        if (days < daysPerMonth) break;
+        days -= daysPerMonth;
+    }
+    d = days + 1;
+}
+
+DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t min, uint8_t sec) {
+    if (year >= 2000U) year -= 2000U;
+    yOff = year;
+    m = month;
+    d = day;
+    hh = hour;
+    mm = min;
+    ss = sec;
+}
+
+// 解析编译器的__DATE__ ("Dec 26 2009") 与 __TIME__ ("12:34:56")
+DateTime::DateTime(const char* date, const char* time) {
+    yOff = conv2d(date + 9);
+    switch (date[0]) {
+    case 'J': m = (date[1] == 'a') ? 1 : ((date[2] == 'n') ? 6 : 7); break;
+    case 'F': m = 2; break;
+    case 'A': m = date[2] == 'r' ? 4 : 8; break;
+    case 'M': m = date[2] == 'r' ? 3 : 5; break;
+    case 'S': m = 9; break;
+    case 'O': m = 10; break;
+    case 'N': m = 11; break;
+    case 'D': m = 12; break;
+    default: m = 1; break;
+    }
+    d = conv2d(date + 4);
+    hh = conv2d(time);
+    mm = conv2d(time + 3);
+    ss = conv2d(time + 6);
+}
+
+bool DateTime::isValid() const {
+    if (yOff >= 100) return false;
+    DateTime other(unixtime());
+    return yOff == other.yOff && m == other.m && d == other.d && hh == other.hh && mm == other.mm && ss == other.ss;
+}
+
+uint8_t DateTime::dayOfTheWeek() const {
+    uint16_t day = date2days(yOff, m, d);
+    return (day + 6) % 7;  // 2000-01-01是星期六
+}
+
+uint32_t DateTime::secondstime() const {
+    return time2ulong(date2days(yOff, m, d), hh, mm, ss);
+}
+
+uint32_t DateTime::unixtime() const {
+    return secondstime() + SECONDS_FROM_1970_TO_2000;
+}
+
+DateTime DateTime::operator+(const TimeSpan& span) const {
+    return DateTime(unixtime() + span.totalseconds());
+}
+
+DateTime DateTime::operator-(const TimeSpan& span) const {
+    return DateTime(unixtime() - span.totalseconds());
+}
+
+TimeSpan DateTime::operator-(const DateTime& right) const {
+    return TimeSpan((int32_t)(unixtime() - right.unixtime()));
+}
+
+// =============================================================================
+// RTC_DS1307
+// =============================================================================
+
+// 一次DS1307事务：地址+寄存器指针+数据，每字节9个时钟
+static void rtcTransfer(uint32_t dataBytes) {
+    uint32_t bytes = 2 + dataBytes;
+    hostState.i2cBytes += bytes;
+    hostConsumeMicros(HOST_TIME_I2C_RTC, (uint64_t)bytes * 9 * 1000000ULL / hostState.i2cClockHz);
+}
+
+// 按晶振频偏推算当前RTC读数
+static uint32_t rtcCurrentUnix() {
+    if (!hostState.rtcRunning) return hostState.rtcBaseUnix;
+    uint64_t elapsedUs = hostElapsedMicros() - hostState.rtcBaseMicros;
+    double scaled = (double)elapsedUs * (1.0 + hostState.rtcDriftPpm * 1e-6);
+    return hostState.rtcBaseUnix + (uint32_t)(scaled / 1000000.0);
+}
+
+// 把基准点移到当前时刻，保留秒内相位（修改频偏或停振时使用）
+static void rtcRebase() {
+    uint64_t now = hostElapsedMicros();
+    if (hostState.rtcRunning) {
+        double rate = 1.0 + hostState.rtcDriftPpm * 1e-6;
+        double scaled = (double)(now - hostState.rtcBaseMicros) * rate;
+        uint32_t secs = (uint32_t)(scaled / 1000000.0);
+        double fracUs = scaled - (double)secs * 1000000.0;
+        hostState.rtcBaseUnix += secs;
+        hostState.rtcBaseMicros = now - (uint64_t)(fracUs / rate);
+    } else {
+        hostState.rtcBaseMicros = now;
+    }
+}
+
+bool RTC_DS1307::begin() {
+    return hostState.rtcPresent;
+}
+
+void RTC_DS1307::adjust(const DateTime& dt) {
+    if (!hostState.rtcPresent) return;
+    // 写入时间会复位DS1307的秒分频链
+    hostState.rtcBaseUnix = dt.unixtime();
+    hostState.rtcBaseMicros = hostElapsedMicros();
+    hostState.rtcRunning = true;
+    rtcTransfer(7);
+}
+
+uint8_t RTC_DS1307::isrunning() {
+    return hostState.rtcPresent && hostState.rtcRunning;
+}
+
+DateTime RTC_DS1307::now() {
+    hostState.rtcReadCount++;
+    rtcTransfer(7);
+    if (!hostState.rtcPresent) {
+        // 总线无应答时RTClib会把0xFF解码成无效日期
+        return DateTime(2165, 165, 165, 165, 165, 85);
+    }
+    return DateTime(rtcCurrentUnix());
+}
+
+uint8_t RTC_DS1307::readnvram(uint8_t address) {
+    return address < sizeof(hostState.rtcNvram) ? hostState.rtcNvram[address] : 0;
+}
+
+void RTC_DS1307::readnvram(uint8_t* buf, uint8_t size, uint8_t address) {
+    for (uint8_t i = 0; i < size; i++) buf[i] = readnvram(address + i);
+}
+
+void RTC_DS1307::writenvram(uint8_t address, uint8_t data) {
+    if (address < sizeof(hostState.rtcNvram)) hostState.rtcNvram[address] = data;
+}
+
+void RTC_DS1307::writenvram(uint8_t address, const uint8_t* buf, uint8_t size) {
+    for (uint8_t i = 0; i < size; i++) writenvram(address + i, buf[i]);
+}
+
+// =============================================================================
+// 测试控制接口
+// =============================================================================
+
+void hostSetRtcPresent(bool present) { hostState.rtcPresent = present; }
+
+void hostSetRtcRunning(bool running) {
+    if (running == hostState.rtcRunning) return;
+    rtcRebase();
+    hostState.rtcRunning = running;
+}
+
+void hostSetRtcDriftPpm(double ppm) {
+    rtcRebase();
+    hostState.rtcDriftPpm = ppm;
+}
+
+void hostSetRtcUnixTime(uint32_t unixTime) {
+    hostState.rtcBaseUnix = unixTime;
+    hostState.rtcBaseMicros = hostElapsedMicros();
+}
+
+uint32_t hostGetRtcUnixTime() { return rtcCurrentUnix(); }
+uint32_t hostGetRtcReadCount() { return hostState.rtcReadCount; }
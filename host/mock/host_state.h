@@ -0,0 +1,81 @@
+/**
+ * @file host_state.h
+ * @brief 模拟外设共享状态（仅供host/mock内部使用）
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_STATE_H
+#define HOST_STATE_H
+
+#include <stdint.h>
+#include "flash_hal.h"
+
+#define HOST_PIN_COUNT 17
+#define HOST_FLASH_SIZE 4096
+#define HOST_RTC_USER_MEMORY_SIZE 512
+
+struct HostState {
+    // 时钟
+    bool virtualTime;
+    uint64_t virtualMicros;       // 虚拟单调时钟（不回绕）
+    uint32_t millisOffset;        // millis() = virtualMicros/1000 + millisOffset
+    uint32_t yieldQuantumUs;
+    uint64_t trueUnixBaseMicros;  // virtualMicros为0时的真实UTC（微秒）
+    double crystalDriftPpm;       // ESP8266晶振频偏，millis()/micros()按此比例快慢
+    uint64_t crystalBaseMicros;   // 最近一次设置频偏时的虚拟时钟
+    uint64_t crystalBaseLocal;    // 同一时刻晶振计得的微秒数
+    uint64_t timeSpent[8];        // 按HostTimeCategory累计的虚拟微秒
+    int delayCategory;            // delay()当前计入的类别
+    void (*delayHook)();          // 固件delay()之后的回调
+
+    // GPIO
+    int pinLevel[HOST_PIN_COUNT];
+    void (*pinHandler[HOST_PIN_COUNT])(void);
+    int pinHandlerMode[HOST_PIN_COUNT];
+    int interruptsDisabled;
+    uint32_t gpioWakeupMask;      // 浅睡眠唤醒的引脚（中断改为电平触发）
+    int gpioWakeupLevel;
+    uint32_t scheduleCount;       // esp_schedule()调用次数
+
+    // 网络
+    bool wifiConnected;
+    int wifiRssi;
+    uint32_t ntpRequestCount;
+    uint32_t dnsLookupCount;
+
+    // RTC
+    bool rtcPresent;
+    bool rtcRunning;
+    double rtcDriftPpm;
+    uint64_t rtcBaseMicros;       // 最近一次adjust时的虚拟时钟
+    uint32_t rtcBaseUnix;         // 最近一次adjust写入的时间
+    uint32_t rtcReadCount;
+    uint8_t rtcNvram[56];
+
+    // I2C
+    bool i2cPresent[128];
+    uint32_t i2cBytes;
+    uint32_t i2cClockHz;          // Wire.setClock()设置的总线频率
+    uint32_t displayDropCount;    // 接下来丢弃的面板写入次数（总线照常占用，面板不更新）
+
+    // EEPROM闪存
+    uint8_t flash[HOST_FLASH_SIZE];
+    uint32_t eepromCommits;
+    uint8_t fsFlash[HOST_FS_SECTORS * FLASH_SECTOR_SIZE];   // 文件系统区，只能把1写成0，擦除后为0xFF
+    uint32_t flashErases;
+
+    // ESP
+    uint32_t restartCount;
+    uint32_t freeHeap;
+    uint32_t rtcUserMemory[HOST_RTC_USER_MEMORY_SIZE / 4];
+};
+
+extern HostState hostState;
+
+// 其他模拟模块的复位钩子（由hostResetHardware统一调用）
+void hostResetNetwork();
+
+#endif // HOST_STATE_H
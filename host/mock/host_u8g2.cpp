@@ -0,0 +1,234 @@
+/**
+ * @file host_u8g2.cpp
+ * @brief U8g2替身的绘图与面板传输实现
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#include <U8g2lib.h>
+#include "host_hardware.h"
+#include "host_state.h"
+
+const u8g2_cb_t u8g2_cb_r0 = {0};
+
+const uint8_t u8g2_font_logisoso26_tr[] = {26, 0, 16, 16, 16, 7};
+const uint8_t u8g2_font_logisoso18_tr[] = {18, 0, 11, 11, 11, 5};
+const uint8_t u8g2_font_wqy12_t_gb2312[] = {10, (uint8_t)-2, 6, 6, 12, 6};
+const uint8_t u8g2_font_wqy16_t_gb2312[] = {13, (uint8_t)-3, 8, 8, 16, 8};
+const uint8_t u8g2_font_unifont_t_chinese3[] = {12, (uint8_t)-2, 8, 8, 16, 8};
+const uint8_t u8g2_font_6x10_tf[] = {7, (uint8_t)-2, 6, 6, 6, 6};
+
+// 解码一个UTF-8字符，返回码点并前移指针
+static uint16_t nextCodepoint(const char*& p) {
+    uint8_t c = (uint8_t)*p++;
+    if (c < 0x80) return c;
+    if ((c & 0xE0) == 0xC0 && *p) {
+        return (uint16_t)(((c & 0x1F) << 6) | ((uint8_t)*p++ & 0x3F));
+    }
+    if ((c & 0xF0) == 0xE0 && p[0] && p[1]) {
+        uint16_t cp = (uint16_t)(((c & 0x0F) << 12) | (((uint8_t)p[0] & 0x3F) << 6) | ((uint8_t)p[1] & 0x3F));
+        p += 2;
+        return cp;
+    }
+    return '?';
+}
+
+// 字形像素图案：由码点和坐标确定性生成，保证不同字形可区分
+static bool glyphPixel(uint16_t encoding, int16_t col, int16_t row) {
+    uint32_t h = (uint32_t)encoding * 2654435761u ^ (uint32_t)(col * 73856093) ^ (uint32_t)(row * 19349663);
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return (h % 3) != 0;
+}
+
+uint8_t U8G2::glyphAdvance(uint16_t encoding) const {
+    if (font == nullptr) return 0;
+    if (encoding >= '0' && encoding <= '9') return font[2];
+    if (encoding == ':') return font[5];
+    if (encoding < 0x80) return font[3];
+    return font[4];
+}
+
+bool U8G2::begin() {
+    clearBuffer();
+    memset(panel, 0, sizeof(panel));
+    powerSave = 0;
+    return hostState.i2cPresent[0x3C];
+}
+
+void U8G2::sendBuffer() {
+    updateDisplayArea(0, 0, getBufferTileWidth(), getBufferTileHeight());
+}
+
+void U8G2::updateDisplayArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th) {
+    uint8_t tileWidth = getBufferTileWidth();
+    uint8_t tileHeight = getBufferTileHeight();
+    if (tx >= tileWidth || ty >= tileHeight) return;
+    if (tx + tw > tileWidth) tw = tileWidth - tx;
+    if (ty + th > tileHeight) th = tileHeight - ty;
+
+    if (hostState.displayDropCount > 0) {
+        hostState.displayDropCount--;
+    } else {
+        for (uint8_t page = ty; page < ty + th; page++) {
+            uint16_t offset = page * HOST_DISPLAY_WIDTH + tx * 8;
+            memcpy(panel + offset, buffer + offset, (size_t)tw * 8);
+        }
+    }
+    uint32_t bytes = (uint32_t)tw * th * 8;
+    bytesSent += bytes;
+    hostState.i2cBytes += bytes;
+    // SSD1306走400kHz总线，每字节9个时钟
+    hostConsumeMicros(HOST_TIME_I2C_DISPLAY, (uint64_t)bytes * 9 * 1000000ULL / 400000);
+}
+
+uint16_t U8G2::drawGlyph(int16_t x, int16_t y, uint16_t encoding) {
+    if (font == nullptr) return 0;
+    uint8_t advance = glyphAdvance(encoding);
+    int16_t top = y - getAscent();
+    int16_t bottom = y - getDescent();
+    // 空格没有墨迹
+    if (encoding != ' ') {
+        for (int16_t col = 0; col < advance - 1; col++) {
+            for (int16_t row = top; row < bottom; row++) {
+                if (glyphPixel(encoding, col, row - top)) drawPixel(x + col, row);
+            }
+        }
+    }
+    return advance;
+}
+
+uint16_t U8G2::drawUTF8(int16_t x, int16_t y, const char* str) {
+    if (str == nullptr) return 0;
+    int16_t start = x;
+    const char* p = str;
+    while (*p) {
+        x += drawGlyph(x, y, nextCodepoint(p));
+    }
+    return (uint16_t)(x - start);
+}
+
+// 与u8g2一致：前面字符按步进累加，最后一个字符按墨迹宽度计算
+uint16_t U8G2::getUTF8Width(const char* str) {
+    if (str == nullptr || font == nullptr) return 0;
+    uint16_t width = 0;
+    uint8_t lastAdvance = 0;
+    const char* p = str;
+    while (*p) {
+        lastAdvance = glyphAdvance(nextCodepoint(p));
+        width += lastAdvance;
+    }
+    if (lastAdvance > 0) width -= 1;
+    return width;
+}
+
+void U8G2::drawPixel(int16_t x, int16_t y) {
+    if (x < 0 || x >= HOST_DISPLAY_WIDTH || y < 0 || y >= HOST_DISPLAY_HEIGHT) return;
+    uint8_t& b = buffer[(y / 8) * HOST_DISPLAY_WIDTH + x];
+    uint8_t mask = (uint8_t)(1 << (y & 7));
+    if (drawColor == 0) {
+        b &= (uint8_t)~mask;
+    } else if (drawColor == 2) {
+        b ^= mask;
+    } else {
+        b |= mask;
+    }
+}
+
+void U8G2::drawHLine(int16_t x, int16_t y, int16_t w) {
+    for (int16_t i = 0; i < w; i++) drawPixel(x + i, y);
+}
+
+void U8G2::drawVLine(int16_t x, int16_t y, int16_t h) {
+    for (int16_t i = 0; i < h; i++) drawPixel(x, y + i);
+}
+
+void U8G2::drawLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    int16_t dx = abs(x2 - x1);
+    int16_t dy = -abs(y2 - y1);
+    int16_t sx = x1 < x2 ? 1 : -1;
+    int16_t sy = y1 < y2 ? 1 : -1;
+    int16_t err = dx + dy;
+    while (true) {
+        drawPixel(x1, y1);
+        if (x1 == x2 && y1 == y2) break;
+        int16_t e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x1 += sx; }
+        if (e2 <= dx) { err += dx; y1 += sy; }
+    }
+}
+
+void U8G2::drawBox(int16_t x, int16_t y, int16_t w, int16_t h) {
+    for (int16_t i = 0; i < h; i++) drawHLine(x, y + i, w);
+}
+
+void U8G2::drawFrame(int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (w <= 0 || h <= 0) return;
+    drawHLine(x, y, w);
+    drawHLine(x, y + h - 1, w);
+    drawVLine(x, y + 1, h - 2);
+    drawVLine(x + w - 1, y + 1, h - 2);
+}
+
+void U8G2::drawCircleSection(int16_t x, int16_t y, int16_t x0, int16_t y0, uint8_t opt) {
+    if (opt & U8G2_DRAW_UPPER_RIGHT) { drawPixel(x0 + x, y0 - y); drawPixel(x0 + y, y0 - x); }
+    if (opt & U8G2_DRAW_UPPER_LEFT) { drawPixel(x0 - x, y0 - y); drawPixel(x0 - y, y0 - x); }
+    if (opt & U8G2_DRAW_LOWER_RIGHT) { drawPixel(x0 + x, y0 + y); drawPixel(x0 + y, y0 + x); }
+    if (opt & U8G2_DRAW_LOWER_LEFT) { drawPixel(x0 - x, y0 + y); drawPixel(x0 - y, y0 + x); }
+}
+
+void U8G2::drawCircle(int16_t x0, int16_t y0, int16_t rad, uint8_t opt) {
+    int16_t f = 1 - rad;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * rad;
+    int16_t x = 0;
+    int16_t y = rad;
+    drawCircleSection(x, y, x0, y0, opt);
+    while (x < y) {
+        if (f >= 0) {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+        drawCircleSection(x, y, x0, y0, opt);
+    }
+}
+
+void U8G2::drawDisc(int16_t x0, int16_t y0, int16_t rad, uint8_t opt) {
+    for (int16_t dy = -rad; dy <= rad; dy++) {
+        for (int16_t dx = -rad; dx <= rad; dx++) {
+            if (dx * dx + dy * dy > rad * rad) continue;
+            bool right = dx >= 0;
+            bool upper = dy <= 0;
+            uint8_t section = upper ? (right ? U8G2_DRAW_UPPER_RIGHT : U8G2_DRAW_UPPER_LEFT)
+                                    : (right ? U8G2_DRAW_LOWER_RIGHT : U8G2_DRAW_LOWER_LEFT);
+            if (opt & section) drawPixel(x0 + dx, y0 + dy);
+        }
+    }
+}
+
+void U8G2::drawRFrame(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r) {
+    if (w <= 0 || h <= 0) return;
+    if (r < 1 || 2 * r >= w || 2 * r >= h) {
+        drawFrame(x, y, w, h);
+        return;
+    }
+    int16_t xl = x + r;
+    int16_t yu = y + r;
+    int16_t xr = x + w - r - 1;
+    int16_t yl = y + h - r - 1;
+    drawCircle(xl, yu, r, U8G2_DRAW_UPPER_LEFT);
+    drawCircle(xr, yu, r, U8G2_DRAW_UPPER_RIGHT);
+    drawCircle(xl, yl, r, U8G2_DRAW_LOWER_LEFT);
+    drawCircle(xr, yl, r, U8G2_DRAW_LOWER_RIGHT);
+    drawHLine(xl + 1, y, w - 2 * r - 2);
+    drawHLine(xl + 1, y + h - 1, w - 2 * r - 2);
+    drawVLine(x, yu + 1, h - 2 * r - 2);
+    drawVLine(x + w - 1, yu + 1, h - 2 * r - 2);
+}
@@ -0,0 +1,25 @@
+/**
+ * @file dns.h
+ * @brief lwIP dns.h的主机替身
+ *
+ * dns_gethostbyname()总是返回ERR_INPROGRESS，结果在模拟的解析时延之后
+ * 经回调送达。固件中lwIP在回到系统上下文时调用回调；替身在下一次访问
+ * 网络栈（WiFi.status()、WiFiUDP::parsePacket()）时调用已到时刻的回调，
+ * 从不在dns_gethostbyname()内部调用
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_LWIP_DNS_H
+#define HOST_LWIP_DNS_H
+
+#include "lwip/ip_addr.h"
+
+// ipaddr为nullptr表示解析失败
+typedef void (*dns_found_callback)(const char* name, const ip_addr_t* ipaddr, void* callback_arg);
+
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg);
+
+#endif // HOST_LWIP_DNS_H
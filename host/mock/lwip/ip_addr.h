@@ -0,0 +1,26 @@
+/**
+ * @file ip_addr.h
+ * @brief lwIP ip_addr.h的主机替身（只有IPv4）
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_LWIP_IP_ADDR_H
+#define HOST_LWIP_IP_ADDR_H
+
+#include <stdint.h>
+
+typedef int8_t err_t;
+
+#define ERR_OK          0
+#define ERR_INPROGRESS  -5
+#define ERR_ARG         -16
+
+// 网络字节序的IPv4地址（第一个字节在最低位）
+typedef struct ip_addr {
+    uint32_t addr;
+} ip_addr_t;
+
+#endif // HOST_LWIP_IP_ADDR_H
@@ -0,0 +1,38 @@
+/**
+ * @file user_interface.h
+ * @brief ESP8266 SDK接口（浅睡眠GPIO唤醒）的主机替身
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef HOST_USER_INTERFACE_H
+#define HOST_USER_INTERFACE_H
+
+#include <stdint.h>
+
+#define GPIO_ID_PIN(n) (n)
+
+typedef enum {
+    GPIO_PIN_INTR_DISABLE = 0,
+    GPIO_PIN_INTR_POSEDGE = 1,
+    GPIO_PIN_INTR_NEGEDGE = 2,
+    GPIO_PIN_INTR_ANYEDGE = 3,
+    GPIO_PIN_INTR_LOLEVEL = 4,
+    GPIO_PIN_INTR_HILEVEL = 5
+} GPIO_INT_TYPE;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 自动浅睡眠期间由该引脚的电平唤醒（引脚中断改为电平触发）
+void wifi_enable_gpio_wakeup(uint32_t i, GPIO_INT_TYPE intr_status);
+void wifi_disable_gpio_wakeup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_USER_INTERFACE_H
@@ -0,0 +1,506 @@
+/**
+ * @file simulator.cpp
+ * @brief 虚拟时间模拟器：在主机上以CPU全速运行固件的setup()/loop()
+ *
+ * 虚拟时钟只在固件delay()/yield()或外设操作时前进，一周的运行只需几秒。
+ * 可以按时间表注入事件（WiFi断开/恢复、NTP超时、RTC无应答、按键），
+ * 并可把millis()起点放在回绕前，覆盖49.7天回绕。
+ *
+ * 用法：host_simulator [--days N] [--step-ms N] [--wrap-at-days D | --no-wrap]
+ *                      [--script FILE] [--log-level 0-4] [--max-error-s N] [--scrape-s N]
+ *
+ * --scrape-s N 模拟Prometheus每N秒抓取一次/metrics，用于对比抓取前后的秒跳变抖动。
+ * 脚本每行一个事件：<时间> <事件> [参数]，时间如 1d2h30m、90s、1500ms，
+ * '#'开头为注释。事件：
+ *   wifi down|up
+ *   ntp timeout|ok|kod <CODE>|offset <ms>|rtt <ms>|jitter <ms>
+ *   rtc nack|ack|stop|drift <ppm>
+ *   esp drift <ppm>                    （ESP8266晶振频偏，millis()随之快慢）
+ *   press K1..K4 [按住毫秒，默认100]
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#include <Arduino.h>
+#include <RTClib.h>
+#include <algorithm>
+#include <chrono>
+#include <stdlib.h>
+#include <vector>
+#include "host_hardware.h"
+#include "config.h"
+#include "global_config.h"
+#include "logger.h"
+#include "time_manager.h"
+#include "runtime_monitor.h"
+#include "idle_manager.h"
+#include "loop_profiler.h"
+#include "monitoring_system.h"
+#include "metrics_server.h"
+#include "heap_tracer.h"
+
+void setup();
+void loop();
+
+// 北京时间相对UTC的偏移（与固件的NTP时区设置一致）
+static const int32_t LOCAL_OFFSET_S = 8 * 3600;
+
+// 单次loop()超过该时长计为一次卡顿（按键和刷新明显延迟）
+static const uint64_t STALL_THRESHOLD_US = 50000;
+
+// 屏幕秒跳变相对真实秒边界的时刻（正值为滞后）
+struct DisplayLatencyStats {
+    uint64_t samples;
+    uint64_t wrongSecond;       // 显示的秒与真实秒不是同一秒或下一秒
+    double sumMs;
+    double sumSquaresMs;
+    double maxAbsMs;
+    uint32_t histogram[1001];   // 按|延迟|的毫秒数统计，用于百分位
+};
+
+static DisplayLatencyStats latencyStats;
+static int lastSeenSecond = -1;
+
+// 每次loop()之后检查屏幕上的秒是否跳变，记录跳变时刻相对真实秒边界的偏差
+static void sampleDisplayLatency() {
+    int shown = displayState.lastDisplayedSecond;
+    if (shown == lastSeenSecond) return;
+    bool first = lastSeenSecond < 0;
+    lastSeenSecond = shown;
+    if (first || shown < 0) return;
+
+    uint64_t trueMicros = hostGetTrueUnixMicros();
+    int trueSecond = (int)((trueMicros / 1000000ULL + LOCAL_OFFSET_S) % 60);
+    double intoSecondMs = (double)(trueMicros % 1000000ULL) / 1000.0;
+    double latencyMs;
+    if (shown == trueSecond) {
+        latencyMs = intoSecondMs;
+    } else if (shown == (trueSecond + 1) % 60) {
+        latencyMs = intoSecondMs - 1000.0;
+    } else {
+        latencyStats.wrongSecond++;
+        return;
+    }
+    latencyStats.samples++;
+    latencyStats.sumMs += latencyMs;
+    latencyStats.sumSquaresMs += latencyMs * latencyMs;
+    double absMs = fabs(latencyMs);
+    if (absMs > latencyStats.maxAbsMs) latencyStats.maxAbsMs = absMs;
+    latencyStats.histogram[std::min((int)absMs, 1000)]++;
+}
+
+static int latencyPercentileMs(double fraction) {
+    uint64_t target = (uint64_t)(latencyStats.samples * fraction);
+    uint64_t seen = 0;
+    for (int ms = 0; ms <= 1000; ms++) {
+        seen += latencyStats.histogram[ms];
+        if (seen > target) return ms;
+    }
+    return 1000;
+}
+
+enum SimEventType {
+    SIM_WIFI_DOWN,
+    SIM_WIFI_UP,
+    SIM_NTP_TIMEOUT,
+    SIM_NTP_OK,
+    SIM_NTP_KOD,
+    SIM_NTP_OFFSET,
+    SIM_NTP_RTT,
+    SIM_NTP_JITTER,
+    SIM_RTC_NACK,
+    SIM_RTC_ACK,
+    SIM_RTC_STOP,
+    SIM_RTC_DRIFT,
+    SIM_ESP_DRIFT,
+    SIM_PIN_LOW,
+    SIM_PIN_HIGH
+};
+
+struct SimEvent {
+    uint64_t atMs;      // 相对模拟开始的虚拟时间
+    SimEventType type;
+    double value;       // 数值参数（毫秒、ppm、引脚号）
+    char code[5];       // KoD代码
+};
+
+struct SimOptions {
+    double days;
+    uint32_t stepMs;
+    bool wrap;
+    double wrapAtDays;
+    const char* scriptPath;
+    int logLevel;
+    double maxErrorS;
+    double scrapeS;
+};
+
+static SimOptions options = {
+    7.0,      // days
+    10,       // stepMs：每次yield()推进的虚拟时间
+    true,     // wrap
+    3.5,      // wrapAtDays：millis()在第3.5天回绕
+    nullptr,  // scriptPath
+    LOG_LEVEL_ERROR,
+    2.0,      // maxErrorS：结束时允许的最大时钟误差
+    0.0       // scrapeS：/metrics抓取间隔，0表示不抓取
+};
+
+static std::vector<SimEvent> events;
+
+// =============================================================================
+// 脚本解析
+// =============================================================================
+
+// 解析 1d2h30m15s500ms 形式的时长，纯数字按秒计
+static bool parseDuration(const char* text, uint64_t& ms) {
+    ms = 0;
+    const char* p = text;
+    if (*p == '\0') return false;
+    while (*p) {
+        char* end;
+        double value = strtod(p, &end);
+        if (end == p) return false;
+        p = end;
+        if (strncmp(p, "ms", 2) == 0) { ms += (uint64_t)value; p += 2; }
+        else if (*p == 'd') { ms += (uint64_t)(value * 86400000.0); p++; }
+        else if (*p == 'h') { ms += (uint64_t)(value * 3600000.0); p++; }
+        else if (*p == 'm') { ms += (uint64_t)(value * 60000.0); p++; }
+        else if (*p == 's' || *p == '\0') { ms += (uint64_t)(value * 1000.0); if (*p) p++; }
+        else return false;
+    }
+    return true;
+}
+
+static void addEvent(uint64_t atMs, SimEventType type, double value = 0, const char* code = nullptr) {
+    SimEvent event;
+    event.atMs = atMs;
+    event.type = type;
+    event.value = value;
+    event.code[0] = '\0';
+    if (code) {
+        strncpy(event.code, code, 4);
+        event.code[4] = '\0';
+    }
+    events.push_back(event);
+}
+
+static const uint8_t buttonPins[] = {K1_PIN, K2_PIN, K3_PIN, K4_PIN};
+
+static bool parseEventLine(char* line, int lineNo) {
+    char* hash = strchr(line, '#');
+    if (hash) *hash = '\0';
+
+    char* tokens[4] = {nullptr, nullptr, nullptr, nullptr};
+    int count = 0;
+    for (char* tok = strtok(line, " \t\r\n"); tok && count < 4; tok = strtok(nullptr, " \t\r\n")) {
+        tokens[count++] = tok;
+    }
+    if (count == 0) return true;
+
+    uint64_t at;
+    if (count < 3 || !parseDuration(tokens[0], at)) {
+        fprintf(stderr, "script line %d: expected '<time> <event> <arg>'\n", lineNo);
+        return false;
+    }
+    const char* what = tokens[1];
+    const char* arg = tokens[2];
+    double number = tokens[3] ? atof(tokens[3]) : 0;
+
+    if (strcmp(what, "wifi") == 0 && strcmp(arg, "down") == 0) addEvent(at, SIM_WIFI_DOWN);
+    else if (strcmp(what, "wifi") == 0 && strcmp(arg, "up") == 0) addEvent(at, SIM_WIFI_UP);
+    else if (strcmp(what, "ntp") == 0 && strcmp(arg, "timeout") == 0) addEvent(at, SIM_NTP_TIMEOUT);
+    else if (strcmp(what, "ntp") == 0 && strcmp(arg, "ok") == 0) addEvent(at, SIM_NTP_OK);
+    else if (strcmp(what, "ntp") == 0 && strcmp(arg, "kod") == 0) addEvent(at, SIM_NTP_KOD, 0, tokens[3] ? tokens[3] : "RATE");
+    else if (strcmp(what, "ntp") == 0 && strcmp(arg, "offset") == 0) addEvent(at, SIM_NTP_OFFSET, number);
+    else if (strcmp(what, "ntp") == 0 && strcmp(arg, "rtt") == 0) addEvent(at, SIM_NTP_RTT, number);
+    else if (strcmp(what, "ntp") == 0 && strcmp(arg, "jitter") == 0) addEvent(at, SIM_NTP_JITTER, number);
+    else if (strcmp(what, "rtc") == 0 && strcmp(arg, "nack") == 0) addEvent(at, SIM_RTC_NACK);
+    else if (strcmp(what, "rtc") == 0 && strcmp(arg, "ack") == 0) addEvent(at, SIM_RTC_ACK);
+    else if (strcmp(what, "rtc") == 0 && strcmp(arg, "stop") == 0) addEvent(at, SIM_RTC_STOP);
+    else if (strcmp(what, "rtc") == 0 && strcmp(arg, "drift") == 0) addEvent(at, SIM_RTC_DRIFT, number);
+    else if (strcmp(what, "esp") == 0 && strcmp(arg, "drift") == 0) addEvent(at, SIM_ESP_DRIFT, number);
+    else if (strcmp(what, "press") == 0 && (arg[0] == 'K' || arg[0] == 'k') && arg[1] >= '1' && arg[1] <= '4') {
+        uint8_t pin = buttonPins[arg[1] - '1'];
+        uint64_t holdMs = tokens[3] ? (uint64_t)number : 100;
+        addEvent(at, SIM_PIN_LOW, pin);
+        addEvent(at + holdMs, SIM_PIN_HIGH, pin);
+    } else {
+        fprintf(stderr, "script line %d: unknown event '%s %s'\n", lineNo, what, arg);
+        return false;
+    }
+    return true;
+}
+
+static bool loadScript(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "cannot open script %s\n", path);
+        return false;
+    }
+    char line[256];
+    int lineNo = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        ok = parseEventLine(line, ++lineNo);
+    }
+    fclose(file);
+    return ok;
+}
+
+// 未指定脚本时的默认场景：一周内各类故障各发生一次
+static void loadDefaultScenario() {
+    static const char* const lines[] = {
+        "6h     press K4",          // 显示网络状态
+        "12h    wifi down",
+        "14h    wifi up",
+        "1d     ntp timeout",
+        "1d1h   ntp ok",
+        "2d     rtc nack",
+        "2d20m  rtc ack",
+        "3d     press K2",          // 切换字体
+        "3d12h  wifi down",         // 跨越millis()回绕的断网
+        "3d13h  wifi up",
+        "4d     rtc drift 30",
+        "5d     ntp kod RATE",
+        "5d2h   ntp ok",
+        "6d     press K2",
+    };
+    char buffer[64];
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
+        strncpy(buffer, lines[i], sizeof(buffer) - 1);
+        buffer[sizeof(buffer) - 1] = '\0';
+        parseEventLine(buffer, (int)i + 1);
+    }
+}
+
+static void applyEvent(const SimEvent& event) {
+    switch (event.type) {
+    case SIM_WIFI_DOWN: hostSetWifiConnected(false); break;
+    case SIM_WIFI_UP: hostSetWifiConnected(true); break;
+    case SIM_NTP_TIMEOUT: hostSetNtpServer(nullptr, false, 40, 0); break;
+    case SIM_NTP_OK:
+        hostSetNtpKissCode(nullptr, nullptr);
+        hostSetNtpServer(nullptr, true, 40, 0);
+        break;
+    case SIM_NTP_KOD: hostSetNtpKissCode(nullptr, event.code); break;
+    case SIM_NTP_OFFSET: hostSetNtpServer(nullptr, true, 40, (int32_t)event.value); break;
+    case SIM_NTP_RTT: hostSetNtpServer(nullptr, true, (uint32_t)event.value, 0); break;
+    case SIM_NTP_JITTER: hostSetNtpJitter(nullptr, (uint32_t)event.value); break;
+    case SIM_RTC_NACK: hostSetRtcPresent(false); break;
+    case SIM_RTC_ACK: hostSetRtcPresent(true); break;
+    case SIM_RTC_STOP: hostSetRtcRunning(false); break;
+    case SIM_RTC_DRIFT: hostSetRtcDriftPpm(event.value); break;
+    case SIM_ESP_DRIFT: hostSetCrystalDriftPpm(event.value); break;
+    case SIM_PIN_LOW: hostSetPinLevel((uint8_t)event.value, LOW); break;
+    case SIM_PIN_HIGH: hostSetPinLevel((uint8_t)event.value, HIGH); break;
+    }
+}
+
+static size_t nextEvent = 0;
+static uint64_t eventBaseUs = 0;
+
+// 应用所有已到时刻的事件（主循环每次loop()之前、以及loop()空闲期间调用）
+static void applyDueEvents() {
+    uint64_t nowMs = (hostElapsedMicros() - eventBaseUs) / 1000;
+    while (nextEvent < events.size() && events[nextEvent].atMs <= nowMs) {
+        applyEvent(events[nextEvent++]);
+    }
+}
+
+// =============================================================================
+// 模拟Prometheus抓取
+// =============================================================================
+
+static struct {
+    int connection;         // 进行中的抓取，-1表示没有
+    uint64_t nextUs;        // 下次抓取的时刻
+    uint64_t startUs;
+    uint64_t completed;
+    uint64_t bytes;
+    uint64_t totalUs;       // 各次抓取从连接到服务端关闭的总时长
+} scraper = {-1, 0, 0, 0, 0, 0};
+
+// 每次loop()之前调用：取走应答，到时刻时发起下一次抓取（WiFi断开时连接失败，下个周期再试）
+static void runScraper() {
+    if (options.scrapeS <= 0) return;
+    uint64_t now = hostElapsedMicros();
+    if (scraper.connection >= 0) {
+        char buffer[2048];
+        size_t n;
+        while ((n = hostTcpReceive(scraper.connection, buffer, sizeof(buffer))) > 0) scraper.bytes += n;
+        if (hostTcpIsClosed(scraper.connection)) {
+            scraper.completed++;
+            scraper.totalUs += now - scraper.startUs;
+            scraper.connection = -1;
+        }
+    }
+    if (scraper.connection < 0 && now >= scraper.nextUs) {
+        scraper.connection = hostTcpConnect(METRICS_PORT, "GET /metrics HTTP/1.1\r\nHost: clock\r\n\r\n");
+        scraper.startUs = now;
+        scraper.nextUs = now + (uint64_t)(options.scrapeS * 1e6);
+    }
+}
+
+// =============================================================================
+// 运行与报告
+// =============================================================================
+
+static bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--no-wrap") == 0) { options.wrap = false; continue; }
+        if (value == nullptr) {
+            fprintf(stderr, "missing value for %s\n", arg);
+            return false;
+        }
+        if (strcmp(arg, "--days") == 0) options.days = atof(value);
+        else if (strcmp(arg, "--step-ms") == 0) options.stepMs = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--wrap-at-days") == 0) options.wrapAtDays = atof(value);
+        else if (strcmp(arg, "--script") == 0) options.scriptPath = value;
+        else if (strcmp(arg, "--log-level") == 0) options.logLevel = atoi(value);
+        else if (strcmp(arg, "--max-error-s") == 0) options.maxErrorS = atof(value);
+        else if (strcmp(arg, "--scrape-s") == 0) options.scrapeS = atof(value);
+        else {
+            fprintf(stderr, "unknown option %s\n", arg);
+            return false;
+        }
+        i++;
+    }
+    if (options.stepMs == 0) options.stepMs = 1;
+    return true;
+}
+
+static double realSeconds() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) return 2;
+    if (options.scriptPath) {
+        if (!loadScript(options.scriptPath)) return 2;
+    } else {
+        loadDefaultScenario();
+    }
+    std::stable_sort(events.begin(), events.end(),
+                     [](const SimEvent& a, const SimEvent& b) { return a.atMs < b.atMs; });
+
+    hostResetHardware();
+    hostSetYieldQuantumMicros(options.stepMs * 1000);
+    if (options.wrap) {
+        hostSetMillis((uint32_t)(0x100000000ULL - (uint64_t)(options.wrapAtDays * 86400000.0)));
+    }
+
+    double realStart = realSeconds();
+    setup();
+    // setup()内部会重设日志级别，模拟期间只保留指定级别以上的输出
+    setLogLevel((LogLevel)options.logLevel);
+    double realSetup = realSeconds() - realStart;
+    uint64_t setupUs = hostElapsedMicros();
+
+    uint64_t endUs = setupUs + (uint64_t)(options.days * 86400e6);
+    eventBaseUs = setupUs;
+    // loop()空闲时事件照常按时发生（按键中断会提前结束空闲）
+    hostSetDelayHook(applyDueEvents);
+    uint64_t iterations = 0;
+    uint64_t stalls = 0;
+    uint64_t maxIterationUs = 0;
+    uint64_t maxIterationAtUs = 0;
+
+    while (hostElapsedMicros() < endUs) {
+        applyDueEvents();
+        runScraper();
+
+        uint64_t before = hostElapsedMicros();
+        uint64_t idleBefore = hostGetTimeSpentMicros(HOST_TIME_DELAY);
+        loop();
+        // 空闲（固件delay()）不算卡顿，只统计实际工作的耗时
+        uint64_t spent = hostElapsedMicros() - before - (hostGetTimeSpentMicros(HOST_TIME_DELAY) - idleBefore);
+        iterations++;
+        sampleDisplayLatency();
+        if (spent > STALL_THRESHOLD_US) stalls++;
+        if (spent > maxIterationUs) {
+            maxIterationUs = spent;
+            maxIterationAtUs = before - setupUs;
+        }
+    }
+    double realTotal = realSeconds() - realStart;
+
+    // 结束时的显示时间（含秒内相位）与真实本地时间之差
+    DateTime shown;
+    uint16_t shownMs = 0;
+    bool haveTime = getCurrentTime(shown, shownMs);
+    int64_t trueLocalMs = (int64_t)(hostGetTrueUnixMicros() / 1000) + (int64_t)LOCAL_OFFSET_S * 1000;
+    double clockError = haveTime ? ((int64_t)shown.unixtime() * 1000 + shownMs - trueLocalMs) / 1000.0 : 0;
+
+    double virtualS = (hostElapsedMicros() - setupUs) / 1e6;
+    printf("\n========================================\n");
+    printf("  Simulation Report\n");
+    printf("========================================\n");
+    printf("Virtual time:        %.2f days (+%.1f s setup)\n", virtualS / 86400.0, setupUs / 1e6);
+    printf("Real time:           %.2f s (setup %.3f s), speedup %.0fx\n", realTotal, realSetup,
+           realTotal > 0 ? virtualS / realTotal : 0.0);
+    printf("Events applied:      %zu / %zu\n", nextEvent, events.size());
+    printf("Loop iterations:     %llu\n", (unsigned long long)iterations);
+    printf("Longest iteration:   %.1f ms at +%.3f h\n", maxIterationUs / 1000.0, maxIterationAtUs / 3600e6);
+    printf("Stalls > %llums:      %llu\n", (unsigned long long)(STALL_THRESHOLD_US / 1000),
+           (unsigned long long)stalls);
+    printf("I2C bytes:           %u\n", hostGetI2cBytesTransferred());
+    printf("NTP packets sent:    %u\n", hostGetNtpRequestCount());
+    printf("RTC reads:           %u\n", hostGetRtcReadCount());
+    printf("EEPROM commits:      %u\n", hostGetEepromCommitCount());
+    printf("Flash erases:        %u\n", hostGetFlashEraseCount());
+    printf("Restarts:            %u\n", hostGetRestartCount());
+    printf("Time by code path:\n");
+    uint64_t totalUs = hostElapsedMicros();
+    for (int c = 0; c < HOST_TIME_CATEGORY_COUNT; c++) {
+        uint64_t us = hostGetTimeSpentMicros((HostTimeCategory)c);
+        printf("  %-16s %12.3f s  %6.2f%%\n", hostTimeCategoryName((HostTimeCategory)c), us / 1e6,
+               totalUs ? 100.0 * us / totalUs : 0.0);
+    }
+    if (latencyStats.samples > 0) {
+        double mean = latencyStats.sumMs / latencyStats.samples;
+        double variance = latencyStats.sumSquaresMs / latencyStats.samples - mean * mean;
+        printf("Second flip latency: mean %.1f ms, jitter %.1f ms, p99 %d ms, max %.0f ms\n", mean,
+               sqrt(variance > 0 ? variance : 0), latencyPercentileMs(0.99), latencyStats.maxAbsMs);
+        printf("Second flips:        %llu (+%llu off by more than a second)\n",
+               (unsigned long long)latencyStats.samples, (unsigned long long)latencyStats.wrongSecond);
+    }
+    if (runtimeStats.inputLatencyCount > 0) {
+        printf("Press latency:       %u events, p50 %lu ms, p95 %lu ms, p99 %lu ms, max %lu ms\n",
+               runtimeStats.inputLatencyCount, getInputLatencyPercentile(50), getInputLatencyPercentile(95),
+               getInputLatencyPercentile(99), runtimeStats.inputLatencyMaxMs);
+    }
+    uint16_t duty = getCpuDutyCyclePermille();
+    printf("CPU duty cycle:      %u.%u%%, est. current %.1f mA\n", duty / 10, duty % 10,
+           getEstimatedCurrentMicroamps() / 1000.0);
+    printf("Loop profile (virtual time):\n%s", getProfilerReport());
+    printf("Health:              %s (%s), %u hourly snapshots\n", healthStatusToString(lastHealthCheck.overallStatus),
+           lastHealthCheck.summaryMessage, metricsHistory.sampleCount);
+    const HeapTraceStats& heapStats = getHeapTraceStats();
+    printf("Steady-loop allocs:  %u in %u of %u loops (%u allocs total), heap shrank in %u\n",
+           heapStats.loopAllocations, heapStats.loopsWithAllocations, heapStats.steadyLoops, heapStats.allocations,
+           heapStats.heapShrinkLoops);
+    if (options.scrapeS > 0) {
+        const MetricsServerStats& metricsStats = getMetricsServerStats();
+        printf("Metrics scrapes:     %llu (%u aborted), avg %llu bytes in %.1f ms\n",
+               (unsigned long long)scraper.completed, metricsStats.aborted,
+               (unsigned long long)(scraper.completed ? scraper.bytes / scraper.completed : 0),
+               scraper.completed ? scraper.totalUs / 1000.0 / scraper.completed : 0.0);
+    }
+    if (haveTime) {
+        printf("Clock error at end:  %+.3f s\n", clockError);
+    } else {
+        printf("Clock error at end:  no valid time\n");
+    }
+    printf("========================================\n");
+
+    // 稳态主循环不允许任何堆分配
+    bool ok = haveTime && fabs(clockError) <= options.maxErrorS && hostGetRestartCount() == 0 &&
+              heapStats.loopAllocations == 0;
+    return ok ? 0 : 1;
+}
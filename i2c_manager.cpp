@@ -9,7 +9,10 @@
  * @date 2025-12-23
  */
 
+#define LOG_MODULE I2C
+
 #include "i2c_manager.h"
+#include "display_flush.h"
 #include "utils.h"
 
 // I2C管理器配置定义
@@ -147,6 +150,9 @@ bool resetI2CBus() {
     Wire.begin();
     Wire.setClock(100000);
     
+    // 总线异常期间发往OLED的增量写入可能已丢失，下次刷新整帧发送
+    invalidateDisplayShadow();
+    
     LOG_INFO("I2C bus reset completed");
     return true;
 }
@@ -0,0 +1,152 @@
+/**
+ * @file idle_manager.cpp
+ * @brief 空闲管理实现
+ *
+ * 空闲用esp_delay()挂起主循环，SDK在此期间可以关闭射频（调制解调器睡眠），
+ * 启用自动浅睡眠时还会停掉CPU时钟，只在DTIM信标和定时器到期时醒来。
+ * 不使用强制浅睡眠：它要求先关闭WiFi，且睡眠期间millis()停走，时钟会变慢。
+ * 按键中断调用esp_schedule()立即结束空闲，按键响应不受空闲长度影响
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#include "idle_manager.h"
+#include "global_config.h"
+#include "config.h"
+#include "logger.h"
+#include "button_handler.h"
+#include "ntp_engine.h"
+#include "task_scheduler.h"
+#include "web_ota_manager.h"
+#include "metrics_server.h"
+#include <ESP8266WiFi.h>
+#include <coredecls.h>
+
+static struct {
+  bool lightSleep;             // 空闲时WiFi处于自动浅睡眠
+  uint64_t sinceMillis;        // 统计起点（单调毫秒）
+  uint64_t idleMillis;         // 累计空闲毫秒
+  uint64_t lightSleepMillis;   // 其中可以浅睡眠的毫秒（WiFi已连接）
+} idle = {false, 0, 0, 0};
+
+/**
+ * @brief 设置WiFi睡眠方式（在WiFi初始化之后调用）
+ */
+void initIdleManager() {
+  idle.lightSleep = IDLE_LIGHT_SLEEP && WiFi.setSleepMode(WIFI_LIGHT_SLEEP, IDLE_WIFI_LISTEN_INTERVAL);
+  if (!idle.lightSleep) {
+    WiFi.setSleepMode(WIFI_MODEM_SLEEP);
+  }
+  resetIdleStats();
+  LOG_DEBUG("Idle manager initialized, WiFi %s sleep", idle.lightSleep ? "light" : "modem");
+}
+
+// 辅助：是否有需要主循环逐次轮询的工作
+static bool isPollingRequired() {
+  return isNtpQueryInProgress() || timeState.ntpSyncInProgress || systemState.wifiDisconnectInProgress ||
+         webOtaState.status != WEB_OTA_STATUS_IDLE || systemState.needsRefresh;
+}
+
+/**
+ * @brief 没有需要逐次轮询的工作时挂起到下一个时限
+ * @return true 本次循环已空闲（调用者不必再yield()）
+ *
+ * 时限取调度器下一个任务与按键消抖中较早者，单次最长LOOP_IDLE_MAX
+ * （服务指标连接期间最长METRICS_POLL_INTERVAL）；
+ * 按键按下期间（长按计时）不空闲
+ */
+bool idleUntilNextDeadline() {
+  if (isPollingRequired()) {
+    return false;
+  }
+  unsigned long idleMs = getMillisUntilNextTask();
+  unsigned long buttonMs = getMillisUntilButtonDeadline();
+  if (buttonMs < idleMs) {
+    idleMs = buttonMs;
+  }
+  if (idleMs == 0) {
+    return false;
+  }
+  if (idleMs > LOOP_IDLE_MAX) {
+    idleMs = LOOP_IDLE_MAX;
+  }
+  // 服务指标连接期间分小段空闲：等待TCP确认不必空转，下一个时限也不会因此推迟
+  if (isMetricsClientActive() && idleMs > METRICS_POLL_INTERVAL) {
+    idleMs = METRICS_POLL_INTERVAL;
+  }
+
+  // 空闲时间先用来输出延迟日志，每输出一行检查一次按键和时限
+  if (hasPendingLogs()) {
+    unsigned long drainStart = millis();
+    while (hasPendingLogs() && !hasPendingButtonEdges()) {
+      drainLogBuffer(0);
+      if (millis() - drainStart >= idleMs) {
+        return false;
+      }
+    }
+    if (hasPendingButtonEdges()) {
+      return false;
+    }
+    idleMs -= millis() - drainStart;
+  }
+
+  // WiFi未连接时SDK不会进入浅睡眠，按调制解调器睡眠计
+  bool lightSleep = idle.lightSleep && systemState.networkConnected;
+  armButtonWakeup(lightSleep);
+  uint64_t start = getMonotonicMillis();
+  esp_delay(idleMs, []() { return !hasPendingButtonEdges(); });
+  uint64_t slept = getMonotonicMillis() - start;
+  disarmButtonWakeup();
+
+  idle.idleMillis += slept;
+  if (lightSleep) {
+    idle.lightSleepMillis += slept;
+  }
+  return true;
+}
+
+/**
+ * @brief 重新开始占空比和电流统计
+ */
+void resetIdleStats() {
+  idle.sinceMillis = getMonotonicMillis();
+  idle.idleMillis = 0;
+  idle.lightSleepMillis = 0;
+}
+
+/**
+ * @brief 统计起点以来CPU非空闲时间的千分比
+ */
+uint16_t getCpuDutyCyclePermille() {
+  uint64_t total = getMonotonicMillis() - idle.sinceMillis;
+  if (total == 0) {
+    return 1000;
+  }
+  uint64_t idleMs = idle.idleMillis < total ? idle.idleMillis : total;
+  return (uint16_t)((total - idleMs) * 1000 / total);
+}
+
+/**
+ * @brief 统计起点以来的累计空闲毫秒数（用于计算任意区间的占空比）
+ */
+uint64_t getIdleMillis() {
+  return idle.idleMillis;
+}
+
+/**
+ * @brief 按占空比估算ESP8266模块的平均电流（不含OLED）
+ * @return 微安
+ */
+uint32_t getEstimatedCurrentMicroamps() {
+  uint64_t total = getMonotonicMillis() - idle.sinceMillis;
+  if (total == 0) {
+    return POWER_ACTIVE_UA;
+  }
+  uint64_t idleMs = idle.idleMillis < total ? idle.idleMillis : total;
+  uint64_t lightMs = idle.lightSleepMillis < idleMs ? idle.lightSleepMillis : idleMs;
+  uint64_t chargeUaMs = (total - idleMs) * POWER_ACTIVE_UA + (idleMs - lightMs) * POWER_MODEM_SLEEP_UA +
+                        lightMs * POWER_LIGHT_SLEEP_UA;
+  return (uint32_t)(chargeUaMs / total);
+}
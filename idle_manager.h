@@ -0,0 +1,27 @@
+/**
+ * @file idle_manager.h
+ * @brief 空闲管理：在调度的工作之间让ESP8266睡眠
+ *
+ * 主循环每次开头计算距下一个时限（调度器任务、按键消抖）的时间，
+ * 没有需要逐次轮询的工作时挂起到该时限：WiFi处于调制解调器睡眠或自动浅睡眠，
+ * 按键引脚作为唤醒源。同时统计CPU占空比并估算平均电流
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef IDLE_MANAGER_H
+#define IDLE_MANAGER_H
+
+#include <Arduino.h>
+
+// 函数声明
+void initIdleManager();
+bool idleUntilNextDeadline();
+void resetIdleStats();
+uint16_t getCpuDutyCyclePermille();
+uint64_t getIdleMillis();
+uint32_t getEstimatedCurrentMicroamps();
+
+#endif // IDLE_MANAGER_H
@@ -9,12 +9,14 @@
  * @date 2026-02-04
  */
 
+#define LOG_MODULE TEST
+
 #include "integration_tests.h"
 #include "button_handler.h"
 #include "time_manager.h"
 #include "display_manager.h"
 #include "system_manager.h"
-#include "eeprom_config.h"
+#include "config_manager.h"
 #include "logger.h"
 #include "utils.h"
 
@@ -27,8 +29,8 @@ void runIntegrationTest_system_startup() {
 
     TEST_CASE(test_eeprom_initialization) {
             // 测试EEPROM初始化
-            initEEPROM();
-            uint8_t brightness = loadBrightnessIndex();
+            initConfigManager();
+            uint8_t brightness = getConfigValue(CONFIG_BRIGHTNESS_INDEX);
             // 应该能成功加载（可能返回默认值）
             ASSERT_TRUE(brightness >= 0 && brightness <= 3);
         }
@@ -50,13 +52,13 @@ void runIntegrationTest_system_startup() {
         TEST_CASE(test_brightness_persistence) {
             // 测试亮度持久化
             uint8_t testBrightness = 1;
-            saveBrightnessIndex(testBrightness);
+            setConfigValue(CONFIG_BRIGHTNESS_INDEX, testBrightness);
 
-            uint8_t loadedBrightness = loadBrightnessIndex();
+            uint8_t loadedBrightness = getConfigValue(CONFIG_BRIGHTNESS_INDEX);
             ASSERT_EQ(testBrightness, loadedBrightness);
 
             // 恢复默认值
-            saveBrightnessIndex(2);
+            setConfigValue(CONFIG_BRIGHTNESS_INDEX, 2);
         }
         TEST_CASE_END();
 
@@ -178,7 +180,7 @@ void runIntegrationTest_button_response() {
     TEST_SUITE_END();
 
     LOG_INFO("=== Test Suite Complete: %s ===", g_testStats.currentSuite);
-    LOG_INFO("Passed: %d, Failed: %d", g_testStats.failedTests);
+    LOG_INFO("Passed: %d, Failed: %d", g_testStats.passedTests, g_testStats.failedTests);
     LOG_DEBUG("");
 }
 
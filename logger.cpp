@@ -2,7 +2,9 @@
  * @file logger.cpp
  * @brief 分级日志系统实现
  * 
- * 实现分级的日志输出功能
+ * 实现分级的日志输出功能。延迟日志把记录存入固定大小的环形缓冲区，
+ * 只保存格式串指针和原始参数，不在调用处做vsnprintf和串口输出：
+ * 115200波特下一行日志的同步输出要阻塞主循环数毫秒
  * 
  * @author ESP8266 SSD1306 Clock Project
  * @version 2.0
@@ -12,6 +14,7 @@
 #include "logger.h"
 #include "production_config.h"
 #include "version.h"
+#include "breadcrumbs.h"
 #include <stdarg.h>
 
 // 日志配置定义
@@ -19,7 +22,8 @@ LogConfig logConfig = {
     .currentLevel = DEFAULT_LOG_LEVEL,  // 使用production_config.h中的默认级别
     .enabled = true,
     .timestampEnabled = ENABLE_TIMESTAMP,  // 使用production_config.h中的设置
-    .useFlashStrings = true
+    .useFlashStrings = true,
+    .deferred = false  // 启动阶段没有空闲时间，systemSetup()完成后再启用
 };
 
 // 日志级别名称（使用Flash字符串优化）
@@ -37,6 +41,418 @@ const char* const LOG_LEVEL_NAMES[] PROGMEM = {
     LOG_LEVEL_NAME_VERBOSE
 };
 
+// =============================================================================
+// 延迟日志的环形缓冲区
+// =============================================================================
+
+// 记录 = 头部 + 参数区。参数按格式串中转换说明的顺序存放：整数和指针按实际类型的字节数，
+// 浮点数为double，字符串为1字节长度加内容（按精度和LOG_MAX_STRING_ARG截断），
+// '*'宽度和精度为int。格式串只存指针：日志宏的格式串都是字符串常量
+// format为NULL的记录是"丢弃了N条"的提示，参数区为丢弃的条数
+struct LogRecordHeader {
+    const char* format;
+    uint32_t timestamp;
+    uint8_t level;
+    uint8_t flags;
+    uint8_t argBytes;
+};
+
+static const uint8_t LOG_RECORD_PROGMEM = 0x01;    // 格式串在Flash中
+static const uint8_t LOG_RECORD_TRUNCATED = 0x02;  // 参数区装不下，后面的参数没有保存
+static const uint8_t LOG_MAX_ARG_BYTES = 128;
+static const uint8_t LOG_MAX_STRING_ARG = 48;
+static const size_t LOG_LINE_SIZE = 200;           // 与同步输出的消息长度限制一致
+
+// 只在主循环中写入（中断里不记日志），无需关中断
+static struct {
+    uint8_t data[LOG_BUFFER_SIZE];
+    uint16_t head;             // 下一条记录的写入位置
+    uint16_t tail;             // 最早一条记录的位置
+    uint16_t used;             // 已用字节数
+    uint32_t droppedTotal;     // 缓冲区满被丢弃的总条数
+    uint32_t droppedPending;   // 尚未写入提示记录的丢弃条数
+} logRing;
+
+// 参数类型（决定存取的字节数）
+enum LogArgKind {
+    LOG_ARG_NONE,          // %%
+    LOG_ARG_INT,           // 无修饰或h/hh的整数、%c（按int传递）
+    LOG_ARG_LONG,
+    LOG_ARG_LONG_LONG,
+    LOG_ARG_SIZE,          // z/t修饰
+    LOG_ARG_DOUBLE,
+    LOG_ARG_POINTER,
+    LOG_ARG_STRING,
+    LOG_ARG_UNSUPPORTED    // %n、long double等，遇到后停止解析参数
+};
+
+// 一个转换说明
+struct LogSpec {
+    char conversion;       // 转换字符，'\0'表示格式串在说明中间结束
+    char length;           // 长度修饰：0、'h'、'l'、'q'(ll)、'j'、'z'、't'、'L'
+    bool widthStar;
+    bool precisionStar;
+    int precision;         // -1表示未指定或为'*'
+    uint8_t specLen;       // 从'%'起的字符数
+};
+
+static char formatChar(const char* format, size_t i, bool progmem) {
+    return progmem ? (char)pgm_read_byte(format + i) : format[i];
+}
+
+// 辅助：解析format[pos]处以'%'开始的转换说明
+static LogSpec parseLogSpec(const char* format, size_t pos, bool progmem) {
+    LogSpec spec = {0, 0, false, false, -1, 0};
+    size_t i = pos + 1;
+    char c = formatChar(format, i, progmem);
+    while (c == '-' || c == '+' || c == ' ' || c == '#' || c == '0') {
+        c = formatChar(format, ++i, progmem);
+    }
+    if (c == '*') {
+        spec.widthStar = true;
+        c = formatChar(format, ++i, progmem);
+    }
+    while (c >= '0' && c <= '9') {
+        c = formatChar(format, ++i, progmem);
+    }
+    if (c == '.') {
+        spec.precision = 0;
+        c = formatChar(format, ++i, progmem);
+        if (c == '*') {
+            spec.precisionStar = true;
+            spec.precision = -1;
+            c = formatChar(format, ++i, progmem);
+        }
+        while (c >= '0' && c <= '9') {
+            spec.precision = spec.precision * 10 + (c - '0');
+            c = formatChar(format, ++i, progmem);
+        }
+    }
+    if (c == 'h' || c == 'l' || c == 'j' || c == 'z' || c == 't' || c == 'L') {
+        spec.length = c;
+        c = formatChar(format, ++i, progmem);
+        if ((spec.length == 'h' || spec.length == 'l') && c == spec.length) {
+            spec.length = (c == 'l') ? 'q' : 'h';
+            c = formatChar(format, ++i, progmem);
+        }
+    }
+    spec.conversion = c;
+    spec.specLen = (uint8_t)(i - pos + (c != '\0' ? 1 : 0));
+    return spec;
+}
+
+static LogArgKind logArgKind(const LogSpec& spec) {
+    switch (spec.conversion) {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+            switch (spec.length) {
+                case 'l': return LOG_ARG_LONG;
+                case 'q': case 'j': return LOG_ARG_LONG_LONG;
+                case 'z': case 't': return LOG_ARG_SIZE;
+                case 'L': return LOG_ARG_UNSUPPORTED;
+                default: return LOG_ARG_INT;
+            }
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            return spec.length == 'L' ? LOG_ARG_UNSUPPORTED : LOG_ARG_DOUBLE;
+        case 's':
+            return spec.length == 0 ? LOG_ARG_STRING : LOG_ARG_UNSUPPORTED;
+        case 'p':
+            return LOG_ARG_POINTER;
+        case '%':
+            return LOG_ARG_NONE;
+        default:
+            return LOG_ARG_UNSUPPORTED;
+    }
+}
+
+static bool putLogArg(uint8_t* out, uint8_t* len, const void* value, size_t size) {
+    if (*len + size > LOG_MAX_ARG_BYTES) {
+        return false;
+    }
+    memcpy(out + *len, value, size);
+    *len += size;
+    return true;
+}
+
+// 辅助：按格式串从va_list取出参数存入out，返回字节数；装不下时置LOG_RECORD_TRUNCATED
+static uint8_t encodeLogArgs(const char* format, bool progmem, va_list args, uint8_t* out, uint8_t* flags) {
+    uint8_t len = 0;
+    for (size_t i = 0; formatChar(format, i, progmem) != '\0'; ) {
+        if (formatChar(format, i, progmem) != '%') {
+            i++;
+            continue;
+        }
+        LogSpec spec = parseLogSpec(format, i, progmem);
+        LogArgKind kind = logArgKind(spec);
+        if (spec.conversion == '\0' || kind == LOG_ARG_UNSUPPORTED) {
+            break;
+        }
+        i += spec.specLen;
+
+        bool ok = true;
+        int starPrecision = -1;
+        if (spec.widthStar) {
+            int width = va_arg(args, int);
+            ok = putLogArg(out, &len, &width, sizeof(width));
+        }
+        if (ok && spec.precisionStar) {
+            starPrecision = va_arg(args, int);
+            ok = putLogArg(out, &len, &starPrecision, sizeof(starPrecision));
+        }
+        if (!ok) {
+            *flags |= LOG_RECORD_TRUNCATED;
+            break;
+        }
+
+        switch (kind) {
+            case LOG_ARG_INT: {
+                int value = va_arg(args, int);
+                ok = putLogArg(out, &len, &value, sizeof(value));
+                break;
+            }
+            case LOG_ARG_LONG: {
+                long value = va_arg(args, long);
+                ok = putLogArg(out, &len, &value, sizeof(value));
+                break;
+            }
+            case LOG_ARG_LONG_LONG: {
+                long long value = va_arg(args, long long);
+                ok = putLogArg(out, &len, &value, sizeof(value));
+                break;
+            }
+            case LOG_ARG_SIZE: {
+                size_t value = va_arg(args, size_t);
+                ok = putLogArg(out, &len, &value, sizeof(value));
+                break;
+            }
+            case LOG_ARG_DOUBLE: {
+                double value = va_arg(args, double);
+                ok = putLogArg(out, &len, &value, sizeof(value));
+                break;
+            }
+            case LOG_ARG_POINTER: {
+                void* value = va_arg(args, void*);
+                ok = putLogArg(out, &len, &value, sizeof(value));
+                break;
+            }
+            case LOG_ARG_STRING: {
+                // 字符串内容在调用返回后可能失效，须复制；有精度时不能越过精度读取（如%.4s）
+                const char* str = va_arg(args, const char*);
+                if (str == NULL) {
+                    str = "(null)";
+                }
+                int precision = spec.precisionStar ? starPrecision : spec.precision;
+                size_t maxLen = (precision >= 0 && precision < LOG_MAX_STRING_ARG) ? precision : LOG_MAX_STRING_ARG;
+                uint8_t strLen = (uint8_t)strnlen(str, maxLen);
+                ok = putLogArg(out, &len, &strLen, 1) && putLogArg(out, &len, str, strLen);
+                break;
+            }
+            default:
+                break;
+        }
+        if (!ok) {
+            *flags |= LOG_RECORD_TRUNCATED;
+            break;
+        }
+    }
+    return len;
+}
+
+static void ringWrite(const void* src, size_t len) {
+    const uint8_t* bytes = (const uint8_t*)src;
+    size_t first = LOG_BUFFER_SIZE - logRing.head;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(logRing.data + logRing.head, bytes, first);
+    memcpy(logRing.data, bytes + first, len - first);
+    logRing.head = (logRing.head + len) % LOG_BUFFER_SIZE;
+    logRing.used += len;
+}
+
+static void ringRead(void* dst, size_t len) {
+    uint8_t* bytes = (uint8_t*)dst;
+    size_t first = LOG_BUFFER_SIZE - logRing.tail;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(bytes, logRing.data + logRing.tail, first);
+    memcpy(bytes + first, logRing.data, len - first);
+    logRing.tail = (logRing.tail + len) % LOG_BUFFER_SIZE;
+    logRing.used -= len;
+}
+
+// 辅助：把一条日志存入环形缓冲区，空间不足时丢弃并计数
+static void recordLogMessage(LogLevel level, const char* format, bool progmem, va_list args) {
+    LogRecordHeader header;
+    uint8_t argData[LOG_MAX_ARG_BYTES];
+    header.format = format;
+    header.timestamp = millis();
+    header.level = level;
+    header.flags = progmem ? LOG_RECORD_PROGMEM : 0;
+    header.argBytes = encodeLogArgs(format, progmem, args, argData, &header.flags);
+
+    // 之前有丢弃时先写一条提示记录，让输出中能看出丢弃发生的位置
+    size_t noticeSize = logRing.droppedPending ? sizeof(LogRecordHeader) + sizeof(uint32_t) : 0;
+    size_t recordSize = sizeof(LogRecordHeader) + header.argBytes;
+    if (noticeSize + recordSize > (size_t)(LOG_BUFFER_SIZE - logRing.used)) {
+        logRing.droppedTotal++;
+        logRing.droppedPending++;
+        return;
+    }
+    if (noticeSize) {
+        LogRecordHeader notice = {NULL, header.timestamp, LOG_LEVEL_WARNING, 0, sizeof(uint32_t)};
+        ringWrite(&notice, sizeof(notice));
+        ringWrite(&logRing.droppedPending, sizeof(uint32_t));
+        logRing.droppedPending = 0;
+    }
+    ringWrite(&header, sizeof(header));
+    ringWrite(argData, header.argBytes);
+}
+
+// 辅助：按保存的参数格式化一条记录的消息部分
+static size_t formatLogRecord(const LogRecordHeader& header, const uint8_t* args, char* out, size_t size) {
+    bool progmem = (header.flags & LOG_RECORD_PROGMEM) != 0;
+    size_t n = 0;
+    size_t argPos = 0;
+    bool missing = false;
+
+    for (size_t i = 0; n + 1 < size; ) {
+        char c = formatChar(header.format, i, progmem);
+        if (c == '\0') {
+            break;
+        }
+        if (c != '%') {
+            out[n++] = c;
+            i++;
+            continue;
+        }
+        LogSpec spec = parseLogSpec(header.format, i, progmem);
+        LogArgKind kind = logArgKind(spec);
+        if (spec.conversion == '\0') {
+            break;
+        }
+        if (kind == LOG_ARG_NONE) {
+            out[n++] = '%';
+            i += spec.specLen;
+            continue;
+        }
+
+        // 转换说明复制到RAM，'*'替换为保存的数值
+        char specBuffer[32];
+        size_t specLen = 0;
+        for (uint8_t k = 0; k < spec.specLen && !missing; k++) {
+            char sc = formatChar(header.format, i + k, progmem);
+            if (sc != '*') {
+                if (specLen + 1 < sizeof(specBuffer)) specBuffer[specLen++] = sc;
+                continue;
+            }
+            int star;
+            if (argPos + sizeof(star) > header.argBytes) {
+                missing = true;
+                break;
+            }
+            memcpy(&star, args + argPos, sizeof(star));
+            argPos += sizeof(star);
+            int written = snprintf(specBuffer + specLen, sizeof(specBuffer) - specLen, "%d", star);
+            if (written > 0 && specLen + written < sizeof(specBuffer)) specLen += written;
+        }
+        specBuffer[specLen] = '\0';
+        i += spec.specLen;
+        if (missing) {
+            break;
+        }
+
+        int written = -1;
+        switch (kind) {
+            #define LOG_FORMAT_ARG(type) { \
+                type value; \
+                if (argPos + sizeof(value) > header.argBytes) { missing = true; break; } \
+                memcpy(&value, args + argPos, sizeof(value)); \
+                argPos += sizeof(value); \
+                written = snprintf(out + n, size - n, specBuffer, value); \
+                break; \
+            }
+            case LOG_ARG_INT: LOG_FORMAT_ARG(int)
+            case LOG_ARG_LONG: LOG_FORMAT_ARG(long)
+            case LOG_ARG_LONG_LONG: LOG_FORMAT_ARG(long long)
+            case LOG_ARG_SIZE: LOG_FORMAT_ARG(size_t)
+            case LOG_ARG_DOUBLE: LOG_FORMAT_ARG(double)
+            case LOG_ARG_POINTER: LOG_FORMAT_ARG(void*)
+            #undef LOG_FORMAT_ARG
+            case LOG_ARG_STRING: {
+                char str[LOG_MAX_STRING_ARG + 1];
+                uint8_t strLen = argPos < header.argBytes ? args[argPos] : 0;
+                if (argPos + 1 + strLen > header.argBytes) {
+                    missing = true;
+                    break;
+                }
+                memcpy(str, args + argPos + 1, strLen);
+                str[strLen] = '\0';
+                argPos += 1 + strLen;
+                written = snprintf(out + n, size - n, specBuffer, str);
+                break;
+            }
+            default:
+                missing = true;
+                break;
+        }
+        if (missing) {
+            break;
+        }
+        if (written > 0) {
+            n += ((size_t)written < size - n) ? (size_t)written : size - n - 1;
+        }
+    }
+
+    // 参数没有完整保存时以"..."标明
+    if ((missing || (header.flags & LOG_RECORD_TRUNCATED)) && n + 4 <= size) {
+        memcpy(out + n, "...", 3);
+        n += 3;
+    }
+    out[n] = '\0';
+    return n;
+}
+
+// 辅助：警告和错误同时记入跨重启保留的诊断记录。不做格式化（不受日志级别和开关影响，
+// 每条都要记录），只保存格式串开头和第一个整数参数，查看报告时再拼成文字
+static void recordLogBreadcrumb(LogLevel level, const char* format, bool progmem, va_list args) {
+    BreadcrumbArg argKind = BREADCRUMB_ARG_NONE;
+    uint32_t arg = 0;
+    for (size_t i = 0; formatChar(format, i, progmem) != '\0'; ) {
+        if (formatChar(format, i, progmem) != '%') {
+            i++;
+            continue;
+        }
+        LogSpec spec = parseLogSpec(format, i, progmem);
+        LogArgKind kind = logArgKind(spec);
+        if (kind == LOG_ARG_NONE) {
+            i += spec.specLen;
+            continue;
+        }
+        if (spec.widthStar) {
+            (void)va_arg(args, int);
+        }
+        if (spec.precisionStar) {
+            (void)va_arg(args, int);
+        }
+        bool isSigned = spec.conversion == 'd' || spec.conversion == 'i';
+        switch (kind) {
+            case LOG_ARG_INT: arg = (uint32_t)va_arg(args, int); break;
+            case LOG_ARG_LONG: arg = (uint32_t)va_arg(args, long); break;
+            case LOG_ARG_LONG_LONG: arg = (uint32_t)va_arg(args, long long); break;
+            case LOG_ARG_SIZE: arg = (uint32_t)va_arg(args, size_t); break;
+            case LOG_ARG_POINTER: arg = (uint32_t)(uintptr_t)va_arg(args, void*); break;
+            default: break;  // 字符串、浮点数不保存
+        }
+        if (kind == LOG_ARG_INT || kind == LOG_ARG_LONG || kind == LOG_ARG_LONG_LONG ||
+            kind == LOG_ARG_SIZE || kind == LOG_ARG_POINTER) {
+            argKind = isSigned ? BREADCRUMB_ARG_SIGNED : BREADCRUMB_ARG_UNSIGNED;
+        }
+        break;
+    }
+    addLogBreadcrumb(level, format, progmem, argKind, arg);
+}
+
 void initLogger() {
     Serial.begin(115200);
 
@@ -60,10 +476,25 @@ void initLogger() {
 }
 
 void ICACHE_FLASH_ATTR logMessage(LogLevel level, const char* format, ...) {
+    if (level <= LOG_LEVEL_WARNING) {
+        va_list args;
+        va_start(args, format);
+        recordLogBreadcrumb(level, format, false, args);
+        va_end(args);
+    }
+
     if (!logConfig.enabled || level > logConfig.currentLevel) {
         return;
     }
 
+    if (logConfig.deferred) {
+        va_list args;
+        va_start(args, format);
+        recordLogMessage(level, format, false, args);
+        va_end(args);
+        return;
+    }
+
     // 输出时间戳
     if (logConfig.timestampEnabled) {
         unsigned long currentMillis = millis();
@@ -100,10 +531,25 @@ void ICACHE_FLASH_ATTR logMessage(LogLevel level, const char* format, ...) {
 }
 
 void ICACHE_FLASH_ATTR logMessageP(LogLevel level, const char* format, ...) {
+    if (level <= LOG_LEVEL_WARNING) {
+        va_list args;
+        va_start(args, format);
+        recordLogBreadcrumb(level, format, true, args);
+        va_end(args);
+    }
+
     if (!logConfig.enabled || level > logConfig.currentLevel) {
         return;
     }
 
+    if (logConfig.deferred) {
+        va_list args;
+        va_start(args, format);
+        recordLogMessage(level, format, true, args);
+        va_end(args);
+        return;
+    }
+
     // 输出时间戳
     if (logConfig.timestampEnabled) {
         unsigned long currentMillis = millis();
@@ -117,12 +563,6 @@ void ICACHE_FLASH_ATTR logMessageP(LogLevel level, const char* format, ...) {
     levelName[sizeof(levelName) - 1] = '\0';
     Serial.printf("[%s] ", levelName);
 
-    // 从Flash读取格式化字符串（使用栈分配的缓冲区）
-    char formatBuffer[100];
-    memset(formatBuffer, 0, sizeof(formatBuffer));
-    strncpy_P(formatBuffer, format, sizeof(formatBuffer) - 1);
-    formatBuffer[sizeof(formatBuffer) - 1] = '\0';
-
     // 输出日志消息，使用栈分配的缓冲区避免重入问题
     va_list args;
     va_start(args, format);
@@ -130,7 +570,7 @@ void ICACHE_FLASH_ATTR logMessageP(LogLevel level, const char* format, ...) {
     // 使用栈分配的缓冲区，避免多线程/中断环境下的静态缓冲区冲突
     char tempBuffer[200]; // 限制消息长度以避免缓冲区溢出
     memset(tempBuffer, 0, sizeof(tempBuffer)); // 确保缓冲区初始化
-    int len = vsnprintf(tempBuffer, sizeof(tempBuffer), formatBuffer, args);
+    int len = vsnprintf_P(tempBuffer, sizeof(tempBuffer), format, args);  // 直接读取Flash中的格式串
 
     if (len > 0) {
         // vsnprintf已确保字符串以null结尾，但仍需检查
@@ -162,6 +602,94 @@ void enableTimestamp(bool enable) {
     LOG_INFO("Timestamp %s", enable ? "enabled" : "disabled");
 }
 
+/**
+ * @brief 启用或关闭延迟日志
+ * @return 之前的设置
+ *
+ * 关闭时先输出缓冲区中的日志，保持输出顺序
+ */
+bool setLogDeferred(bool deferred) {
+    bool previous = logConfig.deferred;
+    if (!deferred) {
+        flushLogBuffer();
+    }
+    logConfig.deferred = deferred;
+    return previous;
+}
+
+bool hasPendingLogs() {
+    return logRing.used > 0;
+}
+
+/**
+ * @brief 取出最早的一条日志并格式化（含时间戳和级别，不含换行）
+ * @return false 缓冲区为空
+ */
+bool popLogLine(char* line, size_t size) {
+    if (logRing.used == 0 || size == 0) {
+        return false;
+    }
+    LogRecordHeader header;
+    uint8_t args[LOG_MAX_ARG_BYTES];
+    ringRead(&header, sizeof(header));
+    ringRead(args, header.argBytes);
+
+    size_t n = 0;
+    int written = 0;
+    if (logConfig.timestampEnabled) {
+        written = snprintf(line, size, "[%08lu] ", (unsigned long)header.timestamp);
+        n = (written > 0 && (size_t)written < size) ? written : 0;
+    }
+    written = snprintf(line + n, size - n, "[%s] ", getLogLevelName((LogLevel)header.level));
+    n += (written > 0 && (size_t)written < size - n) ? written : 0;
+
+    if (header.format == NULL) {
+        uint32_t dropped;
+        memcpy(&dropped, args, sizeof(dropped));
+        snprintf(line + n, size - n, "%lu log messages dropped (buffer full)", (unsigned long)dropped);
+    } else {
+        formatLogRecord(header, args, line + n, size - n);
+    }
+    return true;
+}
+
+/**
+ * @brief 输出缓冲区中的日志（在主循环空闲时调用）
+ * @param budgetMs 时间预算；每输出一条检查一次，为0时只输出一条
+ * @return 输出的条数
+ */
+uint16_t drainLogBuffer(unsigned long budgetMs) {
+    char line[LOG_LINE_SIZE + 32];
+    unsigned long start = millis();
+    uint16_t count = 0;
+    while (popLogLine(line, sizeof(line))) {
+        Serial.println(line);
+        count++;
+        if (millis() - start >= budgetMs) {
+            break;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 立即输出缓冲区中的全部日志并等待串口发送完毕（重启前、打印报告前）
+ */
+void flushLogBuffer() {
+    char line[LOG_LINE_SIZE + 32];
+    while (popLogLine(line, sizeof(line))) {
+        Serial.println(line);
+    }
+    Serial.flush();
+}
+
+/**
+ * @brief 缓冲区满被丢弃的日志总条数
+ */
+uint32_t getLogDroppedCount() {
+    return logRing.droppedTotal;
+}
+
 const char* getLogLevelName(LogLevel level) {
     static char buffer[10];
     int safeLevel = (level >= LOG_LEVEL_ERROR && level <= LOG_LEVEL_VERBOSE) ? level : LOG_LEVEL_INFO;
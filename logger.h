@@ -2,7 +2,9 @@
  * @file logger.h
  * @brief 分级日志系统
  * 
- * 提供分级的日志输出功能，支持生产环境调试控制
+ * 提供分级的日志输出功能，支持生产环境调试控制。
+ * 启用延迟日志后，日志调用只记录时间戳、格式串指针和原始参数（约几微秒），
+ * 格式化和串口输出推迟到主循环空闲时或按需进行
  * 
  * @author ESP8266 SSD1306 Clock Project
  * @version 2.0
@@ -31,34 +33,58 @@ struct LogConfig {
     bool enabled;              // 是否启用日志
     bool timestampEnabled;     // 是否包含时间戳
     bool useFlashStrings;      // 是否使用Flash字符串
+    bool deferred;             // 是否存入环形缓冲区、空闲时再输出
 };
 
 extern LogConfig logConfig;
 
-// 宏定义，便于使用
-#ifdef ENABLE_DEBUG_LOGS
-    #define LOG_ERROR(msg, ...)     logMessage(LOG_LEVEL_ERROR, msg, ##__VA_ARGS__)
-    #define LOG_WARNING(msg, ...)   logMessage(LOG_LEVEL_WARNING, msg, ##__VA_ARGS__)
-    #define LOG_INFO(msg, ...)      logMessage(LOG_LEVEL_INFO, msg, ##__VA_ARGS__)
-    #define LOG_DEBUG(msg, ...)     logMessage(LOG_LEVEL_DEBUG, msg, ##__VA_ARGS__)
-    #define LOG_VERBOSE(msg, ...)   logMessage(LOG_LEVEL_VERBOSE, msg, ##__VA_ARGS__)
-#else
-    // 生产环境：仅保留错误和警告日志
-    #define LOG_ERROR(msg, ...)     logMessage(LOG_LEVEL_ERROR, msg, ##__VA_ARGS__)
-    #define LOG_WARNING(msg, ...)   logMessage(LOG_LEVEL_WARNING, msg, ##__VA_ARGS__)
-    #define LOG_INFO(msg, ...)      // 生产环境不输出信息级别日志
-    #define LOG_DEBUG(msg, ...)     // 生产环境不输出调试级别日志
-    #define LOG_VERBOSE(msg, ...)   // 生产环境不输出详细级别日志
+// 日志调用所属的模块：源文件在第一个#include之前定义，例如
+//   #define LOG_MODULE TIME
+// 未定义时归入CORE。各模块编译进固件的最高级别见production_config.h中的LOG_COMPILE_LEVEL_*
+#ifndef LOG_MODULE
+    #define LOG_MODULE CORE
 #endif
 
+#define LOG_COMPILE_LEVEL_OF_(module) LOG_COMPILE_LEVEL_##module
+#define LOG_COMPILE_LEVEL_OF(module) LOG_COMPILE_LEVEL_OF_(module)
+
+// 高于本模块编译期级别的调用点连同格式串整个编译掉；
+// 保留的调用点格式串用PSTR放在Flash中，不占用DRAM。
+// LOG_*("")用于输出空行，只在宏展开处关闭零长度格式串警告
+#define LOG_AT(level, msg, ...) \
+    do { \
+        if constexpr ((level) <= LOG_COMPILE_LEVEL_OF(LOG_MODULE)) { \
+            _Pragma("GCC diagnostic push") \
+            _Pragma("GCC diagnostic ignored \"-Wformat-zero-length\"") \
+            logMessageP((level), PSTR(msg), ##__VA_ARGS__); \
+            _Pragma("GCC diagnostic pop") \
+        } \
+    } while (0)
+
+// 宏定义，便于使用（msg须为字符串常量）
+#define LOG_ERROR(msg, ...)     LOG_AT(LOG_LEVEL_ERROR, msg, ##__VA_ARGS__)
+#define LOG_WARNING(msg, ...)   LOG_AT(LOG_LEVEL_WARNING, msg, ##__VA_ARGS__)
+#define LOG_INFO(msg, ...)      LOG_AT(LOG_LEVEL_INFO, msg, ##__VA_ARGS__)
+#define LOG_DEBUG(msg, ...)     LOG_AT(LOG_LEVEL_DEBUG, msg, ##__VA_ARGS__)
+#define LOG_VERBOSE(msg, ...)   LOG_AT(LOG_LEVEL_VERBOSE, msg, ##__VA_ARGS__)
+
 // 函数声明
 void initLogger();
-void logMessage(LogLevel level, const char* format, ...);
-void logMessageP(LogLevel level, const char* format, ...); // 使用Flash字符串
+void logMessage(LogLevel level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+void logMessageP(LogLevel level, const char* format, ...) __attribute__((format(printf, 2, 3))); // 使用Flash字符串
+
 void setLogLevel(LogLevel level);
 void enableLogger(bool enable);
 void enableTimestamp(bool enable);
 const char* getLogLevelName(LogLevel level);
 void adjustLogLevelForError(ErrorCode code); // 根据错误代码调整日志级别
 
+// 延迟日志
+bool setLogDeferred(bool deferred);          // 返回之前的设置；关闭时先输出缓冲区中的日志
+bool hasPendingLogs();
+bool popLogLine(char* line, size_t size);    // 取出并格式化最早的一条（不含换行）
+uint16_t drainLogBuffer(unsigned long budgetMs);
+void flushLogBuffer();
+uint32_t getLogDroppedCount();
+
 #endif
\ No newline at end of file
@@ -0,0 +1,129 @@
+/**
+ * @file loop_profiler.cpp
+ * @brief 主循环分段性能分析实现
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#include "loop_profiler.h"
+
+#if ENABLE_LOOP_PROFILER
+
+#include "logger.h"
+#include <string.h>
+
+static ProfilerSection sections[PROFILER_MAX_SECTIONS];
+static uint8_t sectionCount = 0;
+
+// 分段表满时登记到的下标，记录时忽略
+static const uint8_t PROFILER_NO_SECTION = 0xFF;
+
+/**
+ * @brief 登记分段（同名的调用点共用一个分段）
+ * @return 分段下标，分段表已满时返回PROFILER_NO_SECTION
+ */
+uint8_t registerProfilerSection(const char* name) {
+  for (uint8_t i = 0; i < sectionCount; i++) {
+    if (strcmp(sections[i].name, name) == 0) {
+      return i;
+    }
+  }
+  if (sectionCount >= PROFILER_MAX_SECTIONS) {
+    LOG_WARNING("Profiler section table full, ignoring %s", name);
+    return PROFILER_NO_SECTION;
+  }
+  sections[sectionCount].name = name;
+  sections[sectionCount].minCycles = 0xFFFFFFFF;
+  return sectionCount++;
+}
+
+void recordProfilerSample(uint8_t section, uint32_t cycles) {
+  if (section >= sectionCount) {
+    return;
+  }
+  ProfilerSection& s = sections[section];
+  s.count++;
+  s.totalCycles += cycles;
+  if (cycles < s.minCycles) {
+    s.minCycles = cycles;
+  }
+  if (cycles > s.maxCycles) {
+    s.maxCycles = cycles;
+  }
+}
+
+/**
+ * @brief 按名称取分段统计
+ * @return 统计，未登记时返回nullptr
+ */
+const ProfilerSection* getProfilerSection(const char* name) {
+  for (uint8_t i = 0; i < sectionCount; i++) {
+    if (strcmp(sections[i].name, name) == 0) {
+      return &sections[i];
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief 分段名称
+ * @return 名称，未登记时返回nullptr
+ */
+const char* getProfilerSectionName(uint8_t section) {
+  return section < sectionCount ? sections[section].name : nullptr;
+}
+
+/**
+ * @brief 清零所有分段的统计（保留登记）
+ */
+void resetProfiler() {
+  for (uint8_t i = 0; i < sectionCount; i++) {
+    sections[i].count = 0;
+    sections[i].minCycles = 0xFFFFFFFF;
+    sections[i].maxCycles = 0;
+    sections[i].totalCycles = 0;
+  }
+}
+
+// 辅助：格式化一个分段（微秒）
+static int formatSection(char* buffer, size_t size, const ProfilerSection& s) {
+  uint32_t mhz = ESP.getCpuFreqMHz();
+  if (s.count == 0) {
+    return snprintf(buffer, size, "%-16s %8u\n", s.name, 0U);
+  }
+  return snprintf(buffer, size, "%-16s %8u %8lu %8lu %8lu\n", s.name, s.count,
+                  (unsigned long)(s.minCycles / mhz),
+                  (unsigned long)(s.totalCycles / s.count / mhz),
+                  (unsigned long)(s.maxCycles / mhz));
+}
+
+/**
+ * @brief 输出分段统计到串口
+ */
+void printProfilerReport() {
+  char line[80];
+  LOG_INFO("  %-16s %8s %8s %8s %8s", "section", "count", "min us", "avg us", "max us");
+  for (uint8_t i = 0; i < sectionCount; i++) {
+    formatSection(line, sizeof(line), sections[i]);
+    line[strcspn(line, "\n")] = '\0';
+    LOG_INFO("  %s", line);
+  }
+}
+
+/**
+ * @brief 分段统计的文本报告（用于HTTP）
+ * @return 静态缓冲区中的文本，下次调用时覆盖
+ */
+const char* getProfilerReport() {
+  static char report[96 + PROFILER_MAX_SECTIONS * 64];
+  size_t used = snprintf(report, sizeof(report), "%-16s %8s %8s %8s %8s\n",
+                         "section", "count", "min us", "avg us", "max us");
+  for (uint8_t i = 0; i < sectionCount && used < sizeof(report); i++) {
+    used += formatSection(report + used, sizeof(report) - used, sections[i]);
+  }
+  return report;
+}
+
+#endif // ENABLE_LOOP_PROFILER
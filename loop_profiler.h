@@ -0,0 +1,81 @@
+/**
+ * @file loop_profiler.h
+ * @brief 主循环分段性能分析
+ *
+ * 在函数或代码块开头写PROFILE_SCOPE("名称")，作用域结束时把ESP.getCycleCount()
+ * 计得的周期数计入同名分段的次数、最小、平均、最大值。分段表是固定容量的静态数组，
+ * 每个调用点首次执行时登记一次，之后不再查找也不分配内存。
+ * 报告可以输出到串口，也可以取文本经HTTP返回（Web OTA服务器的/profile）
+ *
+ * 编译时定义ENABLE_LOOP_PROFILER=0可把PROFILE_SCOPE和报告函数全部编译为空
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <Arduino.h>
+
+#ifndef ENABLE_LOOP_PROFILER
+#define ENABLE_LOOP_PROFILER 1
+#endif
+
+// 最多可登记的分段数
+const uint8_t PROFILER_MAX_SECTIONS = 16;
+
+// 单个分段的统计（周期数，80MHz时每微秒80个周期）
+struct ProfilerSection {
+  const char* name;
+  uint32_t count;
+  uint32_t minCycles;
+  uint32_t maxCycles;
+  uint64_t totalCycles;
+};
+
+#if ENABLE_LOOP_PROFILER
+
+uint8_t registerProfilerSection(const char* name);
+void recordProfilerSample(uint8_t section, uint32_t cycles);
+
+// 作用域计时：构造时读周期计数器，析构时记录差值（计数器约53秒回绕一次，差值不受影响）
+class ProfilerScope {
+public:
+  explicit ProfilerScope(uint8_t section) : section(section), startCycles(ESP.getCycleCount()) {}
+  ~ProfilerScope() { recordProfilerSample(section, ESP.getCycleCount() - startCycles); }
+
+private:
+  uint8_t section;
+  uint32_t startCycles;
+};
+
+#define PROFILER_CONCAT_(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+
+// 统计所在作用域的耗时，name须为字符串常量
+#define PROFILE_SCOPE(name) \
+  static const uint8_t PROFILER_CONCAT(profilerSection_, __LINE__) = registerProfilerSection(name); \
+  ProfilerScope PROFILER_CONCAT(profilerScope_, __LINE__)(PROFILER_CONCAT(profilerSection_, __LINE__))
+
+// 函数声明
+const ProfilerSection* getProfilerSection(const char* name);
+const char* getProfilerSectionName(uint8_t section);
+void resetProfiler();
+void printProfilerReport();
+const char* getProfilerReport();
+
+#else
+
+#define PROFILE_SCOPE(name) do {} while (0)
+
+inline const ProfilerSection* getProfilerSection(const char*) { return nullptr; }
+inline const char* getProfilerSectionName(uint8_t) { return nullptr; }
+inline void resetProfiler() {}
+inline void printProfilerReport() {}
+inline const char* getProfilerReport() { return ""; }
+
+#endif // ENABLE_LOOP_PROFILER
+
+#endif // LOOP_PROFILER_H
@@ -0,0 +1,687 @@
+/**
+ * @file metrics_server.cpp
+ * @brief Prometheus指标服务实现
+ *
+ * 同一时刻只服务一个连接（抓取间隔远大于一次应答的时间，其余连接在监听队列中等待），
+ * 按"读请求 → 逐块发送 → 等确认后关闭"的状态机每次主循环推进一步。
+ * 指标按段和段内的项组织，逐项格式化进栈上的块缓冲区，放不下的一项回退到下一块，
+ * 格式串和段表都在闪存中，整个应答只占用一个块的栈空间。
+ * 关闭连接前等待已写出的数据全部被确认，stop()不会在flush()中等待
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#define LOG_MODULE NET
+
+#include "metrics_server.h"
+#include "config.h"
+#include "global_config.h"
+#include "logger.h"
+#include "version.h"
+#include "runtime_monitor.h"
+#include "idle_manager.h"
+#include "task_scheduler.h"
+#include "ntp_engine.h"
+#include "clock_discipline.h"
+#include "heap_tracer.h"
+#include "config_store.h"
+#include <ESP8266WiFi.h>
+#include <stdarg.h>
+
+// 块缓冲区大小（栈上），含块头和块尾；只在发送窗口放得下整块时才写
+static const size_t METRICS_CHUNK_SIZE = 512;
+static const size_t METRICS_CHUNK_HEADER = 8;    // 为块头"1F6\r\n"预留
+static const size_t METRICS_CHUNK_TRAILER = 2;   // 块尾"\r\n"
+// 每次主循环最多读取的请求字节数
+static const size_t METRICS_READ_SIZE = 128;
+// 请求行只保存方法和路径所需的长度
+static const uint8_t METRICS_REQUEST_LINE_SIZE = 32;
+
+static const char METRICS_RESPONSE_HEADER[] PROGMEM =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "Connection: close\r\n\r\n";
+static const char METRICS_NOT_FOUND[] PROGMEM =
+    "HTTP/1.1 404 Not Found\r\n"
+    "Content-Type: text/plain\r\n"
+    "Content-Length: 10\r\n"
+    "Connection: close\r\n\r\n"
+    "Not Found\n";
+static const char METRICS_LAST_CHUNK[] PROGMEM = "0\r\n\r\n";
+
+enum MetricsClientState : uint8_t {
+  METRICS_CLIENT_IDLE,      // 没有连接
+  METRICS_CLIENT_READING,   // 读取请求头
+  METRICS_CLIENT_SENDING,   // 逐块发送指标
+  METRICS_CLIENT_CLOSING    // 应答已写完，等待对端确认后关闭
+};
+
+static WiFiServer metricsServer(METRICS_PORT);
+static WiFiClient metricsClient;
+
+static struct {
+  MetricsClientState state;
+  unsigned long startMillis;      // 接受连接的时刻
+  size_t sendWindow;              // 接受连接时的发送窗口，数据全部确认后恢复到此值
+  char requestLine[METRICS_REQUEST_LINE_SIZE];
+  uint8_t requestLineLength;
+  bool requestLineDone;
+  uint8_t headerEndMatched;       // 已匹配的"\r\n\r\n"字节数
+  uint8_t section;                // 下一个要输出的段
+  uint8_t item;                   // 段内下一项
+  MetricsServerStats stats;
+} metrics = {};
+
+// =============================================================================
+// 格式化
+// =============================================================================
+
+// 一块应答的正文缓冲区；写满时置overflow，由调用者回退到上一项末尾
+struct MetricsBuffer {
+  char* data;
+  size_t size;
+  size_t length;
+  bool overflow;
+};
+
+static void appendf(MetricsBuffer& out, PGM_P format, ...) __attribute__((format(printf, 2, 3)));
+
+static void appendf(MetricsBuffer& out, PGM_P format, ...) {
+  if (out.overflow) {
+    return;
+  }
+  size_t space = out.size - out.length;
+  va_list args;
+  va_start(args, format);
+  int written = vsnprintf_P(out.data + out.length, space, format, args);
+  va_end(args);
+  if (written < 0 || (size_t)written >= space) {
+    out.overflow = true;
+    return;
+  }
+  out.length += written;
+}
+
+// 定点数：value按decimals位小数输出并换行（如毫秒配3位小数即为秒）
+static void appendDecimal(MetricsBuffer& out, int32_t value, uint8_t decimals) {
+  uint32_t scale = 1;
+  for (uint8_t i = 0; i < decimals; i++) {
+    scale *= 10;
+  }
+  uint32_t magnitude = (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;
+  appendf(out, PSTR("%s%u.%0*u\n"), (value < 0) ? "-" : "", magnitude / scale, (int)decimals, magnitude % scale);
+}
+
+// 指标族的HELP和TYPE行；name、type、help须为字符串常量
+#define METRIC_FAMILY(out, name, type, help) \
+  appendf(out, PSTR("# HELP " name " " help "\n# TYPE " name " " type "\n"))
+
+// 一个样本；name可带标签，format为数值的格式
+#define METRIC_SAMPLE(out, name, format, ...) appendf(out, PSTR(name " " format "\n"), __VA_ARGS__)
+
+// 一个定点数样本
+#define METRIC_DECIMAL(out, name, value, decimals) \
+  do { appendf(out, PSTR(name " ")); appendDecimal(out, value, decimals); } while (0)
+
+// =============================================================================
+// 指标段
+// =============================================================================
+
+// 一段指标：write输出第item项（可以不输出任何内容），每项须能放进一块
+typedef void (*MetricsWriter)(MetricsBuffer& out, uint8_t item);
+
+struct MetricsSection {
+  MetricsWriter write;
+  uint8_t items;
+};
+
+static void writeSystemMetrics(MetricsBuffer& out, uint8_t item) {
+  switch (item) {
+    case 0:
+      METRIC_FAMILY(out, "clock_build_info", "gauge", "Firmware version");
+      appendf(out, PSTR("clock_build_info{version=\"" FIRMWARE_VERSION_STRING "\",commit=\"" GIT_COMMIT "\"} 1\n"));
+      break;
+    case 1: {
+      uint64_t uptime = getMonotonicMillis();
+      METRIC_FAMILY(out, "clock_uptime_seconds", "gauge", "Seconds since boot");
+      METRIC_SAMPLE(out, "clock_uptime_seconds", "%u.%03u", (uint32_t)(uptime / 1000), (uint32_t)(uptime % 1000));
+      break;
+    }
+    case 2: {
+      uint64_t idleMs = getIdleMillis();
+      METRIC_FAMILY(out, "clock_idle_seconds_total", "counter", "Seconds the main loop spent idle");
+      METRIC_SAMPLE(out, "clock_idle_seconds_total", "%u.%03u", (uint32_t)(idleMs / 1000), (uint32_t)(idleMs % 1000));
+      break;
+    }
+    case 3:
+      METRIC_FAMILY(out, "clock_cpu_duty_ratio", "gauge", "Fraction of time the CPU was not idle");
+      METRIC_DECIMAL(out, "clock_cpu_duty_ratio", runtimeStats.cpuDutyPermille, 3);
+      break;
+    case 4:
+      METRIC_FAMILY(out, "clock_supply_current_estimate_amps", "gauge", "Estimated ESP8266 module current");
+      METRIC_DECIMAL(out, "clock_supply_current_estimate_amps", runtimeStats.estimatedCurrentUa, 6);
+      break;
+    case 5:
+      METRIC_FAMILY(out, "clock_loop_last_seconds", "gauge", "Duration of the last main loop pass");
+      METRIC_DECIMAL(out, "clock_loop_last_seconds", runtimeStats.lastLoopTime, 3);
+      break;
+    case 6:
+      METRIC_FAMILY(out, "clock_loop_max_seconds", "gauge", "Longest main loop pass since boot");
+      METRIC_DECIMAL(out, "clock_loop_max_seconds", runtimeStats.maxLoopTime, 3);
+      break;
+    case 7:
+      METRIC_FAMILY(out, "clock_log_dropped_total", "counter", "Deferred log lines dropped");
+      METRIC_SAMPLE(out, "clock_log_dropped_total", "%u", getLogDroppedCount());
+      break;
+    case 8:
+      METRIC_FAMILY(out, "clock_metrics_requests_total", "counter", "Metrics server connections by outcome");
+      METRIC_SAMPLE(out, "clock_metrics_requests_total{result=\"ok\"}", "%u", metrics.stats.scrapes);
+      METRIC_SAMPLE(out, "clock_metrics_requests_total{result=\"not_found\"}", "%u", metrics.stats.notFound);
+      METRIC_SAMPLE(out, "clock_metrics_requests_total{result=\"aborted\"}", "%u", metrics.stats.aborted);
+      break;
+  }
+}
+
+static void writeHeapMetrics(MetricsBuffer& out, uint8_t item) {
+  switch (item) {
+    case 0:
+      METRIC_FAMILY(out, "clock_heap_free_bytes", "gauge", "Free heap");
+      METRIC_SAMPLE(out, "clock_heap_free_bytes", "%u", ESP.getFreeHeap());
+      break;
+    case 1:
+      METRIC_FAMILY(out, "clock_heap_min_free_bytes", "gauge", "Lowest free heap seen by the runtime monitor");
+      METRIC_SAMPLE(out, "clock_heap_min_free_bytes", "%lu", runtimeStats.minFreeHeap);
+      break;
+    case 2:
+      METRIC_FAMILY(out, "clock_heap_max_block_bytes", "gauge", "Largest allocatable heap block");
+      METRIC_SAMPLE(out, "clock_heap_max_block_bytes", "%u", ESP.getMaxFreeBlockSize());
+      break;
+    case 3:
+      METRIC_FAMILY(out, "clock_heap_fragmentation_ratio", "gauge", "Heap fragmentation");
+      METRIC_DECIMAL(out, "clock_heap_fragmentation_ratio", ESP.getHeapFragmentation(), 2);
+      break;
+    case 4:
+      METRIC_FAMILY(out, "clock_heap_min_max_block_bytes", "gauge", "Smallest largest-block seen by the runtime monitor");
+      METRIC_SAMPLE(out, "clock_heap_min_max_block_bytes", "%lu", runtimeStats.minMaxFreeBlock);
+      break;
+    case 5:
+      METRIC_FAMILY(out, "clock_heap_max_fragmentation_ratio", "gauge", "Highest heap fragmentation seen");
+      METRIC_DECIMAL(out, "clock_heap_max_fragmentation_ratio", runtimeStats.maxHeapFragmentation, 2);
+      break;
+    case 6:
+      METRIC_FAMILY(out, "clock_heap_loop_allocations_total", "counter",
+                    "Heap allocations inside the steady-state main loop");
+      METRIC_SAMPLE(out, "clock_heap_loop_allocations_total", "%u", getHeapTraceStats().loopAllocations);
+      break;
+    case 7:
+      METRIC_FAMILY(out, "clock_heap_loop_shrink_total", "counter",
+                    "Steady main loop passes that ended with less free heap or a smaller largest block");
+      METRIC_SAMPLE(out, "clock_heap_loop_shrink_total", "%u", getHeapTraceStats().heapShrinkLoops);
+      break;
+  }
+}
+
+// 任务统计三个指标族共用：第0项为HELP/TYPE，第1项起每项对应一个任务槽位
+static void writeTaskRuns(MetricsBuffer& out, uint8_t item) {
+  if (item == 0) {
+    METRIC_FAMILY(out, "clock_task_runs_total", "counter", "Scheduler task runs");
+    return;
+  }
+  const TaskStats* stats = getTaskStats(item - 1);
+  if (stats) {
+    appendf(out, PSTR("clock_task_runs_total{task=\"%s\"} %u\n"), stats->name, stats->runCount);
+  }
+}
+
+static void writeTaskLate(MetricsBuffer& out, uint8_t item) {
+  if (item == 0) {
+    METRIC_FAMILY(out, "clock_task_late_total", "counter", "Scheduler task runs that fell a whole interval behind");
+    return;
+  }
+  const TaskStats* stats = getTaskStats(item - 1);
+  if (stats) {
+    appendf(out, PSTR("clock_task_late_total{task=\"%s\"} %u\n"), stats->name, stats->lateCount);
+  }
+}
+
+static void writeTaskMaxRun(MetricsBuffer& out, uint8_t item) {
+  if (item == 0) {
+    METRIC_FAMILY(out, "clock_task_max_run_seconds", "gauge", "Longest scheduler task run");
+    return;
+  }
+  const TaskStats* stats = getTaskStats(item - 1);
+  if (stats) {
+    appendf(out, PSTR("clock_task_max_run_seconds{task=\"%s\"} "), stats->name);
+    appendDecimal(out, stats->maxRunMicros, 6);
+  }
+}
+
+static void writeErrorMetrics(MetricsBuffer& out, uint8_t item) {
+  (void)item;
+  uint32_t known = runtimeStats.wifiErrors + runtimeStats.ntpErrors + runtimeStats.rtcErrors + runtimeStats.i2cErrors;
+  METRIC_FAMILY(out, "clock_errors_total", "counter", "Reported errors by subsystem");
+  METRIC_SAMPLE(out, "clock_errors_total{type=\"wifi\"}", "%u", runtimeStats.wifiErrors);
+  METRIC_SAMPLE(out, "clock_errors_total{type=\"ntp\"}", "%u", runtimeStats.ntpErrors);
+  METRIC_SAMPLE(out, "clock_errors_total{type=\"rtc\"}", "%u", runtimeStats.rtcErrors);
+  METRIC_SAMPLE(out, "clock_errors_total{type=\"i2c\"}", "%u", runtimeStats.i2cErrors);
+  METRIC_SAMPLE(out, "clock_errors_total{type=\"other\"}", "%u",
+                (runtimeStats.totalErrors > known) ? runtimeStats.totalErrors - known : 0);
+}
+
+static void writeNetworkMetrics(MetricsBuffer& out, uint8_t item) {
+  switch (item) {
+    case 0:
+      METRIC_FAMILY(out, "clock_wifi_connected", "gauge", "WiFi station connected");
+      METRIC_SAMPLE(out, "clock_wifi_connected", "%d", systemState.networkConnected ? 1 : 0);
+      break;
+    case 1:
+      if (systemState.networkConnected) {
+        METRIC_FAMILY(out, "clock_wifi_rssi_dbm", "gauge", "WiFi signal strength");
+        METRIC_SAMPLE(out, "clock_wifi_rssi_dbm", "%d", (int)WiFi.RSSI());
+      }
+      break;
+    case 2:
+      METRIC_FAMILY(out, "clock_wifi_reconnects_total", "counter", "WiFi reconnections");
+      METRIC_SAMPLE(out, "clock_wifi_reconnects_total", "%u", runtimeStats.wifiReconnectCount);
+      break;
+  }
+}
+
+static void writeNtpMetrics(MetricsBuffer& out, uint8_t item) {
+  switch (item) {
+    case 0:
+      METRIC_FAMILY(out, "clock_ntp_requests_total", "counter", "NTP request packets sent");
+      METRIC_SAMPLE(out, "clock_ntp_requests_total", "%u", ntpEngineStats.requestsSent);
+      break;
+    case 1:
+      METRIC_FAMILY(out, "clock_ntp_replies_total", "counter", "NTP replies by validation result");
+      METRIC_SAMPLE(out, "clock_ntp_replies_total{result=\"accepted\"}", "%u", ntpEngineStats.repliesAccepted);
+      METRIC_SAMPLE(out, "clock_ntp_replies_total{result=\"rejected\"}", "%u", ntpEngineStats.repliesRejected);
+      break;
+    case 2:
+      METRIC_FAMILY(out, "clock_ntp_timeouts_total", "counter", "NTP requests that timed out");
+      METRIC_SAMPLE(out, "clock_ntp_timeouts_total", "%u", ntpEngineStats.timeouts);
+      break;
+    case 3:
+      METRIC_FAMILY(out, "clock_ntp_queries_total", "counter", "NTP queries by outcome");
+      METRIC_SAMPLE(out, "clock_ntp_queries_total{result=\"succeeded\"}", "%u", ntpEngineStats.queriesSucceeded);
+      METRIC_SAMPLE(out, "clock_ntp_queries_total{result=\"failed\"}", "%u", ntpEngineStats.queriesFailed);
+      break;
+    case 4:
+      METRIC_FAMILY(out, "clock_ntp_kiss_of_death_total", "counter", "Kiss-o'-Death replies received");
+      METRIC_SAMPLE(out, "clock_ntp_kiss_of_death_total", "%u", ntpEngineStats.kissOfDeath);
+      break;
+    case 5:
+      METRIC_FAMILY(out, "clock_ntp_poll_interval_seconds", "gauge", "Current NTP poll interval");
+      METRIC_SAMPLE(out, "clock_ntp_poll_interval_seconds", "%lu", getNtpPollInterval() / 1000);
+      break;
+    case 6:
+      METRIC_FAMILY(out, "clock_ntp_time_set", "gauge", "NTP time has been obtained");
+      METRIC_SAMPLE(out, "clock_ntp_time_set", "%d", isNtpTimeSet() ? 1 : 0);
+      break;
+    case 7:
+      if (isNtpTimeSet()) {
+        METRIC_FAMILY(out, "clock_ntp_last_sync_age_seconds", "gauge", "Seconds since the last successful NTP query");
+        METRIC_SAMPLE(out, "clock_ntp_last_sync_age_seconds", "%lu", getNtpResultAge() / 1000);
+      }
+      break;
+    case 8:
+      METRIC_FAMILY(out, "clock_ntp_last_rtt_seconds", "gauge", "Round-trip delay of the last selected NTP sample");
+      METRIC_DECIMAL(out, "clock_ntp_last_rtt_seconds", ntpEngineStats.lastRttMs, 3);
+      break;
+    case 9:
+      METRIC_FAMILY(out, "clock_ntp_last_jitter_seconds", "gauge", "Sample dispersion of the last NTP query");
+      METRIC_DECIMAL(out, "clock_ntp_last_jitter_seconds", ntpEngineStats.lastJitterMs, 3);
+      break;
+    case 10:
+      METRIC_FAMILY(out, "clock_ntp_last_step_seconds", "gauge", "Correction applied by the last NTP query");
+      METRIC_DECIMAL(out, "clock_ntp_last_step_seconds", ntpEngineStats.lastStepMs, 3);
+      break;
+    case 11:
+      METRIC_FAMILY(out, "clock_ntp_dns_lookups_total", "counter", "NTP server DNS lookups (cache misses)");
+      METRIC_SAMPLE(out, "clock_ntp_dns_lookups_total", "%u", ntpEngineStats.dnsLookups);
+      break;
+    case 12:
+      METRIC_FAMILY(out, "clock_ntp_dns_failures_total", "counter", "NTP server DNS lookups that failed or timed out");
+      METRIC_SAMPLE(out, "clock_ntp_dns_failures_total", "%u", ntpEngineStats.dnsFailures);
+      break;
+  }
+}
+
+static void writeTimeMetrics(MetricsBuffer& out, uint8_t item) {
+  switch (item) {
+    case 0: {
+      TimeSource source = timeState.currentTimeSource;
+      METRIC_FAMILY(out, "clock_time_source", "gauge", "Active time source");
+      METRIC_SAMPLE(out, "clock_time_source{source=\"none\"}", "%d", source == TIME_SOURCE_NONE ? 1 : 0);
+      METRIC_SAMPLE(out, "clock_time_source{source=\"rtc\"}", "%d", source == TIME_SOURCE_RTC ? 1 : 0);
+      METRIC_SAMPLE(out, "clock_time_source{source=\"ntp\"}", "%d", source == TIME_SOURCE_NTP ? 1 : 0);
+      METRIC_SAMPLE(out, "clock_time_source{source=\"manual\"}", "%d", source == TIME_SOURCE_MANUAL ? 1 : 0);
+      break;
+    }
+    case 1:
+      METRIC_FAMILY(out, "clock_rtc_time_valid", "gauge", "DS1307 holds a valid time");
+      METRIC_SAMPLE(out, "clock_rtc_time_valid", "%d", systemState.rtcTimeValid ? 1 : 0);
+      break;
+    case 2:
+      if (timeState.lastRtcSync != 0) {
+        METRIC_FAMILY(out, "clock_rtc_last_sync_age_seconds", "gauge", "Seconds since the DS1307 was last set from NTP");
+        METRIC_SAMPLE(out, "clock_rtc_last_sync_age_seconds", "%lu", (millis() - timeState.lastRtcSync) / 1000);
+      }
+      break;
+    case 3:
+      if (isRtcDriftKnown()) {
+        METRIC_FAMILY(out, "clock_rtc_drift_ppb", "gauge", "Estimated DS1307 frequency error");
+        METRIC_SAMPLE(out, "clock_rtc_drift_ppb", "%d", (int)getRtcDriftPpb());
+      }
+      break;
+    case 4:
+      if (isCrystalDriftKnown()) {
+        METRIC_FAMILY(out, "clock_crystal_drift_ppb", "gauge", "Estimated ESP8266 crystal frequency error");
+        METRIC_SAMPLE(out, "clock_crystal_drift_ppb", "%d", (int)getCrystalDriftPpb());
+      }
+      break;
+  }
+}
+
+static void writeUiMetrics(MetricsBuffer& out, uint8_t item) {
+  switch (item) {
+    case 0:
+      METRIC_FAMILY(out, "clock_button_presses_total", "counter", "Button presses");
+      METRIC_SAMPLE(out, "clock_button_presses_total", "%u", runtimeStats.buttonPressCount);
+      break;
+    case 1:
+      METRIC_FAMILY(out, "clock_button_long_presses_total", "counter", "Button long presses");
+      METRIC_SAMPLE(out, "clock_button_long_presses_total", "%u", runtimeStats.longPressCount);
+      break;
+    case 2:
+      METRIC_FAMILY(out, "clock_display_updates_total", "counter", "Display updates");
+      METRIC_SAMPLE(out, "clock_display_updates_total", "%u", runtimeStats.displayUpdateCount);
+      break;
+    case 3:
+      METRIC_FAMILY(out, "clock_display_refreshes_total", "counter", "Forced full display refreshes");
+      METRIC_SAMPLE(out, "clock_display_refreshes_total", "%u", runtimeStats.displayRefreshCount);
+      break;
+  }
+}
+
+static void writeConfigMetrics(MetricsBuffer& out, uint8_t item) {
+  const ConfigStoreStats& store = getConfigStoreStats();
+  switch (item) {
+    case 0:
+      METRIC_FAMILY(out, "clock_config_records_written_total", "counter", "Config records appended to flash");
+      METRIC_SAMPLE(out, "clock_config_records_written_total", "%u", store.recordsWritten);
+      break;
+    case 1:
+      METRIC_FAMILY(out, "clock_config_flushes_total", "counter", "Deferred config flushes");
+      METRIC_SAMPLE(out, "clock_config_flushes_total", "%u", store.flushes);
+      break;
+    case 2:
+      METRIC_FAMILY(out, "clock_config_flush_max_seconds", "gauge", "Longest deferred config flush");
+      METRIC_DECIMAL(out, "clock_config_flush_max_seconds", store.maxFlushMicros, 6);
+      break;
+    case 3:
+      METRIC_FAMILY(out, "clock_config_pending_keys", "gauge", "Config keys changed but not yet flushed");
+      METRIC_SAMPLE(out, "clock_config_pending_keys", "%u", store.pendingKeys);
+      break;
+  }
+}
+
+// 输入延迟直方图：第0项为HELP/TYPE，之后每项一个区间（累计计数），最后一项为总和与计数
+static void writeInputLatency(MetricsBuffer& out, uint8_t item) {
+  if (item == 0) {
+    METRIC_FAMILY(out, "clock_input_latency_seconds", "histogram", "Button event to first frame showing it");
+    return;
+  }
+  if (item <= INPUT_LATENCY_BUCKETS - 1) {
+    uint32_t cumulative = 0;
+    for (uint8_t i = 0; i < item; i++) {
+      cumulative += runtimeStats.inputLatencyHistogram[i];
+    }
+    unsigned long limitMs = getInputLatencyBucketLimit(item - 1);
+    appendf(out, PSTR("clock_input_latency_seconds_bucket{le=\"%lu.%03lu\"} %u\n"), limitMs / 1000, limitMs % 1000,
+            cumulative);
+    return;
+  }
+  METRIC_SAMPLE(out, "clock_input_latency_seconds_bucket{le=\"+Inf\"}", "%u", runtimeStats.inputLatencyCount);
+  METRIC_DECIMAL(out, "clock_input_latency_seconds_sum", runtimeStats.inputLatencyTotalMs, 3);
+  METRIC_SAMPLE(out, "clock_input_latency_seconds_count", "%u", runtimeStats.inputLatencyCount);
+}
+
+static const MetricsSection METRICS_SECTIONS[] PROGMEM = {
+  {writeSystemMetrics, 9},
+  {writeHeapMetrics, 8},
+  {writeTaskRuns, TASK_SCHEDULER_CAPACITY + 1},
+  {writeTaskLate, TASK_SCHEDULER_CAPACITY + 1},
+  {writeTaskMaxRun, TASK_SCHEDULER_CAPACITY + 1},
+  {writeErrorMetrics, 1},
+  {writeNetworkMetrics, 3},
+  {writeNtpMetrics, 13},
+  {writeTimeMetrics, 5},
+  {writeUiMetrics, 4},
+  {writeConfigMetrics, 4},
+  {writeInputLatency, INPUT_LATENCY_BUCKETS + 1},
+};
+
+static const uint8_t METRICS_SECTION_COUNT = sizeof(METRICS_SECTIONS) / sizeof(METRICS_SECTIONS[0]);
+
+// 从当前位置起逐项填充一块，放不下的一项回退，下一块从它开始
+static void fillChunk(MetricsBuffer& out) {
+  while (metrics.section < METRICS_SECTION_COUNT) {
+    MetricsSection section;
+    memcpy_P(&section, &METRICS_SECTIONS[metrics.section], sizeof(section));
+    while (metrics.item < section.items) {
+      size_t mark = out.length;
+      section.write(out, metrics.item);
+      if (out.overflow) {
+        out.length = mark;
+        out.overflow = false;
+        if (mark > 0) {
+          return;
+        }
+        // 单独一项就超过一块，跳过以免卡住
+        LOG_WARNING("Metrics item %u.%u exceeds chunk size", metrics.section, metrics.item);
+      }
+      metrics.item++;
+    }
+    metrics.section++;
+    metrics.item = 0;
+  }
+}
+
+// =============================================================================
+// 连接状态机
+// =============================================================================
+
+static void closeClient() {
+  // 正常结束时数据已全部确认，flush()立即返回；放弃连接时最多等1毫秒
+  metricsClient.stop(1);
+  metrics.state = METRICS_CLIENT_IDLE;
+}
+
+static void abortClient(const char* reason) {
+  LOG_WARNING("Metrics client dropped: %s", reason);
+  metrics.stats.aborted++;
+  closeClient();
+}
+
+// 写出一段闪存中的常量文本（调用前已确认发送窗口放得下）
+static bool writeProgmem(PGM_P text, size_t length) {
+  return metricsClient.write_P(text, length) == length;
+}
+
+static void acceptClient() {
+  metricsClient = metricsServer.accept();
+  if (!metricsClient) {
+    return;
+  }
+  metricsClient.setNoDelay(true);
+  metrics.state = METRICS_CLIENT_READING;
+  metrics.startMillis = millis();
+  metrics.sendWindow = metricsClient.availableForWrite();
+  metrics.requestLine[0] = '\0';
+  metrics.requestLineLength = 0;
+  metrics.requestLineDone = false;
+  metrics.headerEndMatched = 0;
+}
+
+// 请求行是否为GET /metrics（可带查询串）
+static bool isMetricsRequest() {
+  const char* line = metrics.requestLine;
+  if (strncmp_P(line, PSTR("GET /metrics"), 12) != 0) {
+    return false;
+  }
+  return line[12] == ' ' || line[12] == '?' || line[12] == '\0';
+}
+
+static void respond() {
+  if (isMetricsRequest()) {
+    if (!writeProgmem(METRICS_RESPONSE_HEADER, sizeof(METRICS_RESPONSE_HEADER) - 1)) {
+      abortClient("write failed");
+      return;
+    }
+    metrics.section = 0;
+    metrics.item = 0;
+    metrics.state = METRICS_CLIENT_SENDING;
+    return;
+  }
+  LOG_DEBUG("Metrics request rejected: %s", metrics.requestLine);
+  metrics.stats.notFound++;
+  if (!writeProgmem(METRICS_NOT_FOUND, sizeof(METRICS_NOT_FOUND) - 1)) {
+    abortClient("write failed");
+    return;
+  }
+  metrics.state = METRICS_CLIENT_CLOSING;
+}
+
+// 读取请求：保存请求行，读到空行（头部结束）后应答，其余头部丢弃
+static void readRequest() {
+  uint8_t buffer[METRICS_READ_SIZE];
+  int count = metricsClient.read(buffer, sizeof(buffer));
+  for (int i = 0; i < count; i++) {
+    char c = (char)buffer[i];
+    if (!metrics.requestLineDone) {
+      if (c == '\r' || c == '\n') {
+        metrics.requestLineDone = true;
+      } else if (metrics.requestLineLength < METRICS_REQUEST_LINE_SIZE - 1) {
+        metrics.requestLine[metrics.requestLineLength++] = c;
+        metrics.requestLine[metrics.requestLineLength] = '\0';
+      }
+    }
+    if (c == "\r\n\r\n"[metrics.headerEndMatched]) {
+      metrics.headerEndMatched++;
+    } else {
+      metrics.headerEndMatched = (c == '\r') ? 1 : 0;
+    }
+    if (metrics.headerEndMatched == 4) {
+      respond();
+      return;
+    }
+  }
+}
+
+// 发送下一块；整块放不进发送窗口时留到下次循环，write()不会等待确认
+static void sendNextChunk() {
+  char chunk[METRICS_CHUNK_SIZE];
+  if (metricsClient.availableForWrite() < sizeof(chunk)) {
+    return;
+  }
+  if (metrics.section >= METRICS_SECTION_COUNT) {
+    if (!writeProgmem(METRICS_LAST_CHUNK, sizeof(METRICS_LAST_CHUNK) - 1)) {
+      abortClient("write failed");
+      return;
+    }
+    metrics.stats.scrapes++;
+    metrics.state = METRICS_CLIENT_CLOSING;
+    return;
+  }
+
+  MetricsBuffer out = {chunk + METRICS_CHUNK_HEADER, sizeof(chunk) - METRICS_CHUNK_HEADER - METRICS_CHUNK_TRAILER, 0, false};
+  fillChunk(out);
+  if (out.length == 0) {
+    return;
+  }
+  // 块头紧贴在正文之前，块尾紧接正文之后，整块一次写出
+  char header[METRICS_CHUNK_HEADER + 1];
+  int headerLength = snprintf_P(header, sizeof(header), PSTR("%X\r\n"), (unsigned int)out.length);
+  char* start = out.data - headerLength;
+  memcpy(start, header, headerLength);
+  out.data[out.length] = '\r';
+  out.data[out.length + 1] = '\n';
+  size_t total = headerLength + out.length + METRICS_CHUNK_TRAILER;
+  if (metricsClient.write((const uint8_t*)start, total) != total) {
+    abortClient("write failed");
+  }
+}
+
+/**
+ * @brief 开始监听（WiFi连接前调用也可以，连接后即可访问）
+ */
+void initMetricsServer() {
+  metricsServer.begin();
+  metrics.state = METRICS_CLIENT_IDLE;
+  LOG_INFO("Metrics server listening on port %u", METRICS_PORT);
+}
+
+/**
+ * @brief 推进指标服务一步（每次主循环调用）
+ *
+ * 空闲时只检查监听队列；服务连接时每次最多读一段请求或写一块应答
+ */
+void handleMetricsServer() {
+  if (metrics.state == METRICS_CLIENT_IDLE) {
+    if (metricsServer.hasClient()) {
+      acceptClient();
+    }
+    return;
+  }
+
+  if (millis() - metrics.startMillis >= METRICS_CLIENT_TIMEOUT) {
+    // 应答已写完只是确认未到齐时不算失败
+    if (metrics.state == METRICS_CLIENT_CLOSING) {
+      closeClient();
+    } else {
+      abortClient("timeout");
+    }
+    return;
+  }
+
+  switch (metrics.state) {
+    case METRICS_CLIENT_READING:
+      if (!metricsClient.connected()) {
+        abortClient("disconnected");
+        return;
+      }
+      readRequest();
+      break;
+    case METRICS_CLIENT_SENDING:
+      if (!metricsClient.connected()) {
+        abortClient("disconnected");
+        return;
+      }
+      sendNextChunk();
+      break;
+    case METRICS_CLIENT_CLOSING:
+      // 对端收完后先断开也属正常结束
+      if (!metricsClient.connected() || metricsClient.availableForWrite() >= metrics.sendWindow) {
+        closeClient();
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief 是否正在服务一个连接（期间主循环不空闲）
+ */
+bool isMetricsClientActive() {
+  return metrics.state != METRICS_CLIENT_IDLE;
+}
+
+const MetricsServerStats& getMetricsServerStats() {
+  return metrics.stats;
+}
@@ -0,0 +1,33 @@
+/**
+ * @file metrics_server.h
+ * @brief Prometheus指标服务
+ *
+ * 在METRICS_PORT上常驻一个极简HTTP服务，GET /metrics按Prometheus文本格式
+ * 输出运行时统计、堆内存、循环与任务耗时、NTP/RTC状态。应答用分块传输
+ * 直接写到连接上，不拼接String、不申请堆内存；每次主循环最多写一块，
+ * 且只在发送窗口放得下时才写，不会因等待TCP确认阻塞主循环
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <Arduino.h>
+
+// 指标服务统计
+struct MetricsServerStats {
+  uint32_t scrapes;       // 完整发出的/metrics应答数
+  uint32_t notFound;      // 其他路径或方法的请求数（应答404）
+  uint32_t aborted;       // 超时或对端提前断开而放弃的连接数
+};
+
+// 函数声明
+void initMetricsServer();
+void handleMetricsServer();
+bool isMetricsClientActive();
+const MetricsServerStats& getMetricsServerStats();
+
+#endif // METRICS_SERVER_H
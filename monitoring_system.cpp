@@ -0,0 +1,746 @@
+/**
+ * @file monitoring_system.cpp
+ * @brief 生产环境监控系统实现
+ *
+ * 指标从运行时统计、NTP引擎、空闲管理器和显示刷新统计中汇总。
+ * 历史快照写入固定大小的环形缓冲区，需要求平均的瞬时量按写入顺序累加，
+ * 每个槽位保存写入该快照之前的累计和，任意最近N个快照的和都是一次相减。
+ * 累计和随运行时间增大，每绕环一周以最旧的快照为起点重新累加一次
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#include "monitoring_system.h"
+#include "runtime_monitor.h"
+#include "idle_manager.h"
+#include "ntp_engine.h"
+#include "display_flush.h"
+#include "clock_discipline.h"
+#include "task_scheduler.h"
+#include "logger.h"
+#include <ESP8266WiFi.h>
+#include <stddef.h>
+
+// 全局变量
+MonitoringConfig monitoringConfig;
+SystemMetrics currentMetrics;
+HealthCheckResult lastHealthCheck;
+MetricsHistory metricsHistory;
+
+// 监控的全部状态都静态分配，RAM占用在编译期固定
+static const size_t MONITORING_RAM_BUDGET = 3840;
+
+// 需要求平均的瞬时量；其余字段是累计计数，平均值中取最新快照的值
+enum MetricKind : uint8_t {
+    METRIC_FLOAT,
+    METRIC_UINT32,
+    METRIC_INT
+};
+
+struct MetricField {
+    uint8_t offset;
+    MetricKind kind;
+};
+
+#define METRIC_FIELD(field, kind) { (uint8_t)offsetof(SystemMetrics, field), kind }
+
+static const MetricField AVERAGED_FIELDS[] = {
+    METRIC_FIELD(cpuUsagePercent, METRIC_FLOAT),
+    METRIC_FIELD(freeHeapSize, METRIC_UINT32),
+    METRIC_FIELD(heapUsagePercent, METRIC_FLOAT),
+    METRIC_FIELD(maxFreeBlockSize, METRIC_UINT32),
+    METRIC_FIELD(heapFragmentation, METRIC_FLOAT),
+    METRIC_FIELD(wifiSignalStrength, METRIC_INT),
+    METRIC_FIELD(ntpSuccessRate, METRIC_FLOAT),
+    METRIC_FIELD(rtcAccuracy, METRIC_FLOAT),
+    METRIC_FIELD(averageFrameRate, METRIC_FLOAT),
+    METRIC_FIELD(errorRatePerHour, METRIC_FLOAT),
+    METRIC_FIELD(currentConsumption, METRIC_FLOAT)
+};
+
+static const uint8_t AVERAGED_FIELD_COUNT = sizeof(AVERAGED_FIELDS) / sizeof(AVERAGED_FIELDS[0]);
+
+// 各瞬时量的累计和：runningSums为已写入的全部快照之和，
+// prefixSums[slot]为写入该槽位快照之前的runningSums
+static float runningSums[AVERAGED_FIELD_COUNT];
+static float prefixSums[METRICS_HISTORY_SIZE][AVERAGED_FIELD_COUNT];
+
+// 区间量的基线和调度状态
+static struct {
+    bool paused;
+    uint32_t runCount;              // updateMonitoringSystem()的运行次数
+    uint32_t lastRunMicros;         // 最近一次运行的耗时
+    uint32_t maxRunMicros;          // 单次运行的最长耗时
+    uint64_t lastMonotonicMillis;   // 上次采集CPU指标的时刻
+    uint64_t lastIdleMillis;        // 上次采集时的累计空闲时间
+    unsigned long lastFrameMillis;  // 上次采集帧率的时刻
+    uint32_t lastFrameCount;        // 上次采集时的已发送帧数
+    unsigned long lastRtcSync;      // 上次看到的RTC同步时刻
+    bool wifiConnected;
+    unsigned long wifiConnectedSince;
+    uint32_t errorsAtSnapshot;      // 上次保存快照时的错误总数
+    SystemHealthStatus lastAlertStatus;
+    unsigned long lastAlertMillis;
+} monitor;
+
+static_assert(sizeof(MetricsHistory) + sizeof(SystemMetrics) + sizeof(HealthCheckResult) +
+              sizeof(runningSums) + sizeof(prefixSums) + sizeof(monitor) <= MONITORING_RAM_BUDGET,
+              "monitoring state exceeds MONITORING_RAM_BUDGET");
+
+// 辅助：按字段类型读写指标
+static float readMetric(const SystemMetrics& metrics, const MetricField& field) {
+    const uint8_t* p = (const uint8_t*)&metrics + field.offset;
+    switch (field.kind) {
+        case METRIC_UINT32:
+            return (float)*(const uint32_t*)p;
+        case METRIC_INT:
+            return (float)*(const int*)p;
+        default:
+            return *(const float*)p;
+    }
+}
+
+static void writeMetric(SystemMetrics& metrics, const MetricField& field, float value) {
+    uint8_t* p = (uint8_t*)&metrics + field.offset;
+    switch (field.kind) {
+        case METRIC_UINT32:
+            *(uint32_t*)p = (uint32_t)(value + 0.5f);
+            break;
+        case METRIC_INT:
+            *(int*)p = (int)(value < 0 ? value - 0.5f : value + 0.5f);
+            break;
+        default:
+            *(float*)p = value;
+            break;
+    }
+}
+
+// 辅助：第age新的快照（0为最新）
+static const SystemMetrics& sampleAt(uint8_t age) {
+    uint8_t index = (metricsHistory.currentIndex + METRICS_HISTORY_SIZE - 1 - age) % METRICS_HISTORY_SIZE;
+    return metricsHistory.samples[index];
+}
+
+// 辅助：第age新的快照所在的槽位
+static uint8_t slotAt(uint8_t age) {
+    return (metricsHistory.currentIndex + METRICS_HISTORY_SIZE - 1 - age) % METRICS_HISTORY_SIZE;
+}
+
+// 辅助：记下槽位的前缀和，再把其中的快照累加进去
+static void appendToSums(uint8_t slot) {
+    const SystemMetrics& metrics = metricsHistory.samples[slot];
+    for (uint8_t i = 0; i < AVERAGED_FIELD_COUNT; i++) {
+        prefixSums[slot][i] = runningSums[i];
+        runningSums[i] += readMetric(metrics, AVERAGED_FIELDS[i]);
+    }
+}
+
+// 辅助：从最旧的快照起重新累加，防止累计和过大后损失精度
+static void rebaseSums() {
+    memset(runningSums, 0, sizeof(runningSums));
+    for (uint8_t age = metricsHistory.sampleCount; age > 0; age--) {
+        appendToSums(slotAt(age - 1));
+    }
+}
+
+// 辅助：数值越大越差的指标分级，达到警告阈值的3/4记为良好
+static SystemHealthStatus gradeAbove(float value, float warning, float critical) {
+    if (value >= critical) {
+        return HEALTH_CRITICAL;
+    }
+    if (value >= warning) {
+        return HEALTH_WARNING;
+    }
+    if (value >= warning * 3 / 4) {
+        return HEALTH_GOOD;
+    }
+    return HEALTH_EXCELLENT;
+}
+
+static SystemHealthStatus worseOf(SystemHealthStatus a, SystemHealthStatus b) {
+    return (b > a) ? b : a;
+}
+
+// 辅助：自上次快照以来某个计数的增量（还没有快照时为启动以来）
+static uint32_t countSinceSnapshot(uint32_t SystemMetrics::*counter, const SystemMetrics& metrics) {
+    uint32_t base = (metricsHistory.sampleCount > 0) ? sampleAt(0).*counter : 0;
+    return (metrics.*counter >= base) ? metrics.*counter - base : metrics.*counter;
+}
+
+// 各子系统的分级（按给定的指标，供健康检查和整体得分共用）
+static SystemHealthStatus gradeCpu(const SystemMetrics& metrics) {
+    return gradeAbove(metrics.cpuUsagePercent, CPU_USAGE_WARNING_THRESHOLD, CPU_USAGE_CRITICAL_THRESHOLD);
+}
+
+static SystemHealthStatus gradeMemory(const SystemMetrics& metrics) {
+    return gradeAbove(metrics.heapUsagePercent, MEMORY_WARNING_THRESHOLD, MEMORY_CRITICAL_THRESHOLD);
+}
+
+static SystemHealthStatus gradeNetwork(const SystemMetrics& metrics) {
+    // 未连接WiFi时信号强度记为0；时钟仍可依靠RTC走时，只算警告
+    if (metrics.wifiSignalStrength == 0) {
+        return HEALTH_WARNING;
+    }
+    SystemHealthStatus status = HEALTH_EXCELLENT;
+    if (metrics.wifiSignalStrength < WIFI_SIGNAL_WARNING_THRESHOLD) {
+        status = HEALTH_WARNING;
+    } else if (metrics.wifiSignalStrength < WIFI_SIGNAL_WARNING_THRESHOLD + 10) {
+        status = HEALTH_GOOD;
+    }
+    if (metrics.ntpSuccessRate < NTP_SUCCESS_WARNING_THRESHOLD) {
+        status = worseOf(status, HEALTH_WARNING);
+    } else if (metrics.ntpSuccessRate < 90) {
+        status = worseOf(status, HEALTH_GOOD);
+    }
+    return status;
+}
+
+static SystemHealthStatus gradeTime(const SystemMetrics& metrics) {
+    SystemHealthStatus status;
+    switch (timeState.currentTimeSource) {
+        case TIME_SOURCE_NTP:
+            status = HEALTH_EXCELLENT;
+            break;
+        case TIME_SOURCE_RTC:
+            status = HEALTH_GOOD;
+            break;
+        case TIME_SOURCE_MANUAL:
+            status = HEALTH_WARNING;
+            break;
+        default:
+            return HEALTH_CRITICAL;
+    }
+    if (countSinceSnapshot(&SystemMetrics::rtcErrorCount, metrics) > 0) {
+        status = worseOf(status, HEALTH_WARNING);
+    }
+    return status;
+}
+
+static SystemHealthStatus gradeDisplay(const SystemMetrics& metrics) {
+    // 时钟每秒至少刷新一帧，采集区间内一帧都没有发送说明刷新停止了
+    return (metrics.averageFrameRate > 0) ? HEALTH_EXCELLENT : HEALTH_WARNING;
+}
+
+static SystemHealthStatus gradeHardware(const SystemMetrics& metrics) {
+    uint32_t i2cErrors = countSinceSnapshot(&SystemMetrics::i2cErrorCount, metrics);
+    SystemHealthStatus status = HEALTH_EXCELLENT;
+    if (i2cErrors >= ERROR_RATE_WARNING_THRESHOLD) {
+        status = HEALTH_WARNING;
+    } else if (i2cErrors > 0) {
+        status = HEALTH_GOOD;
+    }
+    // 本次启动由看门狗复位引起
+    if (metrics.watchdogResets > 0) {
+        status = worseOf(status, HEALTH_GOOD);
+    }
+    return status;
+}
+
+static SystemHealthStatus gradePower(const SystemMetrics& metrics) {
+    if (metrics.currentConsumption >= CURRENT_WARNING_THRESHOLD) {
+        return HEALTH_WARNING;
+    }
+    return (metrics.currentConsumption >= CURRENT_WARNING_THRESHOLD * 3 / 4) ? HEALTH_GOOD : HEALTH_EXCELLENT;
+}
+
+static SystemHealthStatus gradeErrors(const SystemMetrics& metrics) {
+    return gradeAbove(metrics.errorRatePerHour, ERROR_RATE_WARNING_THRESHOLD, ERROR_RATE_CRITICAL_THRESHOLD);
+}
+
+// 辅助：按运行次数判断某个周期的工作是否到期（任务按MONITOR_SYSTEM_INTERVAL运行）
+static bool isRunDue(uint32_t intervalMs) {
+    uint32_t every = intervalMs / MONITOR_SYSTEM_INTERVAL;
+    return every <= 1 || monitor.runCount % every == 0;
+}
+
+/**
+ * @brief 初始化监控系统（区间量的基线从此刻开始）
+ */
+bool initMonitoringSystem() {
+    resetMonitoringConfigToDefault();
+    memset(&currentMetrics, 0, sizeof(currentMetrics));
+    memset(&metricsHistory, 0, sizeof(metricsHistory));
+    memset(runningSums, 0, sizeof(runningSums));
+    memset(prefixSums, 0, sizeof(prefixSums));
+    memset(&monitor, 0, sizeof(monitor));
+    memset(&lastHealthCheck, 0, sizeof(lastHealthCheck));
+    lastHealthCheck.overallStatus = HEALTH_UNKNOWN;
+
+    unsigned long now = millis();
+    monitor.lastMonotonicMillis = getMonotonicMillis();
+    monitor.lastIdleMillis = getIdleMillis();
+    monitor.lastFrameMillis = now;
+    monitor.lastFrameCount = displayFlushStats.frameCount;
+    monitor.lastRtcSync = timeState.lastRtcSync;
+    monitor.errorsAtSnapshot = runtimeStats.totalErrors;
+    monitor.lastAlertStatus = HEALTH_EXCELLENT;
+    metricsHistory.lastUpdateTime = now;
+
+    // 复位原因在本次启动内不变，只在这里读取一次
+    String reason = ESP.getResetReason();
+    currentMetrics.watchdogResets = (reason.indexOf("Watchdog") >= 0) ? 1 : 0;
+    currentMetrics.manualResets = (reason.indexOf("External") >= 0) ? 1 : 0;
+    currentMetrics.minFreeHeap = ESP.getFreeHeap();
+
+    LOG_INFO("Monitoring initialized: %u-hour history, %u bytes",
+             METRICS_HISTORY_SIZE, (unsigned)sizeof(metricsHistory));
+    return true;
+}
+
+/**
+ * @brief 调度器任务：采集指标，按周期做健康检查、性能检查和保存历史快照
+ */
+void updateMonitoringSystem() {
+    if (!monitoringConfig.enabled || monitor.paused) {
+        return;
+    }
+    uint32_t start = micros();
+    monitor.runCount++;
+
+    bool collected = false;
+    if (monitoringConfig.metricsCollectionEnabled && isRunDue(monitoringConfig.systemCheckInterval)) {
+        performSystemMonitoring();
+        collected = true;
+    }
+
+    if (monitoringConfig.healthCheckEnabled && isRunDue(monitoringConfig.healthCheckInterval)) {
+        HealthCheckResult result = performHealthCheck();
+        if (shouldSendAlert(result)) {
+            sendHealthAlert(result);
+        } else if (result.overallStatus < (SystemHealthStatus)monitoringConfig.alertThresholdLevel) {
+            // 恢复正常后，下一次变差立即报警
+            monitor.lastAlertStatus = HEALTH_EXCELLENT;
+        }
+    }
+
+    if (monitoringConfig.alertingEnabled && isRunDue(monitoringConfig.performanceCheckInterval) &&
+        (currentMetrics.cpuUsagePercent >= CPU_USAGE_WARNING_THRESHOLD ||
+         currentMetrics.heapUsagePercent >= MEMORY_WARNING_THRESHOLD)) {
+        sendPerformanceAlert(currentMetrics);
+    }
+
+    if (collected && isRunDue(METRICS_HISTORY_INTERVAL)) {
+        saveMetricsToHistory();
+        cleanupOldMetrics();
+    }
+
+    uint32_t spent = micros() - start;
+    monitor.lastRunMicros = spent;
+    if (spent > monitor.maxRunMicros) {
+        monitor.maxRunMicros = spent;
+    }
+}
+
+/**
+ * @brief 采集全部指标到currentMetrics
+ */
+void performSystemMonitoring() {
+    collectCpuMemoryMetrics();
+    collectNetworkMetrics();
+    collectTimeMetrics();
+    collectDisplayMetrics();
+    collectHardwareMetrics();
+    collectPowerMetrics();
+    collectErrorMetrics();
+}
+
+/**
+ * @brief 按当前指标评估各子系统，结果同时保存在lastHealthCheck中
+ */
+HealthCheckResult performHealthCheck() {
+    HealthCheckResult result;
+    memset(&result, 0, sizeof(result));
+    result.cpuStatus = evaluateCpuHealth();
+    result.memoryStatus = evaluateMemoryHealth();
+    result.networkStatus = evaluateNetworkHealth();
+    result.timeStatus = evaluateTimeHealth();
+    result.displayStatus = evaluateDisplayHealth();
+    result.hardwareStatus = evaluateHardwareHealth();
+    result.powerStatus = evaluatePowerHealth();
+    SystemHealthStatus errorStatus = gradeErrors(currentMetrics);
+    result.timestamp = millis();
+
+    const struct {
+        const char* name;
+        SystemHealthStatus status;
+    } parts[] = {
+        {"cpu", result.cpuStatus},
+        {"memory", result.memoryStatus},
+        {"network", result.networkStatus},
+        {"time", result.timeStatus},
+        {"display", result.displayStatus},
+        {"hardware", result.hardwareStatus},
+        {"power", result.powerStatus},
+        {"errors", errorStatus}
+    };
+
+    // 摘要列出有警告或严重问题的子系统
+    char issues[64] = "";
+    size_t used = 0;
+    result.overallStatus = HEALTH_EXCELLENT;
+    for (const auto& part : parts) {
+        result.overallStatus = worseOf(result.overallStatus, part.status);
+        if (part.status < HEALTH_WARNING) {
+            continue;
+        }
+        if (part.status == HEALTH_CRITICAL) {
+            result.criticalIssuesCount++;
+        } else {
+            result.warningIssuesCount++;
+        }
+        int written = snprintf(issues + used, sizeof(issues) - used, "%s%s", used ? ", " : "", part.name);
+        if (written > 0) {
+            used += ((size_t)written < sizeof(issues) - used) ? (size_t)written : sizeof(issues) - used - 1;
+        }
+    }
+
+    if (result.criticalIssuesCount + result.warningIssuesCount == 0) {
+        snprintf(result.summaryMessage, sizeof(result.summaryMessage), "All subsystems %s",
+                 result.overallStatus == HEALTH_EXCELLENT ? "excellent" : "good");
+    } else {
+        snprintf(result.summaryMessage, sizeof(result.summaryMessage), "%u critical, %u warning: %s",
+                 (unsigned)result.criticalIssuesCount, (unsigned)result.warningIssuesCount, issues);
+    }
+
+    lastHealthCheck = result;
+    if (monitoringConfig.loggingEnabled) {
+        LOG_DEBUG("Health %s: %s", healthStatusToString(result.overallStatus), result.summaryMessage);
+    }
+    return result;
+}
+
+void collectCpuMemoryMetrics() {
+    // CPU使用率取上次采集以来的非空闲时间比例；空闲统计被重置过时退回累计值
+    uint64_t nowMillis = getMonotonicMillis();
+    uint64_t idleMillis = getIdleMillis();
+    if (nowMillis > monitor.lastMonotonicMillis && idleMillis >= monitor.lastIdleMillis) {
+        uint64_t span = nowMillis - monitor.lastMonotonicMillis;
+        uint64_t idle = idleMillis - monitor.lastIdleMillis;
+        if (idle > span) {
+            idle = span;
+        }
+        currentMetrics.cpuUsagePercent = (float)(span - idle) * 100.0f / (float)span;
+    } else {
+        currentMetrics.cpuUsagePercent = getCpuDutyCyclePermille() / 10.0f;
+    }
+    monitor.lastMonotonicMillis = nowMillis;
+    monitor.lastIdleMillis = idleMillis;
+
+    uint32_t freeHeap = 0;
+    uint32_t maxBlock = 0;
+    uint8_t fragmentation = 0;
+    ESP.getHeapStats(&freeHeap, &maxBlock, &fragmentation);
+    currentMetrics.freeHeapSize = freeHeap;
+    currentMetrics.maxFreeBlockSize = maxBlock;
+    currentMetrics.heapFragmentation = fragmentation;
+    if (currentMetrics.minFreeHeap == 0 || freeHeap < currentMetrics.minFreeHeap) {
+        currentMetrics.minFreeHeap = freeHeap;
+    }
+    // 以启动时的空闲堆为总量
+    unsigned long initialHeap = runtimeStats.initialHeap;
+    currentMetrics.heapUsagePercent = (initialHeap > freeHeap) ?
+        (float)(initialHeap - freeHeap) * 100.0f / (float)initialHeap : 0.0f;
+}
+
+void collectNetworkMetrics() {
+    unsigned long now = millis();
+    bool connected = (WiFi.status() == WL_CONNECTED);
+    if (connected && !monitor.wifiConnected) {
+        monitor.wifiConnectedSince = now;
+    }
+    monitor.wifiConnected = connected;
+    currentMetrics.wifiUptimeSeconds = connected ? (now - monitor.wifiConnectedSince) / 1000 : 0;
+    currentMetrics.wifiSignalStrength = connected ? (int)WiFi.RSSI() : 0;
+
+    currentMetrics.ntpSyncCount = ntpEngineStats.queriesSucceeded;
+    currentMetrics.ntpFailCount = ntpEngineStats.queriesFailed;
+    uint32_t queries = ntpEngineStats.queriesSucceeded + ntpEngineStats.queriesFailed;
+    currentMetrics.ntpSuccessRate = (queries > 0) ? ntpEngineStats.queriesSucceeded * 100.0f / queries : 100.0f;
+}
+
+void collectTimeMetrics() {
+    // RTC同步没有单独计数；同步间隔远长于采集间隔，按同步时刻的变化计数
+    if (timeState.lastRtcSync != monitor.lastRtcSync) {
+        monitor.lastRtcSync = timeState.lastRtcSync;
+        currentMetrics.rtcSyncCount++;
+    }
+    currentMetrics.rtcErrorCount = runtimeStats.rtcErrors;
+    // 修正前的RTC频偏，ppb换算为秒/天
+    currentMetrics.rtcAccuracy = isRtcDriftKnown() ? getRtcDriftPpb() * 0.0000864f : 0.0f;
+    currentMetrics.uptimeSeconds = (millis() - runtimeStats.bootTime) / 1000;
+}
+
+void collectDisplayMetrics() {
+    unsigned long now = millis();
+    uint32_t frames = displayFlushStats.frameCount;
+    unsigned long elapsed = now - monitor.lastFrameMillis;
+    if (elapsed > 0) {
+        currentMetrics.averageFrameRate = (float)(frames - monitor.lastFrameCount) * 1000.0f / elapsed;
+    }
+    monitor.lastFrameMillis = now;
+    monitor.lastFrameCount = frames;
+    currentMetrics.displayRefreshCount = frames;
+}
+
+void collectHardwareMetrics() {
+    currentMetrics.i2cErrorCount = runtimeStats.i2cErrors;
+    currentMetrics.buttonPressCount = runtimeStats.buttonPressCount;
+}
+
+void collectPowerMetrics() {
+    currentMetrics.currentConsumption = getEstimatedCurrentMicroamps() / 1000.0f;
+}
+
+void collectErrorMetrics() {
+    currentMetrics.totalErrorCount = runtimeStats.totalErrors;
+    // 自上次快照以来的错误数；不满一小时时不外推，避免启动后的个别错误被放大
+    uint32_t errors = runtimeStats.totalErrors - monitor.errorsAtSnapshot;
+    unsigned long elapsed = millis() - metricsHistory.lastUpdateTime;
+    if (elapsed < METRICS_HISTORY_INTERVAL) {
+        elapsed = METRICS_HISTORY_INTERVAL;
+    }
+    currentMetrics.errorRatePerHour = (float)errors * METRICS_HISTORY_INTERVAL / elapsed;
+}
+
+SystemHealthStatus evaluateCpuHealth() {
+    return gradeCpu(currentMetrics);
+}
+
+SystemHealthStatus evaluateMemoryHealth() {
+    return gradeMemory(currentMetrics);
+}
+
+SystemHealthStatus evaluateNetworkHealth() {
+    return gradeNetwork(currentMetrics);
+}
+
+SystemHealthStatus evaluateTimeHealth() {
+    return gradeTime(currentMetrics);
+}
+
+SystemHealthStatus evaluateDisplayHealth() {
+    return gradeDisplay(currentMetrics);
+}
+
+SystemHealthStatus evaluateHardwareHealth() {
+    return gradeHardware(currentMetrics);
+}
+
+SystemHealthStatus evaluatePowerHealth() {
+    return gradePower(currentMetrics);
+}
+
+/**
+ * @brief 把currentMetrics存为最新的快照，历史已满时覆盖最旧的快照
+ */
+void saveMetricsToHistory() {
+    uint8_t slot = metricsHistory.currentIndex;
+    if (metricsHistory.sampleCount < METRICS_HISTORY_SIZE) {
+        metricsHistory.sampleCount++;
+    }
+    metricsHistory.samples[slot] = currentMetrics;
+    appendToSums(slot);
+    metricsHistory.currentIndex = (slot + 1) % METRICS_HISTORY_SIZE;
+    if (metricsHistory.currentIndex == 0) {
+        rebaseSums();
+    }
+    metricsHistory.lastUpdateTime = millis();
+    monitor.errorsAtSnapshot = currentMetrics.totalErrorCount;
+}
+
+/**
+ * @brief 最近hours个快照的平均指标
+ * @param hours 小时数，0或超过已有快照数时取全部快照
+ * @return 瞬时量为平均值，计数类字段为最新快照的值；还没有快照时返回currentMetrics
+ *
+ * 窗口内快照的和为累计和减去窗口最旧快照的前缀和，与窗口长度无关（O(1)）
+ */
+SystemMetrics getAverageMetrics(uint8_t hours) {
+    uint8_t count = metricsHistory.sampleCount;
+    if (count == 0) {
+        return currentMetrics;
+    }
+    if (hours == 0 || hours > count) {
+        hours = count;
+    }
+
+    SystemMetrics average = sampleAt(0);
+    const float* windowStart = prefixSums[slotAt(hours - 1)];
+    for (uint8_t i = 0; i < AVERAGED_FIELD_COUNT; i++) {
+        writeMetric(average, AVERAGED_FIELDS[i], (runningSums[i] - windowStart[i]) / hours);
+    }
+    return average;
+}
+
+/**
+ * @brief 淘汰超出保留时长的最旧快照
+ */
+void cleanupOldMetrics() {
+    uint32_t retention = monitoringConfig.metricsRetentionHours;
+    if (retention == 0 || retention > METRICS_HISTORY_SIZE) {
+        retention = METRICS_HISTORY_SIZE;
+    }
+    // 淘汰的快照不再落在任何窗口内，累计和无需调整
+    if (metricsHistory.sampleCount > retention) {
+        metricsHistory.sampleCount = retention;
+    }
+}
+
+/**
+ * @brief 获取系统运行统计（当前值与全部历史的平均值）
+ */
+String getSystemStatistics() {
+    SystemMetrics average = getAverageMetrics(0);
+    char buffer[200];
+    snprintf(buffer, sizeof(buffer),
+             "Uptime: %lu s, errors: %lu, NTP %lu ok / %lu failed\n"
+             "%u-hour average: CPU %.1f%%, heap %.1f%% used, %.2f fps, %.1f mA, %.1f errors/h\n",
+             (unsigned long)currentMetrics.uptimeSeconds, (unsigned long)currentMetrics.totalErrorCount,
+             (unsigned long)currentMetrics.ntpSyncCount, (unsigned long)currentMetrics.ntpFailCount,
+             metricsHistory.sampleCount, average.cpuUsagePercent, average.heapUsagePercent,
+             average.averageFrameRate, average.currentConsumption, average.errorRatePerHour);
+    return String(buffer);
+}
+
+/**
+ * @brief 超过报警级别，且比上次报警更严重或距上次报警已满一小时
+ */
+bool shouldSendAlert(const HealthCheckResult& result) {
+    if (!monitoringConfig.alertingEnabled || result.overallStatus == HEALTH_UNKNOWN ||
+        result.overallStatus < (SystemHealthStatus)monitoringConfig.alertThresholdLevel) {
+        return false;
+    }
+    return result.overallStatus > monitor.lastAlertStatus ||
+           millis() - monitor.lastAlertMillis >= METRICS_HISTORY_INTERVAL;
+}
+
+void sendHealthAlert(const HealthCheckResult& result) {
+    monitor.lastAlertStatus = result.overallStatus;
+    monitor.lastAlertMillis = millis();
+    LOG_WARNING("Health %s: %s", healthStatusToString(result.overallStatus), result.summaryMessage);
+}
+
+void sendPerformanceAlert(const SystemMetrics& metrics) {
+    LOG_WARNING("Performance: CPU %.1f%%, heap %.1f%% used (%lu bytes free)",
+                metrics.cpuUsagePercent, metrics.heapUsagePercent, (unsigned long)metrics.freeHeapSize);
+}
+
+void sendErrorAlert(const char* errorMessage) {
+    if (monitoringConfig.alertingEnabled) {
+        LOG_ERROR("Monitoring alert: %s", errorMessage);
+    }
+}
+
+/**
+ * @brief 更新监控配置，保留时长缩短时立即淘汰多余的快照
+ */
+void updateMonitoringConfig(const MonitoringConfig& config) {
+    monitoringConfig = config;
+    if (monitoringConfig.alertThresholdLevel > HEALTH_CRITICAL) {
+        monitoringConfig.alertThresholdLevel = HEALTH_CRITICAL;
+    }
+    cleanupOldMetrics();
+}
+
+void resetMonitoringConfigToDefault() {
+    monitoringConfig.enabled = true;
+    monitoringConfig.metricsCollectionEnabled = true;
+    monitoringConfig.healthCheckEnabled = true;
+    monitoringConfig.alertingEnabled = true;
+    monitoringConfig.loggingEnabled = true;
+    monitoringConfig.systemCheckInterval = MONITOR_SYSTEM_INTERVAL;
+    monitoringConfig.healthCheckInterval = MONITOR_HEALTH_INTERVAL;
+    monitoringConfig.performanceCheckInterval = MONITOR_PERFORMANCE_INTERVAL;
+    monitoringConfig.metricsRetentionHours = METRICS_HISTORY_SIZE;
+    monitoringConfig.alertThresholdLevel = HEALTH_WARNING;
+}
+
+const char* healthStatusToString(SystemHealthStatus status) {
+    switch (status) {
+        case HEALTH_EXCELLENT: return "EXCELLENT";
+        case HEALTH_GOOD: return "GOOD";
+        case HEALTH_WARNING: return "WARNING";
+        case HEALTH_CRITICAL: return "CRITICAL";
+        default: return "UNKNOWN";
+    }
+}
+
+String formatMetricsForDisplay(const SystemMetrics& metrics) {
+    char buffer[96];
+    snprintf(buffer, sizeof(buffer), "CPU %.0f%% Heap %lu RSSI %d NTP %.0f%% %.1ffps %.1fmA",
+             metrics.cpuUsagePercent, (unsigned long)metrics.freeHeapSize, metrics.wifiSignalStrength,
+             metrics.ntpSuccessRate, metrics.averageFrameRate, metrics.currentConsumption);
+    return String(buffer);
+}
+
+/**
+ * @brief 系统整体得分（0-100），每个子系统按分级扣分
+ */
+float calculateSystemScore(const SystemMetrics& metrics) {
+    static const uint8_t PENALTY[] = {0, 5, 15, 30};   // EXCELLENT、GOOD、WARNING、CRITICAL
+    const SystemHealthStatus grades[] = {
+        gradeCpu(metrics), gradeMemory(metrics), gradeNetwork(metrics), gradeTime(metrics),
+        gradeDisplay(metrics), gradeHardware(metrics), gradePower(metrics), gradeErrors(metrics)
+    };
+    int score = 100;
+    for (SystemHealthStatus grade : grades) {
+        score -= PENALTY[grade];
+    }
+    return (score > 0) ? (float)score : 0.0f;
+}
+
+String generateHealthReport(const HealthCheckResult& result) {
+    char buffer[320];
+    snprintf(buffer, sizeof(buffer),
+             "Health: %s (%s)\n"
+             "CPU: %s, memory: %s, network: %s, time: %s\n"
+             "Display: %s, hardware: %s, power: %s\n"
+             "Score: %.0f, checked at %lu ms\n",
+             healthStatusToString(result.overallStatus), result.summaryMessage,
+             healthStatusToString(result.cpuStatus), healthStatusToString(result.memoryStatus),
+             healthStatusToString(result.networkStatus), healthStatusToString(result.timeStatus),
+             healthStatusToString(result.displayStatus), healthStatusToString(result.hardwareStatus),
+             healthStatusToString(result.powerStatus), calculateSystemScore(currentMetrics),
+             (unsigned long)result.timestamp);
+    return String(buffer);
+}
+
+String getMonitoringDiagnostics() {
+    String report = generateHealthReport(lastHealthCheck);
+    report += "Current: ";
+    report += formatMetricsForDisplay(currentMetrics);
+    report += '\n';
+    report += getSystemStatistics();
+    report += getMonitoringOverhead();
+    return report;
+}
+
+void pauseMonitoring() {
+    monitor.paused = true;
+}
+
+/**
+ * @brief 恢复监控；暂停期间的CPU和帧率基线作废，从此刻重新计
+ */
+void resumeMonitoring() {
+    if (!monitor.paused) {
+        return;
+    }
+    monitor.paused = false;
+    monitor.lastMonotonicMillis = getMonotonicMillis();
+    monitor.lastIdleMillis = getIdleMillis();
+    monitor.lastFrameMillis = millis();
+    monitor.lastFrameCount = displayFlushStats.frameCount;
+}
+
+String getMonitoringOverhead() {
+    char buffer[120];
+    snprintf(buffer, sizeof(buffer), "Monitoring: %lu runs, last %lu us, max %lu us, %u bytes static RAM\n",
+             (unsigned long)monitor.runCount, (unsigned long)monitor.lastRunMicros,
+             (unsigned long)monitor.maxRunMicros,
+             (unsigned)(sizeof(metricsHistory) + sizeof(currentMetrics) + sizeof(lastHealthCheck) +
+                        sizeof(runningSums) + sizeof(prefixSums) + sizeof(monitor)));
+    return String(buffer);
+}
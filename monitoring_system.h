@@ -3,6 +3,10 @@
  * @brief 生产环境监控系统
  * 
  * 提供系统健康监控、性能指标收集和故障检测功能
+ *
+ * 指标每个MONITOR_SYSTEM_INTERVAL由调度器采集一次，每小时存一个快照到
+ * 静态分配的环形历史中。瞬时量的和随快照写入/淘汰增量维护，整个历史的平均值
+ * O(1)可得；采集和健康检查不分配堆内存
  * 
  * @author ESP8266 SSD1306 Clock Project
  * @version 2.0
@@ -27,12 +31,18 @@
 
 // 阈值配置
 #define CPU_USAGE_WARNING_THRESHOLD 80        // CPU使用率警告阈值 (%)
+#define CPU_USAGE_CRITICAL_THRESHOLD 95       // CPU使用率严重阈值 (%)
 #define MEMORY_WARNING_THRESHOLD 85          // 内存使用率警告阈值 (%)
-#define TEMPERATURE_WARNING_THRESHOLD 60      // 温度警告阈值 (°C)
+#define MEMORY_CRITICAL_THRESHOLD 95         // 内存使用率严重阈值 (%)
 #define ERROR_RATE_WARNING_THRESHOLD 5        // 错误率警告阈值 (/hour)
+#define ERROR_RATE_CRITICAL_THRESHOLD 20      // 错误率严重阈值 (/hour)
+#define WIFI_SIGNAL_WARNING_THRESHOLD -80     // WiFi信号警告阈值 (dBm)
+#define NTP_SUCCESS_WARNING_THRESHOLD 50      // NTP成功率警告阈值 (%)
+#define CURRENT_WARNING_THRESHOLD 60          // 平均电流警告阈值 (mA)，接近CPU从不空闲时的电流
 
 // 历史数据保存
 #define METRICS_HISTORY_SIZE 24              // 保存24小时历史数据
+#define METRICS_HISTORY_INTERVAL 3600000      // 每小时保存一个快照
 #define PERFORMANCE_SAMPLES_PER_HOUR 30       // 每小时30个性能样本
 
 // =============================================================================
@@ -57,6 +67,8 @@ struct SystemMetrics {
     uint32_t freeHeapSize;               // 可用堆内存 (bytes)
     uint32_t minFreeHeap;                // 最小可用堆内存历史
     float heapUsagePercent;              // 堆内存使用率 (%)
+    uint32_t maxFreeBlockSize;           // 最大可分配块 (bytes)
+    float heapFragmentation;             // 堆碎片率 (%)
     
     // 网络指标
     uint32_t wifiUptimeSeconds;           // WiFi连接时长 (seconds)
@@ -73,7 +85,6 @@ struct SystemMetrics {
     
     // 显示指标
     uint32_t displayRefreshCount;         // 显示刷新次数
-    uint32_t displayErrorCount;          // 显示错误次数
     float averageFrameRate;               // 平均帧率 (FPS)
     
     // 错误指标
@@ -82,15 +93,12 @@ struct SystemMetrics {
     uint32_t manualResets;               // 手动重启次数
     float errorRatePerHour;              // 每小时错误率
     
-    // 硬件指标
-    float internalTemperature;            // 内部温度 (°C)
+    // 硬件指标（ESP8266没有片内温度传感器，不采集温度）
     uint32_t i2cErrorCount;             // I2C错误次数
     uint32_t buttonPressCount;           // 按键按下次数
     
-    // 电源指标
-    float voltageLevel;                   // 电压等级 (V)
-    float currentConsumption;             // 电流消耗 (mA)
-    uint32_t powerEvents;                // 电源事件次数
+    // 电源指标（ADC未配置为测量VCC，不采集电压）
+    float currentConsumption;             // 电流消耗估算 (mA)
 };
 
 // =============================================================================
@@ -138,9 +146,9 @@ struct MonitoringConfig {
 
 struct MetricsHistory {
     SystemMetrics samples[METRICS_HISTORY_SIZE];  // 历史样本数组
-    uint8_t currentIndex;                         // 当前索引
+    uint8_t currentIndex;                         // 下一个快照的写入位置
     uint8_t sampleCount;                          // 样本数量
-    uint32_t lastUpdateTime;                       // 最后更新时间
+    uint32_t lastUpdateTime;                       // 最后保存快照的millis()
 };
 
 // =============================================================================
@@ -225,7 +233,7 @@ SystemHealthStatus evaluatePowerHealth();
 // 保存当前指标到历史记录
 void saveMetricsToHistory();
 
-// 获取历史平均指标
+// 获取最近hours小时的平均指标（瞬时量取平均，计数类字段取最新快照的值）
 SystemMetrics getAverageMetrics(uint8_t hours);
 
 // 清理过期的历史数据
@@ -254,12 +262,6 @@ void sendErrorAlert(const char* errorMessage);
 // 监控配置函数
 // =============================================================================
 
-// 加载监控配置
-bool loadMonitoringConfig();
-
-// 保存监控配置
-bool saveMonitoringConfig();
-
 // 更新监控配置
 void updateMonitoringConfig(const MonitoringConfig& config);
 
@@ -289,9 +291,6 @@ String getMonitoringDiagnostics();
 // 性能优化相关
 // =============================================================================
 
-// 优化监控性能
-void optimizeMonitoringPerformance();
-
 // 暂停监控（用于性能密集型操作）
 void pauseMonitoring();
 
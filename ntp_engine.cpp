@@ -0,0 +1,651 @@
+/**
+ * @file ntp_engine.cpp
+ * @brief 非阻塞NTP查询引擎实现
+ *
+ * 每次查询从得分最好的服务器开始，向它发送NTP_BURST_SAMPLES个请求，
+ * 由四个时间戳得到每个样本的往返时延 delay = (T4-T1) - (T3-T2)，
+ * 以及收到应答时刻的时间估计 T3 + delay/2（即T4加上偏差offset）。
+ * 拥塞的WiFi只会增加时延、不会减少，所以时延最小的样本排队最少、偏差最可信。
+ * 服务器一个应答都没有时记一次失败，换到未尝试过的得分最好的服务器，
+ * 在NTP_RETRY_DELAY后重试；所有服务器都失败时查询失败。
+ * 请求包的发送时间戳携带随机数，应答的原始时间戳必须与之相同，
+ * 以丢弃之前请求迟到的应答
+ *
+ * 服务器地址缓存在serverAddresses中。缓存过期或没有时调用dns_gethostbyname()，
+ * 在NTP_STATE_RESOLVING中等待lwIP的回调（最长NTP_DNS_TIMEOUT），不阻塞主循环。
+ * 解析失败的服务器在退避期内不再解析：有旧地址时继续用旧地址，否则直接换服务器
+ *
+ * 轮询间隔随修正量调整：连续NTP_POLL_RAISE_COUNT次修正量不超过
+ * NTP_POLL_STEP_THRESHOLD_MS时加倍，超过时减半，超过NTP_POLL_STEP_RESET_MS时
+ * 回到最短。间隔只在外推误差保持很小时才放长，所以两次查询之间的NTP时间
+ * 可以直接用于同步RTC。KoD RATE要求降低请求频率，直接放长到最长间隔；
+ * DENY/RSTR表示服务器拒绝服务，把它排到最后
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.2
+ * @date 2026-10-16
+ */
+
+#define LOG_MODULE TIME
+
+#include "ntp_engine.h"
+#include "global_config.h"
+#include "config.h"
+#include "logger.h"
+#include "clock_discipline.h"
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+#include <lwip/dns.h>
+#include <string.h>
+#include <math.h>
+
+// NTP时间戳纪元（1900年）与Unix纪元之差
+static const uint32_t NTP_UNIX_OFFSET = 2208988800UL;
+static const uint8_t NTP_PACKET_SIZE = 48;
+static const uint16_t NTP_PORT = 123;
+static const uint16_t NTP_LOCAL_PORT = 1337;
+// 连续失败每次加1秒；尚未测量过的服务器得分为0，保证每个服务器至少被测量一次
+static const uint32_t NTP_FAIL_PENALTY_US = 1000000UL;
+static const uint8_t NTP_MAX_FAIL_STREAK = 8;
+
+// NTP引擎统计
+NtpEngineStats ntpEngineStats = {
+  0,    // requestsSent
+  0,    // repliesAccepted
+  0,    // repliesRejected
+  0,    // timeouts
+  0,    // queriesFailed
+  0,    // queriesSucceeded
+  0,    // lastRttMs
+  0,    // lastJitterMs
+  0,    // lastStepMs
+  0,    // kissOfDeath
+  0,    // dnsLookups
+  0     // dnsFailures
+};
+
+// 各服务器的排序依据（下标与NTP_SERVERS相同，最多8个服务器）
+static NtpServerRank serverRanks[8];
+
+// 服务器地址缓存（下标与NTP_SERVERS相同）
+struct NtpServerAddress {
+  IPAddress ip;
+  bool valid;                   // 解析成功过（过期后仍保留，解析失败时继续使用）
+  uint8_t failStreak;           // 连续解析失败次数，0表示不在退避期
+  unsigned long resolvedAt;     // 最近一次解析成功的millis()
+  unsigned long failedAt;       // 最近一次解析失败的millis()
+};
+static NtpServerAddress serverAddresses[8];
+static const uint8_t NTP_DNS_MAX_BACKOFF_SHIFT = 4;   // 退避最长为NTP_DNS_RETRY_DELAY的16倍
+
+// NTP专用UDP套接字
+static WiFiUDP ntpUDP;
+
+// 一个时间样本
+struct NtpSample {
+  uint64_t unixMicros;          // 收到应答时刻的UTC时间估计（T3 + delay/2）
+  uint32_t rxMicros;            // 收到应答时的micros()（T4）
+  uint32_t delayUs;             // 往返时延
+};
+
+static struct {
+  NtpEngineState state;
+  bool started;                 // UDP已begin
+  uint16_t triedMask;           // 本次查询已失败的服务器
+  unsigned long stateSince;     // 进入当前状态的millis()
+  unsigned long sendMillis;     // 本次请求的发送时刻（用于超时）
+  uint32_t sendMicros;          // 本次请求的发送时刻（T1）
+  uint8_t nonce[8];             // 请求发送时间戳（应答的原始时间戳须与之相同）
+  uint8_t burstSent;            // 本组已发送的请求数
+  uint8_t sampleCount;          // 本组已收到的样本数
+  NtpSample samples[NTP_BURST_SAMPLES];
+  IPAddress serverIp;           // 当前服务器的地址（发送前从缓存取得）
+  int8_t dnsIndex;              // 正在解析的服务器索引，-1表示没有进行中的解析
+  bool timeSet;                 // 已获得过有效时间
+  uint32_t epochSeconds;        // 最近一次查询得到的UTC秒
+  uint16_t epochMillis;         // 秒内毫秒
+  unsigned long anchorMillis;   // 与上述时间对应的millis()
+} engine = {NTP_STATE_IDLE, false, 0, 0, 0, 0, {0}, 0, 0, {}, IPAddress(), -1, false, 0, 0, 0};
+
+// 轮询间隔状态
+static struct {
+  uint8_t exponent;             // 轮询间隔为2^exponent秒
+  uint8_t stableCount;          // 连续修正量很小的查询次数
+} poll = {NTP_MIN_POLL, 0};
+
+static uint8_t packetBuffer[NTP_PACKET_SIZE];
+
+// 辅助：溢出安全的经过时间
+static unsigned long elapsedSince(unsigned long since) {
+  unsigned long now = millis();
+  return (now >= since) ? (now - since) : (0xFFFFFFFF - since + now);
+}
+
+static void enterState(NtpEngineState state) {
+  engine.state = state;
+  engine.stateSince = millis();
+}
+
+// 辅助：设置轮询指数（限制在NTP_MIN_POLL和NTP_MAX_POLL之间）
+static void setPollExponent(int exponent) {
+  if (exponent < NTP_MIN_POLL) {
+    exponent = NTP_MIN_POLL;
+  } else if (exponent > NTP_MAX_POLL) {
+    exponent = NTP_MAX_POLL;
+  }
+  if (poll.exponent != exponent) {
+    LOG_DEBUG("NTP poll interval %lu s -> %lu s", 1UL << poll.exponent, 1UL << exponent);
+  }
+  poll.exponent = (uint8_t)exponent;
+  poll.stableCount = 0;
+}
+
+// 辅助：按本次修正量调整轮询间隔
+static void updatePollInterval(int32_t stepMs) {
+  long magnitude = (stepMs < 0) ? -(long)stepMs : (long)stepMs;
+  if (magnitude > NTP_POLL_STEP_RESET_MS) {
+    setPollExponent(NTP_MIN_POLL);
+  } else if (magnitude > NTP_POLL_STEP_THRESHOLD_MS) {
+    setPollExponent(poll.exponent - 1);
+  } else if (++poll.stableCount >= NTP_POLL_RAISE_COUNT) {
+    setPollExponent(poll.exponent + 1);
+  }
+}
+
+/**
+ * @brief 服务器得分（越小越好）：时延 + 2倍抖动 + 连续失败惩罚
+ */
+uint32_t getNtpServerScore(int index) {
+  const NtpServerRank& rank = serverRanks[index];
+  uint32_t score = (rank.delayUs != 0) ? rank.delayUs + 2 * rank.jitterUs : 0;
+  return score + (uint32_t)rank.failStreak * NTP_FAIL_PENALTY_US;
+}
+
+const NtpServerRank& getNtpServerRank(int index) {
+  return serverRanks[index];
+}
+
+// 辅助：在本次查询尚未失败的服务器中选得分最好的一个，得分相同时保持当前服务器
+static bool selectServer() {
+  int best = -1;
+  uint32_t bestScore = 0;
+  for (int n = 0; n < NTP_SERVER_COUNT; n++) {
+    int index = (timeState.currentNtpServerIndex + n) % NTP_SERVER_COUNT;
+    if (engine.triedMask & (1U << index)) {
+      continue;
+    }
+    uint32_t score = getNtpServerScore(index);
+    if (best < 0 || score < bestScore) {
+      best = index;
+      bestScore = score;
+    }
+  }
+  if (best < 0) {
+    return false;
+  }
+  timeState.currentNtpServerIndex = best;
+  return true;
+}
+
+// 辅助：保存解析得到的地址
+static void storeServerAddress(int index, const IPAddress& ip) {
+  NtpServerAddress& entry = serverAddresses[index];
+  entry.ip = ip;
+  entry.valid = true;
+  entry.failStreak = 0;
+  entry.resolvedAt = millis();
+}
+
+// 辅助：记录一次解析失败，进入（或延长）退避期
+static void noteDnsFailure(int index) {
+  NtpServerAddress& entry = serverAddresses[index];
+  if (entry.failStreak <= NTP_DNS_MAX_BACKOFF_SHIFT) {
+    entry.failStreak++;
+  }
+  entry.failedAt = millis();
+  ntpEngineStats.dnsFailures++;
+}
+
+// 辅助：DNS回调（lwIP在系统上下文中调用，可能在解析已超时之后才到达）
+static void onDnsFound(const char* name, const ip_addr_t* ipaddr, void* arg) {
+  (void)name;
+  int index = (int)(intptr_t)arg;
+  bool current = (engine.dnsIndex == index);
+  if (ipaddr != nullptr) {
+    storeServerAddress(index, IPAddress(ipaddr));
+  } else if (current) {
+    noteDnsFailure(index);   // 超时后才到的失败已经计过
+  }
+  if (current) {
+    engine.dnsIndex = -1;
+  }
+}
+
+// 服务器地址查询结果
+enum AddressLookup {
+  ADDRESS_READY,      // engine.serverIp可用
+  ADDRESS_PENDING,    // 已开始异步解析
+  ADDRESS_FAILED      // 没有可用地址
+};
+
+// 辅助：把当前服务器名复制到timeState并取得地址：缓存有效时直接使用，否则开始异步解析
+static AddressLookup lookupServerAddress() {
+  int index = timeState.currentNtpServerIndex;
+  strncpy_P(timeState.currentNtpServer, (const char*)pgm_read_ptr(&NTP_SERVERS[index]),
+            sizeof(timeState.currentNtpServer) - 1);
+  timeState.currentNtpServer[sizeof(timeState.currentNtpServer) - 1] = '\0';
+
+  NtpServerAddress& entry = serverAddresses[index];
+  bool backingOff = entry.failStreak > 0 &&
+                    elapsedSince(entry.failedAt) < (NTP_DNS_RETRY_DELAY << (entry.failStreak - 1));
+  if (entry.valid && (backingOff || elapsedSince(entry.resolvedAt) < NTP_DNS_CACHE_TTL)) {
+    engine.serverIp = entry.ip;
+    return ADDRESS_READY;
+  }
+  if (backingOff) {
+    return ADDRESS_FAILED;
+  }
+
+  ip_addr_t addr;
+  ntpEngineStats.dnsLookups++;
+  err_t err = dns_gethostbyname(timeState.currentNtpServer, &addr, onDnsFound, (void*)(intptr_t)index);
+  if (err == ERR_OK) {  // lwIP缓存命中，不会再回调
+    storeServerAddress(index, IPAddress(&addr));
+    engine.serverIp = entry.ip;
+    return ADDRESS_READY;
+  }
+  if (err == ERR_INPROGRESS) {
+    engine.dnsIndex = (int8_t)index;
+    return ADDRESS_PENDING;
+  }
+  LOG_DEBUG("NTP DNS lookup failed: %s (%d)", timeState.currentNtpServer, err);
+  noteDnsFailure(index);
+  if (entry.valid) {
+    engine.serverIp = entry.ip;
+    return ADDRESS_READY;
+  }
+  return ADDRESS_FAILED;
+}
+
+// 辅助：发送一次请求
+static bool sendRequest() {
+  // 丢弃缓冲区中残留的应答
+  while (ntpUDP.parsePacket() > 0) {
+    ntpUDP.flush();
+  }
+
+  memset(packetBuffer, 0, NTP_PACKET_SIZE);
+  packetBuffer[0] = 0xE3;   // LI=3(未同步), VN=4, Mode=3(客户端)
+  packetBuffer[2] = 6;      // 轮询间隔 2^6秒
+  packetBuffer[3] = 0xEC;   // 本地时钟精度
+  // 发送时间戳填入随机数，服务器会原样放入应答的原始时间戳
+  for (uint8_t i = 0; i < 8; i++) {
+    engine.nonce[i] = (uint8_t)random(256);
+  }
+  memcpy(packetBuffer + 40, engine.nonce, 8);
+
+  if (!ntpUDP.beginPacket(engine.serverIp, NTP_PORT)) {
+    return false;
+  }
+  ntpUDP.write(packetBuffer, NTP_PACKET_SIZE);
+  if (!ntpUDP.endPacket()) {
+    return false;
+  }
+
+  ntpEngineStats.requestsSent++;
+  engine.burstSent++;
+  engine.sendMillis = millis();
+  engine.sendMicros = micros();
+  LOG_DEBUG("NTP request sent to %s (sample %d)", timeState.currentNtpServer, engine.burstSent);
+  return true;
+}
+
+// 应答校验结果
+enum ReplyCheck {
+  REPLY_IGNORED,    // 不是本次请求的应答（迟到的旧应答、其他来源）
+  REPLY_INVALID,    // 本次请求的应答但不可用（KoD、时间戳为空）
+  REPLY_ACCEPTED
+};
+
+// 辅助：读取NTP时间戳，转换为UTC微秒
+static uint64_t readTimestampMicros(const uint8_t* p) {
+  uint32_t seconds = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+  uint32_t fraction = ((uint32_t)p[4] << 24) | ((uint32_t)p[5] << 16) | ((uint32_t)p[6] << 8) | (uint32_t)p[7];
+  return (uint64_t)(seconds - NTP_UNIX_OFFSET) * 1000000ULL + (((uint64_t)fraction * 1000000ULL) >> 32);
+}
+
+// 辅助：校验应答，接受时记录一个样本
+static ReplyCheck checkReply(int size) {
+  if (size < NTP_PACKET_SIZE || ntpUDP.remotePort() != NTP_PORT) {
+    ntpUDP.flush();
+    return REPLY_IGNORED;
+  }
+  ntpUDP.read(packetBuffer, NTP_PACKET_SIZE);
+
+  uint8_t mode = packetBuffer[0] & 0x07;
+  if (mode != 4 || memcmp(packetBuffer + 24, engine.nonce, 8) != 0) {
+    return REPLY_IGNORED;
+  }
+  if (packetBuffer[1] == 0) {  // stratum 0: Kiss-o'-Death，参考ID为ASCII代码
+    const char* code = (const char*)(packetBuffer + 12);
+    LOG_WARNING("NTP kiss-o'-death from %s: %.4s", timeState.currentNtpServer, code);
+    ntpEngineStats.kissOfDeath++;
+    if (memcmp(code, "RATE", 4) == 0) {
+      setPollExponent(NTP_MAX_POLL);
+    } else if (memcmp(code, "DENY", 4) == 0 || memcmp(code, "RSTR", 4) == 0) {
+      serverRanks[timeState.currentNtpServerIndex].failStreak = NTP_MAX_FAIL_STREAK;
+    }
+    return REPLY_INVALID;
+  }
+
+  uint32_t rxMicros = micros();
+  uint32_t receiveSeconds = ((uint32_t)packetBuffer[32] << 24) | ((uint32_t)packetBuffer[33] << 16) |
+                            ((uint32_t)packetBuffer[34] << 8) | (uint32_t)packetBuffer[35];
+  uint32_t transmitSeconds = ((uint32_t)packetBuffer[40] << 24) | ((uint32_t)packetBuffer[41] << 16) |
+                             ((uint32_t)packetBuffer[42] << 8) | (uint32_t)packetBuffer[43];
+  if (receiveSeconds < NTP_UNIX_OFFSET || transmitSeconds < NTP_UNIX_OFFSET) {
+    return REPLY_INVALID;  // 时间戳为空或早于1970年
+  }
+
+  // T2/T3为服务器收到请求和发出应答的时刻，服务器处理时间不计入往返时延
+  uint64_t t2 = readTimestampMicros(packetBuffer + 32);
+  uint64_t t3 = readTimestampMicros(packetBuffer + 40);
+  int64_t roundTrip = (int64_t)(uint32_t)(rxMicros - engine.sendMicros);
+  int64_t serverHold = (t3 >= t2) ? (int64_t)(t3 - t2) : 0;
+  uint32_t delayUs = (roundTrip > serverHold) ? (uint32_t)(roundTrip - serverHold) : 0;
+
+  NtpSample& sample = engine.samples[engine.sampleCount++];
+  sample.unixMicros = t3 + delayUs / 2;
+  sample.rxMicros = rxMicros;
+  sample.delayUs = delayUs;
+  return REPLY_ACCEPTED;
+}
+
+// 辅助：本组请求结束，取时延最小的样本更新时间基准和服务器排序
+static NtpResult finishBurst() {
+  uint8_t best = 0;
+  for (uint8_t i = 1; i < engine.sampleCount; i++) {
+    if (engine.samples[i].delayUs < engine.samples[best].delayUs) {
+      best = i;
+    }
+  }
+  const NtpSample& chosen = engine.samples[best];
+
+  // 抖动：其他样本换算到同一时刻后与所选样本之差的均方根
+  float sumSquares = 0;
+  for (uint8_t i = 0; i < engine.sampleCount; i++) {
+    int32_t shift = (int32_t)(chosen.rxMicros - engine.samples[i].rxMicros);
+    float diff = (float)(int64_t)(engine.samples[i].unixMicros + shift - chosen.unixMicros);
+    sumSquares += diff * diff;
+  }
+  uint32_t jitterUs = (engine.sampleCount > 1) ? (uint32_t)sqrtf(sumSquares / (engine.sampleCount - 1)) : 0;
+
+  // 把所选样本推进到当前时刻
+  uint64_t nowMicros = chosen.unixMicros + (uint32_t)(micros() - chosen.rxMicros);
+  if (engine.timeSet) {
+    ntpEngineStats.lastStepMs = (int32_t)((int64_t)(nowMicros / 1000) - (int64_t)getNtpEpochMillis());
+    updatePollInterval(ntpEngineStats.lastStepMs);
+  }
+  engine.epochSeconds = (uint32_t)(nowMicros / 1000000ULL);
+  engine.epochMillis = (uint16_t)((nowMicros / 1000ULL) % 1000ULL);
+  engine.anchorMillis = millis();
+  engine.timeSet = true;
+  recordCrystalSample(engine.anchorMillis, nowMicros / 1000);
+
+  NtpServerRank& rank = serverRanks[timeState.currentNtpServerIndex];
+  // 时延为0表示未测量，实测值至少记为1us
+  uint32_t delayUs = (rank.delayUs == 0) ? chosen.delayUs : (rank.delayUs * 3 + chosen.delayUs) / 4;
+  rank.jitterUs = (rank.delayUs == 0) ? jitterUs : (rank.jitterUs * 3 + jitterUs) / 4;
+  rank.delayUs = (delayUs > 0) ? delayUs : 1;
+  rank.failStreak = 0;
+
+  ntpEngineStats.lastRttMs = (uint16_t)((chosen.delayUs / 1000 < 65535) ? chosen.delayUs / 1000 : 65535);
+  ntpEngineStats.lastJitterMs = (uint16_t)((jitterUs / 1000 < 65535) ? jitterUs / 1000 : 65535);
+  timeState.ntpFailCount = 0;
+  ntpEngineStats.queriesSucceeded++;
+  enterState(NTP_STATE_IDLE);
+  LOG_DEBUG("NTP %s: %d samples, delay %u ms, jitter %u ms, step %ld ms", timeState.currentNtpServer,
+            engine.sampleCount, ntpEngineStats.lastRttMs, ntpEngineStats.lastJitterMs,
+            (long)ntpEngineStats.lastStepMs);
+  return NTP_RESULT_OK;
+}
+
+// 辅助：开始向当前服务器发送一组请求
+static void beginBurst() {
+  engine.burstSent = 0;
+  engine.sampleCount = 0;
+}
+
+// 辅助：当前服务器本组没有可用样本，记一次失败，换服务器重试或放弃
+static NtpResult failServer() {
+  NtpServerRank& rank = serverRanks[timeState.currentNtpServerIndex];
+  if (rank.failStreak < NTP_MAX_FAIL_STREAK) {
+    rank.failStreak++;
+  }
+  engine.triedMask |= (uint16_t)(1U << timeState.currentNtpServerIndex);
+  if (!selectServer()) {
+    ntpEngineStats.queriesFailed++;
+    // 服务器不可达时放长轮询间隔，避免持续发送无应答的请求
+    setPollExponent(poll.exponent + 1);
+    enterState(NTP_STATE_IDLE);
+    LOG_DEBUG("NTP query failed on all servers");
+    return NTP_RESULT_FAILED;
+  }
+  beginBurst();
+  enterState(NTP_STATE_RETRY_WAIT);
+  return NTP_RESULT_NONE;
+}
+
+// 辅助：当前服务器不再应答，已有样本时据此结束，否则换服务器
+static NtpResult endBurstEarly() {
+  return (engine.sampleCount > 0) ? finishBurst() : failServer();
+}
+
+// 辅助：向当前服务器发送本组的第一个请求；地址正在解析时等待，没有地址时换服务器
+static NtpResult sendOrResolve() {
+  switch (lookupServerAddress()) {
+    case ADDRESS_READY:
+      if (sendRequest()) {
+        enterState(NTP_STATE_WAIT_REPLY);
+        return NTP_RESULT_NONE;
+      }
+      break;
+    case ADDRESS_PENDING:
+      enterState(NTP_STATE_RESOLVING);
+      return NTP_RESULT_NONE;
+    case ADDRESS_FAILED:
+      LOG_DEBUG("NTP server address unavailable: %s", timeState.currentNtpServer);
+      break;
+  }
+  return failServer();
+}
+
+/**
+ * @brief 打开NTP的UDP端口（重复调用无副作用）
+ */
+void initNtpEngine() {
+  if (engine.started) {
+    return;
+  }
+  ntpUDP.begin(NTP_LOCAL_PORT);
+  engine.started = true;
+  engine.dnsIndex = -1;
+  enterState(NTP_STATE_IDLE);
+}
+
+/**
+ * @brief 重新打开UDP端口并放弃进行中的查询，轮询间隔回到最短（网络重连后调用）
+ */
+void restartNtpEngine() {
+  ntpUDP.stop();
+  engine.started = false;
+  // 网络路径可能已变化，从最短间隔重新评估；断网期间的解析失败不再退避
+  setPollExponent(NTP_MIN_POLL);
+  for (int i = 0; i < NTP_SERVER_COUNT; i++) {
+    serverAddresses[i].failStreak = 0;
+  }
+  initNtpEngine();
+}
+
+/**
+ * @brief 开始一次查询（只发送请求，不等待应答）
+ * @return true 已开始或已有查询在进行；false WiFi未连接
+ */
+bool startNtpQuery() {
+  if (engine.state != NTP_STATE_IDLE) {
+    return true;
+  }
+  if (WiFi.status() != WL_CONNECTED) {
+    return false;
+  }
+  initNtpEngine();
+
+  engine.triedMask = 0;
+  selectServer();
+  beginBurst();
+  sendOrResolve();
+  return true;
+}
+
+/**
+ * @brief 推进状态机（在主循环中调用，每次调用只做一次非阻塞的收发）
+ * @return 查询在本次调用中结束时返回其结果，否则返回NTP_RESULT_NONE
+ */
+NtpResult updateNtpEngine() {
+  switch (engine.state) {
+    case NTP_STATE_IDLE:
+      return NTP_RESULT_NONE;
+
+    case NTP_STATE_WAIT_REPLY: {
+      if (WiFi.status() != WL_CONNECTED) {
+        ntpEngineStats.queriesFailed++;
+        enterState(NTP_STATE_IDLE);
+        return NTP_RESULT_FAILED;
+      }
+
+      int size = ntpUDP.parsePacket();
+      if (size > 0) {
+        ReplyCheck check = checkReply(size);
+        if (check == REPLY_ACCEPTED) {
+          ntpEngineStats.repliesAccepted++;
+          if (engine.burstSent >= NTP_BURST_SAMPLES) {
+            return finishBurst();
+          }
+          enterState(NTP_STATE_BURST_WAIT);
+          return NTP_RESULT_NONE;
+        }
+        ntpEngineStats.repliesRejected++;
+        // 迟到的旧应答不算失败，继续等待本次应答；KoD等无效应答不再向该服务器发送
+        if (check == REPLY_INVALID) {
+          return endBurstEarly();
+        }
+      }
+
+      if (elapsedSince(engine.sendMillis) >= (unsigned long)NTP_TIMEOUT) {
+        ntpEngineStats.timeouts++;
+        LOG_DEBUG("NTP timeout: %s", timeState.currentNtpServer);
+        return endBurstEarly();
+      }
+      return NTP_RESULT_NONE;
+    }
+
+    case NTP_STATE_BURST_WAIT:
+      if (elapsedSince(engine.stateSince) < NTP_BURST_INTERVAL) {
+        return NTP_RESULT_NONE;
+      }
+      if (WiFi.status() == WL_CONNECTED && sendRequest()) {
+        enterState(NTP_STATE_WAIT_REPLY);
+        return NTP_RESULT_NONE;
+      }
+      return finishBurst();
+
+    case NTP_STATE_RETRY_WAIT:
+      if (elapsedSince(engine.stateSince) < (unsigned long)NTP_RETRY_DELAY) {
+        return NTP_RESULT_NONE;
+      }
+      if (WiFi.status() != WL_CONNECTED) {
+        ntpEngineStats.queriesFailed++;
+        enterState(NTP_STATE_IDLE);
+        return NTP_RESULT_FAILED;
+      }
+      return sendOrResolve();
+
+    case NTP_STATE_RESOLVING:
+      if (WiFi.status() != WL_CONNECTED) {
+        engine.dnsIndex = -1;
+        ntpEngineStats.queriesFailed++;
+        enterState(NTP_STATE_IDLE);
+        return NTP_RESULT_FAILED;
+      }
+      if (engine.dnsIndex >= 0) {
+        if (elapsedSince(engine.stateSince) < NTP_DNS_TIMEOUT) {
+          return NTP_RESULT_NONE;
+        }
+        LOG_DEBUG("NTP DNS timeout: %s", timeState.currentNtpServer);
+        noteDnsFailure(engine.dnsIndex);
+        engine.dnsIndex = -1;
+      }
+      // 解析已结束：成功时地址已在缓存中，失败时处于退避期
+      return sendOrResolve();
+  }
+  return NTP_RESULT_NONE;
+}
+
+/**
+ * @brief 是否有查询正在进行
+ */
+bool isNtpQueryInProgress() {
+  return engine.state != NTP_STATE_IDLE;
+}
+
+NtpEngineState getNtpEngineState() {
+  return engine.state;
+}
+
+/**
+ * @brief 是否已获得过有效的NTP时间
+ */
+bool isNtpTimeSet() {
+  return engine.timeSet;
+}
+
+/**
+ * @brief 当前UTC时间（最近一次查询的结果加上此后经过的millis()）
+ * @return Unix时间戳（毫秒），未获得过时间时返回0
+ */
+uint64_t getNtpEpochMillis() {
+  if (!engine.timeSet) {
+    return 0;
+  }
+  return (uint64_t)engine.epochSeconds * 1000 + engine.epochMillis + correctElapsedMillis(elapsedSince(engine.anchorMillis));
+}
+
+/**
+ * @brief 当前UTC时间
+ * @return Unix时间戳（秒），未获得过时间时返回0
+ */
+uint32_t getNtpEpochTime() {
+  return (uint32_t)(getNtpEpochMillis() / 1000);
+}
+
+/**
+ * @brief 当前轮询指数（轮询间隔为2^指数秒）
+ */
+uint8_t getNtpPollExponent() {
+  return poll.exponent;
+}
+
+/**
+ * @brief 当前NTP轮询间隔
+ * @return 毫秒
+ */
+unsigned long getNtpPollInterval() {
+  return (1UL << poll.exponent) * 1000UL;
+}
+
+/**
+ * @brief 距最近一次查询成功经过的毫秒数，未获得过时间时返回0xFFFFFFFF
+ */
+unsigned long getNtpResultAge() {
+  return engine.timeSet ? elapsedSince(engine.anchorMillis) : 0xFFFFFFFF;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file ntp_engine.h
+ * @brief 非阻塞NTP查询引擎
+ *
+ * 取代NTPClient的阻塞式update()/forceUpdate()：一次loop()只发送请求，
+ * 之后的loop()轮询parsePacket()。超时、重试和服务器选择都在状态机内部完成，
+ * 主循环的最坏耗时不再受网络往返时延影响。服务器地址用lwIP的异步DNS解析，
+ * 结果按服务器缓存NTP_DNS_CACHE_TTL，解析失败后退避，不在主循环中等待DNS
+ *
+ * 每次查询向同一服务器连续发送一组请求，用四个时间戳计算每个样本的偏差和
+ * 往返时延，取时延最小的样本（RFC 5905时钟过滤的思路）。服务器按实测时延、
+ * 抖动和连续失败次数排序，查询从得分最好的服务器开始
+ *
+ * 轮询间隔为2的幂秒（RFC 5905的poll指数），在NTP_MIN_POLL和NTP_MAX_POLL之间
+ * 自适应：修正量持续很小时加倍，修正量变大、网络变化时缩短，查询失败和
+ * Kiss-o'-Death RATE时放长
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.2
+ * @date 2026-10-16
+ */
+
+#ifndef NTP_ENGINE_H
+#define NTP_ENGINE_H
+
+#include <Arduino.h>
+
+// 每次查询向同一服务器发送的请求数
+const uint8_t NTP_BURST_SAMPLES = 4;
+// 同一组请求之间的间隔(毫秒)
+const unsigned long NTP_BURST_INTERVAL = 2000;
+
+// 引擎状态
+enum NtpEngineState {
+  NTP_STATE_IDLE = 0,       // 空闲
+  NTP_STATE_WAIT_REPLY,     // 请求已发送，等待应答
+  NTP_STATE_BURST_WAIT,     // 已收到样本，等待发送本组的下一个请求
+  NTP_STATE_RETRY_WAIT,     // 当前服务器失败，等待切换服务器后重试
+  NTP_STATE_RESOLVING       // 正在异步解析当前服务器的地址
+};
+
+// 一次查询的结果（由updateNtpEngine在查询结束时返回一次）
+enum NtpResult {
+  NTP_RESULT_NONE = 0,      // 没有查询结束
+  NTP_RESULT_OK,            // 获得有效时间
+  NTP_RESULT_FAILED         // 所有尝试均失败
+};
+
+// NTP引擎统计
+struct NtpEngineStats {
+  uint32_t requestsSent;      // 发出的请求包数
+  uint32_t repliesAccepted;   // 通过校验的应答数
+  uint32_t repliesRejected;   // 被丢弃的应答数（过期、格式错误、KoD）
+  uint32_t timeouts;          // 单次请求超时次数
+  uint32_t queriesFailed;     // 所有服务器都失败的查询次数
+  uint32_t queriesSucceeded;  // 获得有效时间的查询次数
+  uint16_t lastRttMs;         // 最近一次查询所选样本的往返时延
+  uint16_t lastJitterMs;      // 最近一次查询各样本偏差的均方根离散度
+  int32_t lastStepMs;         // 最近一次查询对本地时间的修正量
+  uint32_t kissOfDeath;       // 收到的Kiss-o'-Death应答数
+  uint32_t dnsLookups;        // 发起的DNS解析次数（缓存命中不计）
+  uint32_t dnsFailures;       // 解析失败或超时的次数
+};
+
+// 单个服务器的排序依据
+struct NtpServerRank {
+  uint32_t delayUs;           // 所选样本往返时延的滑动平均，0表示尚未测量
+  uint32_t jitterUs;          // 抖动的滑动平均
+  uint8_t failStreak;         // 连续失败次数
+};
+
+extern NtpEngineStats ntpEngineStats;
+
+// 函数声明
+void initNtpEngine();
+void restartNtpEngine();
+bool startNtpQuery();
+NtpResult updateNtpEngine();
+bool isNtpQueryInProgress();
+NtpEngineState getNtpEngineState();
+bool isNtpTimeSet();
+uint32_t getNtpEpochTime();
+uint64_t getNtpEpochMillis();
+const NtpServerRank& getNtpServerRank(int index);
+uint32_t getNtpServerScore(int index);
+uint8_t getNtpPollExponent();
+unsigned long getNtpPollInterval();
+unsigned long getNtpResultAge();
+
+#endif // NTP_ENGINE_H
@@ -9,6 +9,8 @@
  * @date 2025-12-23
  */
 
+#define LOG_MODULE DISPLAY
+
 #include "power_manager.h"
 #include "global_config.h"
 #include "logger.h"
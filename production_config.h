@@ -24,17 +24,51 @@
 #ifdef PRODUCTION_MODE
     #define DEFAULT_LOG_LEVEL LOG_LEVEL_WARNING  // 生产环境：仅输出错误和警告
     #define ENABLE_TIMESTAMP false               // 生产环境：禁用时间戳
-    #define ENABLE_DEBUG_LOGS false              // 生产环境：禁用调试日志
 #else
     #define DEFAULT_LOG_LEVEL LOG_LEVEL_INFO     // 开发环境：输出信息级别及以上
     #define ENABLE_TIMESTAMP true                // 开发环境：启用时间戳
-    #define ENABLE_DEBUG_LOGS true               // 开发环境：启用调试日志
 #endif
 
+// 各模块编译进固件的最高日志级别：更详细的调用点连同格式串整个编译掉（见logger.h），
+// 运行时级别只能在此范围内调整。可用编译标志单独覆盖，例如-DLOG_COMPILE_LEVEL_NET=LOG_LEVEL_DEBUG
+#ifdef PRODUCTION_MODE
+    #define LOG_COMPILE_LEVEL_DEFAULT LOG_LEVEL_INFO     // 生产环境：去掉调试日志，保留信息级别供出错时临时调高
+#else
+    #define LOG_COMPILE_LEVEL_DEFAULT LOG_LEVEL_VERBOSE  // 开发环境：全部保留
+#endif
+#ifndef LOG_COMPILE_LEVEL_CORE
+    #define LOG_COMPILE_LEVEL_CORE LOG_COMPILE_LEVEL_DEFAULT     // 启动、监控、调度等未归类的模块
+#endif
+#ifndef LOG_COMPILE_LEVEL_TIME
+    #define LOG_COMPILE_LEVEL_TIME LOG_COMPILE_LEVEL_DEFAULT     // 时间源、NTP、RTC与频率修正
+#endif
+#ifndef LOG_COMPILE_LEVEL_DISPLAY
+    #define LOG_COMPILE_LEVEL_DISPLAY LOG_COMPILE_LEVEL_DEFAULT  // 显示与电源管理
+#endif
+#ifndef LOG_COMPILE_LEVEL_NET
+    #define LOG_COMPILE_LEVEL_NET LOG_COMPILE_LEVEL_DEFAULT      // WiFi与网络配置
+#endif
+#ifndef LOG_COMPILE_LEVEL_I2C
+    #define LOG_COMPILE_LEVEL_I2C LOG_COMPILE_LEVEL_DEFAULT      // I2C总线
+#endif
+#ifndef LOG_COMPILE_LEVEL_BUTTON
+    #define LOG_COMPILE_LEVEL_BUTTON LOG_COMPILE_LEVEL_DEFAULT   // 按键
+#endif
+#ifndef LOG_COMPILE_LEVEL_OTA
+    #define LOG_COMPILE_LEVEL_OTA LOG_COMPILE_LEVEL_DEFAULT      // Web OTA
+#endif
+#ifndef LOG_COMPILE_LEVEL_TEST
+    #define LOG_COMPILE_LEVEL_TEST LOG_LEVEL_VERBOSE             // 测试与基准程序：输出即结果，始终保留
+#endif
+
+// 延迟日志：日志调用只把时间戳、格式串指针和原始参数存入环形缓冲区，
+// 主循环空闲时再格式化输出到串口（见logger.cpp）
+#define DEFERRED_LOGGING true                    // 系统启动完成后启用延迟日志
+#define LOG_BUFFER_SIZE 2048                     // 日志环形缓冲区字节数
+
 // 系统配置
 #define WATCHDOG_TIMEOUT_MS 8000                 // 硬件看门狗超时时间
 #define WIFI_TIMEOUT_SECONDS 30                  // WiFi连接超时时间
-#define NTP_SYNC_INTERVAL_MS 60000               // NTP同步间隔
 
 // 电源管理配置
 #define AUTO_DIM_ENABLED true                    // 启用自动调暗
@@ -12,6 +12,13 @@
 #include "config.h"
 #include "utils.h"
 #include "version.h"
+#include "display_flush.h"
+#include "ntp_engine.h"
+#include "task_scheduler.h"
+#include "idle_manager.h"
+#include "loop_profiler.h"
+#include "heap_tracer.h"
+#include "config_store.h"
 #include <ESP8266WiFi.h>
 
 // 全局运行时统计
@@ -20,6 +27,10 @@ RuntimeStats runtimeStats = {
     0,      // minFreeHeap
     0,      // maxHeapUsed
     0,      // initialHeap
+    0,      // maxFreeBlock
+    0,      // minMaxFreeBlock
+    0,      // heapFragmentation
+    0,      // maxHeapFragmentation
     0,      // uptime
     0,      // lastLoopTime
     0,      // maxLoopTime
@@ -31,14 +42,33 @@ RuntimeStats runtimeStats = {
     0,      // wifiReconnectCount
     0,      // ntpSyncCount
     0,      // ntpSyncSuccessCount
+    0,      // ntpPollExponent
+    0,      // ntpLastStepMs
+    0,      // ntpKissOfDeathCount
     0,      // buttonPressCount
     0,      // longPressCount
+    0,      // inputLatencyCount
+    0,      // inputLatencyMaxMs
+    0,      // inputLatencyTotalMs
+    {0},    // inputLatencyHistogram
+    0,      // cpuDutyPermille
+    0,      // estimatedCurrentUa
     0,      // displayUpdateCount
     0,      // displayRefreshCount
     0,      // bootTime
     0       // bootCount
 };
 
+// 输入延迟直方图各区间的上限（毫秒），最后一个区间不设上限
+static const uint16_t INPUT_LATENCY_BUCKET_LIMITS[INPUT_LATENCY_BUCKETS - 1] = {
+    16, 32, 50, 75, 100, 150, 200, 300, 500, 750, 1000
+};
+
+// 已被接受、尚未反映到屏幕上的按键事件；超过此时长仍未上屏的事件不计入统计
+static const unsigned long INPUT_EVENT_MAX_AGE = 60000;
+static bool inputEventPending = false;
+static unsigned long inputEventMillis = 0;
+
 /**
  * @brief 初始化运行时监控
  */
@@ -47,6 +77,7 @@ void initRuntimeMonitor() {
     runtimeStats.bootCount++;
     runtimeStats.initialHeap = ESP.getFreeHeap();
     runtimeStats.minFreeHeap = runtimeStats.initialHeap;
+    runtimeStats.minMaxFreeBlock = ESP.getMaxFreeBlockSize();
 
     LOG_INFO("========================================");
     LOG_INFO("Runtime Monitor initialized");
@@ -65,26 +96,50 @@ void updateRuntimeMonitor() {
     // 更新运行时间
     runtimeStats.uptime = currentMillis - runtimeStats.bootTime;
 
-    // 更新循环时间统计
-    if (runtimeStats.lastLoopTime > 0) {
-        unsigned long loopTime = currentMillis - runtimeStats.lastLoopTime;
-        if (loopTime > runtimeStats.maxLoopTime) {
-            runtimeStats.maxLoopTime = loopTime;
-        }
-    }
-    runtimeStats.lastLoopTime = currentMillis;
-
     // 更新内存统计
     updateMemoryStats();
+
+    // NTP轮询状态
+    runtimeStats.ntpPollExponent = getNtpPollExponent();
+    runtimeStats.ntpLastStepMs = ntpEngineStats.lastStepMs;
+    runtimeStats.ntpKissOfDeathCount = ntpEngineStats.kissOfDeath;
+
+    // 占空比与电流估算
+    runtimeStats.cpuDutyPermille = getCpuDutyCyclePermille();
+    runtimeStats.estimatedCurrentUa = getEstimatedCurrentMicroamps();
+}
+
+/**
+ * @brief 记录一次主循环的耗时（不含空闲）
+ * @param loopMs 本次循环的毫秒数
+ */
+void recordLoopTime(unsigned long loopMs) {
+    runtimeStats.lastLoopTime = loopMs;
+    if (loopMs > runtimeStats.maxLoopTime) {
+        runtimeStats.maxLoopTime = loopMs;
+    }
 }
 
 /**
  * @brief 更新内存统计
  */
 void updateMemoryStats() {
-    unsigned long currentFreeHeap = ESP.getFreeHeap();
+    uint32_t currentFreeHeap = 0;
+    uint32_t maxBlock = 0;
+    uint8_t fragmentation = 0;
+    ESP.getHeapStats(&currentFreeHeap, &maxBlock, &fragmentation);
 
     runtimeStats.freeHeap = currentFreeHeap;
+    runtimeStats.maxFreeBlock = maxBlock;
+    runtimeStats.heapFragmentation = fragmentation;
+
+    // 空闲总量不变而最大块缩小说明堆在碎片化，单看空闲堆发现不了
+    if (maxBlock < runtimeStats.minMaxFreeBlock) {
+        runtimeStats.minMaxFreeBlock = maxBlock;
+    }
+    if (fragmentation > runtimeStats.maxHeapFragmentation) {
+        runtimeStats.maxHeapFragmentation = fragmentation;
+    }
 
     if (currentFreeHeap < runtimeStats.minFreeHeap) {
         runtimeStats.minFreeHeap = currentFreeHeap;
@@ -110,8 +165,11 @@ void updateErrorStats(ErrorCode code) {
         case ERROR_NTP_CONNECTION_FAILED:
             runtimeStats.ntpErrors++;
             break;
-        case ERROR_RTC_INIT_FAILED:
         case ERROR_RTC_I2C_ERROR:
+            runtimeStats.i2cErrors++;
+            runtimeStats.rtcErrors++;
+            break;
+        case ERROR_RTC_INIT_FAILED:
         case ERROR_RTC_TIME_INVALID:
             runtimeStats.rtcErrors++;
             break;
@@ -166,10 +224,99 @@ void updateDisplayStats(bool isRefresh) {
     }
 }
 
+/**
+ * @brief 记录一个已接受的按键事件，等待反映它的第一帧
+ * @param eventMillis 用户期望看到反应的时刻（短按为释放时刻，长按为按满长按时间的时刻）
+ *
+ * 上一个事件还没有上屏时保留较早的时刻，连续操作按最先等待的事件计
+ */
+void noteInputEvent(unsigned long eventMillis) {
+    if (inputEventPending) {
+        return;
+    }
+    // 时刻不可信（晚于当前或过于久远）时按当前时刻计
+    unsigned long age = millis() - eventMillis;
+    if ((long)age < 0 || age > INPUT_EVENT_MAX_AGE) {
+        eventMillis = millis();
+    }
+    inputEventPending = true;
+    inputEventMillis = eventMillis;
+}
+
+/**
+ * @brief 一帧已发送到屏幕：有等待中的按键事件时记录其延迟
+ */
+void noteFrameSent() {
+    if (!inputEventPending) {
+        return;
+    }
+    inputEventPending = false;
+    unsigned long latency = millis() - inputEventMillis;
+    if (latency <= INPUT_EVENT_MAX_AGE) {
+        recordInputLatency(latency);
+    }
+}
+
+/**
+ * @brief 把一次输入延迟计入直方图
+ * @param latencyMs 延迟（毫秒）
+ */
+void recordInputLatency(unsigned long latencyMs) {
+    uint8_t bucket = 0;
+    while (bucket < INPUT_LATENCY_BUCKETS - 1 && latencyMs > INPUT_LATENCY_BUCKET_LIMITS[bucket]) {
+        bucket++;
+    }
+    if (runtimeStats.inputLatencyHistogram[bucket] < 0xFFFF) {
+        runtimeStats.inputLatencyHistogram[bucket]++;
+    }
+    runtimeStats.inputLatencyCount++;
+    runtimeStats.inputLatencyTotalMs += latencyMs;
+    if (latencyMs > runtimeStats.inputLatencyMaxMs) {
+        runtimeStats.inputLatencyMaxMs = latencyMs;
+    }
+}
+
+/**
+ * @brief 输入延迟直方图某个区间的上限
+ * @return 上限（毫秒），最后一个区间不设上限，返回0
+ */
+unsigned long getInputLatencyBucketLimit(uint8_t bucket) {
+    return (bucket < INPUT_LATENCY_BUCKETS - 1) ? INPUT_LATENCY_BUCKET_LIMITS[bucket] : 0;
+}
+
+/**
+ * @brief 输入延迟的百分位数
+ * @param percent 百分位（1-100）
+ * @return 该百分位所在区间的上限（毫秒），最后一个区间返回最大值；没有样本时返回0
+ */
+unsigned long getInputLatencyPercentile(uint8_t percent) {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < INPUT_LATENCY_BUCKETS; i++) {
+        total += runtimeStats.inputLatencyHistogram[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    // 第rank个样本（向上取整）所在的区间
+    uint32_t rank = (total * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < INPUT_LATENCY_BUCKETS - 1; i++) {
+        seen += runtimeStats.inputLatencyHistogram[i];
+        if (seen >= rank) {
+            unsigned long limit = INPUT_LATENCY_BUCKET_LIMITS[i];
+            return (limit < runtimeStats.inputLatencyMaxMs) ? limit : runtimeStats.inputLatencyMaxMs;
+        }
+    }
+    return runtimeStats.inputLatencyMaxMs;
+}
+
 /**
  * @brief 打印运行时统计
  */
 void printRuntimeStats() {
+    // 报告有数十行，会挤满延迟日志缓冲区，直接同步输出
+    bool deferred = setLogDeferred(false);
+
     LOG_INFO("========================================");
     LOG_INFO("  Runtime Statistics");
     LOG_INFO("========================================");
@@ -184,12 +331,38 @@ void printRuntimeStats() {
     LOG_INFO("  Min Free Heap: %lu bytes", runtimeStats.minFreeHeap);
     LOG_INFO("  Max Heap Used: %lu bytes", runtimeStats.maxHeapUsed);
     LOG_INFO("  Free Heap: %.1f%%", getFreeHeapPercentage());
+    LOG_INFO("  Max Free Block: %lu bytes (min %lu)", runtimeStats.maxFreeBlock, runtimeStats.minMaxFreeBlock);
+    LOG_INFO("  Fragmentation: %u%% (max %u%%)", runtimeStats.heapFragmentation, runtimeStats.maxHeapFragmentation);
+    printHeapTraceReport();
+
+    const ConfigStoreStats& store = getConfigStoreStats();
+    LOG_DEBUG("");
+    LOG_INFO("Config Store:");
+    LOG_INFO("  Records Written: %u (%u unchanged skipped)", store.recordsWritten, store.unchangedWrites);
+    LOG_INFO("  Sector Erases: %u, sector %u (sequence %u), %u bytes free", store.sectorErases,
+             store.activeSector, store.sequence, store.freeBytes);
+    LOG_INFO("  Flushes: %u (%u deferred saves, %u pending), last %u us, max %u us", store.flushes,
+             store.deferredWrites, store.pendingKeys, store.lastFlushMicros, store.maxFlushMicros);
 
     LOG_DEBUG("");
     LOG_INFO("Performance:");
     LOG_INFO("  Max Loop Time: %lu ms", runtimeStats.maxLoopTime);
     LOG_INFO("  Display Updates: %u", runtimeStats.displayUpdateCount);
     LOG_INFO("  Display Refreshes: %u", runtimeStats.displayRefreshCount);
+    LOG_INFO("  Display Flushes: %u (full %u, partial %u, skipped %u)",
+             displayFlushStats.frameCount, displayFlushStats.fullFrameCount,
+             displayFlushStats.partialFrameCount, displayFlushStats.skippedFrameCount);
+    LOG_INFO("  Display Bytes: last %u, total %lu KB, saved %u%%",
+             displayFlushStats.lastFrameBytes, (unsigned long)(displayFlushStats.totalBytesSent / 1024),
+             getDisplayFlushSavingPercent());
+
+    LOG_DEBUG("");
+    LOG_INFO("Tasks:");
+    printTaskStats();
+
+    LOG_DEBUG("");
+    LOG_INFO("Profile:");
+    printProfilerReport();
 
     LOG_DEBUG("");
     LOG_INFO("Errors:");
@@ -198,19 +371,33 @@ void printRuntimeStats() {
     LOG_INFO("  NTP: %u", runtimeStats.ntpErrors);
     LOG_INFO("  RTC: %u", runtimeStats.rtcErrors);
     LOG_INFO("  I2C: %u", runtimeStats.i2cErrors);
+    LOG_INFO("  Log Dropped: %lu", (unsigned long)getLogDroppedCount());
 
     LOG_DEBUG("");
     LOG_INFO("Network:");
     LOG_INFO("  WiFi Reconnects: %u", runtimeStats.wifiReconnectCount);
     LOG_INFO("  NTP Sync Attempts: %u", runtimeStats.ntpSyncCount);
     LOG_INFO("  NTP Sync Success: %u", runtimeStats.ntpSyncSuccessCount);
+    LOG_INFO("  NTP Poll Interval: %lu s (2^%u)", 1UL << runtimeStats.ntpPollExponent, runtimeStats.ntpPollExponent);
+    LOG_INFO("  NTP Last Step: %ld ms", (long)runtimeStats.ntpLastStepMs);
+    LOG_INFO("  NTP Kiss-o'-Death: %u", runtimeStats.ntpKissOfDeathCount);
+
+    LOG_DEBUG("");
+    LOG_INFO("Power:");
+    LOG_INFO("  CPU Duty Cycle: %u.%u%%", runtimeStats.cpuDutyPermille / 10, runtimeStats.cpuDutyPermille % 10);
+    LOG_INFO("  Estimated Current: %lu.%lu mA", (unsigned long)(runtimeStats.estimatedCurrentUa / 1000),
+             (unsigned long)(runtimeStats.estimatedCurrentUa % 1000 / 100));
 
     LOG_DEBUG("");
     LOG_INFO("Buttons:");
     LOG_INFO("  Total Presses: %u", runtimeStats.buttonPressCount);
     LOG_INFO("  Long Presses: %u", runtimeStats.longPressCount);
+    LOG_INFO("  Input Latency: %u events, p50 %lu ms, p95 %lu ms, p99 %lu ms, max %lu ms",
+             runtimeStats.inputLatencyCount, getInputLatencyPercentile(50), getInputLatencyPercentile(95),
+             getInputLatencyPercentile(99), runtimeStats.inputLatencyMaxMs);
 
     LOG_INFO("========================================");
+    setLogDeferred(deferred);
 }
 
 /**
@@ -218,9 +405,12 @@ void printRuntimeStats() {
  */
 void resetRuntimeStats() {
     memset(&runtimeStats, 0, sizeof(RuntimeStats));
+    inputEventPending = false;
     runtimeStats.bootTime = millis();
     runtimeStats.bootCount = 1;
     runtimeStats.minFreeHeap = ESP.getFreeHeap();
+    runtimeStats.minMaxFreeBlock = ESP.getMaxFreeBlockSize();
+    resetIdleStats();
 
     LOG_INFO("Runtime statistics reset");
 }
@@ -230,7 +420,7 @@ void resetRuntimeStats() {
  * @return JSON字符串
  */
 const char* getRuntimeStatsJson() {
-    static char jsonBuffer[512];
+    static char jsonBuffer[768];
     unsigned long uptimeSeconds = runtimeStats.uptime / 1000;
 
     snprintf(jsonBuffer, sizeof(jsonBuffer),
@@ -239,27 +429,51 @@ const char* getRuntimeStatsJson() {
              "\"freeHeap\":%lu,"
              "\"minFreeHeap\":%lu,"
              "\"maxHeapUsed\":%lu,"
+             "\"minMaxFreeBlock\":%lu,"
+             "\"maxHeapFragmentation\":%u,"
              "\"totalErrors\":%u,"
              "\"wifiErrors\":%u,"
              "\"ntpErrors\":%u,"
              "\"rtcErrors\":%u,"
              "\"wifiReconnectCount\":%u,"
              "\"ntpSyncSuccessCount\":%u,"
+             "\"ntpPollExponent\":%u,"
+             "\"ntpLastStepMs\":%ld,"
+             "\"ntpKissOfDeathCount\":%u,"
+             "\"cpuDutyPermille\":%u,"
+             "\"estimatedCurrentUa\":%lu,"
              "\"buttonPressCount\":%u,"
-             "\"longPressCount\":%u"
+             "\"longPressCount\":%u,"
+             "\"inputLatencyCount\":%u,"
+             "\"inputLatencyP50\":%lu,"
+             "\"inputLatencyP95\":%lu,"
+             "\"inputLatencyP99\":%lu,"
+             "\"inputLatencyMax\":%lu"
              "}",
              uptimeSeconds,
              runtimeStats.freeHeap,
              runtimeStats.minFreeHeap,
              runtimeStats.maxHeapUsed,
+             runtimeStats.minMaxFreeBlock,
+             runtimeStats.maxHeapFragmentation,
              runtimeStats.totalErrors,
              runtimeStats.wifiErrors,
              runtimeStats.ntpErrors,
              runtimeStats.rtcErrors,
              runtimeStats.wifiReconnectCount,
              runtimeStats.ntpSyncSuccessCount,
+             runtimeStats.ntpPollExponent,
+             (long)runtimeStats.ntpLastStepMs,
+             runtimeStats.ntpKissOfDeathCount,
+             runtimeStats.cpuDutyPermille,
+             (unsigned long)runtimeStats.estimatedCurrentUa,
              runtimeStats.buttonPressCount,
-             runtimeStats.longPressCount);
+             runtimeStats.longPressCount,
+             runtimeStats.inputLatencyCount,
+             getInputLatencyPercentile(50),
+             getInputLatencyPercentile(95),
+             getInputLatencyPercentile(99),
+             runtimeStats.inputLatencyMaxMs);
 
     return jsonBuffer;
 }
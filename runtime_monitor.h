@@ -15,6 +15,9 @@
 #include <Arduino.h>
 #include "logger.h"
 
+// 输入延迟直方图的区间数（区间上限见runtime_monitor.cpp）
+#define INPUT_LATENCY_BUCKETS 12
+
 // 监控统计结构体
 typedef struct {
     // 内存统计
@@ -22,11 +25,15 @@ typedef struct {
     unsigned long minFreeHeap;       // 最小空闲堆内存
     unsigned long maxHeapUsed;       // 最大堆内存使用
     unsigned long initialHeap;       // 初始堆内存大小
+    unsigned long maxFreeBlock;      // 最大可分配块
+    unsigned long minMaxFreeBlock;   // 最大可分配块的最小值
+    uint8_t heapFragmentation;       // 堆碎片率（%）
+    uint8_t maxHeapFragmentation;    // 堆碎片率的最大值（%）
 
     // 运行时间统计
     unsigned long uptime;            // 运行时间（毫秒）
-    unsigned long lastLoopTime;      // 上次循环时间
-    unsigned long maxLoopTime;       // 最大循环时间
+    unsigned long lastLoopTime;      // 上次循环耗时（毫秒，不含空闲）
+    unsigned long maxLoopTime;       // 最大循环耗时（毫秒）
 
     // 错误统计
     uint32_t totalErrors;            // 总错误数
@@ -39,11 +46,24 @@ typedef struct {
     uint32_t wifiReconnectCount;     // WiFi重连次数
     uint32_t ntpSyncCount;           // NTP同步次数
     uint32_t ntpSyncSuccessCount;    // NTP同步成功次数
+    uint8_t ntpPollExponent;         // NTP轮询间隔的2的幂（秒）
+    int32_t ntpLastStepMs;           // 最近一次NTP查询的修正量
+    uint32_t ntpKissOfDeathCount;    // 收到的Kiss-o'-Death次数
 
     // 按键统计
     uint32_t buttonPressCount;       // 按键按下次数
     uint32_t longPressCount;         // 长按次数
 
+    // 输入延迟统计（按键事件到反映它的第一帧发送完成）
+    uint32_t inputLatencyCount;      // 已测量的按键事件数
+    unsigned long inputLatencyMaxMs; // 最大延迟（毫秒）
+    uint32_t inputLatencyTotalMs;    // 延迟总和（毫秒）
+    uint16_t inputLatencyHistogram[INPUT_LATENCY_BUCKETS]; // 各延迟区间的事件数
+
+    // 功耗统计（空闲管理器估算）
+    uint16_t cpuDutyPermille;        // CPU非空闲时间的千分比
+    uint32_t estimatedCurrentUa;     // ESP8266模块平均电流估算（微安，不含OLED）
+
     // 显示统计
     uint32_t displayUpdateCount;     // 显示更新次数
     uint32_t displayRefreshCount;    // 显示刷新次数
@@ -59,11 +79,17 @@ extern RuntimeStats runtimeStats;
 // 函数声明
 void initRuntimeMonitor();
 void updateRuntimeMonitor();
+void recordLoopTime(unsigned long loopMs);
 void updateMemoryStats();
 void updateErrorStats(ErrorCode code);
 void updateNetworkStats(bool connected, bool ntpSuccess);
 void updateButtonStats(bool isLongPress);
 void updateDisplayStats(bool isRefresh);
+void noteInputEvent(unsigned long eventMillis);
+void noteFrameSent();
+void recordInputLatency(unsigned long latencyMs);
+unsigned long getInputLatencyBucketLimit(uint8_t bucket);
+unsigned long getInputLatencyPercentile(uint8_t percent);
 void printRuntimeStats();
 void resetRuntimeStats();
 const char* getRuntimeStatsJson();
@@ -13,18 +13,24 @@
 #include "button_handler.h"
 #include "time_manager.h"
 #include "display_manager.h"
+#include "display_flush.h"
 #include "system_manager.h"
 #include "utils.h"
-#include "eeprom_config.h"
+#include "ntp_engine.h"
+#include "config_manager.h"
 #include "web_ota_manager.h"
 #include "logger.h"
 #include "version.h"
+#include "idle_manager.h"
+#include "runtime_monitor.h"
+#include "breadcrumbs.h"
+#include "monitoring_system.h"
+#include "metrics_server.h"
 
 // 外部变量声明
 extern SystemState systemState;
 extern DisplayState displayState;
 extern TimeState timeState;
-extern NTPClient timeClient;
 extern U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2;
 extern const uint8_t BRIGHTNESS_LEVELS[];
 
@@ -35,9 +41,15 @@ void initBasicSystem() {
   // 初始化串口和日志系统
   initLogger();
 
+  // 取出上次启动留下的诊断记录（在写入本次的记录之前）
+  initBreadcrumbs();
+
   // 初始化版本管理器
   initVersionManager();
 
+  // 初始化运行时监控（之后由调度器每秒更新）
+  initRuntimeMonitor();
+
   // 输出固件版本信息
   Serial.println();
   Serial.println("========================================");
@@ -75,29 +87,25 @@ void initHardwarePeripherals() {
   // 初始化Web OTA管理器
   initWebOtaManager();
 
-  // 初始化EEPROM
-  initEEPROM();
-
-  // 从EEPROM加载亮度设置
-  uint8_t savedBrightnessIndex = loadBrightnessIndex();
-  if (savedBrightnessIndex <= 3) {
-    displayState.brightnessIndex = savedBrightnessIndex;
-    LOG_DEBUG("Loaded brightness index from EEPROM: %d", savedBrightnessIndex);
-  } else {
-    LOG_DEBUG("Using default brightness index: %d", displayState.brightnessIndex);
-  }
+  // 初始化配置管理器（迁移旧版配置，解码全部配置到RAM）
+  initConfigManager();
 
-  // 从EEPROM加载字体大小状态
-  bool savedFontSize = loadFontSize();
-  displayState.largeFont = savedFontSize;
-  LOG_DEBUG("Loaded font size from EEPROM: %s", savedFontSize ? "Large" : "Small");
+  // 加载亮度设置和字体大小状态（超出范围的值已换成默认值）
+  displayState.brightnessIndex = getConfigValue(CONFIG_BRIGHTNESS_INDEX);
+  displayState.largeFont = getConfigValue(CONFIG_FONT_SIZE) != 0;
+  LOG_DEBUG("Loaded config: brightness index %d, font %s", displayState.brightnessIndex,
+            displayState.largeFont ? "Large" : "Small");
 
   // 初始化I2C总线和OLED显示器
   Wire.begin();
   u8g2.begin();
+  invalidateDisplayShadow();  // 控制器已重新初始化，首帧整帧发送
   u8g2.setPowerSave(false);
   u8g2.setContrast(BRIGHTNESS_LEVELS[displayState.brightnessIndex]);
 
+  // 启动时预解码时间数字字形
+  prepareTimeGlyphCache();
+
   LOG_DEBUG("Hardware peripherals initialized");
 }
 
@@ -110,6 +118,10 @@ bool initRTCAndBootScreen() {
   bool rtcSuccess = initializeRTC();
   LOG_DEBUG("RTC init: %s", rtcSuccess ? "Success" : "Failed");
 
+  // 输出复位原因和上次启动的诊断记录（断电重启时取DS1307中的镜像）
+  loadBreadcrumbMirror();
+  printBreadcrumbs();
+
   // 显示启动画面（无论RTC是否有效，都显示1秒）
   drawClockIcon();
   LOG_DEBUG("Clock icon displayed");
@@ -277,9 +289,7 @@ void connectWiFiAndInitNTP(bool enterAPMode) {
   // 初始化NTP客户端
   if (systemState.networkConnected) {
     LOG_DEBUG("IP: %s", WiFi.localIP().toString().c_str());
-    timeClient.begin();
-    timeClient.setTimeOffset(8 * 3600); // 设置时区偏移（北京时间）
-    timeClient.setPoolServerName(timeState.currentNtpServer);
+    initNtpEngine();
 
     // 首次连接网络时，立即同步一次时间到RTC
     if (systemState.rtcInitialized) {
@@ -307,6 +317,8 @@ void initSystemState() {
   LOG_DEBUG("Time source: %s", sourceName);
 
   // 初始化系统状态变量
+  // setup()可能耗时超过WATCHDOG_INTERVAL（配网门户、NTP重试），主循环时间戳必须从这里开始计
+  systemState.lastMainLoopTime = millis();
   systemState.lastWatchdogCheck = millis();
   systemState.lastNetworkCheck = millis();
   systemState.lastDisplayUpdate = millis();
@@ -339,7 +351,19 @@ void systemSetup() {
   // 6. 初始化系统状态变量
   initSystemState();
 
+  // 7. 设置主循环空闲时的WiFi睡眠方式
+  initIdleManager();
+
+  // 8. 初始化健康监控（CPU占用、帧率等区间量从此刻开始计）
+  initMonitoringSystem();
+
+  // 9. 启动Prometheus指标服务（WiFi稍后才连上也能访问）
+  initMetricsServer();
+
   LOG_DEBUG("System setup complete");
+
+  // 10. 之后的日志存入缓冲区，在主循环空闲时输出
+  setLogDeferred(DEFERRED_LOGGING);
 }
 
 /**
@@ -1,18 +1,24 @@
+#define LOG_MODULE NET
+
 #include "system_manager.h"
 #include "time_manager.h"
 #include "display_manager.h"
 #include "button_handler.h"
 #include "utils.h"
+#include "ntp_engine.h"
 #include <WiFiManager.h>
 #include <RTClib.h>
 #include "logger.h"
+#include "loop_profiler.h"
+#include "breadcrumbs.h"
+#include "config_store.h"
+#include "runtime_monitor.h"
 
 // 外部变量声明 - 精简版本
 extern SystemState systemState;
 extern DisplayState displayState;
 extern SettingState settingState;
 extern TimeState timeState;
-extern NTPClient timeClient;
 extern RTC_DS1307 rtc;
 extern const uint8_t BRIGHTNESS_LEVELS[];
 extern const char* const BRIGHTNESS_LABELS[];
@@ -101,6 +107,7 @@ void updateWifiDisconnect() {
 
   if (disconnectElapsed >= DISCONNECT_TIMEOUT) {
     LOG_WARNING("WiFi disconnect timeout after %lu ms, forcing system restart", disconnectElapsed);
+    flushConfigStore();
     ESP.reset();
     return;
   }
@@ -109,6 +116,7 @@ void updateWifiDisconnect() {
   if (WiFi.status() != WL_CONNECTED) {
     LOG_DEBUG("WiFi disconnected successfully");
     systemState.wifiDisconnectInProgress = false;
+    flushConfigStore();
     ESP.reset();
     return;
   }
@@ -127,29 +135,32 @@ void systemWatchdog() {
                                  (0xFFFFFFFF - systemState.lastMainLoopTime + currentMillis);
   if (mainLoopElapsed > WATCHDOG_INTERVAL) {
     LOG_WARNING("Main loop watchdog timeout - restarting system");
+    recordRestartBreadcrumb("loop watchdog");
+    flushConfigStore();
+    flushLogBuffer();
     ESP.restart();
   }
+}
 
-  // 定期检查网络连接状态（使用溢出安全的时间比较）
-  unsigned long networkCheckElapsed = (currentMillis >= systemState.lastNetworkCheck) ?
-                                     (currentMillis - systemState.lastNetworkCheck) :
-                                     (0xFFFFFFFF - systemState.lastNetworkCheck + currentMillis);
-  if (networkCheckElapsed > NETWORK_CHECK_INTERVAL) {
-    checkNetworkStatus();
-    systemState.lastNetworkCheck = currentMillis;
+void checkRtcSync() {
+  // 使用NTP时间源且距上次RTC同步已满间隔时同步（使用溢出安全的时间比较）
+  if (timeState.currentTimeSource != TIME_SOURCE_NTP || !systemState.rtcInitialized ||
+      !systemState.networkConnected) {
+    return;
   }
-
-  // 定期同步RTC时间（如果使用NTP，使用溢出安全的时间比较）
+  unsigned long currentMillis = millis();
   unsigned long rtcSyncElapsed = (currentMillis >= timeState.lastRtcSync) ?
                                 (currentMillis - timeState.lastRtcSync) :
                                 (0xFFFFFFFF - timeState.lastRtcSync + currentMillis);
-  if (timeState.currentTimeSource == TIME_SOURCE_NTP && systemState.rtcInitialized &&
-      rtcSyncElapsed > RTC_SYNC_INTERVAL) {
-    syncNtpToRtc();
+  if (rtcSyncElapsed >= RTC_SYNC_INTERVAL) {
+    syncNtpToRtc(); // 触发RTC同步（非阻塞）
+    LOG_DEBUG("Triggered periodic RTC sync");
   }
 }
 
 void checkNetworkStatus() {
+  PROFILE_SCOPE("checkNetwork");
+  BREADCRUMB_SECTION("checkNetwork");
   // 检查WiFi连接状态
   if (systemState.wifiConfigured) {
     wl_status_t status = WiFi.status();
@@ -162,10 +173,8 @@ void checkNetworkStatus() {
         LOG_DEBUG("Network connected");
         // 网络连接恢复，尝试更新NTP时间
         if (timeState.currentTimeSource == TIME_SOURCE_NTP) {
-          // 确保NTP客户端已正确初始化
-          timeClient.begin();
-          timeClient.setTimeOffset(8 * 3600);
-          timeClient.setPoolServerName(timeState.currentNtpServer);
+          // 重新打开NTP端口，放弃断网前未完成的查询
+          restartNtpEngine();
         }
         // 如果当前不是NTP时间源，且网络已恢复，尝试切换回NTP
         else if (timeState.currentTimeSource != TIME_SOURCE_NTP) {
@@ -216,7 +225,7 @@ void checkNetworkStatus() {
     // 如果网络已连接但长时间未获取到NTP时间，尝试重新连接
     if (systemState.networkConnected && timeState.currentTimeSource == TIME_SOURCE_NTP) {
       // 检查NTP客户端是否正常工作
-      if (!timeClient.isTimeSet() && !timeState.ntpCheckInProgress) {
+      if (!isNtpTimeSet() && !timeState.ntpCheckInProgress) {
         // 如果距离上次NTP检查已超过一定时间，重新尝试（使用溢出安全的时间比较）
         unsigned long currentMillis = millis();
         unsigned long ntpCheckElapsed = (currentMillis >= timeState.lastNtpCheckAttempt) ?
@@ -268,6 +277,8 @@ void reportError(ErrorCode code, ErrorLevel level, const char* message) {
 
   // 格式化错误信息
   LOG_DEBUG("[%s] %s%s%s", levelDesc, errorDesc, message ? ": " : "", message ? message : "");
+  addBreadcrumb(BREADCRUMB_ERROR, code, level, message ? message : errorDesc);
+  updateErrorStats(code);
 
   // 根据错误级别采取不同措施
   switch (level) {
@@ -523,13 +534,23 @@ String encryptPasswordAES(const String& password, const uint8_t* key) {
 
   // 使用确定性的初始化向量（基于密码长度和密钥，确保加解密一致）
   uint8_t iv[AES_KEY_SIZE];
-  String encrypted = "";
+  // 结果一次性预留：IV和密文各按十六进制两字符/字节，避免逐字节追加时反复realloc产生碎片
+  size_t blockCount = (password.length() + AES_KEY_SIZE - 1) / AES_KEY_SIZE;
+  String result;
+  result.reserve((blockCount + 1) * AES_KEY_SIZE * 2);
 
   // 生成IV
   for (int i = 0; i < AES_KEY_SIZE; i++) {
     iv[i] = (password.length() * 7 + i * 13) ^ key[(i + 5) % AES_KEY_SIZE];
   }
 
+  // 输出以IV开头
+  for (int i = 0; i < AES_KEY_SIZE; i++) {
+    char hex[3];
+    snprintf(hex, sizeof(hex), "%02X", iv[i]);
+    result += hex;
+  }
+
   // CBC模式加密
   uint8_t prevBlock[AES_KEY_SIZE];
   memcpy(prevBlock, iv, AES_KEY_SIZE);
@@ -572,19 +593,10 @@ String encryptPasswordAES(const String& password, const uint8_t* key) {
     for (int j = 0; j < AES_KEY_SIZE; j++) {
       char hex[3];
       snprintf(hex, sizeof(hex), "%02X", block[j]);
-      encrypted += hex;
+      result += hex;
     }
   }
 
-  // 添加IV和校验信息
-  String result = "";
-  for (int i = 0; i < AES_KEY_SIZE; i++) {
-    char hex[3];
-    snprintf(hex, sizeof(hex), "%02X", iv[i]);
-    result += hex;
-  }
-  result += encrypted;
-
   return result;
 }
 
@@ -18,6 +18,7 @@ String getApName();
 void resetToAP();
 void updateWifiDisconnect(); // 更新WiFi断开状态（非阻塞，在主循环中调用）
 void systemWatchdog(); // 系统看门狗，防止死锁
+void checkRtcSync(); // 到期时把NTP时间同步到RTC
 void checkNetworkStatus(); // 检查网络连接状态
 
 // 统一错误处理函数
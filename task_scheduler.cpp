@@ -0,0 +1,255 @@
+/**
+ * @file task_scheduler.cpp
+ * @brief 协作式定时任务调度器实现
+ *
+ * 任务槽位固定分配，已排期的任务另按下次运行时刻组成二叉最小堆，
+ * 堆顶即最早到期的任务：取最早任务O(1)，排期、改期、取消O(log n)。
+ * 单调毫秒由millis()扩展为64位（检测到回绕时高位加一），
+ * 只要至少每49天调用一次即可保持连续
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#include "task_scheduler.h"
+#include "logger.h"
+#include <string.h>
+
+// 任务槽位
+struct TaskSlot {
+  TaskCallback callback;        // NULL表示槽位空闲
+  uint64_t dueMillis;           // 下次运行的单调时刻
+  int8_t heapIndex;             // 在堆中的位置，-1表示未排期
+  TaskStats stats;
+};
+
+static TaskSlot tasks[TASK_SCHEDULER_CAPACITY];
+static uint8_t heap[TASK_SCHEDULER_CAPACITY];   // 按dueMillis排列的槽位下标
+static uint8_t heapSize = 0;
+
+// 64位单调毫秒
+static struct {
+  uint32_t lastMillis;
+  uint32_t wraps;
+} monotonic = {0, 0};
+
+/**
+ * @brief 64位单调毫秒（不随millis()回绕）
+ */
+uint64_t getMonotonicMillis() {
+  uint32_t now = millis();
+  if (now < monotonic.lastMillis) {
+    monotonic.wraps++;
+  }
+  monotonic.lastMillis = now;
+  return ((uint64_t)monotonic.wraps << 32) | now;
+}
+
+// 辅助：交换堆中两个位置并更新槽位记录的位置
+static void heapSwap(uint8_t a, uint8_t b) {
+  uint8_t slot = heap[a];
+  heap[a] = heap[b];
+  heap[b] = slot;
+  tasks[heap[a]].heapIndex = a;
+  tasks[heap[b]].heapIndex = b;
+}
+
+static bool heapLess(uint8_t a, uint8_t b) {
+  return tasks[heap[a]].dueMillis < tasks[heap[b]].dueMillis;
+}
+
+static void siftUp(uint8_t pos) {
+  while (pos > 0) {
+    uint8_t parent = (pos - 1) / 2;
+    if (!heapLess(pos, parent)) {
+      break;
+    }
+    heapSwap(pos, parent);
+    pos = parent;
+  }
+}
+
+static void siftDown(uint8_t pos) {
+  while (true) {
+    uint8_t smallest = pos;
+    uint8_t left = 2 * pos + 1;
+    uint8_t right = left + 1;
+    if (left < heapSize && heapLess(left, smallest)) {
+      smallest = left;
+    }
+    if (right < heapSize && heapLess(right, smallest)) {
+      smallest = right;
+    }
+    if (smallest == pos) {
+      break;
+    }
+    heapSwap(pos, smallest);
+    pos = smallest;
+  }
+}
+
+// 辅助：从堆中移除任务（未排期时无操作）
+static void unschedule(uint8_t slot) {
+  int8_t pos = tasks[slot].heapIndex;
+  if (pos < 0) {
+    return;
+  }
+  tasks[slot].heapIndex = -1;
+  heapSize--;
+  if (pos == heapSize) {
+    return;
+  }
+  heap[pos] = heap[heapSize];
+  tasks[heap[pos]].heapIndex = pos;
+  siftUp(pos);
+  siftDown(tasks[heap[pos]].heapIndex);
+}
+
+// 辅助：把任务排在指定时刻（已排期时改期）
+static void scheduleAt(uint8_t slot, uint64_t dueMillis) {
+  unschedule(slot);
+  tasks[slot].dueMillis = dueMillis;
+  tasks[slot].heapIndex = heapSize;
+  heap[heapSize] = slot;
+  heapSize++;
+  siftUp(tasks[slot].heapIndex);
+}
+
+static bool isValidTask(int taskId) {
+  return taskId >= 0 && taskId < TASK_SCHEDULER_CAPACITY && tasks[taskId].callback != NULL;
+}
+
+/**
+ * @brief 注册任务
+ * @param name 任务名（须为静态字符串）
+ * @param callback 任务函数
+ * @param intervalMs 运行周期，0表示只运行一次
+ * @param firstDelayMs 首次运行距现在的毫秒数
+ * @return 任务ID，容量已满时返回-1
+ */
+int addTask(const char* name, TaskCallback callback, unsigned long intervalMs, unsigned long firstDelayMs) {
+  for (uint8_t slot = 0; slot < TASK_SCHEDULER_CAPACITY; slot++) {
+    if (tasks[slot].callback != NULL) {
+      continue;
+    }
+    tasks[slot].callback = callback;
+    tasks[slot].heapIndex = -1;
+    memset(&tasks[slot].stats, 0, sizeof(TaskStats));
+    tasks[slot].stats.name = name;
+    tasks[slot].stats.intervalMs = intervalMs;
+    scheduleAt(slot, getMonotonicMillis() + firstDelayMs);
+    return slot;
+  }
+  LOG_ERROR("Task scheduler full, cannot add task %s", name);
+  return -1;
+}
+
+/**
+ * @brief 注销任务并释放槽位（可在任务自己的回调中调用）
+ */
+void cancelTask(int taskId) {
+  if (!isValidTask(taskId)) {
+    return;
+  }
+  unschedule(taskId);
+  tasks[taskId].callback = NULL;
+}
+
+/**
+ * @brief 把任务的下次运行改到距现在delayMs毫秒（单次任务运行后也可再次排期）
+ */
+void rescheduleTask(int taskId, unsigned long delayMs) {
+  if (!isValidTask(taskId)) {
+    return;
+  }
+  scheduleAt(taskId, getMonotonicMillis() + delayMs);
+}
+
+/**
+ * @brief 修改任务周期，从下一次运行后生效
+ */
+void setTaskInterval(int taskId, unsigned long intervalMs) {
+  if (!isValidTask(taskId)) {
+    return;
+  }
+  tasks[taskId].stats.intervalMs = intervalMs;
+}
+
+bool isTaskScheduled(int taskId) {
+  return isValidTask(taskId) && tasks[taskId].heapIndex >= 0;
+}
+
+/**
+ * @brief 运行所有在调用时刻已到期的任务
+ * @return 本次运行的任务数
+ *
+ * 周期任务在运行前按"计划时刻 + 周期"重新排期，保持固定节拍；
+ * 落后超过一个周期时从当前时刻重新计，不补运行错过的次数
+ */
+uint8_t runDueTasks() {
+  uint64_t now = getMonotonicMillis();
+  uint8_t ran = 0;
+  while (heapSize > 0 && tasks[heap[0]].dueMillis <= now) {
+    uint8_t slot = heap[0];
+    TaskSlot& task = tasks[slot];
+    unschedule(slot);
+    if (task.stats.intervalMs > 0) {
+      uint64_t next = task.dueMillis + task.stats.intervalMs;
+      if (next <= now) {
+        next = now + task.stats.intervalMs;
+        task.stats.lateCount++;
+      }
+      scheduleAt(slot, next);
+    }
+
+    uint32_t start = micros();
+    task.callback();
+    uint32_t spent = micros() - start;
+    task.stats.runCount++;
+    task.stats.lastRunMicros = spent;
+    if (spent > task.stats.maxRunMicros) {
+      task.stats.maxRunMicros = spent;
+    }
+    ran++;
+  }
+  return ran;
+}
+
+/**
+ * @brief 距最早到期的任务还有多少毫秒
+ * @return 毫秒数，已到期返回0，没有已排期的任务返回TASK_NEVER
+ */
+unsigned long getMillisUntilNextTask() {
+  if (heapSize == 0) {
+    return TASK_NEVER;
+  }
+  uint64_t now = getMonotonicMillis();
+  uint64_t due = tasks[heap[0]].dueMillis;
+  if (due <= now) {
+    return 0;
+  }
+  return (due - now < TASK_NEVER) ? (unsigned long)(due - now) : TASK_NEVER - 1;
+}
+
+/**
+ * @brief 获取任务的运行统计
+ * @return 统计信息，任务不存在时返回NULL
+ */
+const TaskStats* getTaskStats(int taskId) {
+  return isValidTask(taskId) ? &tasks[taskId].stats : NULL;
+}
+
+/**
+ * @brief 打印所有任务的运行统计
+ */
+void printTaskStats() {
+  for (uint8_t slot = 0; slot < TASK_SCHEDULER_CAPACITY; slot++) {
+    if (tasks[slot].callback == NULL) {
+      continue;
+    }
+    const TaskStats& stats = tasks[slot].stats;
+    LOG_INFO("  %-12s every %lu ms: %u runs, %u late, max %u us, last %u us", stats.name, stats.intervalMs,
+             stats.runCount, stats.lateCount, stats.maxRunMicros, stats.lastRunMicros);
+  }
+}
@@ -0,0 +1,52 @@
+/**
+ * @file task_scheduler.h
+ * @brief 协作式定时任务调度器
+ *
+ * 取代loop()中各自维护static lastX变量和溢出安全减法的周期任务：
+ * 任务按下次运行时刻放在固定容量的最小堆中，时刻用64位单调毫秒表示，
+ * millis()回绕不影响比较。loop()每次只运行已到期的任务，
+ * 并可以据getMillisUntilNextTask()空闲到下一个任务到期
+ *
+ * 任务在运行前按周期重新排入堆中，回调内可以改期、修改周期或取消自己
+ *
+ * @author ESP8266 SSD1306 Clock Project
+ * @version 1.0
+ * @date 2026-10-16
+ */
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <Arduino.h>
+
+// 最多可注册的任务数
+const uint8_t TASK_SCHEDULER_CAPACITY = 12;
+
+// 没有待运行任务时getMillisUntilNextTask()的返回值
+const unsigned long TASK_NEVER = 0xFFFFFFFF;
+
+typedef void (*TaskCallback)();
+
+// 单个任务的运行统计
+struct TaskStats {
+  const char* name;             // 任务名（用于日志）
+  unsigned long intervalMs;     // 运行周期，0表示单次任务
+  uint32_t runCount;            // 运行次数
+  uint32_t lateCount;           // 晚于计划时刻一个周期以上、跳过了错过的运行的次数
+  uint32_t maxRunMicros;        // 单次运行的最长耗时
+  uint32_t lastRunMicros;       // 最近一次运行的耗时
+};
+
+// 函数声明
+int addTask(const char* name, TaskCallback callback, unsigned long intervalMs, unsigned long firstDelayMs);
+void cancelTask(int taskId);
+void rescheduleTask(int taskId, unsigned long delayMs);
+void setTaskInterval(int taskId, unsigned long intervalMs);
+bool isTaskScheduled(int taskId);
+uint8_t runDueTasks();
+unsigned long getMillisUntilNextTask();
+uint64_t getMonotonicMillis();
+const TaskStats* getTaskStats(int taskId);
+void printTaskStats();
+
+#endif // TASK_SCHEDULER_H
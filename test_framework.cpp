@@ -7,6 +7,8 @@
  * @date 2026-02-04
  */
 
+#define LOG_MODULE TEST
+
 #include "test_framework.h"
 #include "test_suites.h"
 #include "logger.h"
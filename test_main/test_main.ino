@@ -11,12 +11,15 @@
  * @date 2026-02-04
  */
 
+#define LOG_MODULE TEST
+
 #include <Arduino.h>
 #include <ESP8266WiFi.h>
 #include <Wire.h>
 #include "test_framework.h"
 #include "test_suites.h"
 #include "integration_tests.h"
+#include "benchmark_suites.h"
 #include "logger.h"
 #include "config.h"
 #include "global_config.h"
@@ -25,13 +28,14 @@
 #include "display_manager.h"
 #include "system_manager.h"
 #include "utils.h"
-#include "eeprom_config.h"
+#include "config_manager.h"
 #include "runtime_monitor.h"
 #include "error_recovery.h"
 
 // 测试模式选择
 #define RUN_UNIT_TESTS true
 #define RUN_INTEGRATION_TESTS false
+#define RUN_BENCHMARKS false
 #define RUN_TEST_ON_STARTUP true
 #define RUN_EEPROM_TESTS_ONLY false
 #define RUN_UTILS_TESTS_ONLY false
@@ -65,7 +69,7 @@ void setup() {
     enableTimestamp(true);
 
     // 初始化所有模块（测试需要）
-    initEEPROM();
+    initConfigManager();
     initLogger();
     // initPowerManagement(); // 已删除 power_manager 模块
     initRuntimeMonitor();
@@ -119,12 +123,20 @@ void setup() {
             runAllIntegrationTests();
             Serial.flush();
         }
+
+        if (RUN_BENCHMARKS) {
+            LOG_INFO("Running benchmarks...");
+            Serial.flush();
+            runAllBenchmarks();
+            Serial.flush();
+        }
     } else {
         LOG_INFO("Test mode: Manual");
         LOG_INFO("Current log level: %d", logConfig.currentLevel);
         LOG_INFO("Send 'u' to run unit tests");
         LOG_INFO("Send 'i' to run integration tests");
         LOG_INFO("Send 'a' to run all tests");
+        LOG_INFO("Send 'b' to run benchmarks");
         LOG_INFO("Send 's' to show system stats");
         LOG_INFO("Send 'r' to show runtime stats");
         LOG_INFO("Send 'c' to show config");
@@ -168,6 +180,12 @@ void loop() {
                 runAllIntegrationTests();
                 break;
 
+            case 'b':
+            case 'B':
+                LOG_INFO("Running benchmarks...");
+                runAllBenchmarks();
+                break;
+
             case 's':
             case 'S':
                 LOG_INFO("System Statistics:");
@@ -203,6 +221,7 @@ void loop() {
                 LOG_INFO("  u - Run unit tests");
                 LOG_INFO("  i - Run integration tests");
                 LOG_INFO("  a - Run all tests");
+                LOG_INFO("  b - Run benchmarks");
                 LOG_INFO("  s - Show system stats");
                 LOG_INFO("  r - Show runtime stats");
                 LOG_INFO("  c - Show configuration");
@@ -9,11 +9,14 @@
  * @date 2026-02-04
  */
 
+#define LOG_MODULE TEST
+
 #include "test_suites.h"
-#include "eeprom_config.h"
+#include "config_manager.h"
 #include "utils.h"
 #include "system_manager.h"
 #include "time_manager.h"
+#include "display_manager.h"
 #include "logger.h"
 
 // =============================================================================
@@ -24,71 +27,71 @@ void runTestSuite_eeprom() {
     TEST_SUITE_START(eeprom);
 
     TEST_CASE(test_clear_eeprom) {
-            clearEEPROM();
-            uint8_t brightness = loadBrightnessIndex();
+            resetAllConfigs();
+            uint8_t brightness = getConfigValue(CONFIG_BRIGHTNESS_INDEX);
             LOG_ERROR("    Clear EEPROM test: brightness = %d (expected: 2)", brightness);
             ASSERT_EQ(2, brightness); // 默认值应该是2
         }
         TEST_CASE_END();
 
         TEST_CASE(test_save_and_load_brightness_0) {
-            clearEEPROM();
-            bool result = saveBrightnessIndex(0);
+            resetAllConfigs();
+            bool result = setConfigValue(CONFIG_BRIGHTNESS_INDEX, 0);
             LOG_ERROR("    Save brightness 0: result = %d (expected: 1)", result);
             ASSERT_TRUE(result);
 
-            uint8_t brightness = loadBrightnessIndex();
+            uint8_t brightness = getConfigValue(CONFIG_BRIGHTNESS_INDEX);
             LOG_ERROR("    Load brightness: %d (expected: 0)", brightness);
             ASSERT_EQ(0, brightness);
         }
         TEST_CASE_END();
 
         TEST_CASE(test_save_and_load_brightness_3) {
-            clearEEPROM();
-            bool result = saveBrightnessIndex(3);
+            resetAllConfigs();
+            bool result = setConfigValue(CONFIG_BRIGHTNESS_INDEX, 3);
             LOG_ERROR("    Save brightness 3: result = %d (expected: 1)", result);
             ASSERT_TRUE(result);
 
-            uint8_t brightness = loadBrightnessIndex();
+            uint8_t brightness = getConfigValue(CONFIG_BRIGHTNESS_INDEX);
             LOG_ERROR("    Load brightness: %d (expected: 3)", brightness);
             ASSERT_EQ(3, brightness);
         }
         TEST_CASE_END();
 
         TEST_CASE(test_save_invalid_brightness) {
-            clearEEPROM();
-            bool result = saveBrightnessIndex(5); // 无效值
+            resetAllConfigs();
+            bool result = setConfigValue(CONFIG_BRIGHTNESS_INDEX, 5); // 无效值
             LOG_ERROR("    Save invalid brightness 5: result = %d (expected: 0)", result);
             ASSERT_FALSE(result);
 
-            uint8_t brightness = loadBrightnessIndex();
+            uint8_t brightness = getConfigValue(CONFIG_BRIGHTNESS_INDEX);
             LOG_ERROR("    Load brightness: %d (expected: 2)", brightness);
             ASSERT_EQ(2, brightness); // 应该保持默认值
         }
         TEST_CASE_END();
 
         TEST_CASE(test_save_negative_brightness) {
-            clearEEPROM();
-            bool result = saveBrightnessIndex(255); // 负数（作为无符号处理）
+            resetAllConfigs();
+            bool result = setConfigValue(CONFIG_BRIGHTNESS_INDEX, 255); // 负数（作为无符号处理）
             LOG_ERROR("    Save negative brightness 255: result = %d (expected: 0)", result);
             ASSERT_FALSE(result);
         }
         TEST_CASE_END();
 
         TEST_CASE(test_multiple_saves) {
-            clearEEPROM();
-            saveBrightnessIndex(1);
-            uint8_t b1 = loadBrightnessIndex();
+            resetAllConfigs();
+            setConfigValue(CONFIG_BRIGHTNESS_INDEX, 1);
+            uint8_t b1 = getConfigValue(CONFIG_BRIGHTNESS_INDEX);
             LOG_ERROR("    Save/Load brightness 1: %d (expected: 1)", b1);
             ASSERT_EQ(1, b1);
 
-            saveBrightnessIndex(2);
-            uint8_t b2 = loadBrightnessIndex();
+            setConfigValue(CONFIG_BRIGHTNESS_INDEX, 2);
+            uint8_t b2 = getConfigValue(CONFIG_BRIGHTNESS_INDEX);
             LOG_ERROR("    Save/Load brightness 2: %d (expected: 2)", b2);
             ASSERT_EQ(2, b2);
 
-            saveBrightnessIndex(0);
-            uint8_t b3 = loadBrightnessIndex();
+            setConfigValue(CONFIG_BRIGHTNESS_INDEX, 0);
+            uint8_t b3 = getConfigValue(CONFIG_BRIGHTNESS_INDEX);
             LOG_ERROR("    Save/Load brightness 0: %d (expected: 0)", b3);
             ASSERT_EQ(0, b3);
         }
@@ -175,6 +178,36 @@ void runTestSuite_time() {
         }
         TEST_CASE_END();
 
+        TEST_CASE(test_days_from_civil) {
+            static_assert(daysFromCivil(1970, 1, 1) == 0, "epoch must be day 0");
+            ASSERT_TRUE(daysFromCivil(2000, 1, 1) == 10957);
+            ASSERT_TRUE(daysFromCivil(2000, 3, 1) == 11017);   // 世纪闰年
+            ASSERT_TRUE(daysFromCivil(2024, 2, 29) == 19782);
+            ASSERT_TRUE(daysFromCivil(2100, 3, 1) - daysFromCivil(2100, 2, 28) == 1);  // 2100非闰年
+            ASSERT_TRUE(daysFromCivil(1969, 12, 31) == -1);
+            ASSERT_EQ(6, weekdayFromDays(daysFromCivil(2000, 1, 1)));   // 星期六
+            ASSERT_EQ(4, weekdayFromDays(daysFromCivil(1970, 1, 1)));   // 星期四
+            ASSERT_EQ(3, weekdayFromDays(daysFromCivil(1969, 12, 31))); // 星期三
+        }
+        TEST_CASE_END();
+
+        TEST_CASE(test_market_day_cycle) {
+            ASSERT_EQ(0, getMarketIndexForDate(2000, 1, 1));
+            ASSERT_EQ(1, getMarketIndexForDate(2000, 1, 2));
+            ASSERT_EQ(2, getMarketIndexForDate(2000, 1, 3));
+            ASSERT_EQ(2, getMarketIndexForDate(1999, 12, 31));  // 基准日期之前
+
+            // 跨月、跨年连续递增
+            ASSERT_EQ((getMarketIndexForDate(2024, 2, 29) + 1) % 3, getMarketIndexForDate(2024, 3, 1));
+            ASSERT_EQ((getMarketIndexForDate(2025, 12, 31) + 1) % 3, getMarketIndexForDate(2026, 1, 1));
+
+            const MarketDayInfo& info = getMarketDayInfo(2000, 1, 2);
+            ASSERT_EQ(1, info.marketIndex);
+            ASSERT_EQ(0, info.weekdayIndex);  // 2000-01-02 星期日
+            ASSERT_TRUE(info.dateKey == 20000102);
+        }
+        TEST_CASE_END();
+
     TEST_SUITE_END();
 
     LOG_DEBUG("=== Test Suite Complete: %s ===", g_testStats.currentSuite);
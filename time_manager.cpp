@@ -1,18 +1,24 @@
+#define LOG_MODULE TIME
+
 #include "time_manager.h"
 #include "system_manager.h"
 #include "display_manager.h"
+#include "display_flush.h"
 #include "utils.h"
+#include "ntp_engine.h"
+#include "clock_discipline.h"
 #include <Wire.h>
 #include <time.h>
 #include "config.h"
 #include "logger.h"
+#include "loop_profiler.h"
+#include "breadcrumbs.h"
 
 // 外部变量声明
 extern SystemState systemState;
 extern DisplayState displayState;
 extern SettingState settingState;
 extern TimeState timeState;
-extern NTPClient timeClient;
 extern RTC_DS1307 rtc;
 
 // NTP服务器列表声明 - 现在统一在global_config.cpp中定义
@@ -22,7 +28,29 @@ extern const int NTP_SERVER_COUNT;
 // 辅助函数声明
 bool isLeapYear(int year);
 int getDaysInMonth(int month, int year);
-void ensureNtpClientInitialized();
+static bool ntpTimeToDateTime(DateTime& now, uint16_t& subsecondMs);
+
+// DS1307时钟缓存：芯片只有整秒寄存器，锁定秒边界（两次相邻读取之间秒寄存器发生变化的时刻）
+// 后以millis()外推，只在RTC_CLOCK_RESYNC_INTERVAL到期或读数与外推不符时重新读取。
+// 对外提供的时间扣除频偏修正量（见clock_discipline.h）
+static struct {
+  bool valid;                   // 已锁定秒边界，可由锚点外推
+  uint32_t anchorUnix;          // 锚点秒边界时的RTC时间（原始读数）
+  unsigned long boundaryMillis; // 锚点秒边界对应的millis()
+  unsigned long lockedMillis;   // 最近一次锁定秒边界的millis()
+  int32_t correctionMs;         // 锁定时RTC累积的频偏误差
+  bool haveLast;
+  uint8_t lastSecond;           // 上次读到的秒
+  unsigned long lastReadMillis; // 上次读取的millis()
+} rtcClock = {false, 0, 0, 0, 0, false, 0, 0};
+
+// RTC同步先测量RTC相对NTP的偏差，由频偏修正决定是否需要写入
+static bool rtcMeasurePending = false;
+static unsigned long rtcMeasureStart = 0;
+
+// NTP时间写入DS1307要等到NTP的下一个秒边界（写入会复位DS1307的秒分频链）
+static bool rtcWritePending = false;
+static uint32_t rtcWritePendingSecond = 0;
 
 bool initializeRTC() {
   // 尝试初始化RTC (添加I2C错误检测)
@@ -43,6 +71,7 @@ bool initializeRTC() {
   }
   
   systemState.rtcInitialized = true;
+  initClockDiscipline();
   
   // 禁用DS1307的SQW输出，避免干扰
   rtc.writeSqwPinMode(DS1307_OFF);
@@ -57,17 +86,20 @@ bool initializeRTC() {
     if (compileTime.year() >= 2000) {
       // rtc.adjust()函数返回void，无法检查返回值
       rtc.adjust(compileTime);
+      noteRtcSetManually();
       LOG_INFO("RTC was not running, set to compilation time");
     } else {
       // 编译时间不合理，设置一个默认时间
       // rtc.adjust()函数返回void，无法检查返回值
       rtc.adjust(DateTime(2023, 1, 1, 12, 0, 0));
+      noteRtcSetManually();
       LOG_INFO("RTC was not running, set to default time");
     }
   }
   
-  // 验证RTC时间是否有效
+  // 验证RTC时间是否有效（重新初始化后时钟缓存需要重新锁定）
   DateTime rtcTime = rtc.now();
+  rtcClock.valid = false;
   systemState.rtcTimeValid = isRtcTimeValid(rtcTime);
   
   if (!systemState.rtcTimeValid) {
@@ -130,29 +162,50 @@ bool isRtcTimeValid(const DateTime& rtcTime) {
   
   // 额外的安全检查：验证时间戳是否在合理范围内
   if (rtcTime.unixtime() < 946684800UL || rtcTime.unixtime() > 4102444799UL) { // 2000-01-01 到 2099-12-31 23:59:59
-    LOG_DEBUG("Time outside valid range: %lu", rtcTime.unixtime());
+    LOG_DEBUG("Time outside valid range: %lu", (unsigned long)rtcTime.unixtime());
     return false;
   }
   
   return true;
 }
 
-// 确保NTP客户端正确初始化的辅助函数（仅在必要时调用）
-void ensureNtpClientInitialized() {
-  // 只负责初始化NTP客户端，不设置ntpCheckInProgress标志
-  // 该标志由调用者checkNtpConnection()管理
-  if (!timeClient.isTimeSet()) {
-    timeClient.end();
-    // 使用非阻塞延时替代delay(10)
-    nonBlockingDelay(10);
-    timeClient.begin();
-    timeClient.setTimeOffset(8 * 3600); // 设置北京时间
-    timeClient.setPoolServerName(timeState.currentNtpServer);
-    // 使用非阻塞延时替代delay(50)
-    nonBlockingDelay(50);
+// 辅助函数：把NTP引擎当前的时间换算为本地时间的DateTime和秒内毫秒
+static bool ntpTimeToDateTime(DateTime& now, uint16_t& subsecondMs) {
+  if (!isNtpTimeSet()) {
+    return false;
+  }
+  uint64_t epochMillis = getNtpEpochMillis();
+  time_t ntpTime = (time_t)(epochMillis / 1000) + NTP_TIME_OFFSET;
+  subsecondMs = (uint16_t)(epochMillis % 1000);
+
+  // 验证NTP时间有效性
+  if (ntpTime <= 946684800L || ntpTime >= 4102444799L) { // 2000-01-01 到 2099-12-31 23:59:59
+    return false;
+  }
+
+  struct tm ntpTm;
+  if (gmtime_r(&ntpTime, &ntpTm) == nullptr) {
+    LOG_WARNING("gmtime_r() returned nullptr for NTP time");
+    return false;
   }
+
+  // 检查年份有效性 (tm_year >= 100 表示2000年及以后)
+  if (ntpTm.tm_year < 100) {
+    return false;
+  }
+
+  DateTime ntpDateTime(ntpTm.tm_year + 1900, ntpTm.tm_mon + 1, ntpTm.tm_mday,
+                       ntpTm.tm_hour, ntpTm.tm_min, ntpTm.tm_sec);
+  now = ntpDateTime;  // 使用拷贝构造而非赋值操作符
+  return true;
 }
 
+/**
+ * @brief 发起一次NTP查询（非阻塞）
+ *
+ * 只发送请求，应答、超时和服务器轮换由NTP引擎处理，结果在updateNtpSync()中收取
+ * @return 当前是否已有有效的NTP时间（不等待本次查询的应答）
+ */
 bool checkNtpConnection(bool forceCheck) {
   if (!systemState.wifiConfigured || WiFi.status() != WL_CONNECTED) {
     LOG_DEBUG("WiFi not connected for NTP");
@@ -171,7 +224,7 @@ bool checkNtpConnection(bool forceCheck) {
       timeState.ntpCheckStartTime = 0;
     } else {
       LOG_DEBUG("NTP check already in progress");
-      return false;
+      return isNtpTimeSet();
     }
   }
 
@@ -183,76 +236,19 @@ bool checkNtpConnection(bool forceCheck) {
                                    (0xFFFFFFFF - timeState.lastNtpCheckAttempt + currentMillis);
     if (ntpCheckElapsed < NTP_CHECK_COOLDOWN) {
       LOG_DEBUG("NTP check in cooldown period");
-      return false;
+      return isNtpTimeSet();
     }
   }
 
   timeState.lastNtpCheckAttempt = currentMillis;
 
-  // 确保NTP客户端已正确初始化
-  ensureNtpClientInitialized();
-
-  // 标记正在检查并记录开始时间
-  timeState.ntpCheckInProgress = true;
-  timeState.ntpCheckStartTime = currentMillis;
-
-  // 尝试获取NTP时间
-  bool success = false;
-
-  // 使用当前NTP服务器（先尝试当前，失败时下次会轮换）
-  strncpy_P(timeState.currentNtpServer, (const char*)pgm_read_ptr(&NTP_SERVERS[timeState.currentNtpServerIndex]), sizeof(timeState.currentNtpServer) - 1);
-  timeState.currentNtpServer[sizeof(timeState.currentNtpServer) - 1] = '\0';
-  timeClient.setPoolServerName(timeState.currentNtpServer);
-
-  LOG_DEBUG("Trying NTP server: %s", timeState.currentNtpServer);
-
-  // 使用非阻塞方式更新NTP时间，只尝试一次
-  yield(); // 让出控制权
-  ESP.wdtFeed(); // 喂看门狗
-
-  // 尝试更新NTP时间（只尝试一次，避免阻塞）
-  timeClient.update();
-
-  // 在NTP检查后调用yield()，确保按键响应
-  yield();
-
-  // 检查NTP时间是否有效
-  if (timeClient.isTimeSet()) {
-    time_t ntpTime = timeClient.getEpochTime();
-    LOG_DEBUG(" -> Got timestamp: %lu", ntpTime);
-
-    // 验证时间戳的合理性
-    if (ntpTime < 946684800UL || ntpTime > 4102444799UL) { // 2000-01-01 到 2099-12-31 23:59:59
-      LOG_DEBUG("NTP time out of range");
-      timeState.ntpCheckInProgress = false;
-      timeState.ntpCheckStartTime = 0;
-      return false;
-    }
-
-    success = true;
-    timeState.ntpFailCount = 0; // 成功后重置失败计数
-  } else {
-    LOG_DEBUG(" -> Failed");
-    // 记录NTP连接失败，并轮换到下一个服务器供下次尝试
-    timeState.ntpFailCount++;
-    static char ntpErrorMsg[60];
-    snprintf(ntpErrorMsg, sizeof(ntpErrorMsg), "NTP连接失败,服务器: %s", timeState.currentNtpServer);
-    timeState.currentNtpServerIndex = (timeState.currentNtpServerIndex + 1) % NTP_SERVER_COUNT;
-    if (timeState.ntpFailCount >= NTP_SERVER_COUNT) {
-      handleError(ERROR_NTP_CONNECTION_FAILED, ERROR_LEVEL_WARNING, "所有NTP服务器均失败");
-      timeState.ntpFailCount = 0;
-    } else {
-      handleError(ERROR_NTP_CONNECTION_FAILED, ERROR_LEVEL_WARNING, ntpErrorMsg);
-    }
+  // 发出请求，标记正在检查并记录开始时间
+  if (startNtpQuery()) {
+    timeState.ntpCheckInProgress = true;
+    timeState.ntpCheckStartTime = currentMillis;
   }
 
-  timeState.ntpCheckInProgress = false;
-  timeState.ntpCheckStartTime = 0;
-
-  // 在NTP检查后调用yield()，确保按键响应
-  yield();
-
-  return success;
+  return isNtpTimeSet();
 }
 
 void setupTimeSources() {
@@ -271,16 +267,9 @@ void setupTimeSources() {
   if (systemState.networkConnected) {
     LOG_DEBUG("RTC not available, trying NTP as backup...");
     
-    // 确保NTP客户端已初始化（重新初始化以确保可靠性）
-    timeClient.end();
-    // 使用非阻塞延时替代delay(100)
-    nonBlockingDelay(100);
-    timeClient.begin();
-    timeClient.setTimeOffset(8 * 3600);
-    timeClient.setPoolServerName(timeState.currentNtpServer);
-    LOG_DEBUG("NTP client initialized for backup time source");
-    
-    // 尝试获取NTP时间
+    initNtpEngine();
+
+    // 已有NTP时间时直接使用；否则发出请求，应答稍后由updateNtpSync()处理
     if (checkNtpConnection(false)) {
       // NTP连接成功，切换到NTP时间源
       switchTimeSource(TIME_SOURCE_NTP);
@@ -312,80 +301,130 @@ void setupTimeSources() {
   }
 }
 
-bool getCurrentTimeFromNtp(DateTime& now) {
-  if (!systemState.networkConnected) {
-    return false;
-  }
-  
-  // 确保NTP客户端已正确初始化
-  ensureNtpClientInitialized();
-  
-  // 检查NTP时间是否已设置（避免不必要的网络请求）
-  if (timeClient.isTimeSet()) {
-    time_t ntpTime = timeClient.getEpochTime();
-
-    // 验证NTP时间有效性
-    if (ntpTime > 946684800UL && ntpTime < 4102444799UL) {
-      struct tm ntpTm;
-      if (gmtime_r(&ntpTime, &ntpTm) == nullptr) {
-        LOG_WARNING("gmtime_r() returned nullptr for NTP time");
-        return false;
-      }
+// 辅助函数：时钟缓存是否需要重新读取DS1307锁定秒边界
+static bool rtcClockResyncDue(unsigned long currentMillis) {
+  return !rtcClock.valid || currentMillis - rtcClock.lockedMillis >= RTC_CLOCK_RESYNC_INTERVAL;
+}
 
-      // 检查年份有效性 (tm_year >= 100 表示2000年及以后)
-      if (ntpTm.tm_year >= 100) {
-        // 创建NTP时间的DateTime对象
-        DateTime ntpDateTime(ntpTm.tm_year + 1900, ntpTm.tm_mon + 1, ntpTm.tm_mday,
-                             ntpTm.tm_hour, ntpTm.tm_min, ntpTm.tm_sec);
-        now = ntpDateTime;  // 使用拷贝构造而非赋值操作符
-        return true;
-      }
+// 读取DS1307，检查读数与外推是否一致，并在看到秒寄存器变化时重新锁定秒边界
+static DateTime readRtcTracked() {
+  DateTime rtcNow = rtc.now();
+  unsigned long currentMillis = millis();
+
+  if (rtcClock.valid) {
+    // 秒边界附近允许相差一秒，其他时刻读数必须与外推一致
+    unsigned long intoSecond = (currentMillis - rtcClock.boundaryMillis) % 1000;
+    bool nearBoundary = intoSecond < 2 * RTC_PHASE_POLL_INTERVAL || intoSecond >= 1000 - 2 * RTC_PHASE_POLL_INTERVAL;
+    long diff = (long)(rtcNow.unixtime() - (rtcClock.anchorUnix + (currentMillis - rtcClock.boundaryMillis) / 1000));
+    if (diff != 0 && !(nearBoundary && (diff == 1 || diff == -1))) {
+      LOG_DEBUG("RTC clock cache off by %ld s, re-locking", diff);
+      rtcClock.valid = false;
     }
   }
 
-  // 如果时间未设置，尝试更新（仅在必要时）
-  if (!timeState.ntpCheckInProgress) {
-    timeState.ntpCheckInProgress = true;
-    timeClient.update();
-    timeState.ntpCheckInProgress = false;
+  if (rtcClock.haveLast && rtcNow.second() != rtcClock.lastSecond && isRtcTimeValid(rtcNow)) {
+    // 两次读取间隔很短：秒边界取两次读取的中点
+    unsigned long gap = currentMillis - rtcClock.lastReadMillis;
+    if (gap <= 2 * RTC_PHASE_POLL_INTERVAL) {
+      rtcClock.boundaryMillis = rtcClock.lastReadMillis + gap / 2;
+      rtcClock.anchorUnix = rtcNow.unixtime();
+      rtcClock.lockedMillis = currentMillis;
+      rtcClock.correctionMs = getRtcCorrectionMs(rtcClock.anchorUnix);
+      rtcClock.valid = true;
+    } else if (rtcClock.valid) {
+      // 读取窗口开始前秒寄存器已变化：预测边界偏晚，提前一个轮询间隔再找
+      rtcClock.boundaryMillis -= RTC_PHASE_POLL_INTERVAL;
+    }
   }
 
-  // 再次检查NTP时间是否有效
-  if (timeClient.isTimeSet()) {
-    time_t ntpTime = timeClient.getEpochTime();
+  rtcClock.haveLast = true;
+  rtcClock.lastSecond = rtcNow.second();
+  rtcClock.lastReadMillis = currentMillis;
+  return rtcNow;
+}
 
-    // 验证NTP时间有效性
-    if (ntpTime > 946684800UL && ntpTime < 4102444799UL) {
-      struct tm ntpTm;
-      if (gmtime_r(&ntpTime, &ntpTm) == nullptr) {
-        LOG_WARNING("gmtime_r() returned nullptr for NTP time (retry)");
-        return false;
-      }
+// 辅助函数：本地时间（毫秒）拆成DateTime和秒内毫秒
+static void localMillisToDateTime(uint64_t localMs, DateTime& now, uint16_t& subsecondMs) {
+  DateTime converted((uint32_t)(localMs / 1000));
+  now = converted;  // 使用拷贝构造而非赋值操作符
+  subsecondMs = (uint16_t)(localMs % 1000);
+}
 
-      // 检查年份有效性 (tm_year >= 100 表示2000年及以后)
-      if (ntpTm.tm_year >= 100) {
-        // 创建NTP时间的DateTime对象
-        DateTime ntpDateTime(ntpTm.tm_year + 1900, ntpTm.tm_mon + 1, ntpTm.tm_mday,
-                             ntpTm.tm_hour, ntpTm.tm_min, ntpTm.tm_sec);
-        now = ntpDateTime;  // 使用拷贝构造而非赋值操作符
-        return true;
-      }
+// 辅助函数：已锁定的时钟缓存当前的修正后时间（本地时间，毫秒）
+static uint64_t rtcClockMillis(unsigned long currentMillis) {
+  return (uint64_t)rtcClock.anchorUnix * 1000 + (currentMillis - rtcClock.boundaryMillis) - rtcClock.correctionMs;
+}
+
+/**
+ * @brief 从DS1307时钟缓存取时间
+ *
+ * 锁定秒边界后由millis()外推，不访问I2C；需要重新锁定时读取DS1307，
+ * 尚未锁定时直接返回修正后的读数（秒内相位未知）
+ */
+void getRtcClockTime(DateTime& now, uint16_t& subsecondMs) {
+  if (rtcClockResyncDue(millis())) {
+    DateTime rtcNow = readRtcTracked();
+    if (!rtcClock.valid) {
+      localMillisToDateTime((uint64_t)rtcNow.unixtime() * 1000 - getRtcCorrectionMs(rtcNow.unixtime()),
+                            now, subsecondMs);
+      return;
     }
   }
+  localMillisToDateTime(rtcClockMillis(millis()), now, subsecondMs);
+}
+
+/**
+ * @brief 写入DS1307后把时钟缓存锚定到写入时刻（写入会复位DS1307的秒分频链）
+ */
+void anchorRtcClock(const DateTime& written) {
+  unsigned long currentMillis = millis();
+  rtcClock.anchorUnix = written.unixtime();
+  rtcClock.boundaryMillis = currentMillis;
+  rtcClock.lockedMillis = currentMillis;
+  rtcClock.lastReadMillis = currentMillis;
+  rtcClock.lastSecond = written.second();
+  rtcClock.haveLast = true;
+  rtcClock.correctionMs = getRtcCorrectionMs(rtcClock.anchorUnix);
+  rtcClock.valid = true;
+}
+
+// 辅助函数：从NTP引擎取时间；尚无NTP时间时发出请求（受冷却时间限制），本次不等待应答
+static bool readNtpTime(DateTime& now, uint16_t& subsecondMs) {
+  if (!systemState.networkConnected) {
+    return false;
+  }
 
+  if (ntpTimeToDateTime(now, subsecondMs)) {
+    return true;
+  }
+
+  if (!timeState.ntpCheckInProgress) {
+    checkNtpConnection(false);
+  }
   return false;
 }
 
+bool getCurrentTimeFromNtp(DateTime& now) {
+  uint16_t subsecondMs;
+  return readNtpTime(now, subsecondMs);
+}
+
 bool getCurrentTime(DateTime& now) {
+  uint16_t subsecondMs;
+  return getCurrentTime(now, subsecondMs);
+}
+
+// 获取当前时间及秒内毫秒相位（DS1307相位未锁定时为0）
+bool getCurrentTime(DateTime& now, uint16_t& subsecondMs) {
+  subsecondMs = 0;
   // 简化的时间获取逻辑，避免频繁重试和阻塞
   switch (timeState.currentTimeSource) {
     case TIME_SOURCE_NTP:
-      return getCurrentTimeFromNtp(now);
+      return readNtpTime(now, subsecondMs);
       
     case TIME_SOURCE_RTC:
       if (systemState.rtcInitialized && systemState.rtcTimeValid) {
-        DateTime rtcNow = rtc.now();
-        now = rtcNow;  // 使用拷贝构造而非赋值操作符
+        getRtcClockTime(now, subsecondMs);
         return true;
       }
       return false;
@@ -397,9 +436,11 @@ bool getCurrentTime(DateTime& now) {
         unsigned long elapsed = (currentMillis >= timeState.softwareClockBase) ?
                               (currentMillis - timeState.softwareClockBase) :
                               (0xFFFFFFFF - timeState.softwareClockBase + currentMillis);
-        // 转换为秒并加到基准时间上
+        // 按晶振频偏修正后转换为秒并加到基准时间上
+        elapsed = correctElapsedMillis(elapsed);
         DateTime manualTime(timeState.softwareClockTime + elapsed / 1000);
         now = manualTime;  // 使用拷贝构造而非赋值操作符
+        subsecondMs = (uint16_t)(elapsed % 1000);
         return true;
       }
       return false;
@@ -410,6 +451,51 @@ bool getCurrentTime(DateTime& now) {
   }
 }
 
+/**
+ * @brief 距当前时间源下一个秒边界的毫秒数
+ *
+ * NTP、软件时钟和已锁定的DS1307缓存直接返回到边界的时间；DS1307缓存需要
+ * 重新锁定时，在预测边界前后按RTC_PHASE_POLL_INTERVAL读取，直到看到秒寄存器变化。
+ * 尚未锁定时返回轮询间隔以寻找边界
+ */
+unsigned long getMillisToNextSecond() {
+  unsigned long currentMillis = millis();
+  switch (timeState.currentTimeSource) {
+    case TIME_SOURCE_NTP:
+      if (isNtpTimeSet()) {
+        return 1000 - (unsigned long)(getNtpEpochMillis() % 1000);
+      }
+      break;
+
+    case TIME_SOURCE_RTC: {
+      if (!rtcClock.valid) {
+        return RTC_PHASE_POLL_INTERVAL;
+      }
+      if (!rtcClockResyncDue(currentMillis)) {
+        return 1000 - (unsigned long)(rtcClockMillis(currentMillis) % 1000);
+      }
+      // 重新锁定按原始读数的秒边界进行
+      unsigned long intoSecond = (currentMillis - rtcClock.boundaryMillis) % 1000;
+      unsigned long toBoundary = 1000 - intoSecond;
+      // 需要重新锁定：在预测边界前后的窗口内逐次读取，其余时间等到窗口开始
+      if (toBoundary <= 2 * RTC_PHASE_POLL_INTERVAL || intoSecond < 2 * RTC_PHASE_POLL_INTERVAL) {
+        return RTC_PHASE_POLL_INTERVAL;
+      }
+      return toBoundary - 2 * RTC_PHASE_POLL_INTERVAL;
+    }
+
+    case TIME_SOURCE_MANUAL:
+      if (timeState.softwareClockValid) {
+        return 1000 - correctElapsedMillis(currentMillis - timeState.softwareClockBase) % 1000;
+      }
+      break;
+
+    default:
+      break;
+  }
+  return DISPLAY_UPDATE_INTERVAL;
+}
+
 void syncNtpToRtc() {
   if (!systemState.rtcInitialized) {
     LOG_DEBUG("RTC not initialized, cannot sync");
@@ -436,122 +522,147 @@ void syncNtpToRtc() {
   LOG_DEBUG("Starting non-blocking NTP sync to RTC");
 }
 
-// 非阻塞更新NTP同步状态（在主循环中调用）
-void updateNtpSync() {
-  if (!timeState.ntpSyncInProgress) {
+// 辅助函数：把刚收到的NTP时间写入DS1307，结束本次同步
+static void writeNtpTimeToRtc() {
+  timeState.ntpSyncInProgress = false;
+  rtcWritePending = false;
+
+  DateTime rtcTime;
+  uint16_t subsecondMs;
+  if (!ntpTimeToDateTime(rtcTime, subsecondMs)) {
+    LOG_DEBUG("Failed to parse NTP time for RTC synchronization");
+    handleError(ERROR_TIME_SETTING_INVALID, ERROR_LEVEL_ERROR, "Invalid NTP timestamp");
     return;
   }
 
-  unsigned long currentMillis = millis();
-  const unsigned long SYNC_TIMEOUT = 5000; // 5秒超时
-  const int MAX_RETRIES = 3; // 最大重试次数
+  // 验证时间有效性
+  if (!isRtcTimeValid(rtcTime)) {
+    LOG_DEBUG("RTC time validation failed after NTP sync");
+    handleError(ERROR_RTC_TIME_INVALID, ERROR_LEVEL_ERROR, "RTC time validation failed");
+    return;
+  }
 
-  // 检查超时
-  unsigned long syncElapsed = (currentMillis >= timeState.ntpSyncStartTime) ?
-                              (currentMillis - timeState.ntpSyncStartTime) :
-                              (0xFFFFFFFF - timeState.ntpSyncStartTime + currentMillis);
+  // 写入复位DS1307的秒分频链，写入时刻即为RTC新的秒边界
+  rtc.adjust(rtcTime);
+  noteRtcWritten(rtcTime.unixtime());
+  anchorRtcClock(rtcTime);
 
-  if (syncElapsed >= SYNC_TIMEOUT) {
-    LOG_WARNING("NTP sync timeout after %lu ms", syncElapsed);
+  systemState.rtcTimeValid = true;
+  timeState.lastRtcSync = millis();
+  timeState.ntpSyncRetryCount = 0;
+
+  LOG_DEBUG("NTP time successfully synchronized to RTC: %04d/%02d/%02d %02d:%02d:%02d (+%u ms)",
+         rtcTime.year(), rtcTime.month(), rtcTime.day(),
+         rtcTime.hour(), rtcTime.minute(), rtcTime.second(), subsecondMs);
+}
+
+// 辅助函数：推进RTC偏差测量（每次最多读取一次DS1307）
+// 锁定新的秒边界后与NTP比较，由频偏修正决定是重写RTC还是保留
+static void updateRtcOffsetMeasurement() {
+  unsigned long currentMillis = millis();
+  if (rtcClock.valid && (long)(rtcClock.lockedMillis - rtcMeasureStart) >= 0) {
+    rtcMeasurePending = false;
+    int64_t rtcMs = (int64_t)rtcClock.anchorUnix * 1000 + (currentMillis - rtcClock.boundaryMillis);
+    int64_t ntpMs = (int64_t)getNtpEpochMillis() + (int64_t)NTP_TIME_OFFSET * 1000;
+    if (updateRtcDiscipline((int32_t)(rtcMs - ntpMs), (uint32_t)(rtcMs / 1000))) {
+      rtcWritePending = true;
+      rtcWritePendingSecond = getNtpEpochTime();
+      return;
+    }
+    // 修正后的RTC仍然准确：保留RTC，让频偏测量的基线继续延长
     timeState.ntpSyncInProgress = false;
-    handleError(ERROR_NTP_CONNECTION_FAILED, ERROR_LEVEL_WARNING, "NTP sync timeout");
+    timeState.lastRtcSync = currentMillis;
+    timeState.ntpSyncRetryCount = 0;
     return;
   }
 
-  // 检查重试次数
-  if (timeState.ntpSyncRetryCount >= MAX_RETRIES) {
-    LOG_WARNING("NTP sync max retries reached");
-    timeState.ntpSyncInProgress = false;
-    handleError(ERROR_NTP_CONNECTION_FAILED, ERROR_LEVEL_WARNING, "NTP sync max retries reached");
+  if (currentMillis - rtcMeasureStart >= RTC_OFFSET_MEASURE_TIMEOUT) {
+    // 找不到秒边界（RTC停走或读取太慢）：直接写入
+    LOG_DEBUG("RTC offset measurement timed out, rewriting RTC");
+    rtcMeasurePending = false;
+    rtcWritePending = true;
+    rtcWritePendingSecond = getNtpEpochTime();
     return;
   }
+  if (currentMillis - rtcClock.lastReadMillis >= RTC_PHASE_POLL_INTERVAL) {
+    readRtcTracked();
+  }
+}
 
-  // 检查网络连接
-  if (WiFi.status() != WL_CONNECTED) {
-    LOG_WARNING("Network disconnected during NTP sync");
-    timeState.ntpSyncInProgress = false;
-    handleError(ERROR_NTP_CONNECTION_FAILED, ERROR_LEVEL_WARNING, "Network disconnected during NTP sync");
-    return;
+// 辅助函数：NTP时间可用，RTC时间有效时先测量偏差，否则等秒边界直接写入
+static void beginRtcSyncFromNtp() {
+  if (systemState.rtcTimeValid) {
+    rtcMeasurePending = true;
+    rtcMeasureStart = millis();
+  } else {
+    rtcWritePending = true;
+    rtcWritePendingSecond = getNtpEpochTime();
   }
+}
 
-  // 尝试更新NTP时间（每次调用只尝试一次）
-  yield();
-  ESP.wdtFeed();
+// 非阻塞更新NTP查询与同步状态（在主循环中调用）
+// 每次调用只推进一次NTP引擎，收发、超时和服务器轮换都不在此等待
+void updateNtpSync() {
+  PROFILE_SCOPE("updateNtpSync");
+  BREADCRUMB_SECTION("updateNtpSync");
+  const int MAX_RETRIES = 3; // 同步的最大查询次数（每次查询已包含服务器轮换）
 
-  bool updateSuccess = timeClient.forceUpdate();
+  // 等到NTP时间跨过下一个秒边界再写入DS1307，使RTC的秒边界与NTP对齐
+  if (rtcWritePending && getNtpEpochTime() != rtcWritePendingSecond) {
+    writeNtpTimeToRtc();
+  }
+  if (rtcMeasurePending) {
+    updateRtcOffsetMeasurement();
+  }
 
-  if (updateSuccess) {
-    // 获取NTP时间戳并验证有效性
-    time_t ntpTime = timeClient.getEpochTime();
+  NtpResult result = updateNtpEngine();
 
-    // 检查时间戳有效性 (2000年到2099年之间)
-    if (ntpTime < 946684800UL || ntpTime > 4102444799UL) {
-      LOG_DEBUG("Invalid NTP timestamp: %lld", (long long)ntpTime);
-      timeState.ntpSyncInProgress = false;
-      handleError(ERROR_TIME_SETTING_INVALID, ERROR_LEVEL_ERROR, "Invalid NTP timestamp");
-      return;
+  if (result == NTP_RESULT_OK) {
+    timeState.ntpCheckInProgress = false;
+    timeState.ntpCheckStartTime = 0;
+    timeState.ntpFailCount = 0;
+    if (timeState.currentTimeSource == TIME_SOURCE_NTP) {
+      systemState.needsRefresh = true;
     }
-
-    // 使用gmtime_r替代gmtime，避免线程安全问题
-    struct tm ntpTm;
-    if (gmtime_r(&ntpTime, &ntpTm) == nullptr) {
-      LOG_ERROR("gmtime_r() returned nullptr for NTP time");
-      timeState.ntpSyncInProgress = false;
-      handleError(ERROR_TIME_SETTING_INVALID, ERROR_LEVEL_ERROR, "gmtime_r returned nullptr");
-      return;
+    if (timeState.ntpSyncInProgress && !rtcWritePending && !rtcMeasurePending) {
+      beginRtcSyncFromNtp();
     }
+    return;
+  }
 
-    // 检查年份有效性
-    if (ntpTm.tm_year >= 100) {
-      // 验证时间字段的合理性
-      if (ntpTm.tm_mon >= 0 && ntpTm.tm_mon < 12 &&
-          ntpTm.tm_mday >= 1 && ntpTm.tm_mday <= 31 &&
-          ntpTm.tm_hour >= 0 && ntpTm.tm_hour < 24 &&
-          ntpTm.tm_min >= 0 && ntpTm.tm_min < 60 &&
-          ntpTm.tm_sec >= 0 && ntpTm.tm_sec < 60) {
-
-        // 将NTP时间同步到DS1307
-        DateTime rtcTime(ntpTm.tm_year + 1900, ntpTm.tm_mon + 1, ntpTm.tm_mday,
-                        ntpTm.tm_hour, ntpTm.tm_min, ntpTm.tm_sec);
-
-        // 验证时间有效性
-        if (isRtcTimeValid(rtcTime)) {
-          rtc.adjust(rtcTime);
-          systemState.rtcTimeValid = true;
-          timeState.lastRtcSync = currentMillis;
-          timeState.ntpSyncRetryCount = 0;
-
-          LOG_DEBUG("NTP time successfully synchronized to RTC: %04d/%02d/%02d %02d:%02d:%02d",
-                 rtcTime.year(), rtcTime.month(), rtcTime.day(),
-                 rtcTime.hour(), rtcTime.minute(), rtcTime.second());
-        } else {
-          LOG_DEBUG("RTC time validation failed after NTP sync");
-          timeState.ntpSyncInProgress = false;
-          handleError(ERROR_RTC_TIME_INVALID, ERROR_LEVEL_ERROR, "RTC time validation failed");
-        }
-      } else {
-        LOG_DEBUG("NTP time field validation failed");
+  if (result == NTP_RESULT_FAILED) {
+    timeState.ntpCheckInProgress = false;
+    timeState.ntpCheckStartTime = 0;
+    handleError(ERROR_NTP_CONNECTION_FAILED, ERROR_LEVEL_WARNING, "所有NTP服务器均失败");
+
+    if (timeState.ntpSyncInProgress) {
+      timeState.ntpSyncRetryCount++;
+      LOG_DEBUG("NTP sync attempt %d failed", timeState.ntpSyncRetryCount);
+      if (timeState.ntpSyncRetryCount >= MAX_RETRIES) {
         timeState.ntpSyncInProgress = false;
-        handleError(ERROR_TIME_SETTING_INVALID, ERROR_LEVEL_ERROR, "NTP time field validation failed");
+        handleError(ERROR_NTP_CONNECTION_FAILED, ERROR_LEVEL_WARNING, "NTP sync failed after max retries");
       }
-    } else {
-      LOG_DEBUG("Failed to parse NTP time for RTC synchronization");
-      timeState.ntpSyncInProgress = false;
-      handleError(ERROR_TIME_SETTING_INVALID, ERROR_LEVEL_ERROR, "Failed to parse NTP time");
-    }
-  } else {
-    // 更新失败，增加重试计数
-    timeState.ntpSyncRetryCount++;
-    LOG_DEBUG("NTP sync attempt %d failed", timeState.ntpSyncRetryCount);
-
-    // 如果达到最大重试次数，放弃同步
-    if (timeState.ntpSyncRetryCount >= MAX_RETRIES) {
-      timeState.ntpSyncInProgress = false;
-      handleError(ERROR_NTP_CONNECTION_FAILED, ERROR_LEVEL_WARNING, "NTP sync failed after max retries");
     }
+    return;
+  }
+
+  if (!timeState.ntpSyncInProgress || rtcWritePending || rtcMeasurePending || isNtpQueryInProgress()) {
+    return;
   }
 
-  yield();
+  // 同步已请求但没有查询在进行：检查网络后发出新的请求
+  if (WiFi.status() != WL_CONNECTED) {
+    LOG_WARNING("Network disconnected during NTP sync");
+    timeState.ntpSyncInProgress = false;
+    handleError(ERROR_NTP_CONNECTION_FAILED, ERROR_LEVEL_WARNING, "Network disconnected during NTP sync");
+    return;
+  }
+  // 轮询间隔只在外推误差很小时放长，间隔内的NTP时间可以直接同步RTC，不另发查询
+  if (getNtpResultAge() <= getNtpPollInterval()) {
+    beginRtcSyncFromNtp();
+    return;
+  }
+  startNtpQuery();
 }
 
 void switchTimeSource(TimeSource newSource) {
@@ -564,8 +675,8 @@ void switchTimeSource(TimeSource newSource) {
     // 根据新的时间源类型执行特定操作
     switch (newSource) {
       case TIME_SOURCE_NTP:
-        // 确保NTP客户端已初始化
-        ensureNtpClientInitialized();
+        // 确保NTP端口已打开
+        initNtpEngine();
         break;
         
       case TIME_SOURCE_RTC:
@@ -710,7 +821,7 @@ void displayTimeSourceSettingScreen() {
     }
   }
 
-  u8g2.sendBuffer();
+  flushDisplay();
 }
 
 void selectNextTimeSource() {
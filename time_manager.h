@@ -17,7 +17,6 @@
 #define TIME_MANAGER_H
 
 #include <Arduino.h>
-#include <NTPClient.h>
 #include <RTClib.h>
 #include "global_config.h"
 
@@ -33,6 +32,10 @@ extern TimeState timeState;
 void setupTimeSources(); // 设置时间源
 bool checkNtpConnection(bool forceCheck = false); // 检查NTP连接
 bool getCurrentTime(DateTime& now); // 获取当前时间（从NTP或DS1306）
+bool getCurrentTime(DateTime& now, uint16_t& subsecondMs); // 获取当前时间及秒内毫秒相位
+unsigned long getMillisToNextSecond(); // 距当前时间源下一个秒边界的毫秒数（用于安排下一帧）
+void getRtcClockTime(DateTime& now, uint16_t& subsecondMs); // 从DS1307时钟缓存取时间（稳态不访问I2C）
+void anchorRtcClock(const DateTime& written); // 写入DS1307后锚定时钟缓存
 bool getCurrentTimeFromNtp(DateTime& now); // 从NTP获取当前时间
 void syncNtpToRtc(); // 将NTP时间同步到DS1307（启动非阻塞同步）
 void updateNtpSync(); // 更新NTP同步状态（非阻塞，在主循环中调用）
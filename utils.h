@@ -17,4 +17,32 @@
 // 函数声明
 void nonBlockingDelay(unsigned long delayMs);
 
+/**
+ * @brief 公历日期转换为自1970-01-01起的天数（常数时间）
+ *
+ * 采用days_from_civil算法：把3月作为一年的第一个月，闰日落在年末，
+ * 按400年周期(146097天)直接求出天数，无需逐年逐月累加
+ *
+ * @param year 年
+ * @param month 月 (1-12)
+ * @param day 日 (1-31)
+ * @return 天数（1970-01-01之前为负数）
+ */
+constexpr long daysFromCivil(int year, int month, int day) {
+    int y = year - (month <= 2 ? 1 : 0);
+    long era = (y >= 0 ? y : y - 399) / 400;
+    long yoe = y - era * 400;                                            // [0, 399]
+    long doy = (153L * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;  // [0, 365]
+    long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;                   // [0, 146096]
+    return era * 146097 + doe - 719468;
+}
+
+/**
+ * @brief 由daysFromCivil的天数求星期
+ * @return 0=星期日 ... 6=星期六（与RTClib的dayOfTheWeek一致）
+ */
+constexpr int weekdayFromDays(long days) {
+    return (int)((days % 7 + 11) % 7);  // 1970-01-01为星期四
+}
+
 #endif
\ No newline at end of file
@@ -7,14 +7,20 @@
  * @date 2026-02-05
  */
 
+#define LOG_MODULE OTA
+
 #include "web_ota_manager.h"
 #include "global_config.h"
 #include "utils.h"
 #include "display_manager.h"
 #include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
 #include <ESP8266HTTPUpdateServer.h>
 #include <ESP8266httpUpdate.h>
 #include "version.h"
+#include "loop_profiler.h"
+#include "breadcrumbs.h"
+#include "config_store.h"
 
 // Web服务器和HTTP更新服务器
 ESP8266WebServer webServer(80);
@@ -33,6 +39,8 @@ void handleCustomOTAUpdate() {
     // 开始上传
     otaUpdateStarted = true;
     otaUpdateComplete = false;
+    // 写入固件前先保存未写回的配置，升级失败断电也不丢
+    flushConfigStore();
     webOtaState.status = WEB_OTA_STATUS_UPLOADING;
     webOtaState.startTime = millis();
     webOtaState.progress = 0;
@@ -160,6 +168,8 @@ void initWebOtaManager() {
 void updateWebOtaManager() {
     // 处理Web服务器客户端
     if (webOtaState.status == WEB_OTA_STATUS_ACTIVE) {
+        PROFILE_SCOPE("webOta");
+        BREADCRUMB_SECTION("webOta");
         webServer.handleClient();
     }
 }
@@ -318,6 +328,9 @@ void startWebOtaServer() {
         // 如果更新成功，延迟重启
         if (otaUpdateComplete && webOtaState.status == WEB_OTA_STATUS_SUCCESS) {
             nonBlockingDelay(5000);
+            recordRestartBreadcrumb("web OTA update");
+            flushConfigStore();
+            flushLogBuffer();
             ESP.restart();
         }
     }, handleCustomOTAUpdate);
@@ -334,6 +347,16 @@ void startWebOtaServer() {
         webServer.send(200, "application/json", json);
     });
 
+    // 配置性能分析报告页面
+    webServer.on("/profile", HTTP_GET, []() {
+        webServer.send(200, "text/plain", getProfilerReport());
+    });
+
+    // 配置诊断记录页面（复位原因和上次启动的记录）
+    webServer.on("/breadcrumbs", HTTP_GET, []() {
+        webServer.send(200, "text/plain", getBreadcrumbReport());
+    });
+
     // 启动Web服务器
     webServer.begin();
 